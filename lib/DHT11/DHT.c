@@ -20,7 +20,7 @@ static int _waitOrTimeout(uint16_t microSeconds, int level) {
     return micros_ticks;
 }
 
-static int _checkCRC(uint8_t data[]) {
+int DHT11_checkCRC(const uint8_t data[5]) {
     if(data[4] == (data[0] + data[1] + data[2] + data[3]))
         return DHT11_OK;
     else
@@ -72,31 +72,39 @@ struct dht11_reading DHT11_read() {
 
     last_read_time = esp_timer_get_time();
 
-    uint8_t data[5] = {0,0,0,0,0};
+    int16_t pulses[DHT11_FRAME_BITS];
 
     _sendStartSignal();
 
     if(_checkResponse() == DHT11_TIMEOUT_ERROR)
         return last_read = _timeoutError();
     
-    /* Read response */
-    for(int i = 0; i < 40; i++) {
+    /* Read response: only capture the high-pulse widths here, decode afterwards */
+    for(int i = 0; i < DHT11_FRAME_BITS; i++) {
         /* Initial data */
         if(_waitOrTimeout(50, 0) == DHT11_TIMEOUT_ERROR)
             return last_read = _timeoutError();
-                
-        if(_waitOrTimeout(70, 1) > 28) {
+
+        pulses[i] = _waitOrTimeout(70, 1);
+    }
+
+    return last_read = DHT11_decode(pulses);
+}
+
+struct dht11_reading DHT11_decode(const int16_t pulses[DHT11_FRAME_BITS]) {
+    uint8_t data[5] = {0,0,0,0,0};
+
+    for(int i = 0; i < DHT11_FRAME_BITS; i++) {
+        if(pulses[i] > DHT11_ONE_THRESHOLD_US) {
             /* Bit received was a 1 */
             data[i/8] |= (1 << (7-(i%8)));
         }
     }
 
-    if(_checkCRC(data) != DHT11_CRC_ERROR) {
-        last_read.status = DHT11_OK;
-        last_read.temperature = data[2];
-        last_read.humidity = data[0];
-        return last_read;
+    if(DHT11_checkCRC(data) != DHT11_CRC_ERROR) {
+        struct dht11_reading reading = {DHT11_OK, data[2], data[0]};
+        return reading;
     } else {
-        return last_read = _crcError();
+        return _crcError();
     }
 }
\ No newline at end of file
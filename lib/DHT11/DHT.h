@@ -1,8 +1,14 @@
 #ifndef DHT11_H_
 #define DHT11_H_
 
+#include <stdint.h>
 #include "driver/gpio.h"
 
+/* One frame is 40 bits: humidity (2 bytes), temperature (2 bytes), checksum */
+#define DHT11_FRAME_BITS 40
+/* High pulses longer than this (in ~1us polling steps) are decoded as a 1 */
+#define DHT11_ONE_THRESHOLD_US 28
+
 enum dht11_status {
     DHT11_CRC_ERROR = -2,
     DHT11_TIMEOUT_ERROR,
@@ -19,4 +25,11 @@ void DHT11_init(gpio_num_t);
 
 struct dht11_reading DHT11_read();
 
+/* Packs 40 captured high-pulse widths into bytes and validates the checksum.
+   Pure function (no GPIO access), so it can be benchmarked or replayed. */
+struct dht11_reading DHT11_decode(const int16_t pulses[DHT11_FRAME_BITS]);
+
+/* Returns DHT11_OK if data[4] matches the sum of data[0..3], else DHT11_CRC_ERROR */
+int DHT11_checkCRC(const uint8_t data[5]);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include <string.h>
+
+#include "frame_auth.h"
+
+// --- SipHash-2-4 ---
+
+#define ROTL64(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+
+#define SIPROUND(v0, v1, v2, v3) do {                                          \
+        v0 += v1; v1 = ROTL64(v1, 13); v1 ^= v0; v0 = ROTL64(v0, 32);         \
+        v2 += v3; v3 = ROTL64(v3, 16); v3 ^= v2;                              \
+        v0 += v3; v3 = ROTL64(v3, 21); v3 ^= v0;                              \
+        v2 += v1; v1 = ROTL64(v1, 17); v1 ^= v2; v2 = ROTL64(v2, 32);         \
+    } while (0)
+
+static inline uint64_t load_le64(const uint8_t* p) {
+    return (uint64_t)p[0] | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) | ((uint64_t)p[3] << 24) |
+           ((uint64_t)p[4] << 32) | ((uint64_t)p[5] << 40) | ((uint64_t)p[6] << 48) | ((uint64_t)p[7] << 56);
+}
+
+uint64_t fa_siphash(const fa_key_t* key, const uint8_t* data, size_t len) {
+    uint64_t v0 = 0x736f6d6570736575ULL ^ key->k0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ key->k1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ key->k0;
+    uint64_t v3 = 0x7465646279746573ULL ^ key->k1;
+
+    const uint8_t* end = data + (len & ~(size_t)7);
+    for (; data != end; data += 8) {
+        uint64_t m = load_le64(data);
+        v3 ^= m;
+        SIPROUND(v0, v1, v2, v3);
+        SIPROUND(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+
+    uint64_t b = (uint64_t)len << 56;
+    for (size_t i = 0; i < (len & 7); i++) {
+        b |= (uint64_t)data[i] << (8 * i);
+    }
+    v3 ^= b;
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    v0 ^= b;
+
+    v2 ^= 0xff;
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+// --- Keys ---
+
+void fa_key_from_bytes(fa_key_t* key, const uint8_t bytes[FA_KEY_LEN]) {
+    key->k0 = load_le64(bytes);
+    key->k1 = load_le64(bytes + 8);
+}
+
+void fa_derive_key(const fa_key_t* site_key, const uint8_t mac[6], fa_key_t* out) {
+    // Two domain-separated PRF outputs keyed by the site key
+    uint8_t msg[8];
+    memcpy(msg, mac, 6);
+    msg[6] = 'K';
+    msg[7] = 0;
+    out->k0 = fa_siphash(site_key, msg, sizeof(msg));
+    msg[7] = 1;
+    out->k1 = fa_siphash(site_key, msg, sizeof(msg));
+}
+
+void fa_derive_group_key(const fa_key_t* site_key, fa_key_t* out) {
+    static const uint8_t broadcast[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    fa_derive_key(site_key, broadcast, out);
+}
+
+// --- Sign / Verify ---
+
+size_t fa_sign(const fa_key_t* key, uint32_t seq, uint8_t* frame, size_t payload_len, size_t cap) {
+    if (frame == NULL || cap < payload_len + FA_TRAILER_LEN) return 0;
+    uint8_t* p = frame + payload_len;
+    p[0] = (uint8_t)seq;
+    p[1] = (uint8_t)(seq >> 8);
+    p[2] = (uint8_t)(seq >> 16);
+    p[3] = (uint8_t)(seq >> 24);
+    uint64_t tag = fa_siphash(key, frame, payload_len + 4); // Tag covers the sequence number too
+    for (int i = 0; i < FA_TAG_LEN; i++) {
+        p[4 + i] = (uint8_t)(tag >> (8 * i));
+    }
+    return payload_len + FA_TRAILER_LEN;
+}
+
+bool fa_replay_accept(fa_replay_t* window, uint32_t seq) {
+    if (!window->primed) {
+        window->primed = true;
+        window->top = seq;
+        window->seen = 1;
+        return true;
+    }
+    if (seq > window->top) {
+        uint32_t shift = seq - window->top;
+        window->seen = shift >= FA_REPLAY_WINDOW ? 1 : (window->seen << shift) | 1;
+        window->top = seq;
+        return true;
+    }
+    uint32_t age = window->top - seq;
+    if (age >= FA_REPLAY_WINDOW) return false;
+    uint64_t bit = 1ULL << age;
+    if (window->seen & bit) return false;
+    window->seen |= bit;
+    return true;
+}
+
+void fa_replay_merge(fa_replay_t* window, const fa_replay_t* other) {
+    if (!other->primed) return;
+    if (!window->primed) {
+        *window = *other;
+        return;
+    }
+    if (other->top > window->top) {
+        uint32_t shift = other->top - window->top;
+        window->seen = (shift >= FA_REPLAY_WINDOW ? 0 : window->seen << shift) | other->seen;
+        window->top = other->top;
+    } else {
+        uint32_t shift = window->top - other->top;
+        if (shift < FA_REPLAY_WINDOW) window->seen |= other->seen << shift;
+    }
+}
+
+uint32_t fa_frame_seq(const uint8_t* frame, size_t len) {
+    if (frame == NULL || len < FA_TRAILER_LEN) return 0;
+    const uint8_t* p = frame + len - FA_TRAILER_LEN;
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+esp_err_t fa_verify(const fa_key_t* key, fa_replay_t* window, const uint8_t* frame, size_t len, size_t* payload_len) {
+    if (frame == NULL || len < FA_TRAILER_LEN) return ESP_ERR_INVALID_SIZE;
+    size_t body = len - FA_TRAILER_LEN;
+    const uint8_t* p = frame + body;
+
+    uint64_t tag = fa_siphash(key, frame, body + 4);
+    uint8_t diff = 0; // Constant-time compare
+    for (int i = 0; i < FA_TAG_LEN; i++) {
+        diff |= p[4 + i] ^ (uint8_t)(tag >> (8 * i));
+    }
+    if (diff != 0) return ESP_ERR_INVALID_CRC;
+
+    if (!fa_replay_accept(window, fa_frame_seq(frame, len))) return ESP_ERR_INVALID_STATE;
+
+    if (payload_len) *payload_len = body;
+    return ESP_OK;
+}
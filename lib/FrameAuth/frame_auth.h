@@ -0,0 +1,111 @@
+#ifndef FRAME_AUTH_H
+#define FRAME_AUTH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Application-level authentication for ESP-NOW frames.
+//
+// Each slave has its own 128-bit key, derived from a site key and the slave's MAC so
+// the master needs no key table. A signed frame is the unchanged payload followed by a
+// 12-byte trailer: a 32-bit sequence number and a SipHash-2-4 tag over payload + sequence,
+// truncated to 64 bits. SipHash was chosen over ESP-NOW's own LMK encryption because
+// the radio only supports a handful of encrypted peers (CONFIG_ESP_WIFI_ESPNOW_MAX_ENCRYPT_NUM)
+// and the master serves up to 64 slaves, and over HMAC-SHA256 because it costs a few
+// microseconds per frame without touching the SHA peripheral.
+//
+// The receiver keeps a sliding window per sender (highest sequence plus a 64-bit bitmap),
+// so frames may arrive out of order within the window but each is accepted only once.
+//
+// Frames broadcast to every node of a site (slot beacons, time sync, route adverts) are
+// signed with the site's group key instead: the key derived for the broadcast address.
+
+#define FA_KEY_LEN      16
+#define FA_TAG_LEN      8
+#define FA_TRAILER_LEN  (4 + FA_TAG_LEN)
+#define FA_REPLAY_WINDOW 64
+
+typedef struct {
+    uint64_t k0;
+    uint64_t k1;
+} fa_key_t;
+
+// Replay window for one sender
+typedef struct {
+    bool primed;        // false until the first authentic frame
+    uint32_t top;       // highest sequence accepted
+    uint64_t seen;      // bit n set = sequence (top - n) accepted
+} fa_replay_t;
+
+/**
+ * @brief Loads a key from its 16-byte little-endian representation.
+ */
+void fa_key_from_bytes(fa_key_t* key, const uint8_t bytes[FA_KEY_LEN]);
+
+/**
+ * @brief Derives a slave's key from the site key and the slave's MAC address.
+ *
+ * @param site_key Key shared by the master and provisioning.
+ * @param mac Slave MAC (the source address its frames arrive from).
+ * @param out Per-slave key.
+ */
+void fa_derive_key(const fa_key_t* site_key, const uint8_t mac[6], fa_key_t* out);
+
+/**
+ * @brief Derives the site's group key (the key of FF:FF:FF:FF:FF:FF), which signs
+ *        broadcast frames.
+ */
+void fa_derive_group_key(const fa_key_t* site_key, fa_key_t* out);
+
+/**
+ * @brief SipHash-2-4 of data under key.
+ */
+uint64_t fa_siphash(const fa_key_t* key, const uint8_t* data, size_t len);
+
+/**
+ * @brief Appends the sequence number and tag to a frame in place.
+ *
+ * @param key Sender's key.
+ * @param seq Sequence number; must never repeat for this key.
+ * @param frame Buffer holding the payload, with room for the trailer.
+ * @param payload_len Payload length.
+ * @param cap Buffer size.
+ * @return Signed frame length, or 0 if cap < payload_len + FA_TRAILER_LEN.
+ */
+size_t fa_sign(const fa_key_t* key, uint32_t seq, uint8_t* frame, size_t payload_len, size_t cap);
+
+/**
+ * @brief Checks a signed frame's tag and sequence number. The replay window is only
+ *        updated for authentic frames.
+ *
+ * @param key Sender's key.
+ * @param window Sender's replay window.
+ * @param frame Received frame.
+ * @param len Received length.
+ * @param payload_len Set to the payload length on success (may be NULL).
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE if too short for a trailer, ESP_ERR_INVALID_CRC if
+ *         the tag does not match, ESP_ERR_INVALID_STATE if the sequence was already seen
+ *         or is older than the window.
+ */
+esp_err_t fa_verify(const fa_key_t* key, fa_replay_t* window, const uint8_t* frame, size_t len, size_t* payload_len);
+
+/**
+ * @brief Sequence number from a signed frame's trailer (not checked; 0 if too short).
+ */
+uint32_t fa_frame_seq(const uint8_t* frame, size_t len);
+
+/**
+ * @brief Replay check on its own: accepts seq once if newer than, or inside, the window.
+ * @return true if accepted (and recorded).
+ */
+bool fa_replay_accept(fa_replay_t* window, uint32_t seq);
+
+/**
+ * @brief Merges another receiver's window for the same sender into window (union of
+ *        accepted sequence numbers), e.g. from a peer master's CTRL_MASTER_SYNC frame.
+ */
+void fa_replay_merge(fa_replay_t* window, const fa_replay_t* other);
+
+#endif // FRAME_AUTH_H
@@ -0,0 +1,490 @@
+#include "history.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "HISTORY";
+
+// --- On-Flash Layout ---
+// [header 32 B][records ...][footer: count, t_last, sparse index]
+// The header's sealed word stays 0xFFFFFFFF until the footer has been written.
+
+#define HIST_MAGIC 0x31545348u // "HST1"
+#define HIST_ERASED32 0xFFFFFFFFu
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t seq;          // Increases by one per segment started; orders the ring
+    uint32_t t_first;
+    uint32_t reserved;
+    uint32_t sealed;       // 0 once the footer is valid
+    uint8_t pad[12];
+} hist_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t t;            // First valid timestamp in the stride (UINT32_MAX if none)
+    uint64_t slaves;       // Bit (slave & 63) set if the stride holds a record of that slave
+} hist_index_entry_t;
+
+#define HIST_FOOTER_FIXED (2 * sizeof(uint32_t))
+#define HIST_RECORDS_PER_SEGMENT_RAW ((HIST_SEGMENT_SIZE - sizeof(hist_header_t) - HIST_FOOTER_FIXED) / sizeof(hist_record_t))
+#define HIST_INDEX_PER_SEGMENT ((HIST_RECORDS_PER_SEGMENT_RAW + HIST_INDEX_STRIDE - 1) / HIST_INDEX_STRIDE)
+
+typedef struct __attribute__((packed)) {
+    uint32_t count;
+    uint32_t t_last;
+    hist_index_entry_t index[HIST_INDEX_PER_SEGMENT];
+} hist_footer_t;
+
+#define HIST_RECORDS_PER_SEGMENT ((HIST_SEGMENT_SIZE - sizeof(hist_header_t) - sizeof(hist_footer_t)) / sizeof(hist_record_t))
+#define HIST_FOOTER_OFFSET (sizeof(hist_header_t) + HIST_RECORDS_PER_SEGMENT * sizeof(hist_record_t))
+
+_Static_assert(sizeof(hist_record_t) == 16, "hist_record_t must stay 16 bytes");
+_Static_assert(HIST_SEGMENT_SIZE % 4096 == 0, "segments must be whole flash sectors");
+_Static_assert((HIST_RECORDS_PER_SEGMENT + HIST_INDEX_STRIDE - 1) / HIST_INDEX_STRIDE <= HIST_INDEX_PER_SEGMENT,
+               "sparse index does not cover the segment");
+
+#define HIST_READ_CHUNK 32 // Records per backend read during scans
+
+// --- In-Memory State ---
+
+typedef struct {
+    bool valid;
+    bool sealed;
+    bool closed;           // A record write failed; sealed before the next append
+    uint32_t seq;
+    uint32_t t_first;
+    uint32_t t_last;
+    uint32_t count;        // Record slots used (including torn ones)
+    hist_index_entry_t index[HIST_INDEX_PER_SEGMENT];
+} hist_segment_t;
+
+struct hist_store {
+    hist_backend_t be;
+    uint32_t n_segments;
+    int active;            // Segment taking appends, -1 if the store is empty
+    hist_segment_t* segs;
+    SemaphoreHandle_t lock;
+    bool have_newest;
+    uint32_t t_newest;
+};
+
+static inline size_t seg_base(uint32_t seg) {
+    return (size_t)seg * HIST_SEGMENT_SIZE;
+}
+
+static inline size_t record_offset(uint32_t seg, uint32_t slot) {
+    return seg_base(seg) + sizeof(hist_header_t) + (size_t)slot * sizeof(hist_record_t);
+}
+
+// --- Records ---
+
+static uint16_t hist_check(const hist_record_t* rec) {
+    const uint8_t* p = (const uint8_t*)rec;
+    uint16_t a = 0, b = 0;
+    for (size_t i = 0; i < offsetof(hist_record_t, check); i++) {
+        a = (a + p[i]) % 255;
+        b = (b + a) % 255;
+    }
+    return (uint16_t)((b << 8) | a); // Never 0xFFFF, so an erased slot never verifies
+}
+
+static inline bool hist_record_erased(const hist_record_t* rec) {
+    return rec->t == HIST_ERASED32 && rec->check == 0xFFFF;
+}
+
+static inline bool hist_record_ok(const hist_record_t* rec) {
+    return rec->check == hist_check(rec);
+}
+
+static uint16_t hist_pack_ppm(float ppm) {
+    if (!(ppm > 0)) return 0;
+    float scaled = ppm * 10.0f + 0.5f;
+    return scaled >= 65535.0f ? 65535 : (uint16_t)scaled;
+}
+
+void hist_record_make(hist_record_t* rec, uint32_t t, uint8_t slave, float temperature, float humidity,
+                      float lpg, float co, float smoke, bool motion) {
+    memset(rec, 0, sizeof(*rec));
+    rec->t = t;
+    rec->slave = slave;
+    if (motion) rec->flags |= HIST_FLAG_MOTION;
+    if (!isnan(temperature) && !isnan(humidity)) {
+        rec->flags |= HIST_FLAG_DHT_VALID;
+        float tc = roundf(temperature);
+        rec->temperature = (int8_t)(tc < -128 ? -128 : tc > 127 ? 127 : tc);
+        float hc = roundf(humidity);
+        rec->humidity = (uint8_t)(hc < 0 ? 0 : hc > 100 ? 100 : hc);
+    }
+    if (!isnan(smoke) && smoke >= 0) {
+        rec->flags |= HIST_FLAG_MQ2_VALID;
+        rec->lpg_x10 = hist_pack_ppm(lpg);
+        rec->co_x10 = hist_pack_ppm(co);
+        rec->smoke_x10 = hist_pack_ppm(smoke);
+    }
+    rec->check = hist_check(rec);
+}
+
+// --- Index Maintenance ---
+
+static void hist_index_add(hist_segment_t* seg, uint32_t slot, const hist_record_t* rec) {
+    hist_index_entry_t* e = &seg->index[slot / HIST_INDEX_STRIDE];
+    if (slot % HIST_INDEX_STRIDE == 0) {
+        e->t = HIST_ERASED32;
+        e->slaves = 0;
+    }
+    if (!hist_record_ok(rec)) return; // Torn write: occupies the slot, never returned
+    if (e->t == HIST_ERASED32) e->t = rec->t;
+    e->slaves |= 1ULL << (rec->slave & 63);
+    seg->t_last = rec->t;
+}
+
+// Rebuilds an unsealed segment's state by reading its records up to the first erased slot
+static esp_err_t hist_scan_segment(hist_store_t* store, uint32_t s) {
+    hist_segment_t* seg = &store->segs[s];
+    hist_record_t chunk[HIST_READ_CHUNK];
+    seg->count = 0;
+    seg->t_last = seg->t_first;
+    for (uint32_t slot = 0; slot < HIST_RECORDS_PER_SEGMENT; slot += HIST_READ_CHUNK) {
+        uint32_t n = HIST_RECORDS_PER_SEGMENT - slot < HIST_READ_CHUNK ? HIST_RECORDS_PER_SEGMENT - slot : HIST_READ_CHUNK;
+        esp_err_t ret = store->be.read(store->be.ctx, record_offset(s, slot), chunk, n * sizeof(hist_record_t));
+        if (ret != ESP_OK) return ret;
+        for (uint32_t i = 0; i < n; i++) {
+            if (hist_record_erased(&chunk[i])) return ESP_OK;
+            hist_index_add(seg, slot + i, &chunk[i]);
+            seg->count = slot + i + 1;
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t hist_seal(hist_store_t* store, uint32_t s) {
+    hist_segment_t* seg = &store->segs[s];
+    hist_footer_t footer;
+    memset(&footer, 0xFF, sizeof(footer));
+    footer.count = seg->count;
+    footer.t_last = seg->t_last;
+    memcpy(footer.index, seg->index, sizeof(seg->index));
+    esp_err_t ret = store->be.write(store->be.ctx, seg_base(s) + HIST_FOOTER_OFFSET, &footer, sizeof(footer));
+    if (ret != ESP_OK) return ret;
+    uint32_t sealed = 0; // Written last: a crash before this leaves the segment to be rescanned
+    ret = store->be.write(store->be.ctx, seg_base(s) + offsetof(hist_header_t, sealed), &sealed, sizeof(sealed));
+    if (ret == ESP_OK) seg->sealed = true;
+    return ret;
+}
+
+static esp_err_t hist_start_segment(hist_store_t* store, uint32_t s, uint32_t seq, uint32_t t_first) {
+    esp_err_t ret = store->be.erase(store->be.ctx, seg_base(s), HIST_SEGMENT_SIZE); // Drops the oldest data
+    if (ret != ESP_OK) return ret;
+    hist_header_t header;
+    memset(&header, 0xFF, sizeof(header));
+    header.magic = HIST_MAGIC;
+    header.seq = seq;
+    header.t_first = t_first;
+    ret = store->be.write(store->be.ctx, seg_base(s), &header, sizeof(header));
+    if (ret != ESP_OK) return ret;
+
+    hist_segment_t* seg = &store->segs[s];
+    memset(seg, 0, sizeof(*seg));
+    seg->valid = true;
+    seg->seq = seq;
+    seg->t_first = t_first;
+    seg->t_last = t_first;
+    store->active = (int)s;
+    return ESP_OK;
+}
+
+// --- Open / Close ---
+
+esp_err_t hist_open(const hist_backend_t* backend, hist_store_t** out) {
+    uint32_t n = backend->size / HIST_SEGMENT_SIZE;
+    if (n > HIST_MAX_SEGMENTS) n = HIST_MAX_SEGMENTS;
+    if (n < 2) return ESP_ERR_INVALID_SIZE;
+
+    hist_store_t* store = calloc(1, sizeof(hist_store_t));
+    if (store == NULL) return ESP_ERR_NO_MEM;
+    store->be = *backend;
+    store->n_segments = n;
+    store->active = -1;
+    store->segs = calloc(n, sizeof(hist_segment_t));
+    store->lock = xSemaphoreCreateMutex();
+    if (store->segs == NULL || store->lock == NULL) {
+        hist_close(store);
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = ESP_OK;
+    uint32_t best_seq = 0;
+    for (uint32_t s = 0; s < n && ret == ESP_OK; s++) {
+        hist_header_t header;
+        ret = backend->read(backend->ctx, seg_base(s), &header, sizeof(header));
+        if (ret != ESP_OK || header.magic != HIST_MAGIC) continue;
+
+        hist_segment_t* seg = &store->segs[s];
+        seg->valid = true;
+        seg->seq = header.seq;
+        seg->t_first = header.t_first;
+        if (header.sealed == 0) {
+            hist_footer_t footer;
+            ret = backend->read(backend->ctx, seg_base(s) + HIST_FOOTER_OFFSET, &footer, sizeof(footer));
+            if (ret != ESP_OK) break;
+            seg->sealed = true;
+            seg->count = footer.count;
+            seg->t_last = footer.t_last;
+            memcpy(seg->index, footer.index, sizeof(seg->index));
+        } else {
+            ret = hist_scan_segment(store, s); // Open segment (or one interrupted while sealing)
+        }
+        if (store->active < 0 || seg->seq > best_seq) {
+            store->active = (int)s;
+            best_seq = seg->seq;
+        }
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "hist_open: backend read failed: %s", esp_err_to_name(ret));
+        hist_close(store);
+        return ret;
+    }
+
+    uint32_t t_oldest = 0, t_newest = 0, records = 0;
+    if (store->active >= 0) {
+        store->have_newest = true;
+        store->t_newest = store->segs[store->active].t_last;
+    }
+    hist_span(store, &t_oldest, &t_newest, &records);
+    ESP_LOGI(TAG, "History: %lu segments x %u records, %lu records held (t %lu..%lu)",
+             (unsigned long)n, (unsigned)HIST_RECORDS_PER_SEGMENT, (unsigned long)records,
+             (unsigned long)t_oldest, (unsigned long)t_newest);
+    *out = store;
+    return ESP_OK;
+}
+
+void hist_close(hist_store_t* store) {
+    if (store == NULL) return;
+    if (store->lock != NULL) vSemaphoreDelete(store->lock);
+    free(store->segs);
+    free(store);
+}
+
+// --- Append ---
+
+esp_err_t hist_append(hist_store_t* store, const hist_record_t* rec) {
+    if (store == NULL || rec == NULL) return ESP_ERR_INVALID_ARG;
+    xSemaphoreTake(store->lock, portMAX_DELAY);
+    esp_err_t ret = ESP_OK;
+    if (store->have_newest && rec->t < store->t_newest) {
+        ret = ESP_ERR_INVALID_ARG; // Segments must stay time-ordered
+        goto out;
+    }
+
+    if (store->active < 0) {
+        ret = hist_start_segment(store, 0, 1, rec->t);
+    } else {
+        hist_segment_t* seg = &store->segs[store->active];
+        if (seg->sealed || seg->closed || seg->count >= HIST_RECORDS_PER_SEGMENT) {
+            if (!seg->sealed) ret = hist_seal(store, store->active);
+            if (ret == ESP_OK) {
+                uint32_t next = ((uint32_t)store->active + 1) % store->n_segments;
+                ret = hist_start_segment(store, next, seg->seq + 1, rec->t);
+            }
+        }
+    }
+    if (ret != ESP_OK) goto out;
+
+    hist_segment_t* seg = &store->segs[store->active];
+    hist_record_t stored = *rec;
+    stored.check = hist_check(&stored);
+    ret = store->be.write(store->be.ctx, record_offset(store->active, seg->count), &stored, sizeof(stored));
+    if (ret == ESP_OK) {
+        hist_index_add(seg, seg->count, &stored);
+        seg->count++;
+        store->have_newest = true;
+        store->t_newest = stored.t;
+    } else {
+        seg->closed = true; // The slot may be half written; continue in the next segment
+    }
+out:
+    xSemaphoreGive(store->lock);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_ARG) {
+        ESP_LOGE(TAG, "hist_append failed: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+// --- Queries ---
+
+static esp_err_t hist_query_locked(hist_store_t* store, uint8_t slave, uint32_t t0, uint32_t t1,
+                                   hist_visit_cb_t cb, void* ctx) {
+    if (store->active < 0) return ESP_OK;
+    const uint64_t bit = 1ULL << (slave & 63);
+    hist_record_t chunk[HIST_READ_CHUNK];
+
+    // Oldest segment first: the ring continues after the active one
+    for (uint32_t k = 1; k <= store->n_segments; k++) {
+        uint32_t s = ((uint32_t)store->active + k) % store->n_segments;
+        const hist_segment_t* seg = &store->segs[s];
+        if (!seg->valid || seg->count == 0 || seg->t_last < t0) continue;
+        if (seg->t_first > t1) break; // Later segments are newer still
+
+        uint32_t strides = (seg->count + HIST_INDEX_STRIDE - 1) / HIST_INDEX_STRIDE;
+        for (uint32_t e = 0; e < strides; e++) {
+            const hist_index_entry_t* entry = &seg->index[e];
+            if (!(entry->slaves & bit) || entry->t == HIST_ERASED32) continue;
+            if (entry->t > t1) return ESP_OK;
+            uint32_t stride_end_t = seg->t_last;
+            for (uint32_t f = e + 1; f < strides; f++) {
+                if (seg->index[f].t != HIST_ERASED32) {
+                    stride_end_t = seg->index[f].t;
+                    break;
+                }
+            }
+            if (stride_end_t < t0) continue;
+
+            uint32_t first = e * HIST_INDEX_STRIDE;
+            uint32_t last = first + HIST_INDEX_STRIDE < seg->count ? first + HIST_INDEX_STRIDE : seg->count;
+            for (uint32_t slot = first; slot < last; slot += HIST_READ_CHUNK) {
+                uint32_t n = last - slot < HIST_READ_CHUNK ? last - slot : HIST_READ_CHUNK;
+                esp_err_t ret = store->be.read(store->be.ctx, record_offset(s, slot), chunk, n * sizeof(hist_record_t));
+                if (ret != ESP_OK) return ret;
+                for (uint32_t i = 0; i < n; i++) {
+                    const hist_record_t* rec = &chunk[i];
+                    if (rec->slave != slave || !hist_record_ok(rec)) continue;
+                    if (rec->t > t1) return ESP_OK;
+                    if (rec->t >= t0 && !cb(rec, ctx)) return ESP_OK;
+                }
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t hist_query(hist_store_t* store, uint8_t slave, uint32_t t0, uint32_t t1, hist_visit_cb_t cb, void* ctx) {
+    if (store == NULL || cb == NULL || t1 < t0) return ESP_ERR_INVALID_ARG;
+    xSemaphoreTake(store->lock, portMAX_DELAY);
+    esp_err_t ret = hist_query_locked(store, slave, t0, t1, cb, ctx);
+    xSemaphoreGive(store->lock);
+    return ret;
+}
+
+typedef struct {
+    uint32_t t0;
+    uint32_t step_s;
+    size_t n;
+    hist_point_t* out;
+    uint32_t* dht_count;
+    uint32_t* mq2_count;
+} hist_downsample_t;
+
+static bool hist_downsample_visit(const hist_record_t* rec, void* ctx) {
+    hist_downsample_t* ds = ctx;
+    size_t b = (rec->t - ds->t0) / ds->step_s;
+    if (b >= ds->n) return false;
+    hist_point_t* p = &ds->out[b];
+    p->count++;
+    if (rec->flags & HIST_FLAG_MOTION) p->motion++;
+    if (rec->flags & HIST_FLAG_DHT_VALID) {
+        p->temperature += rec->temperature;
+        p->humidity += rec->humidity;
+        ds->dht_count[b]++;
+    }
+    if (rec->flags & HIST_FLAG_MQ2_VALID) {
+        float smoke = rec->smoke_x10 / 10.0f;
+        p->lpg += rec->lpg_x10 / 10.0f;
+        p->co += rec->co_x10 / 10.0f;
+        p->smoke += smoke;
+        if (smoke > p->smoke_max) p->smoke_max = smoke;
+        ds->mq2_count[b]++;
+    }
+    return true;
+}
+
+esp_err_t hist_query_downsampled(hist_store_t* store, uint8_t slave, uint32_t t0, uint32_t t1, uint32_t step_s,
+                                 hist_point_t* out, size_t max_points, size_t* n_out) {
+    if (store == NULL || out == NULL || n_out == NULL || step_s == 0 || t1 < t0) return ESP_ERR_INVALID_ARG;
+    size_t n = ((size_t)(t1 - t0) / step_s) + 1;
+    if (n > max_points) n = max_points;
+    *n_out = 0;
+    if (n == 0) return ESP_OK;
+
+    uint32_t* counts = calloc(2 * n, sizeof(uint32_t));
+    if (counts == NULL) return ESP_ERR_NO_MEM;
+    memset(out, 0, n * sizeof(hist_point_t));
+    hist_downsample_t ds = { .t0 = t0, .step_s = step_s, .n = n, .out = out,
+                             .dht_count = counts, .mq2_count = counts + n };
+    esp_err_t ret = hist_query(store, slave, t0, t1, hist_downsample_visit, &ds);
+
+    for (size_t b = 0; b < n; b++) {
+        hist_point_t* p = &out[b];
+        p->t = t0 + (uint32_t)b * step_s;
+        if (ds.dht_count[b]) {
+            p->temperature /= ds.dht_count[b];
+            p->humidity /= ds.dht_count[b];
+        } else {
+            p->temperature = p->humidity = NAN;
+        }
+        if (ds.mq2_count[b]) {
+            p->lpg /= ds.mq2_count[b];
+            p->co /= ds.mq2_count[b];
+            p->smoke /= ds.mq2_count[b];
+        } else {
+            p->lpg = p->co = p->smoke = p->smoke_max = NAN;
+        }
+    }
+    free(counts);
+    *n_out = n;
+    return ret;
+}
+
+void hist_span(hist_store_t* store, uint32_t* t_oldest, uint32_t* t_newest, uint32_t* records) {
+    uint32_t oldest = 0, newest = 0, total = 0;
+    bool first = true;
+    xSemaphoreTake(store->lock, portMAX_DELAY);
+    if (store->active >= 0) {
+        for (uint32_t k = 1; k <= store->n_segments; k++) {
+            const hist_segment_t* seg = &store->segs[((uint32_t)store->active + k) % store->n_segments];
+            if (!seg->valid || seg->count == 0) continue;
+            if (first) {
+                oldest = seg->t_first;
+                first = false;
+            }
+            newest = seg->t_last;
+            total += seg->count;
+        }
+    }
+    xSemaphoreGive(store->lock);
+    if (t_oldest) *t_oldest = oldest;
+    if (t_newest) *t_newest = newest;
+    if (records) *records = total;
+}
+
+// --- Partition Backend ---
+
+static esp_err_t hist_part_read(void* ctx, size_t offset, void* dst, size_t len) {
+    return esp_partition_read((const esp_partition_t*)ctx, offset, dst, len);
+}
+
+static esp_err_t hist_part_write(void* ctx, size_t offset, const void* src, size_t len) {
+    return esp_partition_write((const esp_partition_t*)ctx, offset, src, len);
+}
+
+static esp_err_t hist_part_erase(void* ctx, size_t offset, size_t len) {
+    return esp_partition_erase_range((const esp_partition_t*)ctx, offset, len);
+}
+
+esp_err_t hist_backend_partition(const char* label, hist_backend_t* out) {
+    const esp_partition_t* part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (part == NULL) {
+        ESP_LOGW(TAG, "No data partition labelled \"%s\".", label);
+        return ESP_ERR_NOT_FOUND;
+    }
+    out->size = (part->size / HIST_SEGMENT_SIZE) * HIST_SEGMENT_SIZE;
+    out->read = hist_part_read;
+    out->write = hist_part_write;
+    out->erase = hist_part_erase;
+    out->ctx = (void*)part;
+    return ESP_OK;
+}
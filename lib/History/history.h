@@ -0,0 +1,139 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Append-only, time-partitioned sample history for the master, so questions like
+// "what did node 7's CO do overnight" are answered locally.
+//
+// The storage region is split into fixed-size segments used as a ring: the newest
+// segment takes appends, and when it fills it is sealed and the oldest segment is
+// erased to make room. Each segment covers a contiguous time range (appends must be
+// in time order). A sparse index entry every HIST_INDEX_STRIDE records holds the
+// first timestamp and a bitmap of the slaves present, so a range query for one
+// slave only reads the strides that can contain it. Sealed segments store their
+// index in a footer, so mounting reads a few hundred bytes per segment plus the
+// open segment.
+//
+// Sizing: one record per slave per minute (e.g. the 1-minute rollup) for 50 slaves
+// over 24 h is 72,000 records = 1.15 MB; HIST_MIN_REGION_BYTES rounds that up to
+// whole segments plus the one being recycled.
+//
+// Storage goes through hist_backend_t. hist_backend_partition() uses a raw flash
+// partition; on the IDF linux (host) target the same partition API is backed by a
+// memory-mapped file, so the store runs unchanged on the host. Writes follow NOR
+// flash rules: a record slot is written once between erases.
+
+// --- Configuration Constants ---
+
+#define HIST_SEGMENT_SIZE   (64 * 1024)  // Multiple of the 4 KB flash sector
+#define HIST_INDEX_STRIDE   (256)        // Records per sparse index entry
+#define HIST_MAX_SEGMENTS   (64)
+#define HIST_MIN_REGION_BYTES (20 * HIST_SEGMENT_SIZE) // >= 24 h x 50 slaves at 1/min
+
+// --- Records ---
+
+#define HIST_FLAG_MOTION    0x01
+#define HIST_FLAG_DHT_VALID 0x02
+#define HIST_FLAG_MQ2_VALID 0x04
+
+// 16 bytes. ppm values are stored x10 and saturate at 6553.5 ppm.
+typedef struct __attribute__((packed)) {
+    uint32_t t;            // seconds (wall clock or master uptime, non-decreasing)
+    uint8_t slave;         // master-side slave index
+    uint8_t flags;         // HIST_FLAG_*
+    int8_t temperature;    // C
+    uint8_t humidity;      // %RH
+    uint16_t lpg_x10;
+    uint16_t co_x10;
+    uint16_t smoke_x10;
+    uint16_t check;        // Fletcher-16 of the bytes above; detects torn writes
+} hist_record_t;
+
+// One downsampled point: means over the records in [t, t + step)
+typedef struct {
+    uint32_t t;
+    uint32_t count;        // records in the bucket (0 = no data)
+    uint32_t motion;       // records with motion
+    float temperature;     // NAN if no valid DHT record
+    float humidity;
+    float lpg;             // NAN if no valid MQ2 record
+    float co;
+    float smoke;
+    float smoke_max;
+} hist_point_t;
+
+// --- Storage Backend ---
+
+typedef struct {
+    size_t size;    // Region size in bytes (a multiple of HIST_SEGMENT_SIZE)
+    esp_err_t (*read)(void* ctx, size_t offset, void* dst, size_t len);
+    esp_err_t (*write)(void* ctx, size_t offset, const void* src, size_t len);
+    esp_err_t (*erase)(void* ctx, size_t offset, size_t len); // Sets the range to 0xFF
+    void* ctx;
+} hist_backend_t;
+
+/**
+ * @brief Backend on a raw data partition (e.g. a "history" entry in partitions.csv).
+ *        The usable size is rounded down to whole segments.
+ */
+esp_err_t hist_backend_partition(const char* label, hist_backend_t* out);
+
+// --- Store API ---
+
+typedef struct hist_store hist_store_t;
+
+/**
+ * @brief Mounts the store: reads segment headers and footers and scans the open segment.
+ *
+ * @param backend Storage region (copied).
+ * @param out Store handle.
+ * @return ESP_ERR_INVALID_SIZE if the region holds fewer than 2 segments,
+ *         ESP_ERR_NO_MEM, or a backend error.
+ */
+esp_err_t hist_open(const hist_backend_t* backend, hist_store_t** out);
+
+void hist_close(hist_store_t* store);
+
+/**
+ * @brief Packs a sample into a record. Pass NAN for missing DHT / MQ2 values.
+ */
+void hist_record_make(hist_record_t* rec, uint32_t t, uint8_t slave, float temperature, float humidity,
+                      float lpg, float co, float smoke, bool motion);
+
+/**
+ * @brief Appends a record, recycling the oldest segment when the open one is full.
+ *        After a failed write the open segment is sealed and the next append starts
+ *        a new one, so a half-written slot is never written again.
+ * @return ESP_ERR_INVALID_ARG if rec->t is older than the last appended record.
+ */
+esp_err_t hist_append(hist_store_t* store, const hist_record_t* rec);
+
+/**
+ * @brief Visitor for hist_query(); return false to stop early.
+ */
+typedef bool (*hist_visit_cb_t)(const hist_record_t* rec, void* ctx);
+
+/**
+ * @brief Calls cb for every record of one slave with t0 <= t <= t1, oldest first.
+ */
+esp_err_t hist_query(hist_store_t* store, uint8_t slave, uint32_t t0, uint32_t t1, hist_visit_cb_t cb, void* ctx);
+
+/**
+ * @brief Downsampled read: one point per step_s bucket starting at t0.
+ *
+ * @param out Receives ceil((t1 - t0 + 1) / step_s) points, at most max_points.
+ * @param n_out Number of points written.
+ */
+esp_err_t hist_query_downsampled(hist_store_t* store, uint8_t slave, uint32_t t0, uint32_t t1, uint32_t step_s,
+                                 hist_point_t* out, size_t max_points, size_t* n_out);
+
+/**
+ * @brief Oldest and newest timestamps held, and the number of records.
+ */
+void hist_span(hist_store_t* store, uint32_t* t_oldest, uint32_t* t_newest, uint32_t* records);
+
+#endif // HISTORY_H
@@ -0,0 +1,443 @@
+#include "journal.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+static const char *TAG = "JOURNAL";
+
+// --- On-Flash Layout ---
+// Sector: [header, one record slot][record] x JOURNAL_SECTOR_RECORDS
+
+#define JOURNAL_MAGIC 0x314C4E4Au // "JNL1"
+#define JOURNAL_ERASED32 0xFFFFFFFFu
+#define JOURNAL_SECTOR_RECORDS (JOURNAL_SECTOR_SIZE / sizeof(journal_record_t) - 1)
+#define JOURNAL_SCAN_CHUNK 16     // Records read per backend call when scanning
+#define JOURNAL_BLOOM_WORDS 8     // 256 bits per sector
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t seq;          // Increases by one per sector started; orders the ring
+    uint8_t reserved[sizeof(journal_record_t) - 8];
+} journal_sector_hdr_t;
+
+_Static_assert(sizeof(journal_record_t) == 32, "journal record size");
+_Static_assert(sizeof(journal_sector_hdr_t) == sizeof(journal_record_t), "header fills one slot");
+
+// --- In-Memory State ---
+
+typedef struct {
+    bool valid;
+    bool closed;           // Ends in a torn or failed slot; takes no more appends
+    uint32_t seq;
+    uint16_t used;         // Record slots written (intact or not)
+    uint16_t records;      // Intact records
+    uint32_t t_min;
+    uint32_t t_max;
+    uint32_t bloom[JOURNAL_BLOOM_WORDS];
+} journal_sector_t;
+
+struct journal {
+    journal_backend_t be;
+    journal_config_t cfg;
+    uint32_t n_sectors;
+    journal_sector_t* sectors;
+    int wr;                // Sector taking commits, -1 while the journal has never been written
+    SemaphoreHandle_t lock; // Flash, the sector index and scratch
+    journal_record_t scratch[JOURNAL_RAM_RECORDS]; // Commit batch / copy of RAM events for scans
+
+    // RAM buffer: the only state journal_append touches
+    portMUX_TYPE mux;
+    journal_record_t ram[JOURNAL_RAM_RECORDS];
+    int64_t ram_us[JOURNAL_RAM_RECORDS]; // Arrival times, for the durability window
+    uint16_t ram_head;     // Oldest waiting event
+    uint16_t ram_count;
+    uint32_t next_seq;
+
+    TaskHandle_t task;
+    SemaphoreHandle_t done;
+    volatile bool stopping;
+    journal_stats_t stats; // appended/dropped/pending under mux, the rest under lock
+};
+
+static inline size_t sector_base(uint32_t s) {
+    return (size_t)s * JOURNAL_SECTOR_SIZE;
+}
+
+static inline size_t slot_offset(uint32_t s, uint32_t slot) {
+    return sector_base(s) + (slot + 1) * sizeof(journal_record_t);
+}
+
+static uint16_t journal_check(const journal_record_t* rec) {
+    const uint8_t* p = (const uint8_t*)rec;
+    uint16_t a = 0, b = 0;
+    for (size_t i = 0; i < offsetof(journal_record_t, check); i++) {
+        a = (a + p[i]) % 255;
+        b = (b + a) % 255;
+    }
+    return (uint16_t)((b << 8) | a);
+}
+
+// --- Sector Index ---
+
+static uint32_t uid_hash(const uint8_t* uid, uint8_t len) {
+    uint32_t h = 2166136261u; // FNV-1a
+    for (uint8_t i = 0; i < len; i++) h = (h ^ uid[i]) * 16777619u;
+    return h;
+}
+
+static void index_add(journal_sector_t* sec, const journal_record_t* rec) {
+    uint32_t h = uid_hash(rec->uid, rec->uid_len);
+    sec->bloom[(h & 0xFF) / 32] |= 1u << (h & 31);
+    sec->bloom[((h >> 8) & 0xFF) / 32] |= 1u << ((h >> 8) & 31);
+    if (sec->records == 0 || rec->t < sec->t_min) sec->t_min = rec->t;
+    if (sec->records == 0 || rec->t > sec->t_max) sec->t_max = rec->t;
+    sec->records++;
+}
+
+static bool index_may_match(const journal_sector_t* sec, const uint8_t* uid, uint8_t uid_len, uint32_t t0, uint32_t t1) {
+    if (sec->records == 0 || sec->t_max < t0 || sec->t_min > t1) return false;
+    if (uid == NULL) return true;
+    uint32_t h = uid_hash(uid, uid_len);
+    return (sec->bloom[(h & 0xFF) / 32] & (1u << (h & 31))) &&
+           (sec->bloom[((h >> 8) & 0xFF) / 32] & (1u << ((h >> 8) & 31)));
+}
+
+static bool record_matches(const journal_record_t* rec, const uint8_t* uid, uint8_t uid_len, uint32_t t0, uint32_t t1) {
+    if (rec->t < t0 || rec->t > t1) return false;
+    return uid == NULL || (rec->uid_len == uid_len && memcmp(rec->uid, uid, uid_len) == 0);
+}
+
+// --- Mount ---
+
+static esp_err_t journal_scan_sector(journal_t* j, uint32_t s) {
+    journal_sector_t* sec = &j->sectors[s];
+    for (uint32_t slot = 0; slot < JOURNAL_SECTOR_RECORDS; slot += JOURNAL_SCAN_CHUNK) {
+        uint32_t n = JOURNAL_SECTOR_RECORDS - slot < JOURNAL_SCAN_CHUNK ? JOURNAL_SECTOR_RECORDS - slot : JOURNAL_SCAN_CHUNK;
+        esp_err_t ret = j->be.read(j->be.ctx, slot_offset(s, slot), j->scratch, n * sizeof(journal_record_t));
+        if (ret != ESP_OK) return ret;
+        for (uint32_t i = 0; i < n; i++) {
+            const journal_record_t* rec = &j->scratch[i];
+            if (rec->seq == JOURNAL_ERASED32 && rec->check == 0xFFFF) return ESP_OK;
+            sec->used = (uint16_t)(slot + i + 1);
+            if (rec->check != journal_check(rec)) {
+                ESP_LOGW(TAG, "Torn record in sector %lu slot %lu, closing sector.", (unsigned long)s,
+                         (unsigned long)(slot + i));
+                sec->closed = true;
+                continue; // Later slots may still hold records written before the tear was found
+            }
+            if (rec->seq < j->next_seq) continue; // Rewritten after a failed batch write; counted once
+            index_add(sec, rec);
+            j->stats.records++;
+            j->next_seq = rec->seq + 1;
+        }
+    }
+    return ESP_OK;
+}
+
+// --- Commit ---
+
+static esp_err_t journal_next_sector(journal_t* j) {
+    uint32_t next = j->wr < 0 ? 0 : ((uint32_t)j->wr + 1) % j->n_sectors;
+    journal_sector_t* sec = &j->sectors[next];
+    if (sec->valid) {
+        j->stats.overwritten += sec->records;
+        j->stats.records -= sec->records;
+    }
+    memset(sec, 0, sizeof(*sec));
+    esp_err_t ret = j->be.erase(j->be.ctx, sector_base(next), JOURNAL_SECTOR_SIZE);
+    if (ret != ESP_OK) return ret;
+    journal_sector_hdr_t hdr;
+    memset(&hdr, 0xFF, sizeof(hdr));
+    hdr.magic = JOURNAL_MAGIC;
+    hdr.seq = j->wr < 0 ? 1 : j->sectors[j->wr].seq + 1;
+    ret = j->be.write(j->be.ctx, sector_base(next), &hdr, sizeof(hdr));
+    if (ret != ESP_OK) return ret;
+    sec->valid = true;
+    sec->seq = hdr.seq;
+    j->wr = (int)next;
+    return ESP_OK;
+}
+
+// Writes everything waiting in RAM, one backend write per sector touched. Lock held.
+static esp_err_t journal_commit(journal_t* j) {
+    esp_err_t ret = ESP_OK;
+    for (;;) {
+        if (j->wr < 0 || j->sectors[j->wr].closed || j->sectors[j->wr].used >= JOURNAL_SECTOR_RECORDS) {
+            int64_t start = esp_timer_get_time();
+            ret = journal_next_sector(j);
+            uint32_t us = (uint32_t)(esp_timer_get_time() - start);
+            if (us > j->stats.commit_us_max) j->stats.commit_us_max = us;
+            if (ret != ESP_OK) break;
+        }
+        journal_sector_t* sec = &j->sectors[j->wr];
+
+        // Copy out, but leave the events in RAM until they are on flash so scans always see them
+        portENTER_CRITICAL(&j->mux);
+        uint16_t n = j->ram_count;
+        if (n > JOURNAL_SECTOR_RECORDS - sec->used) n = JOURNAL_SECTOR_RECORDS - sec->used;
+        for (uint16_t i = 0; i < n; i++) j->scratch[i] = j->ram[(j->ram_head + i) % JOURNAL_RAM_RECORDS];
+        int64_t oldest_us = n > 0 ? j->ram_us[j->ram_head] : 0;
+        portEXIT_CRITICAL(&j->mux);
+        if (n == 0) break;
+
+        int64_t start = esp_timer_get_time();
+        ret = j->be.write(j->be.ctx, slot_offset((uint32_t)j->wr, sec->used), j->scratch, n * sizeof(journal_record_t));
+        int64_t end = esp_timer_get_time();
+        if (ret != ESP_OK) {
+            // Slots may be half written; the events stay in RAM and go to a fresh sector. Any
+            // slot that did land intact repeats a seq, which scans and queries drop.
+            sec->closed = true;
+            j->stats.write_errors++;
+            break;
+        }
+        for (uint16_t i = 0; i < n; i++) index_add(sec, &j->scratch[i]);
+        sec->used += n;
+
+        portENTER_CRITICAL(&j->mux);
+        j->ram_head = (j->ram_head + n) % JOURNAL_RAM_RECORDS;
+        j->ram_count -= n;
+        j->stats.pending = j->ram_count;
+        portEXIT_CRITICAL(&j->mux);
+
+        j->stats.committed += n;
+        j->stats.records += n;
+        j->stats.commits++;
+        if ((uint32_t)(end - start) > j->stats.commit_us_max) j->stats.commit_us_max = (uint32_t)(end - start);
+        uint32_t waited_ms = (uint32_t)((end - oldest_us) / 1000);
+        if (waited_ms > j->stats.window_ms_max) j->stats.window_ms_max = waited_ms;
+    }
+    if (ret != ESP_OK) ESP_LOGE(TAG, "Commit failed: %s", esp_err_to_name(ret));
+    return ret;
+}
+
+static void journal_task(void* arg) {
+    journal_t* j = arg;
+    while (!j->stopping) {
+        portENTER_CRITICAL(&j->mux);
+        uint16_t count = j->ram_count;
+        int64_t oldest_us = count > 0 ? j->ram_us[j->ram_head] : 0;
+        portEXIT_CRITICAL(&j->mux);
+
+        TickType_t wait = portMAX_DELAY;
+        if (count > 0) {
+            int64_t due_us = oldest_us + (int64_t)j->cfg.commit_window_ms * 1000 - esp_timer_get_time();
+            if (count >= j->cfg.batch_records || due_us <= 0) {
+                xSemaphoreTake(j->lock, portMAX_DELAY);
+                esp_err_t ret = journal_commit(j);
+                xSemaphoreGive(j->lock);
+                if (ret != ESP_OK) vTaskDelay(pdMS_TO_TICKS(j->cfg.commit_window_ms) + 1); // Do not spin on a failing flash
+                continue;
+            }
+            wait = pdMS_TO_TICKS(due_us / 1000) + 1;
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+    xSemaphoreGive(j->done);
+    vTaskDelete(NULL);
+}
+
+// --- Public API ---
+
+esp_err_t journal_append(journal_t* j, const uint8_t* uid, uint8_t uid_len, uint8_t reader,
+                         journal_decision_t decision, uint32_t t) {
+    if (j == NULL || uid == NULL || uid_len == 0 || uid_len > JOURNAL_UID_MAX) return ESP_ERR_INVALID_ARG;
+    journal_record_t rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.t = t;
+    memcpy(rec.uid, uid, uid_len);
+    rec.uid_len = uid_len;
+    rec.reader = reader;
+    rec.decision = (uint8_t)decision;
+    int64_t now = esp_timer_get_time();
+
+    bool notify;
+    portENTER_CRITICAL(&j->mux);
+    if (j->ram_count >= JOURNAL_RAM_RECORDS) {
+        j->stats.dropped++;
+        portEXIT_CRITICAL(&j->mux);
+        return ESP_ERR_NO_MEM;
+    }
+    rec.seq = j->next_seq++;
+    rec.check = journal_check(&rec);
+    uint16_t slot = (j->ram_head + j->ram_count) % JOURNAL_RAM_RECORDS;
+    j->ram[slot] = rec;
+    j->ram_us[slot] = now;
+    j->ram_count++;
+    j->stats.appended++;
+    j->stats.pending = j->ram_count;
+    // First event starts the window timer; a full batch commits at once
+    notify = j->ram_count == 1 || j->ram_count == j->cfg.batch_records;
+    portEXIT_CRITICAL(&j->mux);
+
+    if (notify) xTaskNotifyGive(j->task);
+    return ESP_OK;
+}
+
+esp_err_t journal_flush(journal_t* j) {
+    if (j == NULL) return ESP_ERR_INVALID_ARG;
+    xSemaphoreTake(j->lock, portMAX_DELAY);
+    esp_err_t ret = journal_commit(j);
+    xSemaphoreGive(j->lock);
+    return ret;
+}
+
+esp_err_t journal_query(journal_t* j, const uint8_t* uid, uint8_t uid_len, uint32_t t0, uint32_t t1,
+                        journal_visit_cb_t cb, void* ctx) {
+    if (j == NULL || cb == NULL || (uid != NULL && (uid_len == 0 || uid_len > JOURNAL_UID_MAX))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = ESP_OK;
+    bool more = true;
+    uint32_t next_seq = 0; // Seqs rise oldest first; a lower one is a copy already visited
+    xSemaphoreTake(j->lock, portMAX_DELAY);
+    for (uint32_t k = 1; k <= j->n_sectors && more && j->wr >= 0; k++) {
+        uint32_t s = ((uint32_t)j->wr + k) % j->n_sectors; // Oldest first
+        const journal_sector_t* sec = &j->sectors[s];
+        if (!sec->valid || sec->used == 0) continue;
+        if (!index_may_match(sec, uid, uid_len, t0, t1)) {
+            j->stats.scan_sectors_skipped++;
+            continue;
+        }
+        j->stats.scan_sectors_read++;
+        for (uint32_t slot = 0; slot < sec->used && more; slot += JOURNAL_SCAN_CHUNK) {
+            uint32_t n = sec->used - slot < JOURNAL_SCAN_CHUNK ? sec->used - slot : JOURNAL_SCAN_CHUNK;
+            ret = j->be.read(j->be.ctx, slot_offset(s, slot), j->scratch, n * sizeof(journal_record_t));
+            if (ret != ESP_OK) goto out;
+            for (uint32_t i = 0; i < n && more; i++) {
+                const journal_record_t* rec = &j->scratch[i];
+                if (rec->check != journal_check(rec)) continue; // Torn slot
+                if (rec->seq < next_seq) continue;
+                next_seq = rec->seq + 1;
+                if (record_matches(rec, uid, uid_len, t0, t1)) more = cb(rec, ctx);
+            }
+        }
+    }
+
+    // Events not committed yet. Commits wait for the lock, so none is seen twice or missed.
+    if (more) {
+        portENTER_CRITICAL(&j->mux);
+        uint16_t n = j->ram_count;
+        for (uint16_t i = 0; i < n; i++) j->scratch[i] = j->ram[(j->ram_head + i) % JOURNAL_RAM_RECORDS];
+        portEXIT_CRITICAL(&j->mux);
+        for (uint16_t i = 0; i < n && more; i++) {
+            if (j->scratch[i].seq < next_seq) continue; // Partly on flash from a failed commit
+            if (record_matches(&j->scratch[i], uid, uid_len, t0, t1)) more = cb(&j->scratch[i], ctx);
+        }
+    }
+out:
+    xSemaphoreGive(j->lock);
+    return ret;
+}
+
+void journal_get_stats(journal_t* j, journal_stats_t* out) {
+    xSemaphoreTake(j->lock, portMAX_DELAY);
+    portENTER_CRITICAL(&j->mux);
+    *out = j->stats;
+    portEXIT_CRITICAL(&j->mux);
+    xSemaphoreGive(j->lock);
+}
+
+// --- Lifecycle ---
+
+static void journal_free(journal_t* j) {
+    if (j->lock != NULL) vSemaphoreDelete(j->lock);
+    if (j->done != NULL) vSemaphoreDelete(j->done);
+    free(j->sectors);
+    free(j);
+}
+
+esp_err_t journal_open(const journal_backend_t* backend, const journal_config_t* config, journal_t** out) {
+    if (backend == NULL || config == NULL || out == NULL || config->batch_records == 0 ||
+        config->batch_records > JOURNAL_RAM_RECORDS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t n = backend->size / JOURNAL_SECTOR_SIZE;
+    if (n > JOURNAL_MAX_SECTORS) n = JOURNAL_MAX_SECTORS;
+    if (n < 2) return ESP_ERR_INVALID_SIZE;
+
+    journal_t* j = calloc(1, sizeof(journal_t));
+    if (j == NULL) return ESP_ERR_NO_MEM;
+    j->be = *backend;
+    j->cfg = *config;
+    j->n_sectors = n;
+    j->wr = -1;
+    portMUX_INITIALIZE(&j->mux);
+    j->sectors = calloc(n, sizeof(journal_sector_t));
+    j->lock = xSemaphoreCreateMutex();
+    j->done = xSemaphoreCreateBinary();
+    if (j->sectors == NULL || j->lock == NULL || j->done == NULL) {
+        journal_free(j);
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = ESP_OK;
+    for (uint32_t s = 0; s < n && ret == ESP_OK; s++) {
+        journal_sector_hdr_t hdr;
+        ret = backend->read(backend->ctx, sector_base(s), &hdr, sizeof(hdr));
+        if (ret != ESP_OK || hdr.magic != JOURNAL_MAGIC) continue;
+        j->sectors[s].valid = true;
+        j->sectors[s].seq = hdr.seq;
+        if (j->wr < 0 || hdr.seq > j->sectors[j->wr].seq) j->wr = (int)s;
+    }
+    // Oldest first, so the first copy of a rewritten record is the one indexed
+    for (uint32_t k = 1; k <= n && ret == ESP_OK && j->wr >= 0; k++) {
+        uint32_t s = ((uint32_t)j->wr + k) % n;
+        if (j->sectors[s].valid) ret = journal_scan_sector(j, s);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "journal_open: backend read failed: %s", esp_err_to_name(ret));
+        journal_free(j);
+        return ret;
+    }
+
+    if (xTaskCreate(journal_task, "journal", JOURNAL_TASK_STACK, j, config->task_priority, &j->task) != pdPASS) {
+        journal_free(j);
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Journal: %lu sectors, %lu events on flash, next event %lu", (unsigned long)n,
+             (unsigned long)j->stats.records, (unsigned long)j->next_seq);
+    *out = j;
+    return ESP_OK;
+}
+
+void journal_close(journal_t* j) {
+    if (j == NULL) return;
+    j->stopping = true;
+    xTaskNotifyGive(j->task);
+    xSemaphoreTake(j->done, portMAX_DELAY);
+    journal_flush(j);
+    journal_free(j);
+}
+
+// --- Partition Backend ---
+
+static esp_err_t journal_part_read(void* ctx, size_t offset, void* dst, size_t len) {
+    return esp_partition_read((const esp_partition_t*)ctx, offset, dst, len);
+}
+
+static esp_err_t journal_part_write(void* ctx, size_t offset, const void* src, size_t len) {
+    return esp_partition_write((const esp_partition_t*)ctx, offset, src, len);
+}
+
+static esp_err_t journal_part_erase(void* ctx, size_t offset, size_t len) {
+    return esp_partition_erase_range((const esp_partition_t*)ctx, offset, len);
+}
+
+esp_err_t journal_backend_partition(const char* label, journal_backend_t* out) {
+    const esp_partition_t* part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (part == NULL) {
+        ESP_LOGW(TAG, "No data partition labelled \"%s\".", label);
+        return ESP_ERR_NOT_FOUND;
+    }
+    out->size = (part->size / JOURNAL_SECTOR_SIZE) * JOURNAL_SECTOR_SIZE;
+    out->read = journal_part_read;
+    out->write = journal_part_write;
+    out->erase = journal_part_erase;
+    out->ctx = (void*)part;
+    return ESP_OK;
+}
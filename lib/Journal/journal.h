@@ -0,0 +1,145 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Access journal for the master's RFID door: every tap becomes an audit record
+// without putting flash writes on the door-open path.
+//
+// journal_append() copies the event into a RAM buffer under a spinlock and returns:
+// no flash, no allocation, no blocking, so it can run right after rc522_read_card()
+// with the door decision. A commit task group-commits waiting events to a flash log
+// with one write per batch, as soon as batch_records are waiting and otherwise at
+// most commit_window_ms after the oldest arrived. That window bounds what a power cut
+// can lose; journal_flush() commits at once (e.g. before a restart).
+//
+// The log is a ring of 4 KB sectors holding fixed 32-byte records. A RAM index per
+// sector keeps its time range and a 256-bit Bloom filter of the UIDs in it, so a scan
+// by UID and/or time range only reads sectors that can match. Scans also see events
+// still waiting in RAM. When the ring is full the oldest sector is erased
+// (journal_stats_t.overwritten).
+//
+// Storage goes through journal_backend_t with NOR flash rules (write once between
+// erases), as for the spool and the history store; on the IDF linux target the
+// partition backend runs against a file.
+
+// --- Configuration Constants ---
+
+#define JOURNAL_SECTOR_SIZE   (4096)
+#define JOURNAL_MAX_SECTORS   (256)
+#define JOURNAL_RAM_RECORDS   (128)   // Events waiting for a commit; appends beyond fail (stats.dropped)
+#define JOURNAL_UID_MAX       (10)    // ISO 14443 triple-size UID
+#define JOURNAL_TASK_STACK    (3072)
+
+typedef struct {
+    uint32_t commit_window_ms;  // Longest an event waits in RAM: the durability window
+    uint16_t batch_records;     // Commit as soon as this many are waiting (1..JOURNAL_RAM_RECORDS)
+    uint8_t task_priority;
+} journal_config_t;
+
+// --- Records ---
+
+typedef enum {
+    JOURNAL_DENIED = 0,
+    JOURNAL_GRANTED,
+    JOURNAL_UNKNOWN_CARD,
+} journal_decision_t;
+
+// 32 bytes, one flash slot
+typedef struct __attribute__((packed)) {
+    uint32_t seq;               // Event number, increasing over the journal's life
+    uint32_t t;                 // seconds (wall clock or master uptime)
+    uint8_t uid[JOURNAL_UID_MAX]; // Zero padded
+    uint8_t uid_len;
+    uint8_t reader;             // Door/reader index
+    uint8_t decision;           // journal_decision_t
+    uint8_t reserved[9];
+    uint16_t check;             // Fletcher-16 of the bytes above; detects torn writes
+} journal_record_t;
+
+// --- Storage Backend ---
+
+typedef struct {
+    size_t size;    // Region size in bytes (a multiple of JOURNAL_SECTOR_SIZE)
+    esp_err_t (*read)(void* ctx, size_t offset, void* dst, size_t len);
+    esp_err_t (*write)(void* ctx, size_t offset, const void* src, size_t len);
+    esp_err_t (*erase)(void* ctx, size_t offset, size_t len); // Sets the range to 0xFF
+    void* ctx;
+} journal_backend_t;
+
+/**
+ * @brief Backend on a raw data partition. The usable size is rounded down to whole sectors.
+ */
+esp_err_t journal_backend_partition(const char* label, journal_backend_t* out);
+
+// --- Metrics ---
+
+typedef struct {
+    uint32_t appended;          // Events accepted by journal_append
+    uint32_t dropped;           // Rejected because the RAM buffer was full
+    uint32_t pending;           // In RAM now
+    uint32_t committed;         // Written to flash
+    uint32_t commits;           // Batch writes (committed / commits = group size)
+    uint32_t write_errors;
+    uint32_t overwritten;       // Lost to sector recycling
+    uint32_t records;           // On flash now
+    uint32_t commit_us_max;     // Longest commit (flash write, and erase when a sector was recycled)
+    uint32_t window_ms_max;     // Longest an event waited in RAM before its commit
+    uint32_t scan_sectors_read;
+    uint32_t scan_sectors_skipped; // Ruled out by the time range or the UID filter
+} journal_stats_t;
+
+// --- Journal API ---
+
+typedef struct journal journal_t;
+
+/**
+ * @brief Mounts the journal (scans the region once to rebuild the sector index) and
+ *        starts the commit task.
+ *
+ * @return ESP_ERR_INVALID_SIZE if the region holds fewer than 2 sectors,
+ *         ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM, or a backend error.
+ */
+esp_err_t journal_open(const journal_backend_t* backend, const journal_config_t* config, journal_t** out);
+
+/**
+ * @brief Stops the commit task, commits what is waiting and frees the journal.
+ */
+void journal_close(journal_t* journal);
+
+/**
+ * @brief Records one tap. Never touches flash and never blocks; safe from any task.
+ *
+ * @param uid Card UID as returned by rc522_read_card (uid_len <= JOURNAL_UID_MAX).
+ * @param t Event time in seconds.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM if the RAM buffer is full
+ *         (flash stalled for longer than the buffer covers).
+ */
+esp_err_t journal_append(journal_t* journal, const uint8_t* uid, uint8_t uid_len, uint8_t reader,
+                         journal_decision_t decision, uint32_t t);
+
+/**
+ * @brief Commits every waiting event before returning.
+ */
+esp_err_t journal_flush(journal_t* journal);
+
+/**
+ * @brief Visitor for journal_query(); return false to stop early.
+ */
+typedef bool (*journal_visit_cb_t)(const journal_record_t* rec, void* ctx);
+
+/**
+ * @brief Calls cb for every event with t0 <= t <= t1, oldest first, flash then RAM.
+ *
+ * @param uid Only events of this card, or NULL for all cards.
+ * @note Commits wait while a scan runs; appends do not.
+ */
+esp_err_t journal_query(journal_t* journal, const uint8_t* uid, uint8_t uid_len, uint32_t t0, uint32_t t1,
+                        journal_visit_cb_t cb, void* ctx);
+
+void journal_get_stats(journal_t* journal, journal_stats_t* out);
+
+#endif // JOURNAL_H
@@ -0,0 +1,603 @@
+#include "live.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+static const char *TAG = "LIVE";
+
+#define LIVE_SELECT_MS  (1000)  // Idle wake-up; live_stop also wakes the task directly
+#define LIVE_HEAD_MAX   (224)   // Per-client HTTP response headers
+#define LIVE_SNAPSHOT_SLACK (4 * LIVE_SLAVE_JSON_MAX) // Room to grow in place before a snapshot is reallocated
+
+#ifdef MSG_NOSIGNAL
+#define LIVE_SEND_FLAGS MSG_NOSIGNAL // Linux: a peer that went away is an error, not SIGPIPE
+#else
+#define LIVE_SEND_FLAGS 0
+#endif
+
+// --- Shared Buffers ---
+// Written by live_update, then only read while anyone else holds a reference: a
+// buffer is rewritten in place only when the server holds the sole reference.
+// Reference counts change under the server lock; whoever drops the last reference
+// frees the buffer.
+
+typedef struct {
+    uint32_t refs;
+    int64_t created_us;     // esp_timer time of the live_update that last wrote it
+    size_t cap;             // Bytes allocated for data
+    size_t len;             // SSE event: framing + JSON
+    size_t body_off;        // The JSON alone, for /api/snapshot
+    size_t body_len;
+    char data[];
+} live_buf_t;
+
+static const char SSE_SNAPSHOT[] = "event: snapshot\ndata: ";
+static const char SSE_SLAVE[] = "event: slave\ndata: ";
+static const char SSE_END[] = "\n\n";
+static const char SNAPSHOT_HEAD[] = "{\"slaves\":[";
+
+#define LIVE_EVENT_MAX (sizeof(SSE_SLAVE) + LIVE_SLAVE_JSON_MAX + sizeof(SSE_END))
+#define LIVE_TAIL_MAX  (32)     // "],\"t\":<ms>}" plus SSE_END
+
+static live_buf_t* buf_alloc(size_t max_len) {
+    live_buf_t* b = malloc(sizeof(live_buf_t) + max_len);
+    if (b == NULL) return NULL;
+    b->refs = 1;
+    b->created_us = esp_timer_get_time();
+    b->cap = max_len;
+    b->len = 0;
+    return b;
+}
+
+static void buf_append(live_buf_t* b, const char* src, size_t n) {
+    memcpy(b->data + b->len, src, n);
+    b->len += n;
+}
+
+static live_buf_t* buf_ref(live_buf_t* b) {
+    if (b != NULL) b->refs++;
+    return b;
+}
+
+static void buf_unref(live_buf_t* b) {
+    if (b != NULL && --b->refs == 0) free(b);
+}
+
+// --- Server State ---
+
+typedef enum {
+    CLIENT_FREE = 0,
+    CLIENT_REQUEST,         // Reading the request
+    CLIENT_RESPONSE,        // Sending one response, then closing
+    CLIENT_STREAM,          // /api/events: sending events as they come
+} client_state_t;
+
+typedef struct {
+    int fd;
+    client_state_t state;
+    char req[LIVE_REQUEST_MAX];
+    size_t req_len;
+    char head[LIVE_HEAD_MAX];
+    size_t head_len;
+    size_t head_off;
+    live_buf_t* buf;        // Shared buffer being sent, one reference held
+    size_t buf_off;
+    size_t buf_end;
+    bool buf_is_event;      // Counts as a push once written
+    uint32_t next_seq;      // Next event for a stream
+} live_client_t;
+
+struct live_server_s {
+    live_config_t cfg;
+    int listen_fd;
+    int wake_fd;            // UDP on loopback; a datagram to it ends the task's select()
+    struct sockaddr_in wake_addr;
+    SemaphoreHandle_t lock; // Everything below, and buffer reference counts
+    SemaphoreHandle_t done; // Given by the task as it exits
+    TaskHandle_t task;
+    volatile bool stopping;
+
+    bool seen[LIVE_MAX_SLAVES];
+    uint16_t slave_json_len[LIVE_MAX_SLAVES]; // Of the slave's fragment in the snapshot
+    size_t slaves_len;      // The fragments and the commas between them
+    uint32_t last_timestamp_ms;
+    live_buf_t* snapshot;   // Never NULL once started
+    live_buf_t* events[LIVE_EVENT_RING];
+    uint32_t event_seq;     // Sequence number the next event gets
+    live_stats_t stats;
+    live_client_t* clients; // cfg.max_clients slots
+};
+
+// --- Serialization ---
+
+static void json_number(char* dst, size_t cap, float v) {
+    if (isnan(v) || isinf(v)) {
+        snprintf(dst, cap, "null");
+    } else {
+        snprintf(dst, cap, fabsf(v) < 1e7f ? "%.1f" : "%.3e", v);
+    }
+}
+
+static size_t slave_to_json(uint8_t slave, const live_reading_t* r, char* out, size_t cap) {
+    char t[16], h[16], lpg[16], co[16], smoke[16];
+    json_number(t, sizeof(t), r->temperature);
+    json_number(h, sizeof(h), r->humidity);
+    json_number(lpg, sizeof(lpg), r->lpg_ppm);
+    json_number(co, sizeof(co), r->co_ppm);
+    json_number(smoke, sizeof(smoke), r->smoke_ppm);
+    int n = snprintf(out, cap,
+                     "{\"id\":%u,\"mac\":\"%02x:%02x:%02x:%02x:%02x:%02x\",\"t\":%lu,\"temp\":%s,\"hum\":%s,"
+                     "\"lpg\":%s,\"co\":%s,\"smoke\":%s,\"motion\":%s,\"alarm\":%u}",
+                     (unsigned)slave, r->mac[0], r->mac[1], r->mac[2], r->mac[3], r->mac[4], r->mac[5],
+                     (unsigned long)r->timestamp_ms, t, h, lpg, co, smoke, r->motion ? "true" : "false",
+                     (unsigned)r->alarm);
+    return n < 0 || (size_t)n >= cap ? 0 : (size_t)n;
+}
+
+// Snapshot layout: SSE_SNAPSHOT, then {"slaves":[<fragments in slave order>],"t":<newest
+// sample ms>}, then SSE_END. Everything after the slave array is rewritten on every update.
+static size_t snapshot_slaves_off(const live_buf_t* b) {
+    return b->body_off + sizeof(SNAPSHOT_HEAD) - 1;
+}
+
+// Rewrites the tail after the slave array. b->cap leaves LIVE_TAIL_MAX for it. Lock held.
+static void snapshot_tail(live_server_t* s, live_buf_t* b) {
+    b->len = snapshot_slaves_off(b) + s->slaves_len;
+    char tail[LIVE_TAIL_MAX];
+    int n = snprintf(tail, sizeof(tail), "],\"t\":%lu}", (unsigned long)s->last_timestamp_ms);
+    buf_append(b, tail, (size_t)n);
+    b->body_len = b->len - b->body_off;
+    buf_append(b, SSE_END, sizeof(SSE_END) - 1);
+}
+
+// Empty snapshot, before the first update. Lock held.
+static live_buf_t* snapshot_create(live_server_t* s) {
+    live_buf_t* b = buf_alloc(sizeof(SSE_SNAPSHOT) + sizeof(SNAPSHOT_HEAD) + LIVE_TAIL_MAX + LIVE_SNAPSHOT_SLACK);
+    if (b == NULL) return NULL;
+    buf_append(b, SSE_SNAPSHOT, sizeof(SSE_SNAPSHOT) - 1);
+    b->body_off = b->len;
+    buf_append(b, SNAPSHOT_HEAD, sizeof(SNAPSHOT_HEAD) - 1);
+    snapshot_tail(s, b);
+    return b;
+}
+
+// The snapshot, writable with room for grow more bytes of fragments: in place when no
+// client holds it and it fits, otherwise a copy (the old one stays with its readers).
+// NULL without memory. Lock held.
+static live_buf_t* snapshot_writable(live_server_t* s, size_t grow) {
+    live_buf_t* old = s->snapshot;
+    size_t need = snapshot_slaves_off(old) + s->slaves_len + grow + LIVE_TAIL_MAX;
+    if (old->refs == 1 && need <= old->cap) return old;
+    live_buf_t* b = buf_alloc(need + LIVE_SNAPSHOT_SLACK);
+    if (b == NULL) return NULL;
+    memcpy(b->data, old->data, snapshot_slaves_off(old) + s->slaves_len);
+    b->body_off = old->body_off;
+    buf_unref(old);
+    s->snapshot = b;
+    return b;
+}
+
+// Replaces the slave's fragment, or inserts it between its neighbours. Only the bytes
+// after it move; the other fragments are not re-encoded. Lock held.
+static void snapshot_patch(live_server_t* s, live_buf_t* b, uint8_t slave, const char* json, size_t n) {
+    size_t pos = 0;             // Offset of the fragment within the slave array
+    for (int i = 0; i < slave; i++) {
+        if (s->seen[i]) pos += s->slave_json_len[i] + 1;
+    }
+    char text[LIVE_SLAVE_JSON_MAX + 1];
+    size_t text_len = 0;
+    size_t old_len = 0;
+    if (s->seen[slave]) {
+        old_len = s->slave_json_len[slave];
+    } else if (pos > 0) {
+        pos--;                  // After the previous fragment, which gains a comma
+        text[text_len++] = ',';
+    }
+    memcpy(text + text_len, json, n);
+    text_len += n;
+    if (!s->seen[slave] && pos == 0 && s->slaves_len > 0) text[text_len++] = ',';
+
+    char* at = b->data + snapshot_slaves_off(b) + pos;
+    memmove(at + text_len, at + old_len, s->slaves_len - pos - old_len);
+    memcpy(at, text, text_len);
+    s->slaves_len = s->slaves_len - old_len + text_len;
+    s->slave_json_len[slave] = (uint16_t)n;
+    s->seen[slave] = true;
+    b->created_us = esp_timer_get_time();
+}
+
+// --- Publishing ---
+
+static void live_wake(live_server_t* s) {
+    char b = 0;
+    sendto(s->wake_fd, &b, 1, MSG_DONTWAIT, (const struct sockaddr*)&s->wake_addr, sizeof(s->wake_addr));
+}
+
+esp_err_t live_update(live_server_t* s, uint8_t slave, const live_reading_t* reading) {
+    if (s == NULL || reading == NULL || slave >= LIVE_MAX_SLAVES) return ESP_ERR_INVALID_ARG;
+    char json[LIVE_SLAVE_JSON_MAX];
+    size_t n = slave_to_json(slave, reading, json, sizeof(json));
+    if (n == 0) return ESP_ERR_INVALID_ARG;
+
+    xSemaphoreTake(s->lock, portMAX_DELAY);
+    // The ring slot's buffer is reused once no stream is still sending it
+    uint32_t slot = s->event_seq % LIVE_EVENT_RING;
+    live_buf_t* event = s->events[slot];
+    bool reuse = event != NULL && event->refs == 1;
+    if (!reuse) event = buf_alloc(LIVE_EVENT_MAX);
+    live_buf_t* snapshot = event == NULL ? NULL : snapshot_writable(s, n + 1);
+    if (snapshot == NULL) {
+        if (!reuse) free(event);
+        xSemaphoreGive(s->lock);
+        return ESP_ERR_NO_MEM;
+    }
+    if (!reuse) {
+        buf_unref(s->events[slot]); // Streams still sending it hold their own reference
+        s->events[slot] = event;
+    }
+    event->created_us = esp_timer_get_time();
+    event->len = 0;
+    buf_append(event, SSE_SLAVE, sizeof(SSE_SLAVE) - 1);
+    event->body_off = event->len;
+    event->body_len = n;
+    buf_append(event, json, n);
+    buf_append(event, SSE_END, sizeof(SSE_END) - 1);
+
+    if (reading->timestamp_ms > s->last_timestamp_ms) s->last_timestamp_ms = reading->timestamp_ms;
+    snapshot_patch(s, snapshot, slave, json, n);
+    snapshot_tail(s, snapshot);
+    s->event_seq++;
+    s->stats.updates++;
+    s->stats.snapshot_bytes = (uint32_t)snapshot->body_len;
+    xSemaphoreGive(s->lock);
+
+    live_wake(s);
+    return ESP_OK;
+}
+
+void live_get_stats(live_server_t* s, live_stats_t* out) {
+    xSemaphoreTake(s->lock, portMAX_DELAY);
+    *out = s->stats;
+    xSemaphoreGive(s->lock);
+}
+
+// --- Connections ---
+
+static void client_close(live_server_t* s, live_client_t* c) {
+    close(c->fd);
+    xSemaphoreTake(s->lock, portMAX_DELAY);
+    buf_unref(c->buf);
+    if (c->state == CLIENT_STREAM) s->stats.streams--;
+    s->stats.clients--;
+    xSemaphoreGive(s->lock);
+    c->buf = NULL;
+    c->fd = -1;
+    c->state = CLIENT_FREE;
+}
+
+static void client_respond(live_client_t* c, const char* head, live_buf_t* body, size_t off, size_t len,
+                           client_state_t next) {
+    int n = snprintf(c->head, sizeof(c->head), "%s", head);
+    c->head_len = n < 0 ? 0 : (size_t)n >= sizeof(c->head) ? sizeof(c->head) - 1 : (size_t)n;
+    c->head_off = 0;
+    c->buf = body;
+    c->buf_off = off;
+    c->buf_end = off + len;
+    c->buf_is_event = false;
+    c->state = next;
+}
+
+static void client_route(live_server_t* s, live_client_t* c) {
+    if (strncmp(c->req, "GET ", 4) != 0) {
+        client_respond(c, "HTTP/1.1 405 Method Not Allowed\r\nAllow: GET\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+                       NULL, 0, 0, CLIENT_RESPONSE);
+        return;
+    }
+    const char* path = c->req + 4;
+    size_t path_len = strcspn(path, " ?\r\n");
+
+    if (path_len == 13 && memcmp(path, "/api/snapshot", 13) == 0) {
+        xSemaphoreTake(s->lock, portMAX_DELAY);
+        live_buf_t* snap = buf_ref(s->snapshot);
+        s->stats.snapshots_served++;
+        xSemaphoreGive(s->lock);
+        char head[LIVE_HEAD_MAX];
+        snprintf(head, sizeof(head),
+                 "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %u\r\n"
+                 "Cache-Control: no-store\r\nAccess-Control-Allow-Origin: *\r\nConnection: close\r\n\r\n",
+                 (unsigned)snap->body_len);
+        client_respond(c, head, snap, snap->body_off, snap->body_len, CLIENT_RESPONSE);
+    } else if (path_len == 11 && memcmp(path, "/api/events", 11) == 0) {
+        // The snapshot and the event sequence are taken together, so nothing is missed or sent twice
+        xSemaphoreTake(s->lock, portMAX_DELAY);
+        live_buf_t* snap = buf_ref(s->snapshot);
+        c->next_seq = s->event_seq;
+        s->stats.streams++;
+        xSemaphoreGive(s->lock);
+        client_respond(c,
+                       "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-store\r\n"
+                       "Access-Control-Allow-Origin: *\r\nConnection: keep-alive\r\n\r\n",
+                       snap, 0, snap->len, CLIENT_STREAM);
+    } else {
+        client_respond(c, "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n", NULL, 0, 0,
+                       CLIENT_RESPONSE);
+    }
+}
+
+// Attaches the stream's next event, or the snapshot if it fell a ring behind. Lock held.
+static void client_next(live_server_t* s, live_client_t* c) {
+    if (c->state != CLIENT_STREAM || c->buf != NULL || c->head_off < c->head_len) return;
+    if (c->next_seq == s->event_seq) return;
+    live_buf_t* b;
+    if (s->event_seq - c->next_seq > LIVE_EVENT_RING) {
+        b = s->snapshot;
+        c->next_seq = s->event_seq;
+        c->buf_is_event = false;
+        s->stats.resyncs++;
+    } else {
+        b = s->events[c->next_seq % LIVE_EVENT_RING];
+        c->next_seq++;
+        c->buf_is_event = true;
+    }
+    c->buf = buf_ref(b);
+    c->buf_off = 0;
+    c->buf_end = b->len;
+}
+
+static bool client_has_output(const live_client_t* c) {
+    return c->head_off < c->head_len || c->buf != NULL;
+}
+
+// Writes until the socket would block. Returns false if the client was closed.
+static bool client_write(live_server_t* s, live_client_t* c) {
+    for (;;) {
+        const char* p;
+        size_t n;
+        if (c->head_off < c->head_len) {
+            p = c->head + c->head_off;
+            n = c->head_len - c->head_off;
+        } else if (c->buf != NULL && c->buf_off < c->buf_end) {
+            p = c->buf->data + c->buf_off;
+            n = c->buf_end - c->buf_off;
+        } else {
+            n = 0;
+            p = NULL;
+        }
+        if (n > 0) {
+            ssize_t sent = send(c->fd, p, n, LIVE_SEND_FLAGS);
+            if (sent < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+                client_close(s, c);
+                return false;
+            }
+            if (c->head_off < c->head_len) {
+                c->head_off += (size_t)sent;
+            } else {
+                c->buf_off += (size_t)sent;
+            }
+            if ((size_t)sent < n) return true; // Socket buffer full
+            continue;
+        }
+
+        // Everything queued is out
+        xSemaphoreTake(s->lock, portMAX_DELAY);
+        if (c->buf != NULL) {
+            if (c->buf_is_event) {
+                int64_t latency = esp_timer_get_time() - c->buf->created_us;
+                uint32_t us = latency <= 0 ? 0 : latency >= UINT32_MAX ? UINT32_MAX : (uint32_t)latency;
+                s->stats.events_pushed++;
+                s->stats.push_latency_total_us += us;
+                if (us > s->stats.push_latency_max_us) s->stats.push_latency_max_us = us;
+            }
+            buf_unref(c->buf);
+            c->buf = NULL;
+        }
+        client_next(s, c);
+        bool more = c->buf != NULL;
+        xSemaphoreGive(s->lock);
+        if (!more) break;
+    }
+    if (c->state == CLIENT_RESPONSE) {
+        client_close(s, c);
+        return false;
+    }
+    return true;
+}
+
+static void client_read(live_server_t* s, live_client_t* c) {
+    if (c->state != CLIENT_REQUEST) {
+        char scratch[64]; // A stream client sends nothing more; only notice it closing
+        ssize_t n = recv(c->fd, scratch, sizeof(scratch), 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) client_close(s, c);
+        return;
+    }
+    ssize_t n = recv(c->fd, c->req + c->req_len, sizeof(c->req) - 1 - c->req_len, 0);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        client_close(s, c);
+        return;
+    }
+    if (n < 0) return;
+    c->req_len += (size_t)n;
+    c->req[c->req_len] = '\0';
+    if (strstr(c->req, "\r\n\r\n") != NULL) {
+        client_route(s, c);
+    } else if (c->req_len == sizeof(c->req) - 1) {
+        client_respond(c, "HTTP/1.1 431 Request Header Fields Too Large\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+                       NULL, 0, 0, CLIENT_RESPONSE);
+    }
+}
+
+static void live_accept(live_server_t* s) {
+    for (;;) {
+        int fd = accept(s->listen_fd, NULL, NULL);
+        if (fd < 0) return;
+        live_client_t* c = NULL;
+        for (int i = 0; i < s->cfg.max_clients; i++) {
+            if (s->clients[i].state == CLIENT_FREE) {
+                c = &s->clients[i];
+                break;
+            }
+        }
+        if (c == NULL) {
+            static const char busy[] = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            send(fd, busy, sizeof(busy) - 1, MSG_DONTWAIT | LIVE_SEND_FLAGS); // Best effort
+            close(fd);
+            xSemaphoreTake(s->lock, portMAX_DELAY);
+            s->stats.rejected++;
+            xSemaphoreGive(s->lock);
+            continue;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        memset(c, 0, sizeof(*c));
+        c->fd = fd;
+        c->state = CLIENT_REQUEST;
+        xSemaphoreTake(s->lock, portMAX_DELAY);
+        s->stats.clients++;
+        if (s->stats.clients > s->stats.clients_max) s->stats.clients_max = s->stats.clients;
+        xSemaphoreGive(s->lock);
+    }
+}
+
+// --- Server Task ---
+
+static void live_task(void* arg) {
+    live_server_t* s = arg;
+    while (!s->stopping) {
+        fd_set rd, wr;
+        FD_ZERO(&rd);
+        FD_ZERO(&wr);
+        FD_SET(s->listen_fd, &rd);
+        FD_SET(s->wake_fd, &rd);
+        int max_fd = s->listen_fd > s->wake_fd ? s->listen_fd : s->wake_fd;
+
+        xSemaphoreTake(s->lock, portMAX_DELAY);
+        for (int i = 0; i < s->cfg.max_clients; i++) {
+            live_client_t* c = &s->clients[i];
+            if (c->state == CLIENT_FREE) continue;
+            client_next(s, c);
+            FD_SET(c->fd, &rd);
+            if (client_has_output(c)) FD_SET(c->fd, &wr);
+            if (c->fd > max_fd) max_fd = c->fd;
+        }
+        xSemaphoreGive(s->lock);
+
+        struct timeval tv = { .tv_sec = LIVE_SELECT_MS / 1000, .tv_usec = (LIVE_SELECT_MS % 1000) * 1000 };
+        int ready = select(max_fd + 1, &rd, &wr, NULL, &tv);
+        if (ready < 0) {
+            if (errno != EINTR) {
+                ESP_LOGE(TAG, "select failed: errno %d", errno);
+                vTaskDelay(pdMS_TO_TICKS(100));
+            }
+            continue;
+        }
+        if (FD_ISSET(s->wake_fd, &rd)) {
+            char drain[16];
+            while (recv(s->wake_fd, drain, sizeof(drain), MSG_DONTWAIT) > 0) {
+            }
+        }
+        for (int i = 0; i < s->cfg.max_clients; i++) {
+            live_client_t* c = &s->clients[i];
+            if (c->state == CLIENT_FREE) continue;
+            if (FD_ISSET(c->fd, &rd)) client_read(s, c);
+            // Also picks up events published during select(); a full socket just returns EAGAIN
+            if (c->state == CLIENT_RESPONSE || c->state == CLIENT_STREAM) client_write(s, c);
+        }
+        if (FD_ISSET(s->listen_fd, &rd)) live_accept(s);
+    }
+
+    for (int i = 0; i < s->cfg.max_clients; i++) {
+        if (s->clients[i].state != CLIENT_FREE) client_close(s, &s->clients[i]);
+    }
+    xSemaphoreGive(s->done);
+    vTaskDelete(NULL);
+}
+
+// --- Lifecycle ---
+
+static void live_free(live_server_t* s) {
+    if (s->listen_fd >= 0) close(s->listen_fd);
+    if (s->wake_fd >= 0) close(s->wake_fd);
+    buf_unref(s->snapshot);
+    for (int i = 0; i < LIVE_EVENT_RING; i++) buf_unref(s->events[i]);
+    if (s->lock != NULL) vSemaphoreDelete(s->lock);
+    if (s->done != NULL) vSemaphoreDelete(s->done);
+    free(s->clients);
+    free(s);
+}
+
+esp_err_t live_start(const live_config_t* config, live_server_t** out) {
+    if (config == NULL || out == NULL || config->max_clients == 0) return ESP_ERR_INVALID_ARG;
+    live_server_t* s = calloc(1, sizeof(live_server_t));
+    if (s == NULL) return ESP_ERR_NO_MEM;
+    s->cfg = *config;
+    s->listen_fd = -1;
+    s->wake_fd = -1;
+    s->clients = calloc(config->max_clients, sizeof(live_client_t));
+    s->lock = xSemaphoreCreateMutex();
+    s->done = xSemaphoreCreateBinary();
+    if (s->clients != NULL && s->lock != NULL) {
+        xSemaphoreTake(s->lock, portMAX_DELAY);
+        s->snapshot = snapshot_create(s); // Empty until the first update
+        xSemaphoreGive(s->lock);
+    }
+    if (s->clients == NULL || s->lock == NULL || s->done == NULL || s->snapshot == NULL) {
+        live_free(s);
+        return ESP_ERR_NO_MEM;
+    }
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(config->port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    int on = 1;
+    s->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (s->listen_fd < 0 || setsockopt(s->listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+        bind(s->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(s->listen_fd, 4) != 0) {
+        ESP_LOGE(TAG, "Cannot listen on port %u: errno %d", (unsigned)config->port, errno);
+        live_free(s);
+        return ESP_FAIL;
+    }
+    fcntl(s->listen_fd, F_SETFL, fcntl(s->listen_fd, F_GETFL, 0) | O_NONBLOCK);
+
+    socklen_t wake_len = sizeof(s->wake_addr);
+    s->wake_addr.sin_family = AF_INET;
+    s->wake_addr.sin_port = 0;
+    s->wake_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    s->wake_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (s->wake_fd < 0 || bind(s->wake_fd, (struct sockaddr*)&s->wake_addr, sizeof(s->wake_addr)) != 0 ||
+        getsockname(s->wake_fd, (struct sockaddr*)&s->wake_addr, &wake_len) != 0) {
+        ESP_LOGE(TAG, "Cannot create the wake-up socket: errno %d", errno);
+        live_free(s);
+        return ESP_FAIL;
+    }
+
+    if (xTaskCreate(live_task, "live_http", LIVE_TASK_STACK, s, config->task_priority, &s->task) != pdPASS) {
+        live_free(s);
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Live API on port %u, up to %u clients", (unsigned)config->port, (unsigned)config->max_clients);
+    *out = s;
+    return ESP_OK;
+}
+
+void live_stop(live_server_t* s) {
+    if (s == NULL) return;
+    s->stopping = true;
+    live_wake(s);
+    xSemaphoreTake(s->done, portMAX_DELAY);
+    live_free(s);
+}
@@ -0,0 +1,105 @@
+#ifndef LIVE_H
+#define LIVE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Local live API for the master: an HTTP server on the warehouse LAN so a floor
+// dashboard sees readings as they arrive instead of polling the cloud.
+//
+//   GET /api/snapshot  JSON object with the latest reading of every slave seen
+//   GET /api/events    Server-Sent Events: one "snapshot" event with the same JSON,
+//                      then one "slave" event per update
+//
+// Serialization happens once per update, in live_update: only the changed slave's
+// JSON fragment is encoded, and it is patched into the snapshot in place; the other
+// fragments are not touched, only the bytes after the patch move. The snapshot and
+// the change event are reference-counted buffers that every client sends from. A
+// buffer no client is sending is rewritten where it is, so an update allocates
+// nothing in the steady state; one that a client is still sending is copied first.
+// Requests and pushes never encode anything; a client only adds its own few bytes of
+// HTTP headers.
+//
+// Events go into a ring of LIVE_EVENT_RING buffers. A stream client that falls a
+// whole ring behind (slow reader, stalled socket) skips the backlog and is resynced
+// with the current snapshot, so a slow client costs memory for at most one ring and
+// never delays the others.
+//
+// One task serves all clients with non-blocking BSD sockets and select(), so the
+// server runs unchanged on the IDF linux target against loopback. Every socket
+// counts against CONFIG_LWIP_MAX_SOCKETS on the ESP32: the listener and the wake-up
+// socket take two.
+
+// --- Configuration Constants ---
+
+#ifndef LIVE_MAX_SLAVES
+#define LIVE_MAX_SLAVES     (64)    // Slave indices served; matches TDMA_MAX_SLAVES (override with -D)
+#endif
+#define LIVE_EVENT_RING     (32)    // Change events a stream client may lag behind before a resync
+#define LIVE_REQUEST_MAX    (512)   // Request line plus headers; larger requests get 431
+#define LIVE_SLAVE_JSON_MAX (192)   // One slave's JSON object
+#define LIVE_TASK_STACK     (4096)
+
+typedef struct {
+    uint16_t port;              // TCP port (80 on the master, anything free on loopback)
+    uint8_t max_clients;        // Concurrent connections; more get 503
+    uint8_t task_priority;
+} live_config_t;
+
+// One slave's latest reading. NAN fields are sent as null.
+typedef struct {
+    uint8_t mac[6];
+    uint32_t timestamp_ms;      // Master clock of the sample, 0 = unknown
+    float temperature;          // C
+    float humidity;             // %RH
+    float lpg_ppm;
+    float co_ppm;
+    float smoke_ppm;
+    bool motion;
+    uint8_t alarm;              // alarm_kind_t of the slave's detector (0 = none)
+} live_reading_t;
+
+// --- Metrics ---
+
+typedef struct {
+    uint32_t clients;           // Connected now (any state)
+    uint32_t streams;           // Of those, /api/events streams
+    uint32_t clients_max;
+    uint32_t rejected;          // Turned away at max_clients
+    uint32_t updates;           // live_update calls (= serializations)
+    uint32_t snapshots_served;
+    uint32_t events_pushed;     // Event buffers completely written to a stream client
+    uint32_t resyncs;           // Stream clients that fell a ring behind
+    uint32_t snapshot_bytes;    // Size of the current snapshot JSON
+    uint64_t push_latency_total_us; // live_update to the event's last byte handed to the socket
+    uint32_t push_latency_max_us;
+} live_stats_t;
+
+typedef struct live_server_s live_server_t;
+
+/**
+ * @brief Binds the listening socket and starts the server task.
+ *
+ * @return ESP_OK, ESP_ERR_NO_MEM, or ESP_FAIL if a socket could not be set up.
+ */
+esp_err_t live_start(const live_config_t* config, live_server_t** out);
+
+/**
+ * @brief Closes every connection, stops the task and frees the server. NULL is a no-op.
+ */
+void live_stop(live_server_t* server);
+
+/**
+ * @brief Publishes a slave's new reading: serializes it, patches it into the
+ *        snapshot and queues the change for every stream client. Safe from any task.
+ *
+ * @param slave Slave index, below LIVE_MAX_SLAVES.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG or ESP_ERR_NO_MEM (the previous snapshot stays).
+ */
+esp_err_t live_update(live_server_t* server, uint8_t slave, const live_reading_t* reading);
+
+void live_get_stats(live_server_t* server, live_stats_t* out);
+
+#endif // LIVE_H
@@ -5,6 +5,8 @@
 #include "esp_adc/adc_oneshot.h" // New ADC driver
 #include "hal/adc_types.h"       // For ADC enums
 
+#include <inttypes.h>
+#include <string.h>
 #include "esp_timer.h"
 #include "math.h"        // For pow, log10, fabs, isinf, isnan
 #include "esp_system.h"
@@ -43,7 +45,12 @@ esp_err_t mq2_init(MQ2* mq2, adc_unit_t adc_unit, adc_channel_t adc_channel, adc
     mq2->lastReadTime = 0;
     mq2->adc_handle = NULL; // Initialize handle to NULL
     mq2->adc_initialized = false;
+    memset(&mq2->source, 0, sizeof(mq2->source));
+    mq2->ambient = NAN; // No temperature/humidity reading yet
+    memset(&mq2->ro_track, 0, sizeof(mq2->ro_track));
     for(int i=0; i<3; ++i) mq2->values[i] = NAN; // Clear initial values using NAN
+    mq2->snap_seq = 0;
+    memset(mq2->snap, 0, sizeof(mq2->snap));
 
     // --- ADC Oneshot Init ---
     adc_oneshot_unit_init_cfg_t init_config = {
@@ -77,9 +84,41 @@ esp_err_t mq2_init(MQ2* mq2, adc_unit_t adc_unit, adc_channel_t adc_channel, adc
     return ESP_OK;
 }
 
+esp_err_t mq2_init_source(MQ2* mq2, const mq2_source_t* source) {
+    if (mq2 == NULL || source == NULL || source->read == NULL || source->now_ms == NULL) return ESP_ERR_INVALID_ARG;
+    memset(mq2, 0, sizeof(*mq2));
+    mq2->Ro = -1.0;
+    mq2->rl_value = RL_VALUE;
+    mq2->ro_clean_air_factor = RO_CLEAN_AIR_FACTOR;
+    mq2->ambient = NAN;
+    for (int i = 0; i < 3; ++i) mq2->values[i] = NAN;
+    mq2->source = *source;
+    mq2->adc_initialized = true;
+    return ESP_OK;
+}
+
+// One conversion from the ADC or the source
+static esp_err_t mq2_adc_read(MQ2* mq2, int* raw) {
+    if (mq2->source.read != NULL) return mq2->source.read(mq2->source.ctx, raw);
+    return adc_oneshot_read(mq2->adc_handle, mq2->adc_channel, raw);
+}
+
+// Waits between conversions; a source is sampled back to back
+static void mq2_adc_wait(const MQ2* mq2, uint32_t ms) {
+    if (mq2->source.read == NULL) vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+static uint64_t mq2_now_ms(const MQ2* mq2) {
+    if (mq2->source.now_ms != NULL) return mq2->source.now_ms(mq2->source.ctx);
+    return esp_timer_get_time() / 1000ULL;
+}
+
 // Deinitialization function
 void mq2_deinit(MQ2* mq2) {
-     if (mq2 != NULL && mq2->adc_initialized && mq2->adc_handle != NULL) {
+     if (mq2 != NULL && mq2->source.read != NULL) {
+         mq2->adc_initialized = false;
+         mq2->Ro = -1.0;
+     } else if (mq2 != NULL && mq2->adc_initialized && mq2->adc_handle != NULL) {
          esp_err_t ret = adc_oneshot_del_unit(mq2->adc_handle);
           if (ret != ESP_OK) {
                ESP_LOGE(TAG, "adc_oneshot_del_unit failed: %s", esp_err_to_name(ret));
@@ -103,6 +142,14 @@ bool mq2_begin(MQ2* mq2) {
 
     if (mq2->Ro > 0) {
          ESP_LOGI(TAG, "Calibration successful. Ro = %.3f kOhm", mq2->Ro);
+         // Restart drift tracking from the new value; Ro is rescaled to reference
+         // conditions by the first mq2_set_ambient() if the ambient is not known yet
+         memset(&mq2->ro_track, 0, sizeof(mq2->ro_track));
+         mq2->ro_track.ro_calibrated = mq2->Ro;
+         if (!isnan(mq2->ambient)) {
+             mq2->Ro /= mq2->ambient;
+             mq2->ro_track.ro_calibrated = mq2->Ro;
+         }
          return true;
     } else {
          // Ro will be < 0 if calibration failed (returned -1.0)
@@ -121,6 +168,40 @@ bool mq2_check_calibration(MQ2* mq2) {
     return true;
 }
 
+// --- Snapshot Publication ---
+// Latched seqlock with a single writer (the acquisition task). snap_seq is bumped
+// before each copy is rewritten: while it is odd the writer is updating snap[0] and
+// readers use snap[1], while it is even the reverse. A reader only retries if the
+// writer finished a phase during its copy, so a preempted writer can never make a
+// reader spin, and the writer never waits for readers.
+
+static void mq2_publish(MQ2* mq2, float rs, float ratio) {
+    mq2_snapshot_t snap = {
+        .values = { mq2->values[0], mq2->values[1], mq2->values[2] },
+        .rs = rs,
+        .ratio = ratio,
+        .ro = mq2->Ro,
+        .timestamp_ms = mq2->lastReadTime,
+        .seq = mq2->snap_seq / 2 + 1,
+    };
+    for (int copy = 0; copy < 2; copy++) {
+        __atomic_store_n(&mq2->snap_seq, mq2->snap_seq + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST); // Sequence visible before the copy changes
+        mq2->snap[copy] = snap;
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+}
+
+bool mq2_snapshot(const MQ2* mq2, mq2_snapshot_t* out) {
+    uint32_t seq;
+    do {
+        seq = __atomic_load_n(&mq2->snap_seq, __ATOMIC_ACQUIRE);
+        memcpy(out, &mq2->snap[(seq & 1) ? 1 : 0], sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (__atomic_load_n(&mq2->snap_seq, __ATOMIC_RELAXED) != seq);
+    return out->seq != 0;
+}
+
 // --- Reading Functions ---
 
 float* mq2_read(MQ2* mq2, bool print) {
@@ -138,8 +219,8 @@ float* mq2_read(MQ2* mq2, bool print) {
         return NULL; // Indicate read failure
     }
 
-    // Calculate Rs/Ro ratio
-    float ratio = rs / mq2->Ro; // Ro is guaranteed > 0 here due to mq2_check_calibration
+    // Calculate the compensated Rs/Ro ratio (Ro is guaranteed > 0 here due to mq2_check_calibration)
+    float ratio = mq2_ratio(mq2, rs);
 
     // Calculate PPM for each gas using the Rs/Ro ratio and respective curves
     // mq2_MQ_get_percentage will return < 0 if calculation fails for any reason
@@ -148,7 +229,9 @@ float* mq2_read(MQ2* mq2, bool print) {
     mq2->values[2] = mq2_MQ_get_percentage(ratio, SmokeCurve);
 
     // Update timestamp
-    mq2->lastReadTime = esp_timer_get_time() / 1000ULL; // Get current time in milliseconds
+    mq2->lastReadTime = mq2_now_ms(mq2); // Get current time in milliseconds
+    mq2_publish(mq2, rs, ratio); // Make the complete triple visible to other tasks
+    mq2_ro_track(mq2, rs, mq2->lastReadTime); // Takes effect from the next reading
 
     if (print) {
         // Check for calculation errors before printing PPM values
@@ -157,7 +240,7 @@ float* mq2_read(MQ2* mq2, bool print) {
         snprintf(co_str, sizeof(co_str), mq2->values[1] < 0 ? "ERR" : "%.3f", mq2->values[1]);
         snprintf(smoke_str, sizeof(smoke_str), mq2->values[2] < 0 ? "ERR" : "%.3f", mq2->values[2]);
 
-        ESP_LOGI(TAG, "%llu ms - LPG: %s ppm, CO: %s ppm, SMOKE: %s ppm (Rs=%.3fk, Ro=%.3fk, Ratio=%.3f)",
+        ESP_LOGI(TAG, "%" PRIu64 " ms - LPG: %s ppm, CO: %s ppm, SMOKE: %s ppm (Rs=%.3fk, Ro=%.3fk, Ratio=%.3f)",
                  mq2->lastReadTime, lpg_str, co_str, smoke_str, rs, mq2->Ro, ratio);
     }
 
@@ -165,44 +248,123 @@ float* mq2_read(MQ2* mq2, bool print) {
 }
 
 // Helper for individual gas reads with caching
-static float mq2_read_single_gas(MQ2* mq2, int gas_index, const float *curve) {
+static float mq2_read_single_gas(MQ2* mq2, int gas_index) {
     // Check calibration first - return NAN if not calibrated
      if (!mq2_check_calibration(mq2)) return NAN;
 
-    uint64_t current_time_ms = esp_timer_get_time() / 1000ULL;
+    uint64_t current_time_ms = mq2_now_ms(mq2);
 
     // Use cached value if the specific gas value is valid (not NAN, >=0) and recent
     if (current_time_ms < (mq2->lastReadTime + READ_DELAY) && !isnan(mq2->values[gas_index]) && mq2->values[gas_index] >= 0) {
         return mq2->values[gas_index];
     } else {
-        // Cache miss or expired: Need to re-read sensor resistance
-        float rs = mq2_MQ_read_adc(mq2); // Use new ADC read function, returns < 0 on error
-        if (rs < 0) {
-            mq2->values[gas_index] = -1.0; // Store error indicator
+        // Cache miss or expired: take a full reading so the published triple stays consistent
+        // (the ADC averaging dominates; the two extra curve evaluations are negligible)
+        if (mq2_read(mq2, false) == NULL) {
             return -1.0; // Return error indicator
         }
-        float ratio = rs / mq2->Ro; // Ro is valid here
-        // Calculate and store the new value (mq2_MQ_get_percentage returns < 0 on error)
-        mq2->values[gas_index] = mq2_MQ_get_percentage(ratio, curve);
-        // Note: This single read doesn't update lastReadTime globally, only mq2_read does.
         return mq2->values[gas_index];
     }
 }
 
 
 float mq2_read_LPG(MQ2* mq2) {
-    return mq2_read_single_gas(mq2, 0, LPGCurve);
+    return mq2_read_single_gas(mq2, 0);
 }
 
 float mq2_read_CO(MQ2* mq2) {
-     return mq2_read_single_gas(mq2, 1, COCurve);
+     return mq2_read_single_gas(mq2, 1);
 }
 
 float mq2_read_smoke(MQ2* mq2) {
-     return mq2_read_single_gas(mq2, 2, SmokeCurve);
+     return mq2_read_single_gas(mq2, 2);
 }
 
 
+// --- Ambient Compensation ---
+
+float mq2_ambient_factor(float temp_c, float humidity_pct) {
+    float t = temp_c < -10.0f ? -10.0f : temp_c > 50.0f ? 50.0f : temp_c;
+    float h = humidity_pct < 0.0f ? 0.0f : humidity_pct > 100.0f ? 100.0f : humidity_pct;
+    const float ref = MQ2_AMBIENT_A * 20.0f * 20.0f - MQ2_AMBIENT_B * 20.0f + MQ2_AMBIENT_C;
+    return (MQ2_AMBIENT_A * t * t - MQ2_AMBIENT_B * t + MQ2_AMBIENT_C - MQ2_AMBIENT_D * (h - 33.0f)) / ref;
+}
+
+void mq2_set_ambient(MQ2* mq2, float temp_c, float humidity_pct) {
+    if (mq2 == NULL || isnan(temp_c) || isnan(humidity_pct)) return;
+    float factor = mq2_ambient_factor(temp_c, humidity_pct);
+    if (isnan(mq2->ambient) && mq2->Ro > 0) {
+        // Calibration ran at roughly these conditions: move Ro to reference conditions
+        // so the compensated ratio does not step when compensation starts
+        float ro = mq2->Ro / factor;
+        __atomic_store(&mq2->Ro, &ro, __ATOMIC_RELEASE);
+        mq2->ro_track.ro_calibrated = ro;
+        ESP_LOGI(TAG, "Ambient %.1f C / %.0f %%RH (factor %.3f): Ro at reference conditions = %.3f kOhm",
+                 temp_c, humidity_pct, factor, ro);
+    }
+    mq2->ambient = factor;
+}
+
+float mq2_ratio(const MQ2* mq2, float rs) {
+    if (mq2 == NULL || mq2->Ro <= 0 || rs < 0) return -1.0;
+    float ambient = isnan(mq2->ambient) ? 1.0f : mq2->ambient;
+    return rs / (mq2->Ro * ambient);
+}
+
+// --- Ro Drift Tracking ---
+
+static float mq2_median_peak(const mq2_ro_tracker_t* t) {
+    float sorted[MQ2_RO_WINDOW_BUCKETS];
+    for (uint8_t i = 0; i < t->peaks_n; i++) { // Insertion sort, at most MQ2_RO_WINDOW_BUCKETS
+        float v = t->peaks[i];
+        int j = i - 1;
+        while (j >= 0 && sorted[j] > v) {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = v;
+    }
+    uint8_t n = t->peaks_n;
+    return (n & 1) ? sorted[n / 2] : 0.5f * (sorted[n / 2 - 1] + sorted[n / 2]);
+}
+
+bool mq2_ro_track(MQ2* mq2, float rs, uint64_t now_ms) {
+    if (mq2 == NULL || mq2->Ro <= 0) return false;
+    mq2_ro_tracker_t* t = &mq2->ro_track;
+    if (t->ro_calibrated <= 0 || !(rs > 0)) return false;
+
+    float rs_ref = rs / (isnan(mq2->ambient) ? 1.0f : mq2->ambient);
+    if (t->bucket_samples == 0) t->bucket_start_ms = now_ms;
+    if (t->bucket_samples == 0 || rs_ref > t->bucket_peak) t->bucket_peak = rs_ref;
+    t->bucket_samples++;
+    if (now_ms - t->bucket_start_ms < MQ2_RO_BUCKET_MS) return false;
+
+    // Close the bucket; one with too few readings (sensor mostly failing) is dropped
+    bool counted = t->bucket_samples >= MQ2_RO_MIN_SAMPLES;
+    if (counted) {
+        t->peaks[t->peaks_head] = t->bucket_peak;
+        t->peaks_head = (t->peaks_head + 1) % MQ2_RO_WINDOW_BUCKETS;
+        if (t->peaks_n < MQ2_RO_WINDOW_BUCKETS) t->peaks_n++;
+    }
+    t->bucket_samples = 0;
+    if (!counted || t->peaks_n < MQ2_RO_MIN_BUCKETS || mq2->ro_clean_air_factor <= 0) return false;
+
+    float target = mq2_median_peak(t) / mq2->ro_clean_air_factor;
+    float lo = t->ro_calibrated * (1.0f - MQ2_RO_MAX_DRIFT), hi = t->ro_calibrated * (1.0f + MQ2_RO_MAX_DRIFT);
+    if (target < lo) target = lo;
+    if (target > hi) target = hi;
+    float ro = mq2->Ro;
+    float step = ro * MQ2_RO_MAX_STEP;
+    ro = target > ro + step ? ro + step : target < ro - step ? ro - step : target;
+    if (ro == mq2->Ro) return false;
+
+    __atomic_store(&mq2->Ro, &ro, __ATOMIC_RELEASE); // Readers see the old or the new Ro, never a torn value
+    t->updates++;
+    ESP_LOGD(TAG, "Ro drift: %.3f kOhm (calibrated %.3f, target %.3f, %u peaks)", ro, t->ro_calibrated, target,
+             (unsigned)t->peaks_n);
+    return true;
+}
+
 // --- Core Calculation Functions ---
 
 // Resistance calculation function remains largely the same conceptually
@@ -242,7 +404,7 @@ float mq2_MQ_calibration(MQ2* mq2) {
 
     for (int i = 0; i < CALIBRATION_SAMPLE_TIMES; i++) {
         // Use the new oneshot read function
-        esp_err_t ret = adc_oneshot_read(mq2->adc_handle, mq2->adc_channel, &adc_raw);
+        esp_err_t ret = mq2_adc_read(mq2, &adc_raw);
 
         if (ret == ESP_OK) { // ADC read successful
              float rs_val = mq2_MQ_resistance_calculation(mq2, adc_raw);
@@ -255,11 +417,11 @@ float mq2_MQ_calibration(MQ2* mq2) {
         } else {
             ESP_LOGW(TAG, "Calibration sample %d: adc_oneshot_read failed: %s", i + 1, esp_err_to_name(ret));
              // Optionally add a small delay here if ADC reads fail consecutively
-             vTaskDelay(pdMS_TO_TICKS(5));
+             mq2_adc_wait(mq2, 5);
         }
 
         // Delay between samples
-        vTaskDelay(pdMS_TO_TICKS(CALIBRATION_SAMPLE_INTERVAL));
+        mq2_adc_wait(mq2, CALIBRATION_SAMPLE_INTERVAL);
     }
 
     if (valid_samples == 0) {
@@ -289,7 +451,7 @@ float mq2_MQ_read_adc(MQ2* mq2) {
     int adc_raw = 0;
 
     for (int i = 0; i < READ_SAMPLE_TIMES; i++) {
-         esp_err_t ret = adc_oneshot_read(mq2->adc_handle, mq2->adc_channel, &adc_raw);
+         esp_err_t ret = mq2_adc_read(mq2, &adc_raw);
          if (ret == ESP_OK) {
             float rs_val = mq2_MQ_resistance_calculation(mq2, adc_raw);
             if (rs_val >= 0) { // Check if calculation was valid and non-negative
@@ -305,7 +467,7 @@ float mq2_MQ_read_adc(MQ2* mq2) {
 
         // Only delay if not the last sample
         if (i < READ_SAMPLE_TIMES - 1) {
-            vTaskDelay(pdMS_TO_TICKS(READ_SAMPLE_INTERVAL));
+            mq2_adc_wait(mq2, READ_SAMPLE_INTERVAL);
         }
     }
 
@@ -30,8 +30,62 @@
 // Define the delay (in ms) for cached readings in individual read functions.
 #define READ_DELAY (100) // ms - Only re-read if last read was longer ago than this
 
+// --- Ro Drift Tracking ---
+// Heater ageing and the environment move the clean-air resistance away from the Ro
+// found by mq2_begin. Every reading's Rs, corrected to reference conditions, is fed
+// to a background estimator: the highest Rs of each bucket (the cleanest air seen
+// in it) goes into a window, and Ro follows the median of those peaks, slew-limited
+// and kept near the calibrated value so a long gas exposure cannot be learned as clean air.
+#define MQ2_RO_BUCKET_MS       (3600ULL * 1000) // One clean-air candidate per hour
+#define MQ2_RO_WINDOW_BUCKETS  (24)             // Candidates Ro is taken over (a day)
+#define MQ2_RO_MIN_BUCKETS     (6)              // Candidates needed before Ro is adjusted
+#define MQ2_RO_MIN_SAMPLES     (10)             // Readings a bucket needs to count
+#define MQ2_RO_MAX_STEP        (0.02f)          // Largest Ro change per bucket (fraction of Ro)
+#define MQ2_RO_MAX_DRIFT       (0.5f)           // Ro stays within +-50% of the calibrated value
+
+// Temperature/humidity dependence of Rs/Ro (datasheet sensitivity curves, fitted as
+// A*T^2 - B*T + C - D*(RH - 33)), normalised to 1.0 at the datasheet's 20 C / 33 %RH
+#define MQ2_AMBIENT_A (0.00035f)
+#define MQ2_AMBIENT_B (0.02718f)
+#define MQ2_AMBIENT_C (1.39538f)
+#define MQ2_AMBIENT_D (0.0018f)
+
+// --- Calibration Curves (defined in MQ2.c) ---
+// Format: {log10(Reference PPM), log10(Rs/Ro at Reference PPM), slope of the log-log line}
+extern const float LPGCurve[3];
+extern const float COCurve[3];
+extern const float SmokeCurve[3];
+
 // --- Sensor Data Structure ---
 
+// One complete reading, as published to other tasks by mq2_read()
+typedef struct {
+    float values[3];             // [LPG, CO, SMOKE] in PPM; < 0 if the calculation failed for that gas
+    float rs;                    // Averaged sensor resistance (kOhm)
+    float ratio;                 // Rs/Ro, temperature/humidity compensated
+    float ro;                    // Ro the reading was computed with (kOhm)
+    uint64_t timestamp_ms;       // esp_timer time of the reading
+    uint32_t seq;                // Increments with every published reading; 0 = nothing published yet
+} mq2_snapshot_t;
+
+typedef struct {
+    float ro_calibrated;         // Ro from mq2_begin at reference conditions (<= 0 = not tracking)
+    float bucket_peak;           // Highest compensated Rs in the open bucket
+    uint32_t bucket_samples;
+    uint64_t bucket_start_ms;
+    float peaks[MQ2_RO_WINDOW_BUCKETS]; // Ring of closed bucket peaks
+    uint8_t peaks_n;
+    uint8_t peaks_head;
+    uint32_t updates;            // Times Ro was moved
+} mq2_ro_tracker_t;
+
+// A stand-in for the ADC and the clock (mq2_init_source), e.g. the soak's sensor model
+typedef struct {
+    esp_err_t (*read)(void* ctx, int* raw); // One 12-bit conversion of the sensor's AO voltage
+    uint64_t (*now_ms)(void* ctx);          // Time of readings, for timestamps and Ro tracking
+    void* ctx;
+} mq2_source_t;
+
 typedef struct {
     adc1_channel_t adc_channel;  // ADC channel the sensor's AO pin is connected to
     adc_atten_t adc_atten;       // ADC attenuation setting used for the channel
@@ -42,6 +96,14 @@ typedef struct {
     float rl_value;              // Stored Load Resistor value (kOhm) used for calculations
     float ro_clean_air_factor;   // Stored Clean Air Factor (Rs/Ro in clean air) used for calibration
     bool adc_initialized;
+    mq2_source_t source;         // Used instead of the ADC and esp_timer when source.read is set
+    float ambient;               // Rs/Ro multiplier for the current temperature/humidity; NAN = not known yet
+    mq2_ro_tracker_t ro_track;   // Written only by the acquisition task, like Ro
+
+    // Latched seqlock: the acquisition task keeps two copies of the last reading and
+    // readers copy whichever one it is not currently writing (see mq2_snapshot).
+    uint32_t snap_seq;
+    mq2_snapshot_t snap[2];
 } MQ2;
 
 // --- Function Prototypes ---
@@ -57,6 +119,17 @@ typedef struct {
  */
 esp_err_t mq2_init(MQ2* mq2, adc_unit_t adc_unit, adc_channel_t adc_channel, adc_atten_t adc_atten);
 
+/**
+ * @brief Initializes the MQ2 structure on a modelled sensor instead of the ADC. The
+ *        library then runs unchanged (mq2_begin, mq2_read, mq2_snapshot, Ro tracking),
+ *        except that conversions are taken back to back, without the sample intervals.
+ *
+ * @param mq2 Pointer to the MQ2 structure.
+ * @param source Conversions and clock; copied.
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if an argument or source.read/now_ms is NULL.
+ */
+esp_err_t mq2_init_source(MQ2* mq2, const mq2_source_t* source);
+
 /**
  * @brief Performs calibration to determine Ro (resistance in clean air).
  * @warning Sensor MUST be in clean air and adequately pre-heated (check datasheet,
@@ -93,7 +166,20 @@ bool mq2_check_calibration(MQ2* mq2);
 float* mq2_read(MQ2* mq2, bool print);
 
 /**
- * @brief Reads the LPG concentration in PPM. Uses cached value if recent.
+ * @brief Copies the most recent complete reading. Safe to call from any task while
+ *        another task is reading the sensor; never blocks the acquisition path.
+ * @note mq2_read() and the mq2_read_*() functions must all be called from a single
+ *       acquisition task. Other tasks must only use this function, not mq2->values.
+ *
+ * @param mq2 Pointer to the MQ2 structure.
+ * @param out Receives a consistent copy of values, Rs, ratio and timestamp.
+ * @return true if a reading has been published, false if none yet (out->seq == 0).
+ */
+bool mq2_snapshot(const MQ2* mq2, mq2_snapshot_t* out);
+
+/**
+ * @brief Reads the LPG concentration in PPM. Uses cached value if recent, otherwise
+ *        performs (and publishes) a full reading like mq2_read().
  *
  * @param mq2 Pointer to the MQ2 structure.
  * @return LPG concentration in PPM. Returns 0.0 if not calibrated.
@@ -119,6 +205,42 @@ float mq2_read_CO(MQ2* mq2);
  */
 float mq2_read_smoke(MQ2* mq2);
 
+/**
+ * @brief Sets the temperature and humidity the following readings are compensated for.
+ *        Call from the acquisition task with each ambient reading (e.g. the DHT11's).
+ * @note The first call after calibration takes the current conditions as the ones
+ *       mq2_begin ran in, and rescales Ro to reference conditions accordingly.
+ *
+ * @param mq2 Pointer to the MQ2 structure.
+ * @param temp_c Temperature in degrees C (clamped to the datasheet's -10..50 C).
+ * @param humidity_pct Relative humidity in % (clamped to 0..100).
+ */
+void mq2_set_ambient(MQ2* mq2, float temp_c, float humidity_pct);
+
+/**
+ * @brief Rs/Ro multiplier at the given conditions, relative to 20 C / 33 %RH.
+ */
+float mq2_ambient_factor(float temp_c, float humidity_pct);
+
+/**
+ * @brief Compensated Rs/Ro ratio for a resistance measured at the current ambient.
+ *
+ * @return The ratio, or a negative value if not calibrated or rs is invalid.
+ */
+float mq2_ratio(const MQ2* mq2, float rs);
+
+/**
+ * @brief Feeds one measured resistance to the Ro drift tracker (mq2_read does this).
+ *        Incremental: a reading costs a compare, closing a bucket a 24-value sort.
+ *        Ro is replaced with a single atomic store, so sampling is never paused.
+ *
+ * @param mq2 Pointer to the MQ2 structure.
+ * @param rs Measured sensor resistance (kOhm), at the current ambient.
+ * @param now_ms Time of the reading (only differences are used).
+ * @return true if Ro was changed.
+ */
+bool mq2_ro_track(MQ2* mq2, float rs, uint64_t now_ms);
+
 // --- Internal Helper Functions (Generally not called directly by user) ---
 
 /**
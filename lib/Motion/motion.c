@@ -0,0 +1,272 @@
+#include "motion.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+
+static const char *TAG = "MOTION";
+
+#define MOTION_NONE (-1)
+
+typedef struct {
+    uint16_t zone;
+    uint32_t min_ms;
+    uint32_t max_ms;
+} motion_adj_t;
+
+typedef struct {
+    bool live;
+    bool reported;
+    uint32_t id;
+    int64_t started_ms;
+    int64_t enter_ms;         // First hit in the current zone
+    int64_t last_ms;          // Latest hit in the current zone
+    int64_t prev_enter_ms;    // First hit in the zone before, for hop speed
+    uint16_t zones;
+    uint8_t path_head;        // Next write position in path
+    uint16_t path[MOTION_PATH_MAX]; // Ring; the newest entry is the current zone
+} motion_track_t;
+
+struct motion_engine {
+    uint16_t max_zones;
+    motion_config_t cfg;
+
+    // Zone graph, compressed adjacency lists: zone z's neighbours are adj[first[z] .. first[z + 1])
+    uint32_t* first;          // [max_zones + 1]
+    motion_adj_t* adj;        // [2 * n_edges]
+    motion_pos_t* pos;        // [max_zones] or NULL
+
+    // Per-zone state
+    int8_t* here;             // [max_zones] track in the zone, MOTION_NONE if none
+    int64_t* left_ms;         // [max_zones] last hit in the zone after a track walked on from it
+
+    motion_track_t tracks[MOTION_MAX_TRACKS];
+    uint32_t next_id;
+    motion_alert_cb_t cb;
+    void* cb_ctx;
+    motion_stats_t stats;
+};
+
+// --- Graph ---
+
+esp_err_t motion_create(const motion_edge_t* edges, uint16_t n_edges, const motion_pos_t* positions,
+                        uint16_t max_zones, const motion_config_t* config, motion_engine_t** out) {
+    if (out == NULL || config == NULL || (n_edges > 0 && edges == NULL) || max_zones == 0 || config->alert_zones < 2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out = NULL;
+    for (uint16_t i = 0; i < n_edges; i++) {
+        const motion_edge_t* ed = &edges[i];
+        if (ed->a >= max_zones || ed->b >= max_zones || ed->a == ed->b || ed->min_ms > ed->max_ms) {
+            ESP_LOGE(TAG, "Edge %u (%u - %u) is malformed", i, ed->a, ed->b);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    motion_engine_t* e = calloc(1, sizeof(motion_engine_t));
+    if (e == NULL) return ESP_ERR_NO_MEM;
+    e->max_zones = max_zones;
+    e->cfg = *config;
+    e->first = calloc((size_t)max_zones + 1, sizeof(uint32_t));
+    e->adj = calloc(n_edges ? 2 * (size_t)n_edges : 1, sizeof(motion_adj_t));
+    e->here = malloc(max_zones);
+    e->left_ms = malloc((size_t)max_zones * sizeof(int64_t));
+    if (positions != NULL) e->pos = malloc((size_t)max_zones * sizeof(motion_pos_t));
+    if (!e->first || !e->adj || !e->here || !e->left_ms || (positions != NULL && !e->pos)) {
+        motion_destroy(e);
+        return ESP_ERR_NO_MEM;
+    }
+    memset(e->here, MOTION_NONE, max_zones);
+    for (uint16_t z = 0; z < max_zones; z++) e->left_ms[z] = INT64_MIN / 2;
+    if (positions != NULL) memcpy(e->pos, positions, (size_t)max_zones * sizeof(motion_pos_t));
+
+    // Counting sort of both directions of every edge by source zone
+    for (uint16_t i = 0; i < n_edges; i++) {
+        e->first[edges[i].a + 1]++;
+        e->first[edges[i].b + 1]++;
+    }
+    for (uint16_t z = 0; z < max_zones; z++) e->first[z + 1] += e->first[z];
+    uint32_t* fill = calloc(max_zones, sizeof(uint32_t));
+    if (fill == NULL) {
+        motion_destroy(e);
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint16_t i = 0; i < n_edges; i++) {
+        const motion_edge_t* ed = &edges[i];
+        e->adj[e->first[ed->a] + fill[ed->a]++] = (motion_adj_t){ ed->b, ed->min_ms, ed->max_ms };
+        e->adj[e->first[ed->b] + fill[ed->b]++] = (motion_adj_t){ ed->a, ed->min_ms, ed->max_ms };
+    }
+    free(fill);
+
+    *out = e;
+    return ESP_OK;
+}
+
+void motion_destroy(motion_engine_t* e) {
+    if (e == NULL) return;
+    free(e->first);
+    free(e->adj);
+    free(e->pos);
+    free(e->here);
+    free(e->left_ms);
+    free(e);
+}
+
+void motion_set_alert_cb(motion_engine_t* e, motion_alert_cb_t cb, void* ctx) {
+    e->cb = cb;
+    e->cb_ctx = ctx;
+}
+
+size_t motion_memory_usage(const motion_engine_t* e) {
+    if (e == NULL) return 0;
+    size_t graph = ((size_t)e->max_zones + 1) * sizeof(uint32_t) + e->first[e->max_zones] * sizeof(motion_adj_t) +
+                   (e->pos ? (size_t)e->max_zones * sizeof(motion_pos_t) : 0);
+    size_t per_zone = sizeof(int8_t) + sizeof(int64_t);
+    return sizeof(*e) + graph + (size_t)e->max_zones * per_zone;
+}
+
+// --- Tracks ---
+
+static inline uint16_t track_zone(const motion_track_t* tr) {
+    return tr->path[(tr->path_head + MOTION_PATH_MAX - 1) % MOTION_PATH_MAX];
+}
+
+static inline bool track_expired(const motion_engine_t* e, const motion_track_t* tr, int64_t t_ms) {
+    return t_ms - tr->last_ms > (int64_t)e->cfg.track_timeout_ms;
+}
+
+static void track_alert(motion_engine_t* e, const motion_track_t* tr, motion_alert_kind_t kind, int64_t t_ms) {
+    if (e->cb == NULL) return;
+    motion_alert_t a = {
+        .kind = (uint8_t)kind,
+        .track_id = tr->id,
+        .t_ms = t_ms,
+        .started_ms = tr->started_ms,
+        .zones = tr->zones,
+        .path_len = tr->zones < MOTION_PATH_MAX ? (uint8_t)tr->zones : MOTION_PATH_MAX,
+        .heading_deg = NAN,
+        .speed_m_s = NAN,
+    };
+    for (uint8_t i = 0; i < a.path_len; i++) {
+        a.path[i] = tr->path[(tr->path_head + MOTION_PATH_MAX - a.path_len + i) % MOTION_PATH_MAX];
+    }
+    a.to = a.path[a.path_len - 1];
+    a.from = a.path_len > 1 ? a.path[a.path_len - 2] : a.to;
+    if (e->pos != NULL && a.from != a.to) {
+        float dx = e->pos[a.to].x - e->pos[a.from].x;
+        float dy = e->pos[a.to].y - e->pos[a.from].y;
+        a.heading_deg = atan2f(dx, dy) * (180.0f / (float)M_PI);
+        if (a.heading_deg < 0.0f) a.heading_deg += 360.0f;
+        int64_t dt_ms = tr->enter_ms - tr->prev_enter_ms;
+        if (dt_ms > 0) a.speed_m_s = sqrtf(dx * dx + dy * dy) * 1000.0f / (float)dt_ms;
+    }
+    e->stats.alerts++;
+    e->cb(e->cb_ctx, &a);
+}
+
+static void track_end(motion_engine_t* e, int8_t k) {
+    motion_track_t* tr = &e->tracks[k];
+    uint16_t zone = track_zone(tr);
+    if (e->here[zone] == k) e->here[zone] = MOTION_NONE;
+    if (tr->reported) track_alert(e, tr, MOTION_ALERT_END, tr->last_ms);
+    tr->live = false;
+    e->stats.tracks_ended++;
+    e->stats.tracks_live--;
+}
+
+// A free slot; ends timed-out tracks first, then drops the least recently seen one
+static int8_t track_alloc(motion_engine_t* e, int64_t t_ms) {
+    int8_t oldest = 0;
+    for (int8_t k = 0; k < MOTION_MAX_TRACKS; k++) {
+        motion_track_t* tr = &e->tracks[k];
+        if (tr->live && track_expired(e, tr, t_ms)) track_end(e, k);
+        if (!tr->live) return k;
+        if (tr->last_ms < e->tracks[oldest].last_ms) oldest = k;
+    }
+    e->stats.tracks_dropped++;
+    track_end(e, oldest);
+    return oldest;
+}
+
+static void track_enter(motion_engine_t* e, int8_t k, uint16_t zone, int64_t t_ms) {
+    motion_track_t* tr = &e->tracks[k];
+    tr->path[tr->path_head] = zone;
+    tr->path_head = (tr->path_head + 1) % MOTION_PATH_MAX;
+    if (tr->zones < UINT16_MAX) tr->zones++;
+    tr->prev_enter_ms = tr->enter_ms;
+    tr->enter_ms = t_ms;
+    tr->last_ms = t_ms;
+    e->here[zone] = k;
+}
+
+// --- Ingest ---
+
+void motion_ingest(motion_engine_t* e, uint16_t zone, int64_t t_ms) {
+    if (e == NULL || zone >= e->max_zones) return;
+    e->stats.hits++;
+
+    // 1. Someone already here: the visit goes on
+    int8_t k = e->here[zone];
+    if (k != MOTION_NONE) {
+        if (!track_expired(e, &e->tracks[k], t_ms)) {
+            e->tracks[k].last_ms = t_ms;
+            e->stats.dwells++;
+            return;
+        }
+        track_end(e, k);
+    }
+
+    // 2. The PIR still retriggering after its track walked on
+    if (t_ms - e->left_ms[zone] <= (int64_t)e->cfg.dwell_ms) {
+        e->left_ms[zone] = t_ms;
+        e->stats.absorbed++;
+        return;
+    }
+
+    // 3. A track next door that could have walked here: the most recently seen one wins
+    int8_t best = MOTION_NONE;
+    for (uint32_t i = e->first[zone]; i < e->first[zone + 1]; i++) {
+        const motion_adj_t* adj = &e->adj[i];
+        int8_t c = e->here[adj->zone];
+        if (c == MOTION_NONE) continue;
+        const motion_track_t* tr = &e->tracks[c];
+        if (t_ms - tr->enter_ms < (int64_t)adj->min_ms || t_ms - tr->last_ms > (int64_t)adj->max_ms) continue;
+        if (best == MOTION_NONE || tr->last_ms > e->tracks[best].last_ms) best = c;
+    }
+    if (best != MOTION_NONE) {
+        motion_track_t* tr = &e->tracks[best];
+        uint16_t from = track_zone(tr);
+        e->here[from] = MOTION_NONE;
+        e->left_ms[from] = tr->last_ms;
+        track_enter(e, best, zone, t_ms);
+        e->stats.moves++;
+        if (tr->zones >= e->cfg.alert_zones) {
+            track_alert(e, tr, tr->reported ? MOTION_ALERT_MOVE : MOTION_ALERT_PATH, t_ms);
+            tr->reported = true;
+        }
+        return;
+    }
+
+    // 4. Someone new
+    k = track_alloc(e, t_ms);
+    motion_track_t* tr = &e->tracks[k];
+    memset(tr, 0, sizeof(*tr));
+    tr->live = true;
+    tr->id = e->next_id++;
+    tr->started_ms = t_ms;
+    track_enter(e, k, zone, t_ms);
+    tr->prev_enter_ms = t_ms;
+    e->stats.tracks_started++;
+    e->stats.tracks_live++;
+}
+
+void motion_tick(motion_engine_t* e, int64_t t_ms) {
+    if (e == NULL) return;
+    for (int8_t k = 0; k < MOTION_MAX_TRACKS; k++) {
+        if (e->tracks[k].live && track_expired(e, &e->tracks[k], t_ms)) track_end(e, k);
+    }
+}
+
+void motion_get_stats(const motion_engine_t* e, motion_stats_t* out) {
+    *out = e->stats;
+}
@@ -0,0 +1,138 @@
+#ifndef MOTION_H
+#define MOTION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Cross-slave motion correlation for the master. Each slave is a zone (an aisle
+// section under one PIR); a zone graph says which zones a person can walk between
+// and how long that takes. Motion hits are chained into tracks as they arrive, so
+// an intruder's path and heading come out as alerts instead of being pieced
+// together from per-slave motion flags by hand.
+//
+// A hit costs O(degree of its zone): it either extends the visit of the track
+// already in that zone, is absorbed as the PIR's trailing retrigger after a track
+// left, continues the most recent track in a neighbouring zone whose walk time
+// fits the edge, or starts a new track. Nothing is allocated after
+// motion_create and nothing scans the whole fleet, so a burst from every PIR
+// at once costs one hit's work per PIR.
+//
+// Two people meeting in a zone merge into one track; they split again as new
+// tracks when they leave in different directions. Someone staying behind in a zone
+// a track just left looks like the PIR retriggering until they move on.
+
+// --- Configuration Constants ---
+
+#define MOTION_MAX_TRACKS (16)    // Tracks followed at once; the least recent is dropped beyond
+#define MOTION_PATH_MAX   (8)     // Latest zones of a track reported in alerts
+
+// --- Zone Graph ---
+
+// Undirected: a person can walk a -> b or b -> a
+typedef struct {
+    uint16_t a;
+    uint16_t b;
+    uint32_t min_ms;          // Fastest walk from entering one zone to entering the other
+    uint32_t max_ms;          // Longest gap between the last hit in one and the first in the other
+} motion_edge_t;
+
+// Zone centre in metres, for heading and speed in alerts (optional)
+typedef struct {
+    float x;
+    float y;
+} motion_pos_t;
+
+typedef struct {
+    uint32_t dwell_ms;        // PIR retrigger time: hits this close to a track's last one in a zone belong to it
+    uint32_t track_timeout_ms; // A track with no hit for this long has ended
+    uint8_t alert_zones;      // Zones a track must cross before it is reported (2 = every single move)
+} motion_config_t;
+
+// --- Alerts ---
+
+typedef enum {
+    MOTION_ALERT_PATH = 0,    // A track crossed alert_zones zones
+    MOTION_ALERT_MOVE,        // A reported track moved on to another zone
+    MOTION_ALERT_END,         // A reported track timed out
+} motion_alert_kind_t;
+
+typedef struct {
+    uint8_t kind;             // motion_alert_kind_t
+    uint32_t track_id;        // Increases by one per track started
+    int64_t t_ms;             // Hit that caused the alert (END: the track's last hit)
+    int64_t started_ms;       // The track's first hit
+    uint16_t from;            // Last hop (END: the last one made)
+    uint16_t to;
+    float heading_deg;        // Of the last hop, 0 = +y, 90 = +x; NAN without zone positions
+    float speed_m_s;          // Of the last hop, from zone entry to zone entry; NAN without positions
+    uint16_t zones;           // Zones visited, counting revisits
+    uint8_t path_len;         // Valid entries in path
+    uint16_t path[MOTION_PATH_MAX]; // Latest zones, oldest first, path[path_len - 1] = to
+} motion_alert_t;
+
+typedef void (*motion_alert_cb_t)(void* ctx, const motion_alert_t* alert);
+
+// --- Metrics ---
+
+typedef struct {
+    uint32_t hits;            // motion_ingest calls
+    uint32_t dwells;          // Hits extending the visit of a track already in the zone
+    uint32_t absorbed;        // Hits in a zone a track left, each within dwell_ms of the one before
+    uint32_t moves;           // Hits that moved a track to a neighbouring zone
+    uint32_t tracks_started;
+    uint32_t tracks_ended;
+    uint32_t tracks_dropped;  // Ended early because MOTION_MAX_TRACKS were live
+    uint32_t alerts;
+    uint32_t tracks_live;
+} motion_stats_t;
+
+typedef struct motion_engine motion_engine_t;
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Validates the zone graph, builds its adjacency lists and allocates state
+ *        for max_zones zones.
+ *
+ * @param edges Walkable zone pairs (copied; may be freed after the call).
+ * @param positions max_zones zone positions, or NULL (alerts then carry no heading/speed).
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for a malformed edge or config, ESP_ERR_NO_MEM.
+ */
+esp_err_t motion_create(const motion_edge_t* edges, uint16_t n_edges, const motion_pos_t* positions,
+                        uint16_t max_zones, const motion_config_t* config, motion_engine_t** out);
+
+/**
+ * @brief Frees an engine.
+ */
+void motion_destroy(motion_engine_t* engine);
+
+/**
+ * @brief Registers the alert callback. It runs inside motion_ingest/motion_tick.
+ */
+void motion_set_alert_cb(motion_engine_t* engine, motion_alert_cb_t cb, void* ctx);
+
+/**
+ * @brief Feeds one motion hit: a frame from the zone's slave that reported motion.
+ *        Not thread-safe; call from one task, in timestamp order.
+ *
+ * @param zone Sending slave's zone, below max_zones.
+ * @param t_ms Sample time on the master clock, in milliseconds.
+ */
+void motion_ingest(motion_engine_t* engine, uint16_t zone, int64_t t_ms);
+
+/**
+ * @brief Ends tracks that timed out by t_ms (reporting END for those that were
+ *        reported). Call every few seconds; hits alone only end tracks they touch.
+ */
+void motion_tick(motion_engine_t* engine, int64_t t_ms);
+
+void motion_get_stats(const motion_engine_t* engine, motion_stats_t* out);
+
+/**
+ * @brief Bytes allocated by the engine (graph plus per-zone and track state).
+ */
+size_t motion_memory_usage(const motion_engine_t* engine);
+
+#endif // MOTION_H
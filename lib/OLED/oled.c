@@ -0,0 +1,326 @@
+#include "oled.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "driver/i2c_master.h"
+
+static const char *TAG = "OLED";
+
+// --- SSD1306 Protocol ---
+
+#define SSD1306_CONTROL_CMD  0x00 // Following bytes are commands
+#define SSD1306_CONTROL_DATA 0x40 // Following bytes are display RAM
+#define SSD1306_SET_COLUMN_RANGE 0x21
+#define SSD1306_SET_PAGE_RANGE   0x22
+
+// 128x64, horizontal addressing, internal charge pump, segment/COM remapped for the usual module orientation
+static const uint8_t ssd1306_init_seq[] = {
+    SSD1306_CONTROL_CMD,
+    0xAE,       // Display off
+    0xD5, 0x80, // Clock divide / oscillator
+    0xA8, 0x3F, // Multiplex ratio: 64 rows
+    0xD3, 0x00, // No display offset
+    0x40,       // Start line 0
+    0x8D, 0x14, // Charge pump on
+    0x20, 0x00, // Horizontal addressing mode
+    0xA1,       // Segment remap
+    0xC8,       // COM scan direction remapped
+    0xDA, 0x12, // COM pins: alternative, no remap
+    0x81, 0xCF, // Contrast
+    0xD9, 0xF1, // Pre-charge period
+    0xDB, 0x40, // VCOMH deselect level
+    0xA4,       // Display follows RAM
+    0xA6,       // Normal (not inverted)
+    0xAF,       // Display on
+};
+
+// --- 5x7 Font (0x20-0x7E), one byte per column, LSB = top row ---
+
+static const uint8_t oled_font[95][5] = {
+    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},
+    {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x56,0x20,0x50}, {0x00,0x05,0x03,0x00,0x00},
+    {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x14,0x08,0x3E,0x08,0x14}, {0x08,0x08,0x3E,0x08,0x08},
+    {0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x60,0x60,0x00,0x00}, {0x20,0x10,0x08,0x04,0x02},
+    {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x42,0x61,0x51,0x49,0x46}, {0x21,0x41,0x45,0x4B,0x31},
+    {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x30}, {0x01,0x71,0x09,0x05,0x03},
+    {0x36,0x49,0x49,0x49,0x36}, {0x06,0x49,0x49,0x29,0x1E}, {0x00,0x36,0x36,0x00,0x00}, {0x00,0x56,0x36,0x00,0x00},
+    {0x08,0x14,0x22,0x41,0x00}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x51,0x09,0x06},
+    {0x32,0x49,0x79,0x41,0x3E}, {0x7E,0x11,0x11,0x11,0x7E}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+    {0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, {0x3E,0x41,0x49,0x49,0x7A},
+    {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},
+    {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x0C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+    {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x46,0x49,0x49,0x49,0x31},
+    {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F},
+    {0x63,0x14,0x08,0x14,0x63}, {0x07,0x08,0x70,0x08,0x07}, {0x61,0x51,0x49,0x45,0x43}, {0x00,0x7F,0x41,0x41,0x00},
+    {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x7F,0x00}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},
+    {0x00,0x01,0x02,0x04,0x00}, {0x20,0x54,0x54,0x54,0x78}, {0x7F,0x48,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x20},
+    {0x38,0x44,0x44,0x48,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x08,0x7E,0x09,0x01,0x02}, {0x0C,0x52,0x52,0x52,0x3E},
+    {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x44,0x3D,0x00}, {0x7F,0x10,0x28,0x44,0x00},
+    {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x18,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},
+    {0x7C,0x14,0x14,0x14,0x08}, {0x08,0x14,0x14,0x18,0x7C}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x20},
+    {0x04,0x3F,0x44,0x40,0x20}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},
+    {0x44,0x28,0x10,0x28,0x44}, {0x0C,0x50,0x50,0x50,0x3C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},
+    {0x00,0x00,0x7F,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x10,0x08,0x08,0x10,0x08},
+};
+
+// --- State ---
+
+typedef struct {
+    int16_t x0;             // First dirty column, x0 > x1 = clean
+    int16_t x1;
+} oled_span_t;
+
+struct oled {
+    oled_transport_t tr;
+    SemaphoreHandle_t lock;         // Framebuffer and dirty spans
+    SemaphoreHandle_t bus_lock;     // One flush at a time
+    TaskHandle_t task;
+    uint8_t fb[OLED_PAGES][OLED_WIDTH];
+    oled_span_t dirty[OLED_PAGES];
+    uint8_t shadow[OLED_PAGES][OLED_WIDTH]; // Dirty bytes copied out for the transfer
+    uint8_t tx[1 + OLED_WIDTH];
+    oled_stats_t stats;
+};
+
+static inline void span_reset(oled_span_t* s) {
+    s->x0 = OLED_WIDTH;
+    s->x1 = -1;
+}
+
+static inline void span_add(oled_span_t* s, int x0, int x1) {
+    if (x0 < s->x0) s->x0 = x0;
+    if (x1 > s->x1) s->x1 = x1;
+}
+
+// Writes the bits of mask in one framebuffer byte; caller holds the lock
+static inline void fb_put(oled_t* oled, int page, int x, uint8_t bits, uint8_t mask) {
+    uint8_t* b = &oled->fb[page][x];
+    uint8_t v = (uint8_t)((*b & ~mask) | (bits & mask));
+    if (v != *b) {
+        *b = v;
+        span_add(&oled->dirty[page], x, x);
+    }
+}
+
+// Places an 8-row column of pixels with its top row at y (any alignment)
+static inline void fb_put_column(oled_t* oled, int x, int y, uint8_t bits, uint8_t mask) {
+    if (x < 0 || x >= OLED_WIDTH || y <= -8 || y >= OLED_HEIGHT) return;
+    int page = y >> 3; // Arithmetic shift: rows above the panel land in page -1
+    int shift = y & 7;
+    if (page >= 0) fb_put(oled, page, x, (uint8_t)(bits << shift), (uint8_t)(mask << shift));
+    if (shift && page + 1 < OLED_PAGES) {
+        fb_put(oled, page + 1, x, (uint8_t)(bits >> (8 - shift)), (uint8_t)(mask >> (8 - shift)));
+    }
+}
+
+// --- Drawing ---
+
+void oled_clear(oled_t* oled) {
+    oled_fill_rect(oled, 0, 0, OLED_WIDTH, OLED_HEIGHT, false);
+}
+
+void oled_fill_rect(oled_t* oled, int x, int y, int w, int h, bool on) {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > OLED_WIDTH) w = OLED_WIDTH - x;
+    if (y + h > OLED_HEIGHT) h = OLED_HEIGHT - y;
+    if (w <= 0 || h <= 0) return;
+
+    xSemaphoreTake(oled->lock, portMAX_DELAY);
+    for (int page = y >> 3; page <= (y + h - 1) >> 3; page++) {
+        int r0 = y > page * 8 ? y - page * 8 : 0;
+        int r1 = y + h < (page + 1) * 8 ? y + h - page * 8 : 8;
+        uint8_t mask = (uint8_t)((0xFF << r0) & (0xFF >> (8 - r1)));
+        for (int cx = x; cx < x + w; cx++) {
+            fb_put(oled, page, cx, on ? 0xFF : 0x00, mask);
+        }
+    }
+    xSemaphoreGive(oled->lock);
+}
+
+static void draw_glyph(oled_t* oled, int x, int y, char c, bool invert) {
+    const uint8_t* g = oled_font[(c < 0x20 || c > 0x7E) ? '?' - 0x20 : c - 0x20];
+    for (int col = 0; col < OLED_FONT_W; col++) {
+        uint8_t bits = col < 5 ? g[col] : 0x00;
+        fb_put_column(oled, x + col, y, invert ? (uint8_t)~bits : bits, 0xFF);
+    }
+}
+
+int oled_draw_text(oled_t* oled, int x, int y, const char* text, bool invert) {
+    xSemaphoreTake(oled->lock, portMAX_DELAY);
+    for (; *text != '\0' && x < OLED_WIDTH; text++, x += OLED_FONT_W) {
+        draw_glyph(oled, x, y, *text, invert);
+    }
+    xSemaphoreGive(oled->lock);
+    return x;
+}
+
+void oled_draw_field(oled_t* oled, int x, int y, int chars, const char* text, bool invert) {
+    xSemaphoreTake(oled->lock, portMAX_DELAY);
+    for (int i = 0; i < chars; i++, x += OLED_FONT_W) {
+        char c = *text != '\0' ? *text++ : ' ';
+        draw_glyph(oled, x, y, c, invert);
+    }
+    xSemaphoreGive(oled->lock);
+}
+
+// --- Transfer ---
+
+esp_err_t oled_flush(oled_t* oled) {
+    xSemaphoreTake(oled->bus_lock, portMAX_DELAY);
+
+    // Copy the dirty spans out so drawing can continue during the transfer
+    oled_span_t spans[OLED_PAGES];
+    xSemaphoreTake(oled->lock, portMAX_DELAY);
+    for (int p = 0; p < OLED_PAGES; p++) {
+        spans[p] = oled->dirty[p];
+        if (spans[p].x0 <= spans[p].x1) {
+            memcpy(&oled->shadow[p][spans[p].x0], &oled->fb[p][spans[p].x0], spans[p].x1 - spans[p].x0 + 1);
+        }
+        span_reset(&oled->dirty[p]);
+    }
+    xSemaphoreGive(oled->lock);
+
+    esp_err_t ret = ESP_OK;
+    uint32_t bytes = 0;
+    int64_t start = esp_timer_get_time();
+    for (int p = 0; p < OLED_PAGES; p++) {
+        if (spans[p].x0 > spans[p].x1) continue;
+        if (ret == ESP_OK) {
+            const uint8_t addr[] = {
+                SSD1306_CONTROL_CMD,
+                SSD1306_SET_COLUMN_RANGE, (uint8_t)spans[p].x0, (uint8_t)spans[p].x1,
+                SSD1306_SET_PAGE_RANGE, (uint8_t)p, (uint8_t)p,
+            };
+            size_t n = spans[p].x1 - spans[p].x0 + 1;
+            oled->tx[0] = SSD1306_CONTROL_DATA;
+            memcpy(&oled->tx[1], &oled->shadow[p][spans[p].x0], n);
+            ret = oled->tr.write(oled->tr.ctx, addr, sizeof(addr));
+            if (ret == ESP_OK) ret = oled->tr.write(oled->tr.ctx, oled->tx, 1 + n);
+            if (ret == ESP_OK) bytes += sizeof(addr) + 1 + n;
+        }
+        if (ret != ESP_OK) {
+            // Not sent (or only partly): dirty again so the next flush retries it
+            xSemaphoreTake(oled->lock, portMAX_DELAY);
+            span_add(&oled->dirty[p], spans[p].x0, spans[p].x1);
+            xSemaphoreGive(oled->lock);
+        }
+    }
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+
+    xSemaphoreTake(oled->lock, portMAX_DELAY);
+    if (bytes > 0) {
+        oled->stats.updates++;
+        oled->stats.bytes_total += bytes;
+        oled->stats.last_update_bytes = bytes;
+        oled->stats.last_update_us = elapsed;
+        if (elapsed > oled->stats.max_update_us) oled->stats.max_update_us = elapsed;
+    }
+    if (ret != ESP_OK) oled->stats.errors++;
+    xSemaphoreGive(oled->lock);
+
+    xSemaphoreGive(oled->bus_lock);
+    if (ret != ESP_OK) ESP_LOGW(TAG, "Display update failed: %s", esp_err_to_name(ret));
+    return ret;
+}
+
+static void oled_task(void* arg) {
+    oled_t* oled = arg;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // Requests made during a transfer collapse into one
+        oled_flush(oled);
+    }
+}
+
+void oled_request_flush(oled_t* oled) {
+    if (oled->task != NULL) xTaskNotifyGive(oled->task);
+}
+
+esp_err_t oled_start(oled_t* oled, UBaseType_t priority) {
+    if (oled->task != NULL) return ESP_OK;
+    if (xTaskCreate(oled_task, "oled", OLED_TASK_STACK, oled, priority, &oled->task) != pdPASS) {
+        oled->task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    oled_request_flush(oled); // Push whatever was drawn before the task existed
+    return ESP_OK;
+}
+
+void oled_get_stats(oled_t* oled, oled_stats_t* out) {
+    xSemaphoreTake(oled->lock, portMAX_DELAY);
+    *out = oled->stats;
+    xSemaphoreGive(oled->lock);
+}
+
+// --- Lifecycle ---
+
+esp_err_t oled_create(const oled_transport_t* transport, oled_t** out) {
+    oled_t* oled = calloc(1, sizeof(oled_t));
+    if (oled == NULL) return ESP_ERR_NO_MEM;
+    oled->tr = *transport;
+    oled->lock = xSemaphoreCreateMutex();
+    oled->bus_lock = xSemaphoreCreateMutex();
+    if (oled->lock == NULL || oled->bus_lock == NULL) {
+        oled_destroy(oled);
+        return ESP_ERR_NO_MEM;
+    }
+    for (int p = 0; p < OLED_PAGES; p++) {
+        oled->dirty[p].x0 = 0; // Panel RAM is undefined at power-up
+        oled->dirty[p].x1 = OLED_WIDTH - 1;
+    }
+
+    esp_err_t ret = oled->tr.write(oled->tr.ctx, ssd1306_init_seq, sizeof(ssd1306_init_seq));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SSD1306 init failed: %s", esp_err_to_name(ret));
+        oled_destroy(oled);
+        return ret;
+    }
+    *out = oled;
+    return ESP_OK;
+}
+
+void oled_destroy(oled_t* oled) {
+    if (oled == NULL) return;
+    if (oled->task != NULL) vTaskDelete(oled->task);
+    if (oled->lock != NULL) vSemaphoreDelete(oled->lock);
+    if (oled->bus_lock != NULL) vSemaphoreDelete(oled->bus_lock);
+    free(oled);
+}
+
+// --- I2C Transport ---
+
+static esp_err_t oled_i2c_write(void* ctx, const uint8_t* data, size_t len) {
+    return i2c_master_transmit((i2c_master_dev_handle_t)ctx, data, len, OLED_I2C_TIMEOUT_MS);
+}
+
+esp_err_t oled_transport_i2c(int port, int sda_gpio, int scl_gpio, oled_transport_t* out) {
+    i2c_master_bus_config_t bus_cfg = {
+        .i2c_port = port,
+        .sda_io_num = sda_gpio,
+        .scl_io_num = scl_gpio,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = 7,
+        .flags.enable_internal_pullup = true,
+    };
+    i2c_master_bus_handle_t bus;
+    esp_err_t ret = i2c_new_master_bus(&bus_cfg, &bus);
+    if (ret != ESP_OK) return ret;
+
+    i2c_device_config_t dev_cfg = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = OLED_I2C_ADDR,
+        .scl_speed_hz = OLED_I2C_HZ,
+    };
+    i2c_master_dev_handle_t dev;
+    ret = i2c_master_bus_add_device(bus, &dev_cfg, &dev);
+    if (ret != ESP_OK) {
+        i2c_del_master_bus(bus);
+        return ret;
+    }
+    out->write = oled_i2c_write;
+    out->ctx = dev;
+    return ESP_OK;
+}
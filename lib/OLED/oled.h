@@ -0,0 +1,109 @@
+#ifndef OLED_H
+#define OLED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// Non-blocking driver for the master's 0.96" 128x64 SSD1306 I2C OLED.
+//
+// Drawing goes into a RAM framebuffer in the controller's own layout (8 pages of 8
+// rows, one byte per column per page). Every byte that actually changes widens that
+// page's dirty column span, so redrawing an unchanged value costs nothing and a
+// changed ppm reading dirties a few dozen bytes instead of the whole frame.
+//
+// A flush copies the dirty spans out under the lock and then pushes them with
+// column/page addressing, so drawing never waits for the bus: oled_request_flush()
+// wakes a low-priority task that does the I2C transfer (a full frame is ~1 KB,
+// ~25 ms at 400 kHz). oled_get_stats() reports the bytes sent per update.
+
+// --- Configuration Constants ---
+
+#define OLED_WIDTH          128
+#define OLED_HEIGHT         64
+#define OLED_PAGES          (OLED_HEIGHT / 8)
+#define OLED_I2C_ADDR       0x3C
+#define OLED_I2C_HZ         400000
+#define OLED_I2C_TIMEOUT_MS 50
+#define OLED_FONT_W         6   // 5x7 glyph plus one blank column
+#define OLED_FONT_H         8
+#define OLED_TASK_STACK     3072
+
+// --- Transport ---
+// One call = one I2C write transaction (address handled by the transport).
+typedef struct {
+    esp_err_t (*write)(void* ctx, const uint8_t* data, size_t len);
+    void* ctx;
+} oled_transport_t;
+
+/**
+ * @brief Creates an I2C master bus on the given pins and adds the display at OLED_I2C_ADDR.
+ */
+esp_err_t oled_transport_i2c(int port, int sda_gpio, int scl_gpio, oled_transport_t* out);
+
+// --- Display ---
+
+typedef struct {
+    uint32_t updates;           // Flushes that sent something
+    uint64_t bytes_total;       // I2C payload bytes, including control/addressing bytes
+    uint32_t last_update_bytes;
+    uint32_t last_update_us;
+    uint32_t max_update_us;
+    uint32_t errors;
+} oled_stats_t;
+
+typedef struct oled oled_t;
+
+/**
+ * @brief Allocates the framebuffer and initialises the controller. The whole (blank)
+ *        frame is dirty, so the first flush clears the panel.
+ *
+ * @return ESP_ERR_NO_MEM, or the transport's error if the init sequence failed.
+ */
+esp_err_t oled_create(const oled_transport_t* transport, oled_t** out);
+
+void oled_destroy(oled_t* oled);
+
+/**
+ * @brief Starts the flush task used by oled_request_flush().
+ *
+ * @param priority Keep below the tasks that draw, e.g. tskIDLE_PRIORITY + 1.
+ */
+esp_err_t oled_start(oled_t* oled, UBaseType_t priority);
+
+void oled_clear(oled_t* oled);
+
+/**
+ * @brief Sets (on) or clears a rectangle, clipped to the panel.
+ */
+void oled_fill_rect(oled_t* oled, int x, int y, int w, int h, bool on);
+
+/**
+ * @brief Draws ASCII text with the built-in 5x7 font. Characters outside 0x20-0x7E draw as '?'.
+ *
+ * @param invert Light background, dark text (alarm banners).
+ * @return x just past the last character.
+ */
+int oled_draw_text(oled_t* oled, int x, int y, const char* text, bool invert);
+
+/**
+ * @brief Draws text into a fixed-width field, padding with blanks, so a shorter
+ *        value fully replaces a longer one. Only changed columns become dirty.
+ */
+void oled_draw_field(oled_t* oled, int x, int y, int chars, const char* text, bool invert);
+
+/**
+ * @brief Asks the flush task to push the dirty regions. Never blocks.
+ */
+void oled_request_flush(oled_t* oled);
+
+/**
+ * @brief Pushes the dirty regions from the calling task (blocks for the transfer).
+ */
+esp_err_t oled_flush(oled_t* oled);
+
+void oled_get_stats(oled_t* oled, oled_stats_t* out);
+
+#endif // OLED_H
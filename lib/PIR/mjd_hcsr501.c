@@ -13,6 +13,7 @@
  
  // Internal static reference to ISR semaphore
  static SemaphoreHandle_t _hcsr501_config_isr_semaphore = NULL;
+ static StaticSemaphore_t _hcsr501_isr_semaphore_buf; // Only one sensor instance is supported (single ISR reference)
  
  /*
   * Interrupt Service Routine
@@ -37,8 +38,8 @@
      // Sensor stabilization period (5s)
      vTaskDelay(pdMS_TO_TICKS(5000));
  
-     // Create binary semaphore
-     param_ptr_config->isr_semaphore = xSemaphoreCreateBinary();
+     // Create binary semaphore (statically allocated)
+     param_ptr_config->isr_semaphore = xSemaphoreCreateBinaryStatic(&_hcsr501_isr_semaphore_buf);
      if (param_ptr_config->isr_semaphore == NULL) {
          ESP_LOGE(TAG, "ABORT. Failed to create binary semaphore.");
          return ESP_FAIL;
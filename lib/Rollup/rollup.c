@@ -0,0 +1,305 @@
+#include "rollup.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+
+static const char *TAG = "ROLLUP";
+
+#define ROLLUP_NO_ZONE 0xFF
+
+static const int64_t window_ms[ROLLUP_WINDOW_COUNT] = {
+    60LL * 1000,        // ROLLUP_WINDOW_1MIN
+    15LL * 60 * 1000,   // ROLLUP_WINDOW_15MIN
+    60LL * 60 * 1000,   // ROLLUP_WINDOW_1H
+};
+
+// Sketch range per metric (the envelopes in rollup.h). Values outside are clamped
+// into the edge bins; ppm spans decades so it is binned on a log scale.
+typedef struct {
+    float lo;
+    float hi;
+    bool log_scale;
+} sketch_range_t;
+
+static const sketch_range_t sketch_ranges[ROLLUP_METRIC_COUNT] = {
+    { ROLLUP_TEMPERATURE_LO, ROLLUP_TEMPERATURE_HI, false }, // ROLLUP_TEMPERATURE
+    { ROLLUP_HUMIDITY_LO,    ROLLUP_HUMIDITY_HI,    false }, // ROLLUP_HUMIDITY
+    { ROLLUP_PPM_LO,         ROLLUP_PPM_HI,         true },  // ROLLUP_LPG
+    { ROLLUP_CO_PPM_LO,      ROLLUP_CO_PPM_HI,      true },  // ROLLUP_CO
+    { ROLLUP_PPM_LO,         ROLLUP_PPM_HI,         true },  // ROLLUP_SMOKE
+    { 0.0f,                  1.0f,                  false }, // ROLLUP_MOTION
+};
+
+// --- Sketch Helpers ---
+
+static float sketch_map(const sketch_range_t* r, float v) {
+    if (r->log_scale) {
+        float lv = log10f(v > r->lo ? v : r->lo);
+        return (lv - log10f(r->lo)) / (log10f(r->hi) - log10f(r->lo));
+    }
+    return (v - r->lo) / (r->hi - r->lo);
+}
+
+static float sketch_unmap(const sketch_range_t* r, float x) {
+    if (r->log_scale) {
+        return powf(10.0f, log10f(r->lo) + x * (log10f(r->hi) - log10f(r->lo)));
+    }
+    return r->lo + x * (r->hi - r->lo);
+}
+
+static int sketch_bin(const sketch_range_t* r, float v) {
+    int bin = (int)(sketch_map(r, v) * ROLLUP_SKETCH_BINS);
+    if (bin < 0) bin = 0;
+    if (bin >= ROLLUP_SKETCH_BINS) bin = ROLLUP_SKETCH_BINS - 1;
+    return bin;
+}
+
+// --- Bucket Helpers ---
+
+static void bucket_clear(rollup_bucket_t* b) {
+    memset(b, 0, sizeof(*b));
+}
+
+static void bucket_add(rollup_bucket_t* b, const sketch_range_t* r, float v) {
+    if (b->count == 0 || v < b->min) b->min = v;
+    if (b->count == 0 || v > b->max) b->max = v;
+    uint32_t n = b->count++;
+    b->sum += v;
+    // Once a bin has overflowed only every 2^sketch_shift-th sample enters the sketch,
+    // a uniform subsample, so the bins keep the shape of the whole bucket
+    if (n & ((1u << b->sketch_shift) - 1)) return;
+    uint8_t* bin = &b->sketch[sketch_bin(r, v)];
+    if (*bin == UINT8_MAX) {
+        for (int k = 0; k < ROLLUP_SKETCH_BINS; k++) b->sketch[k] >>= 1;
+        b->sketch_shift++;
+    }
+    (*bin)++;
+}
+
+// Combines the buckets selected by mask into stats for one metric
+static void stats_from_buckets(const rollup_bucket_t* buckets, uint32_t mask, const sketch_range_t* r, rollup_stats_t* out) {
+    float hist[ROLLUP_SKETCH_BINS] = {0}; // In samples: each bucket's sketch scaled up to its count
+    float sum = 0.0f;
+
+    memset(out, 0, sizeof(*out));
+    for (int i = 0; i < ROLLUP_BUCKETS_PER_WINDOW; i++) {
+        const rollup_bucket_t* b = &buckets[i];
+        if (!(mask & (1u << i)) || b->count == 0) continue;
+        if (out->count == 0 || b->min < out->min) out->min = b->min;
+        if (out->count == 0 || b->max > out->max) out->max = b->max;
+        out->count += b->count;
+        sum += b->sum;
+        uint32_t sketch_total = 0;
+        for (int k = 0; k < ROLLUP_SKETCH_BINS; k++) sketch_total += b->sketch[k];
+        float scale = (float)b->count / (float)sketch_total; // ~2^sketch_shift
+        for (int k = 0; k < ROLLUP_SKETCH_BINS; k++) {
+            hist[k] += (float)b->sketch[k] * scale;
+        }
+    }
+    if (out->count == 0) {
+        out->min = out->max = out->mean = out->p95 = NAN;
+        return;
+    }
+    out->mean = sum / (float)out->count;
+
+    // Walk the merged histogram to the target rank and interpolate within the bin
+    float target = ROLLUP_QUANTILE * (float)out->count;
+    float seen = 0.0f;
+    for (int k = 0; k < ROLLUP_SKETCH_BINS; k++) {
+        if (hist[k] == 0.0f) continue;
+        if (seen + hist[k] >= target) {
+            float frac = (target - seen) / hist[k];
+            float q = sketch_unmap(r, ((float)k + frac) / ROLLUP_SKETCH_BINS);
+            out->p95 = fminf(fmaxf(q, out->min), out->max);
+            return;
+        }
+        seen += hist[k];
+    }
+    out->p95 = out->max;
+}
+
+// --- Window Maintenance ---
+
+static int64_t epoch_of(rollup_window_t w, int64_t t_ms) {
+    return t_ms / (window_ms[w] / ROLLUP_BUCKETS_PER_WINDOW);
+}
+
+static void emit_window(rollup_engine_t* engine, rollup_scope_t scope, uint16_t index, rollup_window_t w,
+                        rollup_window_state_t* ws, int64_t end_epoch) {
+    rollup_stats_t stats[ROLLUP_METRIC_COUNT];
+    bool any = false;
+    for (int m = 0; m < ROLLUP_METRIC_COUNT; m++) {
+        stats_from_buckets(ws->buckets[m], 0xFFFFFFFFu, &sketch_ranges[m], &stats[m]);
+        any |= stats[m].count > 0;
+    }
+    if (any) {
+        int64_t end_ms = end_epoch * (window_ms[w] / ROLLUP_BUCKETS_PER_WINDOW);
+        engine->emit_cb(engine->emit_ctx, scope, index, w, end_ms, stats);
+    }
+}
+
+// Moves the ring forward to epoch, emitting each aligned window that completes on the way
+static void window_advance(rollup_engine_t* engine, rollup_scope_t scope, uint16_t index, rollup_window_t w,
+                           rollup_window_state_t* ws, int64_t epoch) {
+    if (ws->head_epoch < 0) {
+        ws->head_epoch = epoch;
+        for (int m = 0; m < ROLLUP_METRIC_COUNT; m++) bucket_clear(&ws->buckets[m][epoch % ROLLUP_BUCKETS_PER_WINDOW]);
+        return;
+    }
+
+    int cleared = 0;
+    while (ws->head_epoch < epoch) {
+        // After a full turn every bucket is empty, so skip the idle gap in one step
+        if (cleared >= ROLLUP_BUCKETS_PER_WINDOW) {
+            ws->head_epoch = epoch - 1;
+        }
+        int64_t next = ws->head_epoch + 1;
+        if (next % ROLLUP_BUCKETS_PER_WINDOW == 0 && engine->emit_cb != NULL && cleared < ROLLUP_BUCKETS_PER_WINDOW) {
+            emit_window(engine, scope, index, w, ws, next);
+        }
+        for (int m = 0; m < ROLLUP_METRIC_COUNT; m++) bucket_clear(&ws->buckets[m][next % ROLLUP_BUCKETS_PER_WINDOW]);
+        ws->head_epoch = next;
+        cleared++;
+    }
+}
+
+static void series_ingest(rollup_engine_t* engine, rollup_scope_t scope, uint16_t index, rollup_series_t* series,
+                          int64_t t_ms, const float values[ROLLUP_METRIC_COUNT]) {
+    for (int w = 0; w < ROLLUP_WINDOW_COUNT; w++) {
+        rollup_window_state_t* ws = &series->windows[w];
+        int64_t epoch = epoch_of(w, t_ms);
+        window_advance(engine, scope, index, w, ws, epoch);
+        // Slightly late samples (zones mix slaves) still land in their bucket if it is live
+        if (epoch <= ws->head_epoch - ROLLUP_BUCKETS_PER_WINDOW) continue;
+        int slot = (int)(epoch % ROLLUP_BUCKETS_PER_WINDOW);
+        for (int m = 0; m < ROLLUP_METRIC_COUNT; m++) {
+            if (isnan(values[m])) continue;
+            bucket_add(&ws->buckets[m][slot], &sketch_ranges[m], values[m]);
+        }
+    }
+}
+
+static void series_reset(rollup_series_t* series) {
+    memset(series, 0, sizeof(*series));
+    for (int w = 0; w < ROLLUP_WINDOW_COUNT; w++) series->windows[w].head_epoch = -1;
+}
+
+// --- Public API ---
+
+rollup_engine_t* rollup_create(uint16_t max_slaves, uint16_t max_zones) {
+    if (max_zones > ROLLUP_NO_ZONE) max_zones = ROLLUP_NO_ZONE;
+    rollup_engine_t* engine = calloc(1, sizeof(rollup_engine_t));
+    if (engine == NULL) return NULL;
+
+    engine->max_slaves = max_slaves;
+    engine->max_zones = max_zones;
+    engine->lock = xSemaphoreCreateMutex();
+    engine->slave_macs = calloc(max_slaves, sizeof(*engine->slave_macs));
+    engine->slave_zone = calloc(max_slaves, sizeof(uint8_t));
+    engine->slaves = calloc(max_slaves, sizeof(rollup_series_t));
+    engine->zones = calloc(max_zones ? max_zones : 1, sizeof(rollup_series_t));
+    if (engine->lock == NULL || engine->slave_macs == NULL || engine->slave_zone == NULL ||
+        engine->slaves == NULL || engine->zones == NULL) {
+        ESP_LOGE(TAG, "rollup_create: allocation failed (%u slaves, %u zones, %u bytes)",
+                 max_slaves, max_zones, (unsigned)((max_slaves + max_zones) * sizeof(rollup_series_t)));
+        rollup_destroy(engine);
+        return NULL;
+    }
+    for (uint16_t i = 0; i < max_slaves; i++) {
+        engine->slave_zone[i] = ROLLUP_NO_ZONE;
+        series_reset(&engine->slaves[i]);
+    }
+    for (uint16_t i = 0; i < max_zones; i++) series_reset(&engine->zones[i]);
+
+    ESP_LOGI(TAG, "Rollup engine: %u slaves, %u zones, %u bytes per series, %u bytes total",
+             max_slaves, max_zones, (unsigned)rollup_bytes_per_series(), (unsigned)rollup_memory_usage(engine));
+    return engine;
+}
+
+void rollup_destroy(rollup_engine_t* engine) {
+    if (engine == NULL) return;
+    if (engine->lock != NULL) vSemaphoreDelete(engine->lock);
+    free(engine->slave_macs);
+    free(engine->slave_zone);
+    free(engine->slaves);
+    free(engine->zones);
+    free(engine);
+}
+
+size_t rollup_bytes_per_series(void) {
+    return sizeof(rollup_series_t);
+}
+
+size_t rollup_memory_usage(const rollup_engine_t* engine) {
+    if (engine == NULL) return 0;
+    return sizeof(*engine) +
+           engine->max_slaves * (sizeof(*engine->slave_macs) + sizeof(uint8_t) + sizeof(rollup_series_t)) +
+           (engine->max_zones ? engine->max_zones : 1) * sizeof(rollup_series_t);
+}
+
+void rollup_set_emit_cb(rollup_engine_t* engine, rollup_emit_cb_t cb, void* ctx) {
+    xSemaphoreTake(engine->lock, portMAX_DELAY);
+    engine->emit_cb = cb;
+    engine->emit_ctx = ctx;
+    xSemaphoreGive(engine->lock);
+}
+
+int rollup_slave_index(rollup_engine_t* engine, const uint8_t mac[6]) {
+    int index = -1;
+    xSemaphoreTake(engine->lock, portMAX_DELAY);
+    for (uint16_t i = 0; i < engine->slave_count; i++) {
+        if (memcmp(engine->slave_macs[i], mac, 6) == 0) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0 && engine->slave_count < engine->max_slaves) {
+        index = engine->slave_count++;
+        memcpy(engine->slave_macs[index], mac, 6);
+    }
+    xSemaphoreGive(engine->lock);
+    return index;
+}
+
+esp_err_t rollup_set_zone(rollup_engine_t* engine, uint16_t slave_index, uint8_t zone) {
+    if (slave_index >= engine->max_slaves || zone >= engine->max_zones) return ESP_ERR_INVALID_ARG;
+    xSemaphoreTake(engine->lock, portMAX_DELAY);
+    engine->slave_zone[slave_index] = zone;
+    xSemaphoreGive(engine->lock);
+    return ESP_OK;
+}
+
+void rollup_ingest(rollup_engine_t* engine, uint16_t slave_index, int64_t t_ms, const float values[ROLLUP_METRIC_COUNT]) {
+    if (slave_index >= engine->slave_count || t_ms < 0) return;
+    xSemaphoreTake(engine->lock, portMAX_DELAY);
+    series_ingest(engine, ROLLUP_SCOPE_SLAVE, slave_index, &engine->slaves[slave_index], t_ms, values);
+    uint8_t zone = engine->slave_zone[slave_index];
+    if (zone != ROLLUP_NO_ZONE) {
+        series_ingest(engine, ROLLUP_SCOPE_ZONE, zone, &engine->zones[zone], t_ms, values);
+    }
+    xSemaphoreGive(engine->lock);
+}
+
+bool rollup_query(rollup_engine_t* engine, rollup_scope_t scope, uint16_t index, rollup_window_t window,
+                  rollup_metric_t metric, int64_t now_ms, rollup_stats_t* out) {
+    if (window >= ROLLUP_WINDOW_COUNT || metric >= ROLLUP_METRIC_COUNT || out == NULL) return false;
+    if (scope == ROLLUP_SCOPE_SLAVE ? index >= engine->slave_count : index >= engine->max_zones) return false;
+
+    xSemaphoreTake(engine->lock, portMAX_DELAY);
+    const rollup_window_state_t* ws = scope == ROLLUP_SCOPE_SLAVE ? &engine->slaves[index].windows[window]
+                                                                  : &engine->zones[index].windows[window];
+    // Select ring slots whose epoch is within the last window as of now
+    int64_t now_epoch = epoch_of(window, now_ms);
+    uint32_t mask = 0;
+    if (ws->head_epoch >= 0) {
+        for (int i = 0; i < ROLLUP_BUCKETS_PER_WINDOW; i++) {
+            int64_t age = (ws->head_epoch % ROLLUP_BUCKETS_PER_WINDOW - i + ROLLUP_BUCKETS_PER_WINDOW) % ROLLUP_BUCKETS_PER_WINDOW;
+            int64_t epoch = ws->head_epoch - age;
+            if (epoch > now_epoch - ROLLUP_BUCKETS_PER_WINDOW && epoch <= now_epoch) mask |= 1u << i;
+        }
+    }
+    stats_from_buckets(ws->buckets[metric], mask, &sketch_ranges[metric], out);
+    xSemaphoreGive(engine->lock);
+    return true;
+}
@@ -0,0 +1,179 @@
+#ifndef ROLLUP_H
+#define ROLLUP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Windowed statistics for the master: every incoming sample updates per-slave and
+// per-zone aggregates in O(1), so the master can upload rollups instead of raw
+// 5 s samples and dashboards read precomputed stats.
+//
+// Each window is split into ROLLUP_BUCKETS_PER_WINDOW buckets aligned to wall-clock
+// multiples of the bucket length. Sliding queries combine the live buckets (so they
+// slide in steps of window/ROLLUP_BUCKETS_PER_WINDOW); when an aligned window
+// completes it is also emitted once as a tumbling rollup through the emit callback.
+
+// --- Configuration Constants ---
+
+#define ROLLUP_BUCKETS_PER_WINDOW (6)
+#define ROLLUP_SKETCH_BINS (32)   // Histogram bins per bucket used for approximate quantiles
+#define ROLLUP_QUANTILE (0.95f)   // Quantile reported in rollup_stats_t.p95
+
+// Sketch envelope per metric: the bins span only the range the sensors report in
+// service, so p95 is within one bin of the true quantile there. Values outside fall
+// into the edge bins; min and max stay exact and p95 is clamped between them.
+#define ROLLUP_TEMPERATURE_LO (0.0f)      // DHT11 range, degrees C: 1.6 C bins
+#define ROLLUP_TEMPERATURE_HI (50.0f)
+#define ROLLUP_HUMIDITY_LO (20.0f)        // DHT11 range, %RH: 2.2 %RH bins
+#define ROLLUP_HUMIDITY_HI (90.0f)
+#define ROLLUP_PPM_LO (10.0f)             // LPG and smoke, ppm; gases are binned on a log
+#define ROLLUP_PPM_HI (10000.0f)          // scale, three decades in 32 bins: 24% apart
+#define ROLLUP_CO_PPM_LO (100.0f)         // CO reads a decade higher on the MQ2 curve
+#define ROLLUP_CO_PPM_HI (100000.0f)
+
+// --- Metrics and Windows ---
+
+typedef enum {
+    ROLLUP_TEMPERATURE = 0,   // degrees C
+    ROLLUP_HUMIDITY,          // %RH
+    ROLLUP_LPG,               // ppm
+    ROLLUP_CO,                // ppm
+    ROLLUP_SMOKE,             // ppm
+    ROLLUP_MOTION,            // 1.0 if the frame reported motion, else 0.0 (mean = share of frames with motion)
+    ROLLUP_METRIC_COUNT
+} rollup_metric_t;
+
+typedef enum {
+    ROLLUP_WINDOW_1MIN = 0,
+    ROLLUP_WINDOW_15MIN,
+    ROLLUP_WINDOW_1H,
+    ROLLUP_WINDOW_COUNT
+} rollup_window_t;
+
+typedef enum {
+    ROLLUP_SCOPE_SLAVE = 0,
+    ROLLUP_SCOPE_ZONE
+} rollup_scope_t;
+
+typedef struct {
+    uint32_t count;
+    float min;
+    float max;
+    float mean;
+    float p95;                // Approximate: within one sketch bin inside the metric's envelope
+} rollup_stats_t;
+
+// --- Internal State (exposed for sizing only) ---
+
+typedef struct {
+    uint32_t count;
+    float sum;
+    float min;
+    float max;
+    uint8_t sketch[ROLLUP_SKETCH_BINS]; // Sampled counts: all bins are halved when one would overflow
+    uint8_t sketch_shift;     // Bins count every 2^sketch_shift-th sample
+} rollup_bucket_t;
+
+typedef struct {
+    int64_t head_epoch;       // Bucket epoch (t / bucket_ms) of the newest bucket, -1 = empty
+    rollup_bucket_t buckets[ROLLUP_METRIC_COUNT][ROLLUP_BUCKETS_PER_WINDOW]; // Ring indexed by epoch % buckets
+} rollup_window_state_t;
+
+typedef struct {
+    rollup_window_state_t windows[ROLLUP_WINDOW_COUNT];
+} rollup_series_t;
+
+/**
+ * @brief Called when an aligned tumbling window completes.
+ *
+ * @param scope Slave or zone.
+ * @param index Slave index (rollup_slave_index) or zone id.
+ * @param window Which window length completed.
+ * @param end_ms Wall-clock end of the window (exclusive).
+ * @param stats One entry per rollup_metric_t; count == 0 means no samples.
+ */
+typedef void (*rollup_emit_cb_t)(void* ctx, rollup_scope_t scope, uint16_t index, rollup_window_t window,
+                                 int64_t end_ms, const rollup_stats_t stats[ROLLUP_METRIC_COUNT]);
+
+typedef struct {
+    SemaphoreHandle_t lock;
+    uint16_t max_slaves;
+    uint16_t max_zones;
+    uint16_t slave_count;
+    uint8_t (*slave_macs)[6];
+    uint8_t* slave_zone;      // Zone per slave, 0xFF = none
+    rollup_series_t* slaves;
+    rollup_series_t* zones;
+    rollup_emit_cb_t emit_cb;
+    void* emit_ctx;
+} rollup_engine_t;
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Allocates an engine for up to max_slaves slaves and max_zones zones.
+ *        All memory is allocated here; ingest and query never allocate.
+ *
+ * @return Engine, or NULL on allocation failure.
+ */
+rollup_engine_t* rollup_create(uint16_t max_slaves, uint16_t max_zones);
+
+/**
+ * @brief Frees an engine created with rollup_create.
+ */
+void rollup_destroy(rollup_engine_t* engine);
+
+/**
+ * @brief Bytes of state held per slave (or per zone), for capacity planning.
+ */
+size_t rollup_bytes_per_series(void);
+
+/**
+ * @brief Total bytes allocated by the engine.
+ */
+size_t rollup_memory_usage(const rollup_engine_t* engine);
+
+/**
+ * @brief Registers the callback that receives completed tumbling windows.
+ *        It runs with the engine lock held and must not call back into the engine.
+ */
+void rollup_set_emit_cb(rollup_engine_t* engine, rollup_emit_cb_t cb, void* ctx);
+
+/**
+ * @brief Returns the index of a slave, registering it on first sight.
+ *
+ * @return Slave index, or -1 if max_slaves are already registered.
+ */
+int rollup_slave_index(rollup_engine_t* engine, const uint8_t mac[6]);
+
+/**
+ * @brief Assigns a slave to a zone; its later samples also feed that zone's aggregates.
+ *
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if either index is out of range.
+ */
+esp_err_t rollup_set_zone(rollup_engine_t* engine, uint16_t slave_index, uint8_t zone);
+
+/**
+ * @brief Adds one sample. O(1) per metric apart from catching up on idle buckets.
+ *
+ * @param engine Engine.
+ * @param slave_index From rollup_slave_index.
+ * @param t_ms Wall-clock time of the sample in milliseconds. Must not go backwards per slave.
+ * @param values One value per rollup_metric_t; NAN (or any negative ppm error code
+ *               mapped to NAN by the caller) marks a missing value.
+ */
+void rollup_ingest(rollup_engine_t* engine, uint16_t slave_index, int64_t t_ms, const float values[ROLLUP_METRIC_COUNT]);
+
+/**
+ * @brief Reads sliding-window statistics as of now_ms.
+ *
+ * @return true if the scope/index is valid (stats may still have count == 0).
+ */
+bool rollup_query(rollup_engine_t* engine, rollup_scope_t scope, uint16_t index, rollup_window_t window,
+                  rollup_metric_t metric, int64_t now_ms, rollup_stats_t* out);
+
+#endif // ROLLUP_H
@@ -0,0 +1,330 @@
+#include "rules.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+
+static const char *TAG = "RULES";
+
+#define BIT_WORDS(n) (((n) + 31) / 32)
+
+typedef struct {
+    float threshold;
+    uint8_t strict;           // 1 for GT/LT, 0 for GE/LE
+} rules_threshold_t;
+
+typedef struct {
+    uint16_t first;           // First compiled condition index of the run
+    uint16_t count;
+} rules_run_t;
+
+struct rules_engine {
+    uint16_t n_rules;
+    uint16_t n_conds;
+    uint16_t max_slaves;
+    uint16_t n_hold;          // Rules with hold_ms > 0
+    uint16_t cond_words;
+    uint16_t rule_words;
+
+    // Compiled program
+    rules_threshold_t* thresholds;                        // [n_conds]
+    rules_run_t upper[RULE_FIELD_COUNT][RULE_KIND_COUNT]; // GT/GE, ascending thresholds
+    rules_run_t lower[RULE_FIELD_COUNT][RULE_KIND_COUNT]; // LT/LE, descending thresholds
+    rule_def_t* rules;                                    // [n_rules] copy of definitions
+    uint16_t (*rule_conds)[RULES_MAX_CONDS];              // [n_rules] compiled condition indices
+    int16_t* hold_slot;                                   // [n_rules] index into hold_since, -1 if none
+
+    // Per-slave state
+    float* prev_values;       // [max_slaves][RULE_FIELD_COUNT]
+    int64_t* prev_t_ms;       // [max_slaves], -1 = no previous frame
+    int64_t* hold_since;      // [max_slaves][n_hold], -1 = conditions not met
+    uint32_t* local_active;   // [max_slaves][rule_words]
+
+    // Cross-slave state
+    uint16_t* fleet_count;    // [n_rules]
+    uint32_t* fleet_active;   // [rule_words]
+    uint16_t expire_next;     // Slave rules_eval ages next
+
+    uint32_t* satisfied;      // [cond_words] scratch for the frame being evaluated
+    rules_alarm_cb_t cb;
+    void* cb_ctx;
+};
+
+// --- Compilation ---
+
+typedef struct {
+    uint8_t field;
+    uint8_t kind;
+    uint8_t lower;            // 0 = GT/GE run, 1 = LT/LE run
+    uint8_t strict;
+    float threshold;
+    uint16_t rule;
+    uint8_t pos;
+} rules_cond_sort_t;
+
+// Orders conditions by run, then so that the satisfied set of each run is a prefix:
+// upper runs ascending (GE before GT on ties), lower runs descending (LE before LT).
+static int cond_cmp(const void* a, const void* b) {
+    const rules_cond_sort_t* x = a;
+    const rules_cond_sort_t* y = b;
+    if (x->field != y->field) return x->field - y->field;
+    if (x->kind != y->kind) return x->kind - y->kind;
+    if (x->lower != y->lower) return x->lower - y->lower;
+    if (x->threshold != y->threshold) {
+        bool less = x->threshold < y->threshold;
+        return (x->lower ? !less : less) ? -1 : 1;
+    }
+    return x->strict - y->strict;
+}
+
+esp_err_t rules_compile(const rule_def_t* defs, uint16_t n_rules, uint16_t max_slaves, rules_engine_t** out) {
+    if (out == NULL || (n_rules > 0 && defs == NULL) || max_slaves == 0) return ESP_ERR_INVALID_ARG;
+    *out = NULL;
+
+    uint32_t n_conds = 0;
+    uint16_t n_hold = 0;
+    for (uint16_t r = 0; r < n_rules; r++) {
+        const rule_def_t* d = &defs[r];
+        if (d->n_conds == 0 || d->n_conds > RULES_MAX_CONDS) {
+            ESP_LOGE(TAG, "Rule %u: needs 1..%d conditions, has %u", d->id, RULES_MAX_CONDS, d->n_conds);
+            return ESP_ERR_INVALID_ARG;
+        }
+        for (int c = 0; c < d->n_conds; c++) {
+            const rule_cond_t* cond = &d->conds[c];
+            if (cond->field >= RULE_FIELD_COUNT || cond->kind >= RULE_KIND_COUNT || cond->op > RULE_LE || isnan(cond->threshold)) {
+                ESP_LOGE(TAG, "Rule %u: condition %d is malformed", d->id, c);
+                return ESP_ERR_INVALID_ARG;
+            }
+        }
+        n_conds += d->n_conds;
+        if (d->hold_ms > 0) n_hold++;
+    }
+    if (n_conds > UINT16_MAX || n_hold > INT16_MAX) return ESP_ERR_INVALID_ARG;
+
+    rules_engine_t* e = calloc(1, sizeof(rules_engine_t));
+    if (e == NULL) return ESP_ERR_NO_MEM;
+    e->n_rules = n_rules;
+    e->n_conds = (uint16_t)n_conds;
+    e->max_slaves = max_slaves;
+    e->n_hold = n_hold;
+    e->cond_words = BIT_WORDS(n_conds);
+    e->rule_words = BIT_WORDS(n_rules);
+
+    e->thresholds = calloc(n_conds ? n_conds : 1, sizeof(rules_threshold_t));
+    e->rules = calloc(n_rules ? n_rules : 1, sizeof(rule_def_t));
+    e->rule_conds = calloc(n_rules ? n_rules : 1, sizeof(*e->rule_conds));
+    e->hold_slot = calloc(n_rules ? n_rules : 1, sizeof(int16_t));
+    e->prev_values = calloc((size_t)max_slaves * RULE_FIELD_COUNT, sizeof(float));
+    e->prev_t_ms = calloc(max_slaves, sizeof(int64_t));
+    e->hold_since = calloc((size_t)max_slaves * (n_hold ? n_hold : 1), sizeof(int64_t));
+    e->local_active = calloc((size_t)max_slaves * (e->rule_words ? e->rule_words : 1), sizeof(uint32_t));
+    e->fleet_count = calloc(n_rules ? n_rules : 1, sizeof(uint16_t));
+    e->fleet_active = calloc(e->rule_words ? e->rule_words : 1, sizeof(uint32_t));
+    e->satisfied = calloc(e->cond_words ? e->cond_words : 1, sizeof(uint32_t));
+    rules_cond_sort_t* sorted = calloc(n_conds ? n_conds : 1, sizeof(rules_cond_sort_t));
+
+    if (!e->thresholds || !e->rules || !e->rule_conds || !e->hold_slot || !e->prev_values || !e->prev_t_ms ||
+        !e->hold_since || !e->local_active || !e->fleet_count || !e->fleet_active || !e->satisfied || !sorted) {
+        free(sorted);
+        rules_destroy(e);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Flatten, sort into runs and number the conditions in sorted order
+    uint32_t k = 0;
+    uint16_t hold = 0;
+    for (uint16_t r = 0; r < n_rules; r++) {
+        e->rules[r] = defs[r];
+        e->hold_slot[r] = defs[r].hold_ms > 0 ? (int16_t)hold++ : -1;
+        for (uint8_t c = 0; c < defs[r].n_conds; c++) {
+            const rule_cond_t* cond = &defs[r].conds[c];
+            sorted[k++] = (rules_cond_sort_t){
+                .field = cond->field,
+                .kind = cond->kind,
+                .lower = (cond->op == RULE_LT || cond->op == RULE_LE),
+                .strict = (cond->op == RULE_GT || cond->op == RULE_LT),
+                .threshold = cond->threshold,
+                .rule = r,
+                .pos = c,
+            };
+        }
+    }
+    qsort(sorted, n_conds, sizeof(rules_cond_sort_t), cond_cmp);
+
+    for (uint32_t i = 0; i < n_conds; i++) {
+        const rules_cond_sort_t* s = &sorted[i];
+        e->thresholds[i].threshold = s->threshold;
+        e->thresholds[i].strict = s->strict;
+        e->rule_conds[s->rule][s->pos] = (uint16_t)i;
+        rules_run_t* run = s->lower ? &e->lower[s->field][s->kind] : &e->upper[s->field][s->kind];
+        if (run->count == 0) run->first = (uint16_t)i;
+        run->count++;
+    }
+    free(sorted);
+
+    for (uint16_t s = 0; s < max_slaves; s++) {
+        e->prev_t_ms[s] = -1;
+        for (uint16_t h = 0; h < n_hold; h++) e->hold_since[(size_t)s * n_hold + h] = -1;
+    }
+
+    ESP_LOGI(TAG, "Compiled %u rules (%u conditions) for %u slaves, %u bytes",
+             n_rules, (unsigned)n_conds, max_slaves, (unsigned)rules_memory_usage(e));
+    *out = e;
+    return ESP_OK;
+}
+
+void rules_destroy(rules_engine_t* e) {
+    if (e == NULL) return;
+    free(e->thresholds);
+    free(e->rules);
+    free(e->rule_conds);
+    free(e->hold_slot);
+    free(e->prev_values);
+    free(e->prev_t_ms);
+    free(e->hold_since);
+    free(e->local_active);
+    free(e->fleet_count);
+    free(e->fleet_active);
+    free(e->satisfied);
+    free(e);
+}
+
+void rules_set_alarm_cb(rules_engine_t* e, rules_alarm_cb_t cb, void* ctx) {
+    e->cb = cb;
+    e->cb_ctx = ctx;
+}
+
+size_t rules_memory_usage(const rules_engine_t* e) {
+    if (e == NULL) return 0;
+    size_t program = sizeof(*e) + e->n_conds * sizeof(rules_threshold_t) +
+                     e->n_rules * (sizeof(rule_def_t) + sizeof(*e->rule_conds) + sizeof(int16_t) + sizeof(uint16_t)) +
+                     (e->rule_words + e->cond_words) * sizeof(uint32_t);
+    size_t per_slave = RULE_FIELD_COUNT * sizeof(float) + sizeof(int64_t) +
+                       e->n_hold * sizeof(int64_t) + e->rule_words * sizeof(uint32_t);
+    return program + (size_t)e->max_slaves * per_slave;
+}
+
+// --- Evaluation ---
+
+static inline bool bit_get(const uint32_t* bits, uint32_t i) {
+    return (bits[i >> 5] >> (i & 31)) & 1u;
+}
+
+static inline void bit_put(uint32_t* bits, uint32_t i, bool v) {
+    if (v) bits[i >> 5] |= 1u << (i & 31);
+    else bits[i >> 5] &= ~(1u << (i & 31));
+}
+
+static void bits_set_range(uint32_t* bits, uint32_t first, uint32_t count) {
+    uint32_t i = first, end = first + count;
+    while (i < end && (i & 31)) bit_put(bits, i++, true);
+    while (i + 32 <= end) { bits[i >> 5] = 0xFFFFFFFFu; i += 32; }
+    while (i < end) bit_put(bits, i++, true);
+}
+
+// Number of leading entries in a run satisfied by v (the run is ordered so this is a prefix)
+static uint32_t run_satisfied(const rules_threshold_t* t, const rules_run_t* run, float v, bool lower) {
+    uint32_t lo = 0, hi = run->count;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        const rules_threshold_t* e = &t[run->first + mid];
+        bool ok = lower ? (e->threshold > v || (e->threshold == v && !e->strict))
+                        : (e->threshold < v || (e->threshold == v && !e->strict));
+        if (ok) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static void rule_transition(rules_engine_t* e, uint16_t r, uint16_t slave, bool met) {
+    const rule_def_t* d = &e->rules[r];
+    if (d->min_slaves <= 1) {
+        if (e->cb) e->cb(e->cb_ctx, d->id, slave, met);
+        return;
+    }
+    if (met) e->fleet_count[r]++;
+    else if (e->fleet_count[r] > 0) e->fleet_count[r]--;
+    bool fleet = e->fleet_count[r] >= d->min_slaves;
+    if (fleet != bit_get(e->fleet_active, r)) {
+        bit_put(e->fleet_active, r, fleet);
+        if (e->cb) e->cb(e->cb_ctx, d->id, slave, fleet);
+    }
+}
+
+// Takes a silent slave out of every cross-slave count it is in
+static void slave_expire(rules_engine_t* e, uint16_t slave, int64_t t_ms) {
+    if (e->prev_t_ms[slave] < 0 || t_ms - e->prev_t_ms[slave] <= RULES_SLAVE_TIMEOUT_MS) return;
+    uint32_t* active = &e->local_active[(size_t)slave * e->rule_words];
+    int64_t* hold_since = &e->hold_since[(size_t)slave * e->n_hold];
+    for (uint16_t r = 0; r < e->n_rules; r++) {
+        if (e->rules[r].min_slaves <= 1) continue;
+        if (e->hold_slot[r] >= 0) hold_since[e->hold_slot[r]] = -1;
+        if (bit_get(active, r)) {
+            bit_put(active, r, false);
+            rule_transition(e, r, slave, false);
+        }
+    }
+}
+
+void rules_expire(rules_engine_t* e, int64_t t_ms) {
+    if (e == NULL) return;
+    for (uint16_t s = 0; s < e->max_slaves; s++) slave_expire(e, s, t_ms);
+}
+
+void rules_eval(rules_engine_t* e, uint16_t slave, int64_t t_ms, const float values[RULE_FIELD_COUNT]) {
+    if (e == NULL || slave >= e->max_slaves) return;
+
+    // 0. Age one other slave per frame, so a fleet count never rests on a slave that went quiet
+    if (e->expire_next != slave) slave_expire(e, e->expire_next, t_ms);
+    e->expire_next = (uint16_t)((e->expire_next + 1) % e->max_slaves);
+
+    float* prev = &e->prev_values[(size_t)slave * RULE_FIELD_COUNT];
+    int64_t dt_ms = e->prev_t_ms[slave] >= 0 ? t_ms - e->prev_t_ms[slave] : 0;
+
+    // 1. Mark satisfied conditions, one binary search per (field, kind, direction)
+    memset(e->satisfied, 0, e->cond_words * sizeof(uint32_t));
+    for (int f = 0; f < RULE_FIELD_COUNT; f++) {
+        float inputs[RULE_KIND_COUNT];
+        inputs[RULE_VALUE] = values[f];
+        inputs[RULE_RATE] = (dt_ms > 0 && !isnan(prev[f])) ? (values[f] - prev[f]) * 60000.0f / (float)dt_ms : NAN;
+        for (int k = 0; k < RULE_KIND_COUNT; k++) {
+            float v = inputs[k];
+            if (isnan(v)) continue;
+            const rules_run_t* up = &e->upper[f][k];
+            const rules_run_t* lo = &e->lower[f][k];
+            if (up->count) bits_set_range(e->satisfied, up->first, run_satisfied(e->thresholds, up, v, false));
+            if (lo->count) bits_set_range(e->satisfied, lo->first, run_satisfied(e->thresholds, lo, v, true));
+        }
+    }
+    for (int f = 0; f < RULE_FIELD_COUNT; f++) {
+        prev[f] = values[f]; // NAN resets the rate baseline for that field
+    }
+    e->prev_t_ms[slave] = t_ms;
+
+    // 2. Combine into rules and report transitions
+    uint32_t* active = &e->local_active[(size_t)slave * e->rule_words];
+    int64_t* hold_since = &e->hold_since[(size_t)slave * e->n_hold];
+    for (uint16_t r = 0; r < e->n_rules; r++) {
+        const rule_def_t* d = &e->rules[r];
+        bool met = true;
+        for (uint8_t c = 0; c < d->n_conds && met; c++) {
+            met = bit_get(e->satisfied, e->rule_conds[r][c]);
+        }
+        int16_t slot = e->hold_slot[r];
+        if (slot >= 0) {
+            if (!met) hold_since[slot] = -1;
+            else if (hold_since[slot] < 0) hold_since[slot] = t_ms;
+            met = met && (t_ms - hold_since[slot]) >= (int64_t)d->hold_ms;
+        }
+        if (met != bit_get(active, r)) {
+            bit_put(active, r, met);
+            rule_transition(e, r, slave, met);
+        }
+    }
+}
+
+bool rules_is_active(const rules_engine_t* e, uint16_t r, uint16_t slave) {
+    if (e == NULL || r >= e->n_rules || slave >= e->max_slaves) return false;
+    if (e->rules[r].min_slaves > 1) return bit_get(e->fleet_active, r);
+    return bit_get(&e->local_active[(size_t)slave * e->rule_words], r);
+}
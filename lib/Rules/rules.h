@@ -0,0 +1,131 @@
+#ifndef RULES_H
+#define RULES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Alarm rule engine for the master. Rules are compiled once into per-field sorted
+// threshold tables; evaluating a frame is one binary search and one bit-range fill
+// per field, then one bit test per rule condition - O(n_rules) per frame, with no
+// per-rule branching on rule type and no allocation.
+//
+// Compilation trick: all "greater than" conditions on one field are numbered
+// consecutively in ascending threshold order (and "less than" ones in descending
+// order), so the conditions a value satisfies are always a prefix of that run.
+
+// --- Configuration Constants ---
+
+#define RULES_MAX_CONDS (4)   // Conditions per rule, ANDed together
+#define RULES_SLAVE_TIMEOUT_MS (60000) // A slave silent this long stops counting toward cross-slave rules
+
+// --- Rule Definition ---
+
+typedef enum {
+    RULE_FIELD_TEMPERATURE = 0,
+    RULE_FIELD_HUMIDITY,
+    RULE_FIELD_LPG,
+    RULE_FIELD_CO,
+    RULE_FIELD_SMOKE,
+    RULE_FIELD_MOTION,        // 1.0 / 0.0
+    RULE_FIELD_HOUR,          // Local hour of day 0-23 at the master, for "after hours" rules
+    RULE_FIELD_COUNT
+} rule_field_t;
+
+typedef enum {
+    RULE_VALUE = 0,           // Compare the field value
+    RULE_RATE,                // Compare the change per minute since the slave's previous frame
+    RULE_KIND_COUNT
+} rule_kind_t;
+
+typedef enum {
+    RULE_GT = 0,
+    RULE_GE,
+    RULE_LT,
+    RULE_LE
+} rule_op_t;
+
+typedef struct {
+    uint8_t field;            // rule_field_t
+    uint8_t kind;             // rule_kind_t
+    uint8_t op;               // rule_op_t
+    float threshold;
+} rule_cond_t;
+
+typedef struct {
+    uint16_t id;              // Reported back in alarm callbacks
+    uint8_t n_conds;          // 1..RULES_MAX_CONDS
+    rule_cond_t conds[RULES_MAX_CONDS];
+    uint32_t hold_ms;         // Conditions must hold continuously this long before the rule fires (0 = immediately)
+    uint16_t min_slaves;      // >1 makes it a cross-slave rule: fires when this many slaves satisfy it at once
+} rule_def_t;
+
+/**
+ * @brief Called on every alarm transition.
+ *
+ * @param rule_id rule_def_t.id.
+ * @param slave_index Slave whose frame caused the transition. For cross-slave rules this is
+ *                    the slave that tipped the count over (or under) min_slaves, including
+ *                    one that timed out (rules_expire()).
+ * @param active true when the alarm starts, false when it clears.
+ */
+typedef void (*rules_alarm_cb_t)(void* ctx, uint16_t rule_id, uint16_t slave_index, bool active);
+
+typedef struct rules_engine rules_engine_t;
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Validates and compiles rules, and allocates state for max_slaves slaves.
+ *
+ * @param defs Rule definitions (copied; may be freed after the call).
+ * @param n_rules Number of rules.
+ * @param max_slaves Slave indices passed to rules_eval must be below this.
+ * @param out Receives the engine.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for a malformed rule, ESP_ERR_NO_MEM.
+ */
+esp_err_t rules_compile(const rule_def_t* defs, uint16_t n_rules, uint16_t max_slaves, rules_engine_t** out);
+
+/**
+ * @brief Frees a compiled engine.
+ */
+void rules_destroy(rules_engine_t* engine);
+
+/**
+ * @brief Registers the alarm transition callback.
+ */
+void rules_set_alarm_cb(rules_engine_t* engine, rules_alarm_cb_t cb, void* ctx);
+
+/**
+ * @brief Evaluates all rules against one frame. Not thread-safe; call from one task.
+ *
+ * @param engine Compiled engine.
+ * @param slave_index Sending slave.
+ * @param t_ms Receive time in milliseconds (monotonic).
+ * @param values One value per rule_field_t; NAN satisfies no condition.
+ */
+void rules_eval(rules_engine_t* engine, uint16_t slave_index, int64_t t_ms, const float values[RULE_FIELD_COUNT]);
+
+/**
+ * @brief Drops slaves silent for more than RULES_SLAVE_TIMEOUT_MS from cross-slave
+ *        counts (reporting any fleet alarm that clears as a result). rules_eval() ages
+ *        one slave per call on its own; call this as well (e.g. once per superframe)
+ *        so counts also age while no frames arrive. Same task as rules_eval().
+ *        Single-slave alarms are left as they are: a slave going quiet clears nothing.
+ *
+ * @param t_ms Current time on the rules_eval() clock.
+ */
+void rules_expire(rules_engine_t* engine, int64_t t_ms);
+
+/**
+ * @brief Whether a rule is currently active for a slave (for cross-slave rules: for the fleet).
+ */
+bool rules_is_active(const rules_engine_t* engine, uint16_t rule_index, uint16_t slave_index);
+
+/**
+ * @brief Bytes allocated by the engine (program plus per-slave state).
+ */
+size_t rules_memory_usage(const rules_engine_t* engine);
+
+#endif // RULES_H
@@ -0,0 +1,419 @@
+#include "spool.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "SPOOL";
+
+// --- On-Flash Layout ---
+// Sector: [header 8 B][record][record]...  Record: [spool_rec_t][payload, padded to 4 B]
+
+#define SPOOL_MAGIC 0x314C5053u // "SPL1"
+#define SPOOL_ERASED16 0xFFFF
+#define SPOOL_DRAIN_WINDOW_MS 1000
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t seq;          // Increases by one per sector started; orders the ring
+} spool_sector_hdr_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t len;          // Payload bytes, 0xFFFF = free space
+    uint16_t check;        // Fletcher-16 over len and payload; detects torn writes
+    uint32_t ack;          // 0 = this and every older record has been delivered
+} spool_rec_t;
+
+_Static_assert(sizeof(spool_rec_t) == SPOOL_RECORD_OVERHEAD, "record header size");
+_Static_assert(sizeof(spool_sector_hdr_t) + SPOOL_RECORD_OVERHEAD + SPOOL_MAX_MESSAGE == SPOOL_SECTOR_SIZE,
+               "SPOOL_MAX_MESSAGE must fill one sector");
+
+#define SPOOL_REC_SIZE(len) ((sizeof(spool_rec_t) + (len) + 3u) & ~3u)
+
+// --- In-Memory State ---
+
+typedef struct {
+    bool valid;
+    bool closed;           // Ends in a torn record; takes no more appends
+    uint32_t seq;
+    uint32_t used;         // Bytes of intact records (including the header)
+} spool_sector_t;
+
+typedef struct {
+    uint32_t sector;
+    uint32_t off;
+} spool_cursor_t;
+
+struct spool {
+    spool_backend_t be;
+    spool_config_t cfg;
+    uint32_t n_sectors;
+    spool_sector_t* sectors;
+    int wr;                // Sector taking appends, -1 while the spool has never been written
+    spool_cursor_t rd;     // Oldest undelivered record
+    uint8_t* batch;        // batch_max_bytes, also the scan buffer at mount
+    SemaphoreHandle_t lock;
+    bool draining;         // A batch is with the sink; its sectors must not be recycled
+
+    int64_t tokens_milli;  // Token bucket in byte-milliseconds (bytes x 1000)
+    int64_t last_refill_ms;
+    bool refill_started;
+    int64_t win_start_ms;
+    uint32_t win_bytes;
+
+    spool_stats_t stats;
+};
+
+static inline size_t sector_base(uint32_t s) {
+    return (size_t)s * SPOOL_SECTOR_SIZE;
+}
+
+static uint16_t spool_check(uint16_t len, const uint8_t* payload) {
+    uint16_t a = 0, b = 0;
+    const uint8_t lb[2] = { (uint8_t)len, (uint8_t)(len >> 8) };
+    for (int i = 0; i < 2; i++) {
+        a = (a + lb[i]) % 255;
+        b = (b + a) % 255;
+    }
+    for (uint16_t i = 0; i < len; i++) {
+        a = (a + payload[i]) % 255;
+        b = (b + a) % 255;
+    }
+    return (uint16_t)((b << 8) | a);
+}
+
+// Moves the cursor past the end of filled sectors; stops at the write sector
+static void spool_settle(spool_t* spool, spool_cursor_t* cur) {
+    if (spool->wr < 0) return;
+    while ((int)cur->sector != spool->wr && cur->off >= spool->sectors[cur->sector].used) {
+        cur->sector = (cur->sector + 1) % spool->n_sectors;
+        cur->off = sizeof(spool_sector_hdr_t);
+    }
+}
+
+// --- Mount ---
+
+// Walks one sector's records. Every delivered record resets the pending totals.
+static esp_err_t spool_scan_sector(spool_t* spool, uint32_t s) {
+    spool_sector_t* sec = &spool->sectors[s];
+    uint32_t off = sizeof(spool_sector_hdr_t);
+    while (off + sizeof(spool_rec_t) <= SPOOL_SECTOR_SIZE) {
+        spool_rec_t rec;
+        esp_err_t ret = spool->be.read(spool->be.ctx, sector_base(s) + off, &rec, sizeof(rec));
+        if (ret != ESP_OK) return ret;
+        if (rec.len == SPOOL_ERASED16) break;
+
+        bool torn = rec.len == 0 || rec.len > SPOOL_MAX_MESSAGE || off + SPOOL_REC_SIZE(rec.len) > SPOOL_SECTOR_SIZE;
+        if (!torn) {
+            ret = spool->be.read(spool->be.ctx, sector_base(s) + off + sizeof(rec), spool->batch, rec.len);
+            if (ret != ESP_OK) return ret;
+            torn = rec.check != spool_check(rec.len, spool->batch);
+        }
+        if (torn) {
+            ESP_LOGW(TAG, "Torn record in sector %lu at %lu, closing sector.", (unsigned long)s, (unsigned long)off);
+            sec->used = off;
+            sec->closed = true;
+            return ESP_OK;
+        }
+
+        off += SPOOL_REC_SIZE(rec.len);
+        spool->stats.records++;
+        spool->stats.bytes += rec.len;
+        if (rec.ack == 0) {
+            spool->stats.records = 0;
+            spool->stats.bytes = 0;
+            spool->rd.sector = s;
+            spool->rd.off = off;
+        }
+    }
+    sec->used = off;
+    return ESP_OK;
+}
+
+esp_err_t spool_open(const spool_backend_t* backend, const spool_config_t* config, spool_t** out) {
+    uint32_t n = backend->size / SPOOL_SECTOR_SIZE;
+    if (n > SPOOL_MAX_SECTORS) n = SPOOL_MAX_SECTORS;
+    if (n < 2 || config->batch_max_bytes < 2 + SPOOL_MAX_MESSAGE) return ESP_ERR_INVALID_SIZE;
+
+    spool_t* spool = calloc(1, sizeof(spool_t));
+    if (spool == NULL) return ESP_ERR_NO_MEM;
+    spool->be = *backend;
+    spool->cfg = *config;
+    if (spool->cfg.burst_bytes < spool->cfg.batch_max_bytes) spool->cfg.burst_bytes = spool->cfg.batch_max_bytes;
+    spool->n_sectors = n;
+    spool->wr = -1;
+    spool->sectors = calloc(n, sizeof(spool_sector_t));
+    spool->batch = malloc(spool->cfg.batch_max_bytes);
+    spool->lock = xSemaphoreCreateMutex();
+    if (spool->sectors == NULL || spool->batch == NULL || spool->lock == NULL) {
+        spool_close(spool);
+        return ESP_ERR_NO_MEM;
+    }
+    spool->stats.capacity_bytes = n * SPOOL_SECTOR_SIZE;
+    spool->tokens_milli = (int64_t)spool->cfg.burst_bytes * 1000;
+
+    esp_err_t ret = ESP_OK;
+    for (uint32_t s = 0; s < n && ret == ESP_OK; s++) {
+        spool_sector_hdr_t hdr;
+        ret = backend->read(backend->ctx, sector_base(s), &hdr, sizeof(hdr));
+        if (ret != ESP_OK || hdr.magic != SPOOL_MAGIC) continue;
+        spool->sectors[s].valid = true;
+        spool->sectors[s].seq = hdr.seq;
+        if (spool->wr < 0 || hdr.seq > spool->sectors[spool->wr].seq) spool->wr = (int)s;
+    }
+
+    if (ret == ESP_OK && spool->wr >= 0) {
+        bool first = true;
+        for (uint32_t k = 1; k <= n && ret == ESP_OK; k++) {
+            uint32_t s = ((uint32_t)spool->wr + k) % n; // Oldest first
+            if (!spool->sectors[s].valid) continue;
+            if (first) {
+                spool->rd.sector = s;
+                spool->rd.off = sizeof(spool_sector_hdr_t);
+                first = false;
+            }
+            ret = spool_scan_sector(spool, s);
+        }
+        if (ret == ESP_OK) spool_settle(spool, &spool->rd);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "spool_open: backend read failed: %s", esp_err_to_name(ret));
+        spool_close(spool);
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Spool: %lu sectors, %lu messages (%lu bytes) waiting", (unsigned long)n,
+             (unsigned long)spool->stats.records, (unsigned long)spool->stats.bytes);
+    *out = spool;
+    return ESP_OK;
+}
+
+void spool_close(spool_t* spool) {
+    if (spool == NULL) return;
+    if (spool->lock != NULL) vSemaphoreDelete(spool->lock);
+    free(spool->batch);
+    free(spool->sectors);
+    free(spool);
+}
+
+// --- Append ---
+
+// Discards the undelivered records left in the oldest sector before it is recycled
+static esp_err_t spool_drop_sector(spool_t* spool, uint32_t s) {
+    uint32_t off = spool->rd.off;
+    while (off + sizeof(spool_rec_t) <= spool->sectors[s].used) {
+        spool_rec_t rec;
+        esp_err_t ret = spool->be.read(spool->be.ctx, sector_base(s) + off, &rec, sizeof(rec));
+        if (ret != ESP_OK) return ret;
+        if (rec.len == SPOOL_ERASED16 || rec.len == 0 || rec.len > SPOOL_MAX_MESSAGE) break;
+        spool->stats.records--;
+        spool->stats.bytes -= rec.len;
+        spool->stats.dropped++;
+        off += SPOOL_REC_SIZE(rec.len);
+    }
+    spool->rd.sector = (s + 1) % spool->n_sectors;
+    spool->rd.off = sizeof(spool_sector_hdr_t);
+    return ESP_OK;
+}
+
+static esp_err_t spool_next_sector(spool_t* spool) {
+    uint32_t next = spool->wr < 0 ? 0 : ((uint32_t)spool->wr + 1) % spool->n_sectors;
+    esp_err_t ret;
+
+    spool_settle(spool, &spool->rd);
+    if (spool->wr >= 0 && spool->stats.records > 0 && spool->rd.sector == next) {
+        if (!spool->cfg.drop_oldest || spool->draining) return ESP_ERR_NO_MEM;
+        ret = spool_drop_sector(spool, next);
+        if (ret != ESP_OK) return ret;
+    }
+
+    ret = spool->be.erase(spool->be.ctx, sector_base(next), SPOOL_SECTOR_SIZE);
+    if (ret != ESP_OK) return ret;
+    spool_sector_hdr_t hdr = {
+        .magic = SPOOL_MAGIC,
+        .seq = spool->wr < 0 ? 1 : spool->sectors[spool->wr].seq + 1,
+    };
+    ret = spool->be.write(spool->be.ctx, sector_base(next), &hdr, sizeof(hdr));
+    if (ret != ESP_OK) return ret;
+
+    spool->sectors[next] = (spool_sector_t){ .valid = true, .seq = hdr.seq, .used = sizeof(hdr) };
+    spool->wr = (int)next;
+    if (spool->stats.records == 0) {
+        spool->rd.sector = next;
+        spool->rd.off = sizeof(hdr);
+    }
+    return ESP_OK;
+}
+
+esp_err_t spool_append(spool_t* spool, const void* msg, size_t len) {
+    if (spool == NULL || msg == NULL) return ESP_ERR_INVALID_ARG;
+    if (len == 0 || len > SPOOL_MAX_MESSAGE) return ESP_ERR_INVALID_SIZE;
+
+    xSemaphoreTake(spool->lock, portMAX_DELAY);
+    esp_err_t ret = ESP_OK;
+    if (spool->wr < 0 || spool->sectors[spool->wr].closed ||
+        spool->sectors[spool->wr].used + SPOOL_REC_SIZE(len) > SPOOL_SECTOR_SIZE) {
+        ret = spool_next_sector(spool);
+    }
+    if (ret == ESP_OK) {
+        spool_sector_t* sec = &spool->sectors[spool->wr];
+        spool_rec_t rec = { .len = (uint16_t)len, .check = spool_check((uint16_t)len, msg), .ack = 0xFFFFFFFFu };
+        size_t at = sector_base((uint32_t)spool->wr) + sec->used;
+        // Header first: a reset mid-payload then fails the check instead of looking like free space
+        ret = spool->be.write(spool->be.ctx, at, &rec, sizeof(rec));
+        if (ret == ESP_OK) ret = spool->be.write(spool->be.ctx, at + sizeof(rec), msg, len);
+        if (ret == ESP_OK) {
+            sec->used += SPOOL_REC_SIZE(len);
+            spool->stats.records++;
+            spool->stats.bytes += len;
+        } else {
+            sec->closed = true; // The slot may be half written; start afresh in the next sector
+        }
+    } else if (ret == ESP_ERR_NO_MEM) {
+        spool->stats.rejected++;
+    }
+    xSemaphoreGive(spool->lock);
+    if (ret != ESP_OK && ret != ESP_ERR_NO_MEM) {
+        ESP_LOGE(TAG, "spool_append failed: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+// --- Drain ---
+
+static void spool_refill(spool_t* spool, int64_t now_ms) {
+    if (!spool->refill_started) {
+        spool->refill_started = true;
+        spool->last_refill_ms = now_ms;
+        spool->win_start_ms = now_ms;
+        return;
+    }
+    int64_t dt = now_ms - spool->last_refill_ms;
+    if (dt <= 0) return;
+    spool->last_refill_ms = now_ms;
+    spool->tokens_milli += (int64_t)spool->cfg.drain_rate_bps * dt;
+    int64_t cap = (int64_t)spool->cfg.burst_bytes * 1000;
+    if (spool->tokens_milli > cap) spool->tokens_milli = cap;
+
+    int64_t win = now_ms - spool->win_start_ms;
+    if (win >= SPOOL_DRAIN_WINDOW_MS) {
+        spool->stats.drain_bps = (uint32_t)((int64_t)spool->win_bytes * 1000 / win);
+        spool->win_bytes = 0;
+        spool->win_start_ms = now_ms;
+    }
+}
+
+esp_err_t spool_drain(spool_t* spool, int64_t now_ms, spool_sink_t sink, void* ctx) {
+    if (spool == NULL || sink == NULL) return ESP_ERR_INVALID_ARG;
+
+    xSemaphoreTake(spool->lock, portMAX_DELAY);
+    spool_refill(spool, now_ms);
+    if (spool->stats.records == 0 || spool->draining) {
+        xSemaphoreGive(spool->lock);
+        return ESP_OK;
+    }
+
+    // Wait until a full batch (or everything left) is affordable
+    uint64_t pending_wire = (uint64_t)spool->stats.bytes + 2ULL * spool->stats.records;
+    uint32_t budget = pending_wire < spool->cfg.batch_max_bytes ? (uint32_t)pending_wire : spool->cfg.batch_max_bytes;
+    if (spool->tokens_milli < (int64_t)budget * 1000) {
+        xSemaphoreGive(spool->lock);
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    esp_err_t ret = ESP_OK;
+    spool_cursor_t cur = spool->rd;
+    spool_cursor_t last = cur;
+    size_t len = 0;
+    uint32_t n = 0, payload = 0;
+    while (n < spool->stats.records) {
+        spool_settle(spool, &cur);
+        spool_rec_t rec;
+        ret = spool->be.read(spool->be.ctx, sector_base(cur.sector) + cur.off, &rec, sizeof(rec));
+        if (ret != ESP_OK) break;
+        if (rec.len == SPOOL_ERASED16 || rec.len == 0 || rec.len > SPOOL_MAX_MESSAGE) {
+            ret = ESP_ERR_INVALID_STATE; // Intact by construction; flash changed underneath us
+            break;
+        }
+        if (len + 2 + rec.len > budget) break;
+        spool->batch[len] = (uint8_t)rec.len;
+        spool->batch[len + 1] = (uint8_t)(rec.len >> 8);
+        ret = spool->be.read(spool->be.ctx, sector_base(cur.sector) + cur.off + sizeof(rec), spool->batch + len + 2, rec.len);
+        if (ret != ESP_OK) break;
+        len += 2 + rec.len;
+        payload += rec.len;
+        n++;
+        last = cur;
+        cur.off += SPOOL_REC_SIZE(rec.len);
+    }
+    if (ret != ESP_OK || n == 0) {
+        xSemaphoreGive(spool->lock);
+        if (ret != ESP_OK) ESP_LOGE(TAG, "spool_drain: backend read failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    spool->draining = true;
+    xSemaphoreGive(spool->lock);
+
+    esp_err_t sent = sink(spool->batch, len, n, ctx);
+
+    xSemaphoreTake(spool->lock, portMAX_DELAY);
+    spool->draining = false;
+    if (sent == ESP_OK) {
+        uint32_t zero = 0;
+        size_t ack_at = sector_base(last.sector) + last.off + offsetof(spool_rec_t, ack);
+        esp_err_t acked = spool->be.write(spool->be.ctx, ack_at, &zero, sizeof(zero));
+        // Delivered either way; a failed ack only means this batch is resent after a reset
+        if (acked != ESP_OK) {
+            spool->stats.ack_failures++;
+            ESP_LOGW(TAG, "spool_drain: ack write failed: %s", esp_err_to_name(acked));
+        }
+        spool->rd = cur;
+        spool->stats.records -= n;
+        spool->stats.bytes -= payload;
+        spool->stats.drained_records += n;
+        spool->stats.drained_bytes += payload;
+        spool->win_bytes += payload;
+        spool->tokens_milli -= (int64_t)len * 1000;
+    } else {
+        spool->stats.sink_failures++;
+        ret = sent;
+    }
+    xSemaphoreGive(spool->lock);
+    return ret;
+}
+
+void spool_get_stats(spool_t* spool, spool_stats_t* out) {
+    xSemaphoreTake(spool->lock, portMAX_DELAY);
+    *out = spool->stats;
+    xSemaphoreGive(spool->lock);
+}
+
+// --- Partition Backend ---
+
+static esp_err_t spool_part_read(void* ctx, size_t offset, void* dst, size_t len) {
+    return esp_partition_read((const esp_partition_t*)ctx, offset, dst, len);
+}
+
+static esp_err_t spool_part_write(void* ctx, size_t offset, const void* src, size_t len) {
+    return esp_partition_write((const esp_partition_t*)ctx, offset, src, len);
+}
+
+static esp_err_t spool_part_erase(void* ctx, size_t offset, size_t len) {
+    return esp_partition_erase_range((const esp_partition_t*)ctx, offset, len);
+}
+
+esp_err_t spool_backend_partition(const char* label, spool_backend_t* out) {
+    const esp_partition_t* part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (part == NULL) {
+        ESP_LOGW(TAG, "No data partition labelled \"%s\".", label);
+        return ESP_ERR_NOT_FOUND;
+    }
+    out->size = (part->size / SPOOL_SECTOR_SIZE) * SPOOL_SECTOR_SIZE;
+    out->read = spool_part_read;
+    out->write = spool_part_write;
+    out->erase = spool_part_erase;
+    out->ctx = (void*)part;
+    return ESP_OK;
+}
@@ -0,0 +1,122 @@
+#ifndef SPOOL_H
+#define SPOOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Store-and-forward spool between the master's ingest (e.g. rollup emits) and its
+// cloud uplink, so an MQTT/broker outage costs latency instead of data.
+//
+// Messages are appended to a flash log of 4 KB sectors used as a ring. The uplink
+// drains it oldest-first in batches of up to batch_max_bytes through a sink callback.
+// Draining is paced by a token bucket (drain_rate_bps, burst_bytes) charged with the
+// batch bytes handed to the sink, length prefixes included, so catching up after an
+// outage leaves bandwidth for live traffic, and a batch is only sent once the bucket
+// can pay for a full one (or for everything left).
+//
+// A sent batch is acknowledged by zeroing one word in its last record, so after a
+// reset draining resumes after the newest acknowledged record; at most the batch in
+// flight is sent twice. When the spool is full, appends either recycle the oldest
+// sector (drop_oldest, counted in spool_stats_t.dropped) or fail with ESP_ERR_NO_MEM
+// so the producer can apply backpressure. A sector still being drained is never
+// recycled.
+//
+// Storage goes through spool_backend_t with NOR flash rules (write once between
+// erases); the sink is any transport. A RAM backend and a sink that fails while a
+// fake broker is "stopped" exercise outages on the IDF linux target.
+
+// --- Configuration Constants ---
+
+#define SPOOL_SECTOR_SIZE   (4096)
+#define SPOOL_MAX_SECTORS   (256)
+#define SPOOL_RECORD_OVERHEAD (8)   // Per-record header in flash, before 4-byte alignment
+#define SPOOL_MAX_MESSAGE   (SPOOL_SECTOR_SIZE - 8 - SPOOL_RECORD_OVERHEAD)
+
+typedef struct {
+    uint32_t drain_rate_bps;    // Sustained drain rate, batch bytes (wire format below) per second
+    uint32_t burst_bytes;       // Token bucket depth in batch bytes; at least batch_max_bytes
+    uint32_t batch_max_bytes;   // Largest batch handed to the sink (wire format below)
+    bool drop_oldest;           // Full spool: recycle the oldest sector instead of failing appends
+} spool_config_t;
+
+// --- Storage Backend ---
+
+typedef struct {
+    size_t size;    // Region size in bytes (a multiple of SPOOL_SECTOR_SIZE)
+    esp_err_t (*read)(void* ctx, size_t offset, void* dst, size_t len);
+    esp_err_t (*write)(void* ctx, size_t offset, const void* src, size_t len);
+    esp_err_t (*erase)(void* ctx, size_t offset, size_t len); // Sets the range to 0xFF
+    void* ctx;
+} spool_backend_t;
+
+/**
+ * @brief Backend on a raw data partition. The usable size is rounded down to whole sectors.
+ */
+esp_err_t spool_backend_partition(const char* label, spool_backend_t* out);
+
+// --- Metrics ---
+
+typedef struct {
+    uint32_t records;           // Messages waiting
+    uint32_t bytes;             // Payload bytes waiting
+    uint32_t capacity_bytes;    // Region size
+    uint32_t dropped;           // Messages lost to drop_oldest
+    uint32_t rejected;          // Appends refused because the spool was full
+    uint32_t drained_records;
+    uint64_t drained_bytes;
+    uint32_t drain_bps;         // Payload bytes/s drained over the last measurement window
+    uint32_t sink_failures;     // Batches the sink did not accept
+    uint32_t ack_failures;      // Delivered batches whose ack could not be written (resent after a reset)
+} spool_stats_t;
+
+// --- Spool API ---
+
+typedef struct spool spool_t;
+
+/**
+ * @brief Receives one batch, oldest message first. The batch is a sequence of
+ *        [uint16_t length, little-endian][payload] entries.
+ *
+ * Runs without the spool lock held, so ingest continues while it blocks on the network.
+ *
+ * @return ESP_OK once the batch is delivered; anything else leaves it in the spool.
+ */
+typedef esp_err_t (*spool_sink_t)(const uint8_t* batch, size_t len, uint32_t n_messages, void* ctx);
+
+/**
+ * @brief Mounts the spool, resuming after the newest acknowledged message.
+ *
+ * @return ESP_ERR_INVALID_SIZE if the region holds fewer than 2 sectors or
+ *         batch_max_bytes cannot hold a maximum-size message, ESP_ERR_NO_MEM,
+ *         or a backend error.
+ */
+esp_err_t spool_open(const spool_backend_t* backend, const spool_config_t* config, spool_t** out);
+
+void spool_close(spool_t* spool);
+
+/**
+ * @brief Appends one message.
+ *
+ * @return ESP_ERR_INVALID_SIZE if len is 0 or above SPOOL_MAX_MESSAGE, ESP_ERR_NO_MEM if
+ *         the spool is full (and drop_oldest is off or the oldest sector is being drained),
+ *         or a backend error.
+ */
+esp_err_t spool_append(spool_t* spool, const void* msg, size_t len);
+
+/**
+ * @brief Sends at most one batch if the token bucket allows it. Call periodically
+ *        from the uplink task, e.g. whenever the link is up and idle.
+ *
+ * @param now_ms Monotonic time in milliseconds.
+ * @return ESP_OK (batch delivered, or nothing due yet), ESP_ERR_NOT_FINISHED if
+ *         messages are waiting for tokens, the sink's error, or a backend read error.
+ *         A delivered batch whose ack write fails still returns ESP_OK and counts in
+ *         spool_stats_t.ack_failures.
+ */
+esp_err_t spool_drain(spool_t* spool, int64_t now_ms, spool_sink_t sink, void* ctx);
+
+void spool_get_stats(spool_t* spool, spool_stats_t* out);
+
+#endif // SPOOL_H
@@ -0,0 +1,144 @@
+#include "tdma.h"
+#include <string.h>
+#include "esp_random.h"
+
+// --- Slave-Side Schedule ---
+
+void tdma_slave_init(tdma_slave_t* tdma, uint32_t fallback_period_ms) {
+    memset(tdma, 0, sizeof(*tdma));
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    tdma->lock = unlocked;
+    tdma->fallback_period_ms = fallback_period_ms;
+}
+
+// Slots must lie inside the superframe they are advertised with
+static bool tdma_geometry_valid(uint16_t slot_count, uint16_t slot_ms, uint16_t superframe_ms) {
+    return slot_ms != 0 && superframe_ms != 0 && slot_count != 0 &&
+           (uint32_t)slot_count * slot_ms <= superframe_ms;
+}
+
+bool tdma_slave_on_assign(tdma_slave_t* tdma, uint16_t slot_index, uint16_t slot_count,
+                          uint16_t slot_ms, uint16_t superframe_ms) {
+    if (!tdma_geometry_valid(slot_count, slot_ms, superframe_ms) || slot_index >= slot_count) return false;
+    portENTER_CRITICAL(&tdma->lock);
+    tdma->assigned = true;
+    tdma->slot_index = slot_index;
+    tdma->slot_count = slot_count;
+    tdma->slot_ms = slot_ms;
+    tdma->superframe_ms = superframe_ms;
+    portEXIT_CRITICAL(&tdma->lock);
+    return true;
+}
+
+bool tdma_slave_on_beacon(tdma_slave_t* tdma, uint16_t superframe_ms, uint16_t slot_ms,
+                          uint16_t slot_count, int64_t rx_us) {
+    if (!tdma_geometry_valid(slot_count, slot_ms, superframe_ms)) return false;
+    bool accepted = true;
+    portENTER_CRITICAL(&tdma->lock);
+    if (tdma->assigned && tdma->slot_index >= slot_count) {
+        // Our slot is no longer advertised (reclaimed, or the master restarted): stop using
+        // it and fall back to jitter until the master assigns a new one
+        tdma->assigned = false;
+        accepted = false;
+    } else {
+        tdma->last_beacon_us = rx_us;
+        // The fleet may have grown since our assignment; follow the beacon's geometry
+        tdma->superframe_ms = superframe_ms;
+        tdma->slot_ms = slot_ms;
+        tdma->slot_count = slot_count;
+    }
+    portEXIT_CRITICAL(&tdma->lock);
+    return accepted;
+}
+
+static bool tdma_slave_is_synced_locked(const tdma_slave_t* tdma, int64_t now_us) {
+    if (!tdma->assigned || tdma->last_beacon_us == 0 || tdma->superframe_ms == 0) return false;
+    int64_t max_age_us = (int64_t)tdma->superframe_ms * 1000 * TDMA_MAX_MISSED_BEACONS;
+    return (now_us - tdma->last_beacon_us) <= max_age_us;
+}
+
+bool tdma_slave_is_synced(tdma_slave_t* tdma, int64_t now_us) {
+    portENTER_CRITICAL(&tdma->lock);
+    bool synced = tdma_slave_is_synced_locked(tdma, now_us);
+    portEXIT_CRITICAL(&tdma->lock);
+    return synced;
+}
+
+int64_t tdma_slave_next_tx_us(tdma_slave_t* tdma, int64_t now_us) {
+    portENTER_CRITICAL(&tdma->lock);
+    bool synced = tdma_slave_is_synced_locked(tdma, now_us);
+    int64_t beacon_us = tdma->last_beacon_us;
+    int64_t superframe_us = (int64_t)tdma->superframe_ms * 1000;
+    int64_t offset_us = ((int64_t)tdma->slot_index * tdma->slot_ms + TDMA_GUARD_MS) * 1000;
+    uint32_t fallback_ms = tdma->fallback_period_ms;
+    portEXIT_CRITICAL(&tdma->lock);
+
+    if (synced) {
+        // First slot start after now, projected forward from the last beacon
+        int64_t t = beacon_us + offset_us;
+        if (t <= now_us) {
+            t += ((now_us - t) / superframe_us + 1) * superframe_us;
+        }
+        return t;
+    }
+
+    int32_t jitter_range_ms = (int32_t)(fallback_ms * TDMA_FALLBACK_JITTER_PCT / 100);
+    int32_t jitter_ms = 0;
+    if (jitter_range_ms > 0) {
+        jitter_ms = (int32_t)(esp_random() % (uint32_t)(2 * jitter_range_ms + 1)) - jitter_range_ms;
+    }
+    return now_us + ((int64_t)fallback_ms + jitter_ms) * 1000;
+}
+
+// --- Master-Side Slot Table ---
+
+void tdma_master_init(tdma_master_t* tdma, uint16_t slot_ms, uint16_t min_superframe_ms) {
+    memset(tdma, 0, sizeof(*tdma));
+    tdma->slot_ms = slot_ms;
+    tdma->min_superframe_ms = min_superframe_ms;
+}
+
+int tdma_master_assign(tdma_master_t* tdma, const uint8_t mac[6]) {
+    int free_slot = -1;
+    int expired_slot = -1;
+
+    for (int i = 0; i < TDMA_MAX_SLAVES; i++) {
+        tdma_slot_entry_t* e = &tdma->slots[i];
+        if (e->in_use && memcmp(e->mac, mac, 6) == 0) {
+            e->last_seen_superframe = tdma->superframe;
+            return i;
+        }
+        if (!e->in_use) {
+            if (free_slot < 0) free_slot = i;
+        } else if (expired_slot < 0 &&
+                   tdma->superframe - e->last_seen_superframe > TDMA_SLOT_EXPIRY_SUPERFRAMES) {
+            expired_slot = i;
+        }
+    }
+
+    // Prefer never-used low slots so the superframe stays short
+    int slot = free_slot >= 0 ? free_slot : expired_slot;
+    if (slot < 0) return -1;
+
+    tdma_slot_entry_t* e = &tdma->slots[slot];
+    memcpy(e->mac, mac, 6);
+    e->last_seen_superframe = tdma->superframe;
+    e->in_use = true;
+    return slot;
+}
+
+void tdma_master_tick(tdma_master_t* tdma) {
+    tdma->superframe++;
+}
+
+uint16_t tdma_master_slot_count(const tdma_master_t* tdma) {
+    for (int i = TDMA_MAX_SLAVES - 1; i >= 0; i--) {
+        if (tdma->slots[i].in_use) return (uint16_t)(i + 1);
+    }
+    return 0;
+}
+
+uint16_t tdma_master_superframe_ms(const tdma_master_t* tdma) {
+    uint32_t needed = (uint32_t)tdma_master_slot_count(tdma) * tdma->slot_ms;
+    return needed > tdma->min_superframe_ms ? (uint16_t)needed : tdma->min_superframe_ms;
+}
@@ -0,0 +1,126 @@
+#ifndef TDMA_H
+#define TDMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+
+// --- Configuration Constants ---
+
+// Upper bound on slaves one master schedules (one slot each).
+#define TDMA_MAX_SLAVES (64)
+
+// Time (ms) a slave keeps clear at the start of its slot for clock error and beacon jitter.
+#define TDMA_GUARD_MS (4)
+
+// Beacons a slave may miss before it considers itself unsynchronised and falls back to jitter.
+#define TDMA_MAX_MISSED_BEACONS (3)
+
+// Random jitter (+/- percent of the period) applied when unsynchronised, so nodes powered
+// on together drift apart instead of colliding every period.
+#define TDMA_FALLBACK_JITTER_PCT (20)
+
+// Master: a slot whose slave has been silent for this many superframes is reclaimed.
+#define TDMA_SLOT_EXPIRY_SUPERFRAMES (12)
+
+// --- Slave-Side Schedule ---
+
+typedef struct {
+    portMUX_TYPE lock;          // Updated from the Wi-Fi task, read from the sensor task
+    uint32_t fallback_period_ms;// Report period used when no schedule is known
+    bool assigned;              // A slot assignment has been received
+    uint16_t slot_index;
+    uint16_t slot_count;
+    uint16_t slot_ms;
+    uint16_t superframe_ms;
+    int64_t last_beacon_us;     // Local time the last beacon was received (0 = never)
+} tdma_slave_t;
+
+/**
+ * @brief Initialises an unsynchronised schedule that reports every fallback_period_ms with jitter.
+ */
+void tdma_slave_init(tdma_slave_t* tdma, uint32_t fallback_period_ms);
+
+/**
+ * @brief Records a slot assignment from the master.
+ *
+ * @return false (assignment ignored) if slot_index >= slot_count or the slots do not
+ *         fit in the superframe.
+ */
+bool tdma_slave_on_assign(tdma_slave_t* tdma, uint16_t slot_index, uint16_t slot_count,
+                          uint16_t slot_ms, uint16_t superframe_ms);
+
+/**
+ * @brief Records a superframe beacon received at local time rx_us.
+ *
+ * @return false if the beacon is malformed (ignored) or no longer covers the assigned
+ *         slot (the assignment is dropped until the master sends a new one).
+ */
+bool tdma_slave_on_beacon(tdma_slave_t* tdma, uint16_t superframe_ms, uint16_t slot_ms,
+                          uint16_t slot_count, int64_t rx_us);
+
+/**
+ * @brief Checks whether the slave currently has a usable slot and a recent beacon.
+ */
+bool tdma_slave_is_synced(tdma_slave_t* tdma, int64_t now_us);
+
+/**
+ * @brief Computes the local time of the next transmission strictly after now_us.
+ *
+ * When synchronised this is the start of the slave's slot (plus guard) in the next
+ * superframe. Otherwise it is now_us + fallback period +/- random jitter.
+ *
+ * @param tdma Pointer to the schedule.
+ * @param now_us Current local time from esp_timer_get_time().
+ * @return Absolute local time (us) at which to transmit.
+ */
+int64_t tdma_slave_next_tx_us(tdma_slave_t* tdma, int64_t now_us);
+
+// --- Master-Side Slot Table ---
+
+typedef struct {
+    uint8_t mac[6];
+    uint32_t last_seen_superframe;
+    bool in_use;
+} tdma_slot_entry_t;
+
+typedef struct {
+    tdma_slot_entry_t slots[TDMA_MAX_SLAVES];
+    uint16_t slot_ms;            // Width of one slot
+    uint16_t min_superframe_ms;  // Superframe never shrinks below this (the nominal report period)
+    uint32_t superframe;         // Superframes elapsed, advanced by tdma_master_tick()
+} tdma_master_t;
+
+/**
+ * @brief Initialises an empty slot table.
+ *
+ * @param slot_ms Slot width. Must cover one ESP-NOW frame with retries plus TDMA_GUARD_MS.
+ * @param min_superframe_ms Nominal report period; the superframe grows beyond it only when
+ *                          slot_count * slot_ms no longer fits.
+ */
+void tdma_master_init(tdma_master_t* tdma, uint16_t slot_ms, uint16_t min_superframe_ms);
+
+/**
+ * @brief Returns the slot of a slave, allocating (or reclaiming an expired) one if needed.
+ *        Also marks the slave as seen in the current superframe.
+ *
+ * @return Slot index, or -1 if the table is full.
+ */
+int tdma_master_assign(tdma_master_t* tdma, const uint8_t mac[6]);
+
+/**
+ * @brief Advances to the next superframe (call when sending each beacon).
+ */
+void tdma_master_tick(tdma_master_t* tdma);
+
+/**
+ * @brief Number of slots the beacon must advertise (highest used index + 1).
+ */
+uint16_t tdma_master_slot_count(const tdma_master_t* tdma);
+
+/**
+ * @brief Superframe length needed for the current slot count.
+ */
+uint16_t tdma_master_superframe_ms(const tdma_master_t* tdma);
+
+#endif // TDMA_H
@@ -0,0 +1,166 @@
+#include "ts_codec.h"
+#include <string.h>
+
+// --- Bit Stream Helpers ---
+
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t bit_pos;
+    int overflow;
+} bit_writer_t;
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t bit_pos;
+    int underflow;
+} bit_reader_t;
+
+static void bw_put(bit_writer_t *bw, uint32_t value, int nbits) {
+    for (int i = nbits - 1; i >= 0; i--) {
+        size_t byte = bw->bit_pos >> 3;
+        if (byte >= bw->cap) {
+            bw->overflow = 1;
+            return;
+        }
+        uint8_t mask = (uint8_t)(0x80 >> (bw->bit_pos & 7));
+        if ((value >> i) & 1u) {
+            bw->buf[byte] |= mask;
+        } else {
+            bw->buf[byte] &= (uint8_t)~mask;
+        }
+        bw->bit_pos++;
+    }
+}
+
+static uint32_t br_get(bit_reader_t *br, int nbits) {
+    uint32_t value = 0;
+    for (int i = 0; i < nbits; i++) {
+        size_t byte = br->bit_pos >> 3;
+        if (byte >= br->len) {
+            br->underflow = 1;
+            return 0;
+        }
+        value = (value << 1) | ((br->buf[byte] >> (7 - (br->bit_pos & 7))) & 1u);
+        br->bit_pos++;
+    }
+    return value;
+}
+
+static int clz32(uint32_t x) { return x ? __builtin_clz(x) : 32; }
+static int ctz32(uint32_t x) { return x ? __builtin_ctz(x) : 32; }
+
+static uint32_t float_bits(float f) { uint32_t u; memcpy(&u, &f, sizeof(u)); return u; }
+static float bits_float(uint32_t u) { float f; memcpy(&f, &u, sizeof(f)); return f; }
+
+// --- Integer Series ---
+
+size_t tsc_encode_ints(const int32_t *values, size_t n, uint8_t *out, size_t cap) {
+    size_t pos = 0;
+    int32_t prev = 0;
+    for (size_t i = 0; i < n; i++) {
+        int32_t delta = (int32_t)((uint32_t)values[i] - (uint32_t)prev);
+        uint32_t zz = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+        prev = values[i];
+        do {
+            if (pos >= cap) return 0;
+            uint8_t byte = zz & 0x7F;
+            zz >>= 7;
+            out[pos++] = byte | (zz ? 0x80 : 0);
+        } while (zz);
+    }
+    return pos;
+}
+
+size_t tsc_decode_ints(const uint8_t *in, size_t len, int32_t *values, size_t n) {
+    size_t pos = 0;
+    int32_t prev = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t zz = 0;
+        int shift = 0;
+        uint8_t byte;
+        do {
+            if (pos >= len || shift > 28) return 0;
+            byte = in[pos++];
+            zz |= (uint32_t)(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        int32_t delta = (int32_t)(zz >> 1) ^ -(int32_t)(zz & 1);
+        prev = (int32_t)((uint32_t)prev + (uint32_t)delta);
+        values[i] = prev;
+    }
+    return pos;
+}
+
+// --- Float Series ---
+
+size_t tsc_encode_floats(const float *values, size_t n, uint8_t *out, size_t cap) {
+    if (n == 0) return 0;
+    bit_writer_t bw = { out, cap, 0, 0 };
+    uint32_t prev = float_bits(values[0]);
+    int prev_lead = -1, prev_trail = 0; // No window yet
+
+    bw_put(&bw, prev, 32);
+    for (size_t i = 1; i < n && !bw.overflow; i++) {
+        uint32_t cur = float_bits(values[i]);
+        uint32_t x = cur ^ prev;
+        prev = cur;
+        if (x == 0) {
+            bw_put(&bw, 0, 1);
+            continue;
+        }
+        int lead = clz32(x);
+        int trail = ctz32(x);
+        if (lead > 31) lead = 31; // 5-bit field
+        if (prev_lead >= 0 && lead >= prev_lead && trail >= prev_trail) {
+            // Fits in the previous window: '10' + window bits
+            int width = 32 - prev_lead - prev_trail;
+            bw_put(&bw, 2, 2);
+            bw_put(&bw, x >> prev_trail, width);
+        } else {
+            // New window: '11' + 5-bit leading zeros + 5-bit (width - 1) + window bits
+            int width = 32 - lead - trail;
+            bw_put(&bw, 3, 2);
+            bw_put(&bw, (uint32_t)lead, 5);
+            bw_put(&bw, (uint32_t)(width - 1), 5);
+            bw_put(&bw, x >> trail, width);
+            prev_lead = lead;
+            prev_trail = trail;
+        }
+    }
+    if (bw.overflow) return 0;
+    return (bw.bit_pos + 7) >> 3;
+}
+
+size_t tsc_decode_floats(const uint8_t *in, size_t len, float *values, size_t n) {
+    if (n == 0) return 0;
+    bit_reader_t br = { in, len, 0, 0 };
+    uint32_t prev = br_get(&br, 32);
+    int prev_lead = 0, prev_trail = 0;
+    values[0] = bits_float(prev);
+
+    for (size_t i = 1; i < n && !br.underflow; i++) {
+        if (br_get(&br, 1) == 0) {
+            values[i] = bits_float(prev);
+            continue;
+        }
+        uint32_t x;
+        if (br_get(&br, 1) == 0) {
+            int width = 32 - prev_lead - prev_trail;
+            x = br_get(&br, width) << prev_trail;
+        } else {
+            int lead = (int)br_get(&br, 5);
+            int width = (int)br_get(&br, 5) + 1;
+            int trail = 32 - lead - width;
+            if (trail < 0) return 0; // Corrupt window
+            x = br_get(&br, width) << trail;
+            prev_lead = lead;
+            prev_trail = trail;
+        }
+        prev ^= x;
+        values[i] = bits_float(prev);
+    }
+    if (br.underflow) return 0;
+    return (br.bit_pos + 7) >> 3;
+}
@@ -0,0 +1,62 @@
+#ifndef TS_CODEC_H
+#define TS_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Compression for short batches of slowly changing time series.
+//
+// Integers: each value is stored as the zigzag-encoded delta to the previous one
+// (the first against 0) in LEB128 varint form, so a steady temperature costs one byte.
+//
+// Floats: XOR with the previous value, Gorilla style. An identical value costs one bit;
+// otherwise only the meaningful (non-zero) bit window of the XOR is stored, reusing the
+// previous window when it still fits. The bit stream is padded to a whole byte.
+//
+// Decoders are told the value count, so series can be concatenated without length
+// prefixes. All functions return the number of bytes written or consumed, or 0 if the
+// output buffer is too small / the input is truncated.
+
+/**
+ * @brief Worst-case encoded size of n int32 values (5 bytes each).
+ */
+#define TSC_INT_SERIES_MAX_BYTES(n)   ((size_t)(n) * 5)
+
+/**
+ * @brief Worst-case encoded size of n float values (32 bits first, then 44 bits each).
+ */
+#define TSC_FLOAT_SERIES_MAX_BYTES(n) (((size_t)(n) * 44 + 7) / 8 + 1)
+
+/**
+ * @brief Delta + zigzag + varint encodes n integers.
+ *
+ * @param values Input series.
+ * @param n Number of values.
+ * @param out Output buffer.
+ * @param cap Output buffer size in bytes.
+ * @return Bytes written, or 0 if cap is too small.
+ */
+size_t tsc_encode_ints(const int32_t *values, size_t n, uint8_t *out, size_t cap);
+
+/**
+ * @brief Decodes n integers written by tsc_encode_ints.
+ *
+ * @return Bytes consumed, or 0 if the input is truncated or malformed.
+ */
+size_t tsc_decode_ints(const uint8_t *in, size_t len, int32_t *values, size_t n);
+
+/**
+ * @brief XOR-compresses n floats.
+ *
+ * @return Bytes written, or 0 if cap is too small.
+ */
+size_t tsc_encode_floats(const float *values, size_t n, uint8_t *out, size_t cap);
+
+/**
+ * @brief Decodes n floats written by tsc_encode_floats.
+ *
+ * @return Bytes consumed, or 0 if the input is truncated.
+ */
+size_t tsc_decode_floats(const uint8_t *in, size_t len, float *values, size_t n);
+
+#endif // TS_CODEC_H
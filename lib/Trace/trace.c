@@ -0,0 +1,55 @@
+#include "trace.h"
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "TRACE";
+
+static const char *const trace_hop_names[TRACE_HOP_COUNT] = {
+    [TRACE_HOP_QUEUE] = "queue",
+    [TRACE_HOP_MAC] = "mac",
+    [TRACE_HOP_DELIVERY] = "delivery",
+    [TRACE_HOP_UPLINK] = "uplink",
+    [TRACE_HOP_TOTAL] = "total",
+};
+
+void trace_init(trace_t* trace) {
+    memset(trace, 0, sizeof(*trace));
+}
+
+void trace_record(trace_t* trace, trace_hop_t hop, int64_t latency_us) {
+    if (hop >= TRACE_HOP_COUNT) return;
+    trace_hist_t* h = &trace->hops[hop];
+    uint32_t us = latency_us <= 0 ? 0 : latency_us >= UINT32_MAX ? UINT32_MAX : (uint32_t)latency_us;
+    int bucket = us < 2 ? 0 : 31 - __builtin_clz(us);
+    if (bucket >= TRACE_BUCKETS) bucket = TRACE_BUCKETS - 1;
+    h->buckets[bucket]++;
+    h->count++;
+    h->sum_us += us;
+    if (us > h->max_us) h->max_us = us;
+}
+
+uint32_t trace_percentile_us(const trace_hist_t* hist, uint32_t pct) {
+    if (hist->count == 0) return 0;
+    uint64_t rank = ((uint64_t)hist->count * pct + 99) / 100; // 1-based rank of the sample
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < TRACE_BUCKETS - 1; b++) {
+        seen += hist->buckets[b];
+        if (seen >= rank) {
+            uint32_t edge = (2u << b) - 1;
+            return edge < hist->max_us ? edge : hist->max_us;
+        }
+    }
+    return hist->max_us;
+}
+
+void trace_log(const trace_t* trace) {
+    for (int hop = 0; hop < TRACE_HOP_COUNT; hop++) {
+        const trace_hist_t* h = &trace->hops[hop];
+        if (h->count == 0) continue;
+        ESP_LOGI(TAG, "%-8s n=%lu mean=%llu us p50<=%lu p90<=%lu p99<=%lu max=%lu us", trace_hop_names[hop],
+                 (unsigned long)h->count, (unsigned long long)(h->sum_us / h->count),
+                 (unsigned long)trace_percentile_us(h, 50), (unsigned long)trace_percentile_us(h, 90),
+                 (unsigned long)trace_percentile_us(h, 99), (unsigned long)h->max_us);
+    }
+}
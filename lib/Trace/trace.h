@@ -0,0 +1,71 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+// Per-hop latency histograms for a reading's path from sensor to cloud.
+//
+// Trace points, in order: acquisition on the slave (also stamped into the sample
+// on the master's clock, see timesync.h), enqueue (frame handed to ESP-NOW), the
+// send callback (MAC-layer result), receive on the master, and uplink. The slave
+// records the first two hops locally; the master records the rest from the
+// synchronised sample stamps and its own clock.
+//
+// Buckets are powers of two in microseconds, so one histogram covers both the
+// millisecond MAC hop and the tens of seconds a sample may wait for its TDMA slot,
+// in fixed memory with no allocation. Percentiles are reported as the upper edge
+// of the bucket they fall in (at most 2x pessimistic). A trace_t has no lock: keep
+// all trace_record() calls in one task.
+
+// --- Configuration Constants ---
+
+// Bucket k holds [2^k, 2^(k+1)) us (bucket 0 also holds 0); the last is open-ended (>= ~67 s).
+#define TRACE_BUCKETS 27
+
+typedef enum {
+    TRACE_HOP_QUEUE = 0,    // slave: acquisition -> enqueue (batching, waiting for the slot)
+    TRACE_HOP_MAC,          // slave: enqueue -> send callback (channel access, retries, ACK)
+    TRACE_HOP_DELIVERY,     // master: acquisition -> master receive (needs a synchronised stamp)
+    TRACE_HOP_UPLINK,       // master: master receive -> uplink accepted
+    TRACE_HOP_TOTAL,        // master: acquisition -> uplink accepted
+    TRACE_HOP_COUNT
+} trace_hop_t;
+
+typedef struct {
+    uint32_t buckets[TRACE_BUCKETS];
+    uint32_t count;
+    uint64_t sum_us;
+    uint32_t max_us;
+} trace_hist_t;
+
+typedef struct {
+    trace_hist_t hops[TRACE_HOP_COUNT];
+} trace_t;
+
+void trace_init(trace_t* trace);
+
+/**
+ * @brief Adds one latency sample to a hop. Negative values (clock jitter) count as 0.
+ */
+void trace_record(trace_t* trace, trace_hop_t hop, int64_t latency_us);
+
+/**
+ * @brief Latency (us) below which pct percent of the samples fall, rounded up to the
+ *        bucket edge and capped at the maximum seen. 0 if the hop has no samples.
+ */
+uint32_t trace_percentile_us(const trace_hist_t* hist, uint32_t pct);
+
+/**
+ * @brief Age in microseconds of a sensor_data_t.timestamp_ms stamp at master time
+ *        now_ms (both truncated to 32 bits; correct across the rollover).
+ */
+static inline int64_t trace_stamp_age_us(uint32_t now_ms, uint32_t stamp_ms) {
+    return (int64_t)(int32_t)(now_ms - stamp_ms) * 1000;
+}
+
+/**
+ * @brief Logs count, mean, p50/p90/p99 and max for every hop that has samples.
+ */
+void trace_log(const trace_t* trace);
+
+#endif // TRACE_H
@@ -0,0 +1,172 @@
+// src/adaptive.c
+#include <math.h>
+#include <string.h>
+#include "esp_log.h"
+#include "nvs.h"
+
+#include "shared_header.h"
+#include "adaptive.h"
+
+static const char *TAG = "ADAPTIVE";
+
+// --- Config Persistence ---
+
+static bool adaptive_config_valid(const adaptive_config_t* cfg) {
+    return cfg->min_period_ms >= ADAPTIVE_PERIOD_FLOOR_MS &&
+           cfg->max_period_ms <= ADAPTIVE_PERIOD_CEIL_MS &&
+           cfg->min_period_ms <= cfg->max_period_ms &&
+           cfg->ppm_slope_per_min > 0 && cfg->ppm_std > 0 &&
+           cfg->temp_slope_per_min > 0 && cfg->temp_std > 0;
+}
+
+static void adaptive_store(const adaptive_config_t* cfg, uint32_t seq) {
+    nvs_handle_t nvs;
+    if (nvs_open(ADAPTIVE_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) return;
+    if (nvs_set_blob(nvs, "limits", cfg, sizeof(*cfg)) != ESP_OK || nvs_set_u32(nvs, "seq", seq) != ESP_OK ||
+        nvs_commit(nvs) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to store sampling limits in NVS.");
+    }
+    nvs_close(nvs);
+}
+
+// Also primes the master's replay window: every sequence number up to the last one applied is spent
+static bool adaptive_load(adaptive_config_t* cfg, fa_replay_t* window) {
+    nvs_handle_t nvs;
+    if (nvs_open(ADAPTIVE_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) return false;
+    uint32_t seq;
+    if (nvs_get_u32(nvs, "seq", &seq) == ESP_OK) {
+        window->primed = true;
+        window->top = seq;
+        window->seen = UINT64_MAX;
+    }
+    adaptive_config_t stored;
+    size_t len = sizeof(stored);
+    esp_err_t ret = nvs_get_blob(nvs, "limits", &stored, &len);
+    nvs_close(nvs);
+    if (ret != ESP_OK || len != sizeof(stored) || !adaptive_config_valid(&stored)) return false;
+    *cfg = stored;
+    return true;
+}
+
+// --- Signal Estimation ---
+
+// Updates mean/variance/slope EMAs and returns how far past its triggers the signal is (>= 1 = active)
+static float signal_update(adaptive_signal_t* s, float x, int64_t now_us, float slope_trigger, float std_trigger) {
+    if (isnan(x)) return 0.0f;
+    if (!s->primed) {
+        s->primed = true;
+        s->mean = x;
+        s->var = 0.0f;
+        s->slope_per_min = 0.0f;
+        s->last = x;
+        s->last_us = now_us;
+        return 0.0f;
+    }
+
+    float dt_min = (float)(now_us - s->last_us) / 60e6f;
+    if (dt_min > 0.0f) {
+        float slope = (x - s->last) / dt_min;
+        s->slope_per_min += ADAPTIVE_EMA_ALPHA * (slope - s->slope_per_min);
+    }
+    float diff = x - s->mean;
+    s->mean += ADAPTIVE_EMA_ALPHA * diff;
+    s->var = (1.0f - ADAPTIVE_EMA_ALPHA) * (s->var + ADAPTIVE_EMA_ALPHA * diff * diff);
+    s->last = x;
+    s->last_us = now_us;
+
+    float slope_score = fabsf(s->slope_per_min) / slope_trigger;
+    float std_score = sqrtf(s->var) / std_trigger;
+    return slope_score > std_score ? slope_score : std_score;
+}
+
+// --- Public API ---
+
+void adaptive_init(adaptive_t* ad, const adaptive_config_t* defaults) {
+    memset(ad, 0, sizeof(*ad));
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    ad->lock = unlocked;
+    ad->cfg = *defaults;
+    if (adaptive_load(&ad->cfg, &ad->master_window)) {
+        ESP_LOGI(TAG, "Using stored sampling limits: %lu-%lu ms", (unsigned long)ad->cfg.min_period_ms, (unsigned long)ad->cfg.max_period_ms);
+    }
+    ad->period_ms = ad->cfg.max_period_ms;
+}
+
+uint32_t adaptive_update(adaptive_t* ad, float smoke_ppm, float temperature, int64_t now_us) {
+    // Pick up limits received over the radio
+    adaptive_config_t pending;
+    uint32_t pending_seq = 0;
+    bool have_pending = false;
+    portENTER_CRITICAL(&ad->lock);
+    if (ad->pending_valid) {
+        pending = ad->pending;
+        pending_seq = ad->pending_seq;
+        ad->pending_valid = false;
+        have_pending = true;
+    }
+    portEXIT_CRITICAL(&ad->lock);
+    if (have_pending) {
+        ad->cfg = pending;
+        adaptive_store(&pending, pending_seq);
+        ESP_LOGI(TAG, "Applied new sampling limits: %lu-%lu ms", (unsigned long)pending.min_period_ms, (unsigned long)pending.max_period_ms);
+    }
+
+    if (smoke_ppm < 0) smoke_ppm = NAN; // MQ2 error codes are negative
+    float score = signal_update(&ad->ppm, smoke_ppm, now_us, ad->cfg.ppm_slope_per_min, ad->cfg.ppm_std);
+    float temp_score = signal_update(&ad->temp, temperature, now_us, ad->cfg.temp_slope_per_min, ad->cfg.temp_std);
+    if (temp_score > score) score = temp_score;
+    if (score > 1.0f) score = 1.0f;
+
+    // Linear between the limits; faster immediately, slower only gradually
+    float span = (float)(ad->cfg.max_period_ms - ad->cfg.min_period_ms);
+    uint32_t target = ad->cfg.max_period_ms - (uint32_t)(span * score);
+    uint32_t backoff = (uint32_t)((float)ad->period_ms * ADAPTIVE_BACKOFF_FACTOR);
+    uint32_t period = target < ad->period_ms ? target : (target < backoff ? target : backoff);
+    if (period < ad->cfg.min_period_ms) period = ad->cfg.min_period_ms;
+    if (period > ad->cfg.max_period_ms) period = ad->cfg.max_period_ms;
+
+    if (period != ad->period_ms) {
+        ESP_LOGD(TAG, "Sampling period %lu -> %lu ms (activity %.2f)", (unsigned long)ad->period_ms, (unsigned long)period, score);
+    }
+    ad->period_ms = period;
+    return period;
+}
+
+static esp_err_t adaptive_queue(adaptive_t* ad, const adaptive_config_t* cfg, uint32_t seq) {
+    if (cfg == NULL || !adaptive_config_valid(cfg)) return ESP_ERR_INVALID_ARG;
+    portENTER_CRITICAL(&ad->lock);
+    ad->pending = *cfg;
+    ad->pending_seq = seq;
+    ad->pending_valid = true;
+    portEXIT_CRITICAL(&ad->lock);
+    return ESP_OK;
+}
+
+esp_err_t adaptive_set_config(adaptive_t* ad, const adaptive_config_t* cfg) {
+    return adaptive_queue(ad, cfg, ad->master_window.top);
+}
+
+bool adaptive_handle_frame(adaptive_t* ad, const uint8_t* data, int len) {
+    if (!ctrl_frame_is(data, len, CTRL_SAMPLING_CONFIG, sizeof(sampling_config_frame_t) + FA_TRAILER_LEN)) return false;
+    esp_err_t ret = auth_verify(data, len, &ad->master_window);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Sampling config failed authentication (%s), ignored.", esp_err_to_name(ret));
+        return true;
+    }
+
+    sampling_config_frame_t frame;
+    memcpy(&frame, data, sizeof(frame));
+    adaptive_config_t cfg = {
+        .min_period_ms = frame.min_period_ms,
+        .max_period_ms = frame.max_period_ms,
+        .ppm_slope_per_min = frame.ppm_slope_per_min,
+        .ppm_std = frame.ppm_std,
+        .temp_slope_per_min = frame.temp_slope_per_min,
+        .temp_std = frame.temp_std,
+    };
+    if (adaptive_queue(ad, &cfg, ad->master_window.top) != ESP_OK) {
+        ESP_LOGW(TAG, "Rejected sampling config %lu-%lu ms (limits %d-%d ms).", (unsigned long)cfg.min_period_ms,
+                 (unsigned long)cfg.max_period_ms, ADAPTIVE_PERIOD_FLOOR_MS, ADAPTIVE_PERIOD_CEIL_MS);
+    }
+    return true;
+}
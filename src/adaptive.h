@@ -0,0 +1,87 @@
+// adaptive.h
+#ifndef ADAPTIVE_H
+#define ADAPTIVE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "esp_now.h"
+
+#include "auth.h"
+#include "tdma.h"
+
+// --- Configuration ---
+#define ADAPTIVE_NVS_NAMESPACE   "sampling"
+#define ADAPTIVE_EMA_ALPHA       (0.3f) // Weight of the newest sample in the mean/variance/slope estimates
+#define ADAPTIVE_BACKOFF_FACTOR  (1.5f) // Period may grow at most this much per sample (speed-ups are immediate)
+#define ADAPTIVE_PERIOD_FLOOR_MS 1000   // Hard lower bound: one MQ2 read (~200 ms) plus headroom
+#define ADAPTIVE_SUPERFRAME_MS   5000   // Shortest superframe the master runs (its nominal report period)
+// Hard upper bound: half the master's TDMA slot expiry at the shortest superframe, so
+// a slave sampling this slowly can lose a sample and still keep its slot
+#define ADAPTIVE_PERIOD_CEIL_MS  (TDMA_SLOT_EXPIRY_SUPERFRAMES * ADAPTIVE_SUPERFRAME_MS / 2)
+
+typedef struct {
+    uint32_t min_period_ms;
+    uint32_t max_period_ms;
+    float ppm_slope_per_min;
+    float ppm_std;
+    float temp_slope_per_min;
+    float temp_std;
+} adaptive_config_t;
+
+// Running estimate for one signal
+typedef struct {
+    bool primed;
+    float mean;
+    float var;
+    float slope_per_min;
+    float last;
+    int64_t last_us;
+} adaptive_signal_t;
+
+typedef struct {
+    adaptive_config_t cfg;
+    adaptive_signal_t ppm;
+    adaptive_signal_t temp;
+    uint32_t period_ms;
+
+    // Config received over ESP-NOW, applied (and written to NVS) by the sampling task
+    portMUX_TYPE lock;
+    bool pending_valid;
+    adaptive_config_t pending;
+    uint32_t pending_seq;       // Master's sequence number to persist with it
+    fa_replay_t master_window;  // Wi-Fi task only; primed from NVS so a reboot does not reopen old frames
+} adaptive_t;
+
+/**
+ * @brief Initialises the controller with defaults, overridden by limits stored in NVS.
+ *        Starts at defaults->max_period_ms. NVS must already be initialised.
+ */
+void adaptive_init(adaptive_t* ad, const adaptive_config_t* defaults);
+
+/**
+ * @brief Feeds one sample and returns the period (ms) until the next one.
+ *        Also applies any config received via adaptive_handle_frame().
+ *
+ * @param ad Controller.
+ * @param smoke_ppm MQ2 smoke reading, NAN or negative if unavailable.
+ * @param temperature DHT temperature, NAN if unavailable.
+ * @param now_us esp_timer_get_time() at acquisition.
+ */
+uint32_t adaptive_update(adaptive_t* ad, float smoke_ppm, float temperature, int64_t now_us);
+
+/**
+ * @brief Validates limits and queues them for the sampling task (persisted on apply).
+ * @return ESP_ERR_INVALID_ARG if the limits are inconsistent or out of the hard bounds.
+ */
+esp_err_t adaptive_set_config(adaptive_t* ad, const adaptive_config_t* cfg);
+
+/**
+ * @brief Handles a CTRL_SAMPLING_CONFIG frame. Only frames that pass auth_verify()
+ *        against the master's replay window are applied. Safe to call from the Wi-Fi task.
+ * @return true if the frame was a sampling config frame (consumed), false otherwise.
+ */
+bool adaptive_handle_frame(adaptive_t* ad, const uint8_t* data, int len);
+
+#endif // ADAPTIVE_H
@@ -0,0 +1,154 @@
+// src/auth.c
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_random.h"
+#include "nvs.h"
+
+#include "auth.h"
+
+static const char *TAG = "AUTH";
+
+static fa_key_t frame_key;
+static bool have_key;           // No key, no signing: there is no built-in fallback
+static fa_key_t group_key;      // Site-wide, for broadcast frames
+static bool have_group_key;
+static uint32_t next_seq;
+static uint32_t reserved_until; // next_seq may be used up to (not including) this value
+
+// --- Sequence Reservation ---
+// The counter survives reboots by persisting a reservation ahead of use: after a reset
+// the slave resumes at the last reserved value, so a sequence number is never reused.
+
+static esp_err_t auth_reserve(uint32_t from) {
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(AUTH_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret != ESP_OK) return ret;
+    uint32_t until = from + AUTH_SEQ_RESERVE;
+    ret = nvs_set_u32(nvs, "seq", until);
+    if (ret == ESP_OK) ret = nvs_commit(nvs);
+    nvs_close(nvs);
+    if (ret == ESP_OK) reserved_until = until;
+    return ret;
+}
+
+// Parses CONFIG_SLAVE_AUTH_SITE_KEY (32 hex digits); false if unset or malformed
+static bool auth_config_site_key(uint8_t out[FA_KEY_LEN]) {
+    const char *hex = CONFIG_SLAVE_AUTH_SITE_KEY;
+    if (strlen(hex) != 2 * FA_KEY_LEN) {
+        if (hex[0] != '\0') ESP_LOGE(TAG, "CONFIG_SLAVE_AUTH_SITE_KEY must be %d hex digits.", 2 * FA_KEY_LEN);
+        return false;
+    }
+    for (int i = 0; i < 2 * FA_KEY_LEN; i++) {
+        char c = hex[i];
+        int nibble = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+        if (nibble < 0) {
+            ESP_LOGE(TAG, "CONFIG_SLAVE_AUTH_SITE_KEY is not hex.");
+            return false;
+        }
+        out[i / 2] = (uint8_t)(i % 2 ? out[i / 2] | nibble : nibble << 4);
+    }
+    return true;
+}
+
+esp_err_t auth_init(void) {
+    uint8_t key_bytes[FA_KEY_LEN];
+    uint8_t group_bytes[FA_KEY_LEN];
+    size_t key_len = sizeof(key_bytes);
+    size_t group_len = sizeof(group_bytes);
+    uint32_t stored_seq = 0;
+    bool provisioned = false;
+
+    nvs_handle_t nvs;
+    if (nvs_open(AUTH_NVS_NAMESPACE, NVS_READONLY, &nvs) == ESP_OK) {
+        provisioned = nvs_get_blob(nvs, "key", key_bytes, &key_len) == ESP_OK && key_len == FA_KEY_LEN;
+        have_group_key = nvs_get_blob(nvs, "gkey", group_bytes, &group_len) == ESP_OK && group_len == FA_KEY_LEN;
+        nvs_get_u32(nvs, "seq", &stored_seq);
+        nvs_close(nvs);
+    }
+
+    if (provisioned) {
+        fa_key_from_bytes(&frame_key, key_bytes);
+        have_key = true;
+        if (have_group_key) fa_key_from_bytes(&group_key, group_bytes);
+    } else if (auth_config_site_key(key_bytes)) {
+        uint8_t mac[6];
+        fa_key_t site;
+        esp_read_mac(mac, ESP_MAC_WIFI_STA);
+        fa_key_from_bytes(&site, key_bytes);
+        fa_derive_key(&site, mac, &frame_key);
+        fa_derive_group_key(&site, &group_key);
+        memset(&site, 0, sizeof(site));
+        have_key = true;
+        have_group_key = true;
+        ESP_LOGW(TAG, "No provisioned key, using keys derived from CONFIG_SLAVE_AUTH_SITE_KEY.");
+    }
+    memset(key_bytes, 0, sizeof(key_bytes));
+    memset(group_bytes, 0, sizeof(group_bytes));
+    if (!have_key) {
+        have_group_key = false;
+        ESP_LOGE(TAG, "No frame key: provision \"%s\"/\"key\" in NVS (tools/provision_keys.py) or set "
+                 "CONFIG_SLAVE_AUTH_SITE_KEY. Frames will not be signed or sent.", AUTH_NVS_NAMESPACE);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!have_group_key) {
+        ESP_LOGE(TAG, "No group key (\"%s\"/\"gkey\"): slot beacons and time sync will be ignored.",
+                 AUTH_NVS_NAMESPACE);
+    }
+
+    next_seq = stored_seq;
+    esp_err_t ret = auth_reserve(next_seq);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to reserve frame sequence numbers: %s", esp_err_to_name(ret));
+        reserved_until = UINT32_MAX; // Keep signing; the master may reject frames after a reboot
+    }
+    ESP_LOGI(TAG, "Frame authentication ready, sequence resumes at %lu.", (unsigned long)next_seq);
+    return ret;
+}
+
+// Both keys share the sequence counter: it never repeats, and receivers keep a window per key
+static size_t auth_sign_with(const fa_key_t* key, uint8_t* frame, size_t len, size_t cap) {
+    if (next_seq >= reserved_until && reserved_until != UINT32_MAX) {
+        if (auth_reserve(next_seq) != ESP_OK) {
+            ESP_LOGW(TAG, "Sequence reservation not persisted; continuing in RAM.");
+            reserved_until = next_seq + AUTH_SEQ_RESERVE;
+        }
+    }
+    size_t signed_len = fa_sign(key, next_seq, frame, len, cap);
+    if (signed_len > 0) next_seq++;
+    return signed_len;
+}
+
+size_t auth_sign(uint8_t* frame, size_t len, size_t cap) {
+    if (!have_key) return 0;
+    return auth_sign_with(&frame_key, frame, len, cap);
+}
+
+size_t auth_sign_group(uint8_t* frame, size_t len, size_t cap) {
+    if (!have_group_key) return 0;
+    return auth_sign_with(&group_key, frame, len, cap);
+}
+
+void auth_use_ephemeral_key(void) {
+    uint8_t key_bytes[FA_KEY_LEN];
+    esp_fill_random(key_bytes, sizeof(key_bytes));
+    fa_key_from_bytes(&frame_key, key_bytes);
+    esp_fill_random(key_bytes, sizeof(key_bytes));
+    fa_key_from_bytes(&group_key, key_bytes);
+    memset(key_bytes, 0, sizeof(key_bytes));
+    have_key = true;
+    have_group_key = true;
+    ESP_LOGW(TAG, "Using random frame keys for this boot; no master will accept these frames.");
+}
+
+esp_err_t auth_verify(const uint8_t* frame, size_t len, fa_replay_t* window) {
+    if (!have_key) return ESP_ERR_INVALID_STATE;
+    fa_replay_t any = { 0 }; // Unprimed: accepts any sequence number once
+    return fa_verify(&frame_key, window != NULL ? window : &any, frame, len, NULL);
+}
+
+esp_err_t auth_verify_group(const uint8_t* frame, size_t len, fa_replay_t* window) {
+    if (!have_group_key) return ESP_ERR_INVALID_STATE;
+    return fa_verify(&group_key, window, frame, len, NULL);
+}
@@ -0,0 +1,73 @@
+// auth.h
+#ifndef AUTH_H
+#define AUTH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#include "frame_auth.h"
+
+// --- Configuration ---
+#define AUTH_NVS_NAMESPACE "auth"
+#define AUTH_SEQ_RESERVE   1024 // Sequence numbers reserved per NVS write (a reboot skips at most this many)
+
+/**
+ * @brief Loads this slave's frame key, the site's group key and the sequence counter.
+ *        The keys come from NVS ("auth"/"key" and "auth"/"gkey", 16 bytes each, written
+ *        at provisioning: tools/provision_keys.py) or, if absent, are derived from
+ *        CONFIG_SLAVE_AUTH_SITE_KEY (and the station MAC). There is no built-in key:
+ *        without either, nothing is signed or verified. NVS must already be initialised.
+ *
+ * @return ESP_OK; ESP_ERR_INVALID_STATE if no key is provisioned; or the NVS error if
+ *         the sequence counter could not be reserved (frames are still signed, but
+ *         may be rejected as replays after a reboot).
+ */
+esp_err_t auth_init(void);
+
+/**
+ * @brief Signs with random keys for this boot. For test builds without a real master
+ *        (SOAK_MODE), so they run without a provisioned key.
+ */
+void auth_use_ephemeral_key(void);
+
+/**
+ * @brief Appends the sequence number and tag to an outgoing frame. Call from one task only.
+ *
+ * @param frame Buffer holding the payload, with FA_TRAILER_LEN bytes of room.
+ * @param len Payload length.
+ * @param cap Buffer size.
+ * @return Signed length, or 0 if the buffer is too small or no key is provisioned.
+ */
+size_t auth_sign(uint8_t* frame, size_t len, size_t cap);
+
+/**
+ * @brief As auth_sign(), with the site's group key: for frames every slave of the site
+ *        checks (route adverts). Call from the same task as auth_sign().
+ * @return Signed length, or 0 if the buffer is too small or there is no group key.
+ */
+size_t auth_sign_group(uint8_t* frame, size_t len, size_t cap);
+
+/**
+ * @brief Checks a frame the master signed for this slave (with this slave's key).
+ *        Safe to call from the Wi-Fi task.
+ *
+ * @param frame Received frame, payload followed by the FA_TRAILER_LEN trailer.
+ * @param len Received length.
+ * @param window Replay window of the sender, or NULL when the payload carries its own
+ *        freshness (e.g. the nonce of a pairing reply) and only the tag is checked.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE without a key, or the fa_verify() error.
+ */
+esp_err_t auth_verify(const uint8_t* frame, size_t len, fa_replay_t* window);
+
+/**
+ * @brief Checks a frame broadcast under the site's group key (slot beacons, time sync,
+ *        route adverts).
+ *        Safe to call from the Wi-Fi task.
+ *
+ * @param window Replay window of the sender.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE without a group key, or the fa_verify() error.
+ */
+esp_err_t auth_verify_group(const uint8_t* frame, size_t len, fa_replay_t* window);
+
+#endif // AUTH_H
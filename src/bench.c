@@ -0,0 +1,963 @@
+// src/bench.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "nvs.h"
+#ifndef CONFIG_LWIP_MAX_SOCKETS
+#include <sys/resource.h>
+#endif
+
+#include "sensors.h"
+#if SENSOR_HAS_DHT11
+#include "DHT.h"
+#endif
+#if SENSOR_HAS_MQ2
+#include "MQ2.h"
+#endif
+#include "shared_header.h"
+#include "sample_batch.h"
+#include "ts_codec.h"
+#include "bench_codec_trace.h"
+#include "rules.h"
+#include "frame_auth.h"
+#include "history.h"
+#include "oled.h"
+#include "trace.h"
+#include "detect.h"
+#include "live.h"
+#include "journal.h"
+#include "motion.h"
+#include "memstats.h"
+#include "bench.h"
+
+static const char *TAG = "BENCH";
+
+#define BENCH_NVS_NAMESPACE "bench"
+
+// Sink for kernel results so the compiler cannot drop the calls being timed
+static volatile float bench_sink_f;
+static volatile int bench_sink_i;
+
+// --- Kernel Fixtures ---
+
+#if SENSOR_HAS_MQ2
+static MQ2 bench_mq2;
+#endif
+#if SENSOR_HAS_DHT11
+static int16_t bench_dht_pulses[DHT11_FRAME_BITS];
+static uint8_t bench_dht_bytes[5];
+#endif
+static sensor_data_t bench_sample;
+static uint8_t bench_frame[sizeof(sensor_data_t)];
+// The codec trace cut into batch frames as the slave sends them, encoded back to back
+#define BENCH_CODEC_FRAMES ((BENCH_CODEC_TRACE_SAMPLES + SAMPLE_BATCH_MAX - 1) / SAMPLE_BATCH_MAX)
+static uint8_t *bench_codec_frames;
+static uint16_t bench_codec_offsets[BENCH_CODEC_FRAMES + 1];
+static uint8_t bench_batch_frame[SAMPLE_BATCH_MAX_FRAME_BYTES]; // The trace's first frame
+static size_t bench_batch_len;
+static fa_key_t bench_key;
+static uint8_t bench_signed[SAMPLE_BATCH_MAX_FRAME_BYTES + FA_TRAILER_LEN];
+static size_t bench_signed_len;
+static detect_t bench_detector;
+
+// Rule engine sized like a large site: 500 rules evaluated for frames from 50 slaves
+#define BENCH_RULES  500
+#define BENCH_SLAVES 50
+static rules_engine_t *bench_rules = NULL;
+
+// Motion correlation over a warehouse of BENCH_MOTION_SIDE x BENCH_MOTION_SIDE aisle
+// sections, one PIR each, 10 m apart
+#define BENCH_MOTION_SIDE  8
+#define BENCH_MOTION_ZONES (BENCH_MOTION_SIDE * BENCH_MOTION_SIDE)
+#define BENCH_MOTION_EDGES (2 * BENCH_MOTION_SIDE * (BENCH_MOTION_SIDE - 1))
+static motion_engine_t *bench_motion = NULL;
+static int64_t bench_motion_t_ms;
+static const motion_config_t bench_motion_cfg = { .dwell_ms = 3000, .track_timeout_ms = 30000, .alert_zones = 2 };
+
+static esp_err_t bench_motion_create(motion_engine_t **out) {
+    static motion_edge_t edges[BENCH_MOTION_EDGES];
+    static motion_pos_t pos[BENCH_MOTION_ZONES];
+    int n = 0;
+    for (int z = 0; z < BENCH_MOTION_ZONES; z++) {
+        int row = z / BENCH_MOTION_SIDE, col = z % BENCH_MOTION_SIDE;
+        pos[z] = (motion_pos_t){ col * 10.0f, row * 10.0f };
+        // 10 m takes at least 3 s at a run; more than 20 s between hits means someone else
+        if (col + 1 < BENCH_MOTION_SIDE) edges[n++] = (motion_edge_t){ z, z + 1, 3000, 20000 };
+        if (row + 1 < BENCH_MOTION_SIDE) edges[n++] = (motion_edge_t){ z, z + BENCH_MOTION_SIDE, 3000, 20000 };
+    }
+    return motion_create(edges, n, pos, BENCH_MOTION_ZONES, &bench_motion_cfg, out);
+}
+
+// Samples in batch frame f of the codec trace (the last one may be short)
+static size_t bench_codec_count(size_t f) {
+    size_t left = BENCH_CODEC_TRACE_SAMPLES - f * SAMPLE_BATCH_MAX;
+    return left < SAMPLE_BATCH_MAX ? left : SAMPLE_BATCH_MAX;
+}
+
+static void bench_fixtures_init(void) {
+#if SENSOR_HAS_MQ2
+    memset(&bench_mq2, 0, sizeof(bench_mq2));
+    bench_mq2.rl_value = RL_VALUE;
+    bench_mq2.ro_clean_air_factor = RO_CLEAN_AIR_FACTOR;
+    bench_mq2.Ro = 10.0f;
+    bench_mq2.ambient = NAN;
+    bench_mq2.ro_track.ro_calibrated = bench_mq2.Ro;
+#endif
+
+#if SENSOR_HAS_DHT11
+    // 55 %RH, 23 C -> checksum 78, encoded MSB first as short (0) / long (1) pulses
+    const uint8_t bytes[5] = {55, 0, 23, 0, 78};
+    memcpy(bench_dht_bytes, bytes, sizeof(bytes));
+    for (int i = 0; i < DHT11_FRAME_BITS; i++) {
+        bool one = bytes[i / 8] & (1 << (7 - (i % 8)));
+        bench_dht_pulses[i] = one ? 70 : 26;
+    }
+#endif
+
+    memset(&bench_sample, 0, sizeof(bench_sample));
+    bench_sample.dht_status = 0; // DHT11_OK
+    bench_sample.temperature = 23;
+    bench_sample.humidity = 55;
+    bench_sample.mq2_lpg_ppm = 12.5f;
+    bench_sample.mq2_co_ppm = 3.25f;
+    bench_sample.mq2_smoke_ppm = 40.0f;
+    bench_sample.motion_detected = true;
+    bench_sample.timestamp_ms = 3600000; // An hour of master uptime
+    sensor_data_encode(&bench_sample, bench_frame, sizeof(bench_frame));
+
+    detect_init(&bench_detector);
+    bench_batch_len = sample_batch_encode(bench_codec_trace, bench_codec_count(0), bench_batch_frame, sizeof(bench_batch_frame));
+    if (bench_codec_frames == NULL) {
+        // Sized by a first pass, so the buffer holds what the trace compresses to
+        uint8_t buf[SAMPLE_BATCH_MAX_FRAME_BYTES];
+        bench_codec_offsets[0] = 0;
+        for (size_t f = 0; f < BENCH_CODEC_FRAMES; f++) {
+            size_t len = sample_batch_encode(&bench_codec_trace[f * SAMPLE_BATCH_MAX], bench_codec_count(f), buf, sizeof(buf));
+            bench_codec_offsets[f + 1] = (uint16_t)(bench_codec_offsets[f] + len);
+        }
+        bench_codec_frames = malloc(bench_codec_offsets[BENCH_CODEC_FRAMES]);
+        for (size_t f = 0; bench_codec_frames != NULL && f < BENCH_CODEC_FRAMES; f++) {
+            sample_batch_encode(&bench_codec_trace[f * SAMPLE_BATCH_MAX], bench_codec_count(f),
+                                &bench_codec_frames[bench_codec_offsets[f]], sizeof(buf));
+        }
+    }
+
+    const uint8_t site[FA_KEY_LEN] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    const uint8_t mac[6] = {0x24, 0x6f, 0x28, 0x01, 0x02, 0x03};
+    fa_key_t site_key;
+    fa_key_from_bytes(&site_key, site);
+    fa_derive_key(&site_key, mac, &bench_key);
+    memcpy(bench_signed, bench_batch_frame, bench_batch_len);
+    bench_signed_len = fa_sign(&bench_key, 1, bench_signed, bench_batch_len, sizeof(bench_signed));
+
+    if (bench_rules == NULL) {
+        rule_def_t *defs = calloc(BENCH_RULES, sizeof(rule_def_t));
+        if (defs != NULL) {
+            // Mixed thresholds, rates, holds and cross-slave rules spread over all fields
+            for (int i = 0; i < BENCH_RULES; i++) {
+                defs[i].id = i;
+                defs[i].n_conds = 1 + i % 3;
+                for (int c = 0; c < defs[i].n_conds; c++) {
+                    defs[i].conds[c] = (rule_cond_t){ (i + c) % RULE_FIELD_COUNT, (i / 7) % RULE_KIND_COUNT, (i + c) % 4, (float)(i % 97) };
+                }
+                defs[i].hold_ms = (i % 5 == 0) ? 30000 : 0;
+                defs[i].min_slaves = (i % 11 == 0) ? 3 : 1;
+            }
+            if (rules_compile(defs, BENCH_RULES, BENCH_SLAVES, &bench_rules) != ESP_OK) bench_rules = NULL;
+            free(defs);
+        }
+    }
+    if (bench_motion == NULL && bench_motion_create(&bench_motion) != ESP_OK) bench_motion = NULL;
+}
+
+// --- Kernels (one call of the measured operation each) ---
+
+#if SENSOR_HAS_MQ2
+static void k_mq2_resistance(int i) { bench_sink_f = mq2_MQ_resistance_calculation(&bench_mq2, 1000 + (i & 1023)); }
+static void k_mq2_pct_lpg(int i)    { bench_sink_f = mq2_MQ_get_percentage(0.5f + (i & 7) * 0.1f, LPGCurve); }
+static void k_mq2_pct_co(int i)     { bench_sink_f = mq2_MQ_get_percentage(0.5f + (i & 7) * 0.1f, COCurve); }
+static void k_mq2_pct_smoke(int i)  { bench_sink_f = mq2_MQ_get_percentage(0.5f + (i & 7) * 0.1f, SmokeCurve); }
+static void k_mq2_snapshot(int i) {
+    mq2_snapshot_t snap;
+    mq2_snapshot(&bench_mq2, &snap);
+    bench_sink_f = snap.values[i % 3];
+}
+// A reading a minute, so every 60th op closes a bucket and re-fits Ro over the window
+static void k_mq2_ro_track(int i)   { bench_sink_i = mq2_ro_track(&bench_mq2, 98.0f + (i & 7), (uint64_t)i * 60000); }
+#endif
+#if SENSOR_HAS_DHT11
+static void k_dht_decode(int i)     { bench_sink_i = DHT11_decode(bench_dht_pulses).temperature; }
+static void k_dht_crc(int i)        { bench_sink_i = DHT11_checkCRC(bench_dht_bytes); }
+#endif
+
+static void k_frame_encode(int i) {
+    uint8_t buf[sizeof(sensor_data_t)];
+    bench_sink_i = (int)sensor_data_encode(&bench_sample, buf, sizeof(buf)) + buf[i & 3];
+}
+
+static void k_frame_decode(int i) {
+    sensor_data_t out;
+    bench_sink_i = sensor_data_decode(bench_frame, sizeof(bench_frame), &out) + out.temperature;
+}
+
+// One op = the next frame of the codec trace, wrapping around
+static void k_batch_encode(int i) {
+    uint8_t buf[SAMPLE_BATCH_MAX_FRAME_BYTES];
+    size_t f = (size_t)i % BENCH_CODEC_FRAMES;
+    bench_sink_i = (int)sample_batch_encode(&bench_codec_trace[f * SAMPLE_BATCH_MAX], bench_codec_count(f), buf, sizeof(buf)) + buf[i & 3];
+}
+
+static void k_batch_decode(int i) {
+    if (bench_codec_frames == NULL) return;
+    sensor_data_t out[SAMPLE_BATCH_MAX];
+    size_t f = (size_t)i % BENCH_CODEC_FRAMES;
+    bench_sink_i = (int)sample_batch_decode(&bench_codec_frames[bench_codec_offsets[f]], bench_codec_offsets[f + 1] - bench_codec_offsets[f],
+                                            out, SAMPLE_BATCH_MAX) + out[i & 3].humidity;
+}
+
+// Sign/verify a typical batch frame (payload + trailer); verify includes the replay window
+static void k_auth_sign(int i) {
+    uint8_t buf[SAMPLE_BATCH_MAX_FRAME_BYTES + FA_TRAILER_LEN];
+    memcpy(buf, bench_batch_frame, bench_batch_len);
+    bench_sink_i = (int)fa_sign(&bench_key, (uint32_t)i, buf, bench_batch_len, sizeof(buf)) + buf[i & 3];
+}
+
+static void k_auth_verify(int i) {
+    fa_replay_t window = { 0 }; // Fresh window so every op takes the accept path
+    bench_sink_i = fa_verify(&bench_key, &window, bench_signed, bench_signed_len, NULL);
+}
+
+// One op = one incoming frame evaluated against all BENCH_RULES rules
+static void k_rules_eval(int i) {
+    if (bench_rules == NULL) return;
+    float values[RULE_FIELD_COUNT];
+    for (int f = 0; f < RULE_FIELD_COUNT; f++) values[f] = (float)((i * 7 + f * 13) % 100);
+    rules_eval(bench_rules, i % BENCH_SLAVES, (int64_t)i * 100, values);
+}
+
+// Latency sample spread over the bucket range
+static trace_t bench_trace;
+static void k_trace_record(int i) {
+    trace_record(&bench_trace, (trace_hop_t)(i % TRACE_HOP_COUNT), (int64_t)(i & 0x3FF) << (i & 15));
+}
+
+// One sample through the detector: quiet air with a slowly drifting reading and the
+// odd glitch, so the filters, slope fit and baseline all do their usual work
+static void k_detect_update(int i) {
+    sensor_data_t s = bench_sample;
+    s.mq2_smoke_ppm = 40.0f + 0.01f * (i & 1023) + ((i & 63) == 0 ? 500.0f : 0.0f);
+    s.temperature = 23 + ((i >> 8) & 1);
+    bench_sink_i = detect_update(&bench_detector, &s, (int64_t)i * 5000000);
+}
+
+// One op = one PIR hit, 250 ms apart: an intruder walking the aisles in a serpentine
+// (16 hits per section), and every fourth hit from some other PIR (staff, forklifts)
+// starting, extending or dropping tracks
+static void k_motion_ingest(int i) {
+    if (bench_motion == NULL) return;
+    int step = (i / 16) % BENCH_MOTION_ZONES;
+    int row = step / BENCH_MOTION_SIDE, col = step % BENCH_MOTION_SIDE;
+    uint16_t zone = row * BENCH_MOTION_SIDE + ((row & 1) ? BENCH_MOTION_SIDE - 1 - col : col);
+    if ((i & 3) == 3) zone = (uint16_t)((i * 37) % BENCH_MOTION_ZONES);
+    bench_motion_t_ms += 250; // Keeps time moving forward across the warm-up call and reruns
+    motion_ingest(bench_motion, zone, bench_motion_t_ms);
+}
+
+typedef struct {
+    const char *name;   // Also the NVS key, so at most 15 characters
+    void (*fn)(int i);
+    bool log_rate;      // Also log the op rate one core sustains (e.g. frames/s on the master)
+} bench_case_t;
+
+static const bench_case_t bench_cases[] = {
+#if SENSOR_HAS_MQ2
+    { "mq2_resist",  k_mq2_resistance, false },
+    { "mq2_pct_lpg", k_mq2_pct_lpg, false },
+    { "mq2_pct_co",  k_mq2_pct_co, false },
+    { "mq2_pct_smk", k_mq2_pct_smoke, false },
+    { "mq2_snapshot", k_mq2_snapshot, false }, // Uncontended reader cost
+    { "mq2_ro_track", k_mq2_ro_track, false },
+#endif
+#if SENSOR_HAS_DHT11
+    { "dht_decode",  k_dht_decode, false },
+    { "dht_crc",     k_dht_crc, false },
+#endif
+    { "frame_enc",   k_frame_encode, false },
+    { "frame_dec",   k_frame_decode, false },
+    { "batch_enc",   k_batch_encode, false },  // One frame (SAMPLE_BATCH_MAX samples) of the codec trace per op
+    { "batch_dec",   k_batch_decode, false },
+    { "rules_500x50", k_rules_eval, false },
+    { "auth_sign",   k_auth_sign, false },
+    { "auth_verify", k_auth_verify, true },
+    { "trace_record", k_trace_record, false },
+    { "detect_update", k_detect_update, false },
+    { "motion_ingest", k_motion_ingest, true }, // Rate = PIR hits/s the master can correlate
+};
+
+// --- History Store ---
+
+#define BENCH_HISTORY_PARTITION "history"
+#define BENCH_HISTORY_MINUTES   (24 * 60)
+
+static hist_backend_t bench_history_backend;
+static bool bench_history_given;
+
+void bench_use_history(const hist_backend_t *backend) {
+    bench_history_given = backend != NULL;
+    if (backend != NULL) bench_history_backend = *backend;
+}
+
+static bool bench_history_count(const hist_record_t *rec, void *ctx) {
+    (*(uint32_t *)ctx)++;
+    return true;
+}
+
+// Flash-bound, so timed with esp_timer outside the kernel loop. Loads a day of
+// per-minute records for BENCH_SLAVES slaves, then times the dashboard queries.
+// Erases the "history" partition (or bench_use_history's backend); it is skipped when
+// the partition is absent.
+static void bench_history(void) {
+    hist_backend_t backend = bench_history_backend;
+    if (!bench_history_given && hist_backend_partition(BENCH_HISTORY_PARTITION, &backend) != ESP_OK) {
+        ESP_LOGI(TAG, "history: no \"%s\" partition, skipped", BENCH_HISTORY_PARTITION);
+        return;
+    }
+    if (backend.size < HIST_MIN_REGION_BYTES) {
+        ESP_LOGW(TAG, "history: partition holds %u bytes, %u needed for 24 h x %d slaves",
+                 (unsigned)backend.size, (unsigned)HIST_MIN_REGION_BYTES, BENCH_SLAVES);
+    }
+    if (backend.erase(backend.ctx, 0, backend.size) != ESP_OK) return;
+
+    hist_store_t *store = NULL;
+    if (hist_open(&backend, &store) != ESP_OK) return;
+
+    int64_t worst_us = 0;
+    int64_t start = esp_timer_get_time();
+    for (uint32_t m = 0; m < BENCH_HISTORY_MINUTES; m++) {
+        for (int k = 0; k < BENCH_SLAVES; k++) {
+            hist_record_t rec;
+            hist_record_make(&rec, m * 60, (uint8_t)k, 21.0f + (k % 5), 50.0f, 1.5f, 2.0f + (m % 30) * 0.1f,
+                             40.0f + (m % 60), (m + k) % 17 == 0);
+            int64_t t = esp_timer_get_time();
+            if (hist_append(store, &rec) != ESP_OK) goto out;
+            t = esp_timer_get_time() - t;
+            if (t > worst_us) worst_us = t;
+        }
+    }
+    int64_t load_us = esp_timer_get_time() - start;
+    uint32_t appends = BENCH_HISTORY_MINUTES * BENCH_SLAVES;
+    ESP_LOGI(TAG, "history: %lu appends, %llu us/append (worst %lld us)", (unsigned long)appends,
+             (unsigned long long)(load_us / appends), (long long)worst_us);
+
+    const uint32_t t_end = (BENCH_HISTORY_MINUTES - 1) * 60;
+    uint32_t n = 0;
+    start = esp_timer_get_time();
+    hist_query(store, 7, 0, t_end, bench_history_count, &n);
+    ESP_LOGI(TAG, "history: 24 h raw, 1 slave: %lu records in %lld us", (unsigned long)n,
+             (long long)(esp_timer_get_time() - start));
+
+    n = 0;
+    start = esp_timer_get_time();
+    hist_query(store, 7, t_end - 8 * 3600, t_end, bench_history_count, &n);
+    ESP_LOGI(TAG, "history: overnight (8 h), 1 slave: %lu records in %lld us", (unsigned long)n,
+             (long long)(esp_timer_get_time() - start));
+
+    static hist_point_t points[96];
+    size_t n_points = 0;
+    start = esp_timer_get_time();
+    hist_query_downsampled(store, 7, 0, t_end, 900, points, 96, &n_points);
+    ESP_LOGI(TAG, "history: 24 h at 15 min, 1 slave: %u points in %lld us", (unsigned)n_points,
+             (long long)(esp_timer_get_time() - start));
+out:
+    hist_close(store);
+}
+
+// --- Display ---
+
+// Bus time for n bytes on 400 kHz I2C: 9 clocks per byte (8 data + ACK), framing ignored
+#define BENCH_OLED_BUS_US(n) ((uint64_t)(n) * 9 * 1000000 / OLED_I2C_HZ)
+
+static esp_err_t bench_oled_write(void *ctx, const uint8_t *data, size_t len) {
+    return ESP_OK; // Counted by the driver's stats; no panel needed
+}
+
+static void bench_oled_log(oled_t *oled, const char *what) {
+    oled_stats_t before, after;
+    oled_get_stats(oled, &before);
+    oled_flush(oled);
+    oled_get_stats(oled, &after);
+    uint32_t bytes = after.updates != before.updates ? after.last_update_bytes : 0;
+    ESP_LOGI(TAG, "oled: %-22s %5lu bytes, ~%llu us on the bus", what, (unsigned long)bytes,
+             (unsigned long long)BENCH_OLED_BUS_US(bytes));
+}
+
+// Dashboard-like layout drawn through a counting transport: shows how much of the
+// frame each kind of update actually sends over I2C.
+static void bench_display(void) {
+    const oled_transport_t tr = { .write = bench_oled_write, .ctx = NULL };
+    oled_t *oled = NULL;
+    if (oled_create(&tr, &oled) != ESP_OK) return;
+
+    bench_oled_log(oled, "initial clear");
+
+    char line[24];
+    for (int row = 0; row < OLED_PAGES; row++) {
+        snprintf(line, sizeof(line), "S%02d 21.5C 48%% %4d", row, 300 + row);
+        oled_draw_text(oled, 0, row * OLED_FONT_H, line, false);
+    }
+    bench_oled_log(oled, "full redraw");
+
+    oled_draw_field(oled, 15 * OLED_FONT_W, 3 * OLED_FONT_H, 4, " 412", false);
+    bench_oled_log(oled, "one ppm field changed");
+
+    for (int row = 0; row < OLED_PAGES; row++) {
+        snprintf(line, sizeof(line), "S%02d 21.5C 48%% %4d", row, row == 3 ? 412 : 300 + row);
+        oled_draw_text(oled, 0, row * OLED_FONT_H, line, false);
+    }
+    bench_oled_log(oled, "unchanged redraw");
+
+    oled_fill_rect(oled, 0, 0, OLED_WIDTH, OLED_FONT_H, true);
+    oled_draw_text(oled, 2, 0, "ALARM S03 SMOKE", true);
+    bench_oled_log(oled, "alarm banner");
+
+    oled_destroy(oled);
+}
+
+// --- Live API ---
+// Load test over loopback: N clients hold /api/events streams while updates are
+// published one at a time; each update's push latency is the time until every
+// client has read the whole event. A client count is "supported" when no event
+// missed BENCH_LIVE_DEADLINE_US and nobody needed a resync. Each pair of sockets
+// (server side + client side) counts against CONFIG_LWIP_MAX_SOCKETS.
+
+#define BENCH_LIVE_PORT        8080
+#define BENCH_LIVE_UPDATES     200
+#define BENCH_LIVE_DEADLINE_US 100000
+#ifdef CONFIG_LWIP_MAX_SOCKETS
+#define BENCH_LIVE_MAX_CLIENTS ((CONFIG_LWIP_MAX_SOCKETS - 3) / 2) // Listener, wake-up, snapshot GET
+#else
+// Host sockets are file descriptors: RLIMIT_NOFILE lowers this at run time
+#define BENCH_LIVE_MAX_CLIENTS 128
+#define BENCH_LIVE_RESERVED_FDS 16 // stdio, listener, wake-up, snapshot GET and the test's own
+#endif
+
+typedef struct {
+    int fd;
+    uint32_t events;    // "\n\n"-terminated events read, the initial snapshot included
+    char last;
+} bench_live_client_t;
+
+static int bench_live_connect(const char *request) {
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(BENCH_LIVE_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || send(fd, request, strlen(request), 0) < 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    return fd;
+}
+
+// Reads what is waiting and counts completed events; false if the stream closed
+static bool bench_live_drain(bench_live_client_t *c) {
+    char buf[512];
+    for (;;) {
+        ssize_t n = recv(c->fd, buf, sizeof(buf), 0);
+        if (n == 0) return false;
+        if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+        for (ssize_t i = 0; i < n; i++) {
+            if (buf[i] == '\n' && c->last == '\n') c->events++;
+            c->last = buf[i];
+        }
+    }
+}
+
+// Waits until every client has read `target` events; returns the time taken, or -1 past the deadline
+static int64_t bench_live_wait(bench_live_client_t *clients, int n, uint32_t target, int64_t start) {
+    for (;;) {
+        bool all = true;
+        for (int i = 0; i < n; i++) {
+            if (clients[i].fd >= 0 && !bench_live_drain(&clients[i])) {
+                close(clients[i].fd);
+                clients[i].fd = -1;
+            }
+            if (clients[i].fd < 0 || clients[i].events < target) all = false;
+        }
+        int64_t elapsed = esp_timer_get_time() - start;
+        if (all) return elapsed;
+        if (elapsed > BENCH_LIVE_DEADLINE_US) return -1;
+
+        fd_set rd; // Sleep until some client has data, not for a whole tick
+        FD_ZERO(&rd);
+        int max_fd = -1;
+        for (int i = 0; i < n; i++) {
+            if (clients[i].fd < 0) continue;
+            FD_SET(clients[i].fd, &rd);
+            if (clients[i].fd > max_fd) max_fd = clients[i].fd;
+        }
+        struct timeval tv = { .tv_sec = 0, .tv_usec = 10000 };
+        if (max_fd < 0 || select(max_fd + 1, &rd, NULL, NULL, &tv) < 0) return -1;
+    }
+}
+
+static bool bench_live_round(live_server_t *server, int n) {
+    bench_live_client_t clients[BENCH_LIVE_MAX_CLIENTS];
+    live_stats_t before;
+    live_get_stats(server, &before);
+    for (int i = 0; i < n; i++) {
+        clients[i].fd = bench_live_connect("GET /api/events HTTP/1.1\r\nHost: bench\r\n\r\n");
+        clients[i].events = 0;
+        clients[i].last = 0;
+        // One at a time: the listen backlog is short, and a dropped SYN costs a second's retransmit
+        int64_t start = esp_timer_get_time();
+        while (clients[i].fd >= 0 && esp_timer_get_time() - start < BENCH_LIVE_DEADLINE_US) {
+            live_stats_t st;
+            live_get_stats(server, &st);
+            if (st.streams >= before.streams + i + 1) break;
+            vTaskDelay(1);
+        }
+    }
+    bool ok = bench_live_wait(clients, n, 1, esp_timer_get_time()) >= 0; // Initial snapshot
+
+    uint32_t late = 0;
+    int64_t total_us = 0, worst_us = 0;
+    for (uint32_t u = 0; ok && u < BENCH_LIVE_UPDATES; u++) {
+        live_reading_t r = {
+            .mac = { 0x24, 0x0a, 0xc4, 0x00, 0x00, (uint8_t)(u % LIVE_MAX_SLAVES) },
+            .timestamp_ms = 3600000 + u * 100,
+            .temperature = 21.0f + (u % 7),
+            .humidity = 48.0f,
+            .lpg_ppm = 1.5f,
+            .co_ppm = 2.0f,
+            .smoke_ppm = 40.0f + (u % 60),
+            .motion = (u % 17) == 0,
+        };
+        int64_t start = esp_timer_get_time();
+        if (live_update(server, (uint8_t)(u % LIVE_MAX_SLAVES), &r) != ESP_OK) {
+            ok = false;
+            break;
+        }
+        int64_t us = bench_live_wait(clients, n, 2 + u, start);
+        if (us < 0) {
+            late++;
+            us = BENCH_LIVE_DEADLINE_US;
+        }
+        total_us += us;
+        if (us > worst_us) worst_us = us;
+    }
+
+    // One snapshot GET while the streams are connected
+    int64_t get_us = -1;
+    int64_t start = esp_timer_get_time();
+    int get_fd = bench_live_connect("GET /api/snapshot HTTP/1.1\r\nHost: bench\r\n\r\n");
+    if (get_fd >= 0) {
+        char buf[512];
+        while (esp_timer_get_time() - start < BENCH_LIVE_DEADLINE_US) {
+            ssize_t got = recv(get_fd, buf, sizeof(buf), 0);
+            if (got == 0) {
+                get_us = esp_timer_get_time() - start; // Server closes after the body
+                break;
+            }
+            if (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK) break;
+            if (got < 0) vTaskDelay(1);
+        }
+        close(get_fd);
+    }
+
+    live_stats_t after;
+    live_get_stats(server, &after);
+    int open = 0;
+    for (int i = 0; i < n; i++) {
+        if (clients[i].fd >= 0) {
+            open++;
+            close(clients[i].fd);
+        }
+    }
+    uint32_t pushes = after.events_pushed - before.events_pushed;
+    uint32_t resyncs = after.resyncs - before.resyncs;
+    ESP_LOGI(TAG, "live: %2d client(s): push mean %lld us, worst %lld us, %lu late; %lu pushes from %lu "
+             "serializations, %lu resyncs; snapshot GET %lld us (%lu B)",
+             n, (long long)(ok ? total_us / BENCH_LIVE_UPDATES : -1), (long long)worst_us, (unsigned long)late,
+             (unsigned long)pushes, (unsigned long)(after.updates - before.updates), (unsigned long)resyncs,
+             (long long)get_us, (unsigned long)after.snapshot_bytes);
+    vTaskDelay(pdMS_TO_TICKS(50)); // Let the server notice the closed streams
+    return ok && open == n && late == 0 && resyncs == 0;
+}
+
+// Stream clients the socket budget allows
+static int bench_live_max_clients(void) {
+#ifndef CONFIG_LWIP_MAX_SOCKETS
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY) {
+        long fit = ((long)rl.rlim_cur - BENCH_LIVE_RESERVED_FDS) / 2;
+        if (fit < BENCH_LIVE_MAX_CLIENTS) return fit > 0 ? (int)fit : 0;
+    }
+#endif
+    return BENCH_LIVE_MAX_CLIENTS;
+}
+
+static void bench_live(void) {
+    const int max_clients = bench_live_max_clients();
+    const live_config_t cfg = { .port = BENCH_LIVE_PORT, .max_clients = (uint8_t)(max_clients + 1), .task_priority = 5 };
+    live_server_t *server = NULL;
+    if (live_start(&cfg, &server) != ESP_OK) {
+        ESP_LOGW(TAG, "live: server did not start (no network stack?), skipped");
+        return;
+    }
+    int supported = 0;
+    for (int n = 1; n <= max_clients; n = n < max_clients && n * 2 > max_clients ? max_clients : n * 2) { // 1, 2, 4, ..., max
+        if (!bench_live_round(server, n)) break;
+        supported = n;
+    }
+    ESP_LOGI(TAG, "live: %d stream client(s) supported within %d us", supported, BENCH_LIVE_DEADLINE_US);
+    live_stop(server);
+}
+
+// --- Access Journal ---
+
+#define BENCH_JOURNAL_PARTITION "journal"
+#define BENCH_JOURNAL_EVENTS    20000
+#define BENCH_JOURNAL_CARDS     200
+
+static journal_backend_t bench_journal_backend;
+static bool bench_journal_given;
+
+void bench_use_journal(const journal_backend_t *backend) {
+    bench_journal_given = backend != NULL;
+    if (backend != NULL) bench_journal_backend = *backend;
+}
+
+static bool bench_journal_count(const journal_record_t *rec, void *ctx) {
+    (*(uint32_t *)ctx)++;
+    return true;
+}
+
+static void bench_journal_query(journal_t *journal, const char *what, const uint8_t *uid, uint32_t t0, uint32_t t1) {
+    journal_stats_t before, after;
+    journal_get_stats(journal, &before);
+    uint32_t n = 0;
+    int64_t start = esp_timer_get_time();
+    journal_query(journal, uid, uid ? 4 : 0, t0, t1, bench_journal_count, &n);
+    int64_t us = esp_timer_get_time() - start;
+    journal_get_stats(journal, &after);
+    ESP_LOGI(TAG, "journal: %s: %lu events in %lld us (%lu sectors read, %lu skipped)", what, (unsigned long)n,
+             (long long)us, (unsigned long)(after.scan_sectors_read - before.scan_sectors_read),
+             (unsigned long)(after.scan_sectors_skipped - before.scan_sectors_skipped));
+}
+
+// Taps as fast as the journal takes them, one per second of event time across
+// BENCH_JOURNAL_CARDS cards, while the commit task writes batches in the background.
+// Erases the "journal" partition (or bench_use_journal's backend); it is skipped when
+// the partition is absent.
+static void bench_journal(void) {
+    journal_backend_t backend = bench_journal_backend;
+    if (!bench_journal_given && journal_backend_partition(BENCH_JOURNAL_PARTITION, &backend) != ESP_OK) {
+        ESP_LOGI(TAG, "journal: no \"%s\" partition, skipped", BENCH_JOURNAL_PARTITION);
+        return;
+    }
+    if (backend.erase(backend.ctx, 0, backend.size) != ESP_OK) return;
+
+    const journal_config_t cfg = { .commit_window_ms = 200, .batch_records = 32, .task_priority = 5 };
+    journal_t *journal = NULL;
+    if (journal_open(&backend, &cfg, &journal) != ESP_OK) return;
+
+    int64_t append_us = 0, worst_us = 0;
+    uint32_t stalls = 0;
+    int64_t start = esp_timer_get_time();
+    for (uint32_t e = 0; e < BENCH_JOURNAL_EVENTS; e++) {
+        uint32_t card = (e * 7919) % BENCH_JOURNAL_CARDS;
+        const uint8_t uid[4] = { 0x04, (uint8_t)(card >> 8), (uint8_t)card, 0xA1 };
+        for (;;) {
+            int64_t t = esp_timer_get_time();
+            esp_err_t ret = journal_append(journal, uid, sizeof(uid), (uint8_t)(card % 4),
+                                           card % 13 == 0 ? JOURNAL_DENIED : JOURNAL_GRANTED, e);
+            t = esp_timer_get_time() - t;
+            if (ret == ESP_OK) {
+                append_us += t;
+                if (t > worst_us) worst_us = t;
+                break;
+            }
+            stalls++; // RAM buffer full: the flash is the bottleneck, give the commit task the CPU
+            vTaskDelay(1);
+        }
+    }
+    journal_flush(journal);
+    int64_t elapsed_us = esp_timer_get_time() - start;
+
+    journal_stats_t st;
+    journal_get_stats(journal, &st);
+    ESP_LOGI(TAG, "journal: append %lld ns mean, %lld us worst; %llu events/s sustained (%lu buffer-full retries)",
+             (long long)(append_us * 1000 / BENCH_JOURNAL_EVENTS), (long long)worst_us,
+             (unsigned long long)BENCH_JOURNAL_EVENTS * 1000000ULL / (uint64_t)(elapsed_us > 0 ? elapsed_us : 1),
+             (unsigned long)stalls);
+    ESP_LOGI(TAG, "journal: %lu commits (%lu events/commit), longest %lu us, longest wait %lu ms, %lu on flash, %lu overwritten",
+             (unsigned long)st.commits, (unsigned long)(st.commits ? st.committed / st.commits : 0),
+             (unsigned long)st.commit_us_max, (unsigned long)st.window_ms_max, (unsigned long)st.records,
+             (unsigned long)st.overwritten);
+
+    const uint8_t card7[4] = { 0x04, 0x00, 0x07, 0xA1 };
+    const uint8_t stranger[4] = { 0x04, 0xFF, 0xFF, 0xA1 };
+    bench_journal_query(journal, "1 card, all time", card7, 0, UINT32_MAX);
+    bench_journal_query(journal, "unknown card, all time", stranger, 0, UINT32_MAX);
+    bench_journal_query(journal, "all cards, last 10 min", NULL, BENCH_JOURNAL_EVENTS - 600, UINT32_MAX);
+    journal_close(journal);
+}
+
+// --- Motion Correlation ---
+// Replays BENCH_MOTION_INTRUDERS people walking the aisles at random for
+// BENCH_MOTION_RUN_S: each PIR reports while someone is in its section and keeps
+// retriggering for a while after they leave. Every hop they make should come out as an
+// alert with the right zones and time. Then every PIR in the warehouse fires at once,
+// BENCH_MOTION_BURSTS times, to time the worst case the master must keep up with.
+
+#define BENCH_MOTION_INTRUDERS 3
+#define BENCH_MOTION_RUN_S     600
+#define BENCH_MOTION_STEP_MS   250
+#define BENCH_MOTION_HIT_MS    1000   // PIR report interval while someone is in the section
+#define BENCH_MOTION_TRAIL_MS  2000   // Retriggering after they leave
+#define BENCH_MOTION_HOPS_MAX  512
+#define BENCH_MOTION_BURSTS    100
+
+typedef struct {
+    uint16_t from;
+    uint16_t to;
+    int64_t t_ms;
+} bench_hop_t;
+
+typedef struct {
+    bench_hop_t hops[BENCH_MOTION_HOPS_MAX];
+    int n;
+} bench_hops_t;
+
+static bench_hops_t bench_truth, bench_alerted;
+static uint32_t bench_motion_rng = 12345;
+
+static uint32_t bench_motion_rand(uint32_t n) {
+    bench_motion_rng = bench_motion_rng * 1664525u + 1013904223u;
+    return (bench_motion_rng >> 8) % n;
+}
+
+static void bench_hop_add(bench_hops_t *h, uint16_t from, uint16_t to, int64_t t_ms) {
+    if (h->n < BENCH_MOTION_HOPS_MAX) h->hops[h->n++] = (bench_hop_t){ from, to, t_ms };
+}
+
+static void bench_motion_alert(void *ctx, const motion_alert_t *alert) {
+    if (alert->kind != MOTION_ALERT_END) bench_hop_add(&bench_alerted, alert->from, alert->to, alert->t_ms);
+}
+
+// Random neighbour in the grid, avoiding an immediate walk back when there is a choice
+static uint16_t bench_motion_next(uint16_t zone, uint16_t prev) {
+    uint16_t cand[4];
+    int n = 0;
+    int row = zone / BENCH_MOTION_SIDE, col = zone % BENCH_MOTION_SIDE;
+    if (col > 0) cand[n++] = zone - 1;
+    if (col + 1 < BENCH_MOTION_SIDE) cand[n++] = zone + 1;
+    if (row > 0) cand[n++] = zone - BENCH_MOTION_SIDE;
+    if (row + 1 < BENCH_MOTION_SIDE) cand[n++] = zone + BENCH_MOTION_SIDE;
+    for (;;) {
+        uint16_t next = cand[bench_motion_rand(n)];
+        if (next != prev || n == 1) return next;
+    }
+}
+
+static uint32_t bench_motion_cycles, bench_motion_worst, bench_motion_hits;
+
+static void bench_motion_hit(motion_engine_t *engine, uint16_t zone, int64_t t_ms) {
+    uint32_t start = esp_cpu_get_cycle_count();
+    motion_ingest(engine, zone, t_ms);
+    uint32_t cycles = esp_cpu_get_cycle_count() - start;
+    bench_motion_cycles += cycles;
+    if (cycles > bench_motion_worst) bench_motion_worst = cycles;
+    bench_motion_hits++;
+}
+
+static void bench_motion_replay(void) {
+    motion_engine_t *engine = NULL;
+    if (bench_motion_create(&engine) != ESP_OK) return;
+    motion_set_alert_cb(engine, bench_motion_alert, NULL);
+    bench_truth.n = bench_alerted.n = 0;
+    bench_motion_cycles = bench_motion_worst = bench_motion_hits = 0;
+
+    struct {
+        uint16_t zone, prev;
+        int64_t leave_ms, next_hit_ms, trail_until_ms, next_trail_ms;
+    } walkers[BENCH_MOTION_INTRUDERS];
+    for (int w = 0; w < BENCH_MOTION_INTRUDERS; w++) {
+        walkers[w].zone = walkers[w].prev = (uint16_t)bench_motion_rand(BENCH_MOTION_ZONES);
+        walkers[w].leave_ms = 5000 + bench_motion_rand(5000);
+        walkers[w].next_hit_ms = 0;
+        walkers[w].trail_until_ms = walkers[w].next_trail_ms = -1;
+    }
+
+    for (int64_t t = 0; t < BENCH_MOTION_RUN_S * 1000LL; t += BENCH_MOTION_STEP_MS) {
+        for (int w = 0; w < BENCH_MOTION_INTRUDERS; w++) {
+            if (t >= walkers[w].leave_ms) {
+                uint16_t next = bench_motion_next(walkers[w].zone, walkers[w].prev);
+                bench_hop_add(&bench_truth, walkers[w].zone, next, t);
+                walkers[w].prev = walkers[w].zone;
+                walkers[w].zone = next;
+                walkers[w].leave_ms = t + 5000 + bench_motion_rand(5000);
+                walkers[w].next_hit_ms = t;
+                walkers[w].trail_until_ms = t + BENCH_MOTION_TRAIL_MS;
+                walkers[w].next_trail_ms = t + BENCH_MOTION_HIT_MS;
+            }
+            if (t >= walkers[w].next_hit_ms) {
+                bench_motion_hit(engine, walkers[w].zone, t);
+                walkers[w].next_hit_ms += BENCH_MOTION_HIT_MS;
+            }
+            if (t <= walkers[w].trail_until_ms && t >= walkers[w].next_trail_ms) {
+                bench_motion_hit(engine, walkers[w].prev, t);
+                walkers[w].next_trail_ms += BENCH_MOTION_HIT_MS;
+            }
+        }
+        if (t % 5000 == 0) motion_tick(engine, t);
+    }
+
+    int tracked = 0;
+    for (int i = 0; i < bench_truth.n; i++) {
+        for (int j = 0; j < bench_alerted.n; j++) {
+            const bench_hop_t *a = &bench_truth.hops[i], *b = &bench_alerted.hops[j];
+            if (a->from == b->from && a->to == b->to && a->t_ms == b->t_ms) {
+                tracked++;
+                break;
+            }
+        }
+    }
+    motion_stats_t st;
+    motion_get_stats(engine, &st);
+    const uint32_t cpu_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    ESP_LOGI(TAG, "motion: %d intruders, %d PIRs, %u B: %lu hits at %lu cycles mean, %lu worst",
+             BENCH_MOTION_INTRUDERS, BENCH_MOTION_ZONES, (unsigned)motion_memory_usage(engine),
+             (unsigned long)bench_motion_hits, (unsigned long)(bench_motion_cycles / (bench_motion_hits ? bench_motion_hits : 1)),
+             (unsigned long)bench_motion_worst);
+    ESP_LOGI(TAG, "motion: %d/%d hops tracked, %d alerted hops wrong; %lu tracks, %lu trailing hits absorbed",
+             tracked, bench_truth.n, bench_alerted.n - tracked, (unsigned long)st.tracks_started,
+             (unsigned long)st.absorbed);
+
+    // Every PIR at once, on top of whatever the replay left behind
+    int64_t t = BENCH_MOTION_RUN_S * 1000LL;
+    uint32_t total = 0, worst = 0;
+    for (int b = 0; b < BENCH_MOTION_BURSTS; b++, t += 10000) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        for (uint16_t z = 0; z < BENCH_MOTION_ZONES; z++) motion_ingest(engine, z, t);
+        motion_tick(engine, t);
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+        total += cycles;
+        if (cycles > worst) worst = cycles;
+    }
+    ESP_LOGI(TAG, "motion: all %d PIRs at once: %lu us mean, %lu us worst (%llu hits/s on one core)",
+             BENCH_MOTION_ZONES, (unsigned long)(total / BENCH_MOTION_BURSTS / cpu_mhz), (unsigned long)(worst / cpu_mhz),
+             (unsigned long long)BENCH_MOTION_ZONES * BENCH_MOTION_BURSTS * cpu_mhz * 1000000ULL / (total ? total : 1));
+    motion_destroy(engine);
+}
+
+// --- Runner ---
+
+int bench_run_all(bool reset_baseline) {
+    bench_fixtures_init();
+
+    nvs_handle_t nvs = 0;
+    bool have_nvs = nvs_open(BENCH_NVS_NAMESPACE, NVS_READWRITE, &nvs) == ESP_OK;
+    if (!have_nvs) ESP_LOGW(TAG, "NVS unavailable, results will not be compared to a baseline.");
+
+    const uint32_t cpu_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    int regressions = 0;
+    int allocating = 0;
+
+    ESP_LOGI(TAG, "Running %d kernels x %d iterations, best of %d @ %lu MHz",
+             (int)(sizeof(bench_cases) / sizeof(bench_cases[0])), BENCH_ITERATIONS, BENCH_REPEATS, (unsigned long)cpu_mhz);
+    // Against one sample per frame, the slave's format without batching
+    const unsigned codec_raw = (unsigned)(BENCH_CODEC_TRACE_SAMPLES * sizeof(sensor_data_t));
+    const unsigned codec_len = bench_codec_offsets[BENCH_CODEC_FRAMES];
+    ESP_LOGI(TAG, "Batch codec: trace of %u samples in %u frames, %u -> %u bytes (ratio %.2f)",
+             (unsigned)BENCH_CODEC_TRACE_SAMPLES, (unsigned)BENCH_CODEC_FRAMES, codec_raw, codec_len,
+             codec_len ? (float)codec_raw / codec_len : 0.0f);
+    ESP_LOGI(TAG, "Frame auth: %u-byte batch + %d-byte trailer (%.0f%% airtime payload overhead)",
+             (unsigned)bench_batch_len, FA_TRAILER_LEN, bench_batch_len ? 100.0f * FA_TRAILER_LEN / bench_batch_len : 0.0f);
+    ESP_LOGI(TAG, "%-12s %12s %10s %8s %12s", "kernel", "cycles/op", "ns/op", "allocs", "baseline");
+
+    for (size_t c = 0; c < sizeof(bench_cases) / sizeof(bench_cases[0]); c++) {
+        const bench_case_t *bc = &bench_cases[c];
+
+        bc->fn(0); // Warm caches before timing
+
+        // Counts this task's allocations through the heap hook, so a kernel that frees
+        // what it allocated, or another core allocating meanwhile, is not misread
+        memstats_guard_begin();
+        uint32_t cycles = UINT32_MAX;
+        for (int r = 0; r < BENCH_REPEATS; r++) {
+            // Interrupts still land on the loop; the fastest repeat is the one they missed
+            vTaskSuspendAll(); // Keep other tasks from being billed to the kernel
+            uint32_t start = esp_cpu_get_cycle_count();
+            for (int i = 0; i < BENCH_ITERATIONS; i++) {
+                bc->fn(i);
+            }
+            uint32_t elapsed = esp_cpu_get_cycle_count() - start;
+            xTaskResumeAll();
+            if (elapsed < cycles) cycles = elapsed;
+        }
+        uint32_t allocs = memstats_guard_end();
+
+        // Stored as centi-cycles per op so sub-cycle differences in tiny kernels stay visible
+        uint32_t ccycles_per_op = (uint32_t)(((uint64_t)cycles * 100) / BENCH_ITERATIONS);
+        uint32_t ns_per_op = (uint32_t)(((uint64_t)cycles * 1000) / ((uint64_t)cpu_mhz * BENCH_ITERATIONS));
+
+        uint32_t baseline = 0;
+        bool have_baseline = have_nvs && !reset_baseline && nvs_get_u32(nvs, bc->name, &baseline) == ESP_OK;
+        char baseline_str[16] = "new";
+        if (have_baseline) {
+            snprintf(baseline_str, sizeof(baseline_str), "%lu.%02lu", (unsigned long)(baseline / 100), (unsigned long)(baseline % 100));
+        } else if (have_nvs) {
+            nvs_set_u32(nvs, bc->name, ccycles_per_op);
+        }
+
+        ESP_LOGI(TAG, "%-12s %9lu.%02lu %10lu %8lu %12s", bc->name,
+                 (unsigned long)(ccycles_per_op / 100), (unsigned long)(ccycles_per_op % 100),
+                 (unsigned long)ns_per_op, (unsigned long)allocs, baseline_str);
+
+        if (bc->log_rate && cycles > 0) {
+            ESP_LOGI(TAG, "%s: max %llu ops/s on one core", bc->name,
+                     (unsigned long long)cpu_mhz * 1000000ULL * BENCH_ITERATIONS / cycles);
+        }
+
+        if (have_baseline && ccycles_per_op > baseline + (baseline * BENCH_REGRESSION_PCT) / 100) {
+            ESP_LOGW(TAG, "%s regressed: %lu -> %lu centi-cycles/op (> %d%%)", bc->name,
+                     (unsigned long)baseline, (unsigned long)ccycles_per_op, BENCH_REGRESSION_PCT);
+            regressions++;
+        }
+        if (allocs != 0) {
+            ESP_LOGW(TAG, "%s made %lu heap allocations in %d ops; per-sample kernels should not allocate.", bc->name,
+                     (unsigned long)allocs, BENCH_ITERATIONS * BENCH_REPEATS);
+            allocating++;
+        }
+    }
+
+    if (have_nvs) {
+        nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+    bench_history();
+    bench_display();
+    bench_live();
+    bench_journal();
+    bench_motion_replay();
+    ESP_LOGI(TAG, "Benchmark complete: %d regression(s), %d allocating kernel(s).", regressions, allocating);
+    return regressions + allocating;
+}
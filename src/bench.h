@@ -0,0 +1,65 @@
+// bench.h
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "history.h"
+#include "journal.h"
+
+// Number of calls timed per kernel. Large enough to amortise the cycle counter reads.
+#define BENCH_ITERATIONS 2000
+
+// Each kernel's loop is timed this many times and the fastest is kept, so an interrupt
+// or (on the host) a preemption landing on one run is not read as a regression.
+#define BENCH_REPEATS 5
+
+// A kernel is flagged when its cost grows by more than this over the stored baseline.
+#define BENCH_REGRESSION_PCT 15
+
+/**
+ * @brief Runs the per-sample compute kernel suite and logs, for each kernel, cycles/op,
+ *        ns/op and the heap allocations it made (counted by the memstats guard, so
+ *        CONFIG_HEAP_USE_HOOKS is needed; otherwise they read 0). Runs on target, and
+ *        on the host as the test_bench suite.
+ *
+ * The batch codec kernels encode and decode a committed hour of samples
+ * (bench_codec_trace.h) frame by frame, and its compression ratio is logged.
+ *
+ * The first run on a device stores every result as the baseline in NVS (namespace "bench").
+ * Later runs compare against it and log a warning for kernels that got slower by more
+ * than BENCH_REGRESSION_PCT. NVS must already be initialised.
+ *
+ * If a "history" data partition exists (or a backend was given to bench_use_history) it is
+ * erased and loaded with a day of records to time history store appends and queries
+ * (logged only, no baseline). The OLED driver is
+ * then run against a counting transport to log the I2C bytes each kind of display
+ * update sends. Finally the live API (lib/Live) is load-tested over loopback: stream
+ * clients are doubled until pushes miss a deadline or the socket budget runs out, and
+ * push latency and the number of clients supported are logged.
+ * If a "journal" data partition exists (or a backend was given to bench_use_journal) it is
+ * erased and the access journal (lib/Journal) is fed taps as fast as it takes them:
+ * append latency, sustained events/s, commit group size and scan times by card and by
+ * time range are logged.
+ * Last, the motion correlator (lib/Motion) replays intruders walking a 64-PIR warehouse
+ * and logs the share of their hops it tracked, then times bursts of every PIR at once.
+ *
+ * @param reset_baseline If true, overwrite the stored baseline with this run's results.
+ * @return Kernels flagged: slower than the baseline allows, or allocating.
+ */
+int bench_run_all(bool reset_baseline);
+
+/**
+ * @brief Runs the history store bench on backend instead of the "history" partition,
+ *        e.g. a RAM region on the host, which has no partitions. NULL goes back to the
+ *        partition. The backend is erased by every bench_run_all().
+ */
+void bench_use_history(const hist_backend_t* backend);
+
+/**
+ * @brief Runs the access journal bench on backend instead of the "journal" partition, as
+ *        bench_use_history() does for the history store.
+ */
+void bench_use_journal(const journal_backend_t* backend);
+
+#endif // BENCH_H
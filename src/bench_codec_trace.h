@@ -0,0 +1,670 @@
+// src/bench_codec_trace.h
+// The batch codec benchmark's input (bench.c): an hour of one slave's samples as the
+// master received them, captured from test_soak's day (soak.c, SOAK_SEED) between
+// 15:40 and 16:40 simulated time. It holds the quiet aisle before the day's fire
+// plume, the heat and smoke rise and decay, the report period tightening and relaxing
+// (adaptive.h), motion bursts and the DHT11/MQ2 faults the soak injects (status < 0,
+// NaN ppm). timestamp_ms is the soak's uptime: the soak runs without a time master.
+// Included by bench.c only.
+#ifndef BENCH_CODEC_TRACE_H
+#define BENCH_CODEC_TRACE_H
+
+#include <math.h>
+#include "shared_header.h"
+
+static const sensor_data_t bench_codec_trace[] = {
+    // status, temp C, %RH, LPG ppm, CO ppm, smoke ppm, motion, timestamp_ms
+    { 0, 19, 63, 26.1215f, 443.042084f, 39.2756042f, false, 56423000u },
+    { 0, 19, 63, 25.7889824f, 436.371277f, 38.7135925f, false, 56479000u },
+    { 0, 19, 63, 25.4589653f, 429.766235f, 38.1567039f, false, 56505000u },
+    { 0, 19, 63, 26.7940998f, 456.583191f, 40.4151382f, false, 56533000u },
+    { 0, 19, 63, 26.1215f, 443.042084f, 39.2756042f, true, 56559000u },
+    { 0, 19, 63, 27.47682f, 470.392242f, 41.5754814f, false, 56584000u },
+    { 0, 19, 63, 26.7940998f, 456.583191f, 40.4151382f, false, 56613000u },
+    { 0, 19, 63, 27.1341915f, 463.454071f, 40.9926987f, false, 56638000u },
+    { 0, 19, 63, 26.1215f, 443.042084f, 39.2756042f, false, 56667000u },
+    { 0, 19, 63, 25.4589653f, 429.766235f, 38.1567039f, false, 56696000u },
+    { 0, 19, 63, 26.4565372f, 449.779266f, 39.8427773f, false, 56747000u },
+    { 0, 19, 63, 26.7940998f, 456.583191f, 40.4151382f, false, 56778000u },
+    { 0, 19, 63, 26.4565372f, 449.779266f, 39.8427773f, false, 56803000u },
+    { 0, 19, 63, 26.1215f, 443.042084f, 39.2756042f, false, 56828000u },
+    { 0, 19, 63, 26.7940998f, 456.583191f, 40.4151382f, false, 56859000u },
+    { 0, 19, 63, 26.4565372f, 449.779266f, 39.8427773f, false, 56888000u },
+    { 0, 19, 63, 26.4565372f, 449.779266f, 39.8427773f, false, 56914000u },
+    { 0, 19, 63, 26.1215f, 443.042084f, 39.2756042f, false, 56946000u },
+    { 0, 19, 63, 25.4589653f, 429.766235f, 38.1567039f, false, 56971000u },
+    { 0, 19, 63, 26.4565372f, 449.779266f, 39.8427773f, false, 56998000u },
+    { 0, 23, 63, 34.9462433f, 625.362732f, 54.4911003f, false, 57027000u },
+    { 0, 23, 63, 35.7069283f, 641.514893f, 55.8272896f, false, 57027000u },
+    { 0, 23, 63, 35.7069283f, 641.514893f, 55.8272896f, false, 57027000u },
+    { 0, 23, 63, 34.9462433f, 625.362732f, 54.4911003f, false, 57031000u },
+    { 0, 23, 63, 36.4774399f, 657.94043f, 57.1843758f, false, 57031000u },
+    { 0, 24, 63, 35.5195122f, 637.529419f, 55.4977493f, false, 57031000u },
+    { 0, 24, 63, 36.2793884f, 653.71228f, 56.8352089f, false, 57031000u },
+    { 0, 24, 63, 37.828167f, 686.888733f, 59.5720062f, false, 57036000u },
+    { 0, 24, 63, 37.0489235f, 670.164612f, 58.1932411f, false, 57036000u },
+    { 0, 24, 63, 37.4373322f, 678.492615f, 58.8800316f, false, 57036000u },
+    { 0, 24, 63, 39.8190269f, 729.902893f, 63.1105499f, false, 57036000u },
+    { 0, 25, 63, 39.6227455f, 725.644165f, 62.7606812f, false, 57036000u },
+    { 0, 25, 63, 40.4257698f, 743.091919f, 64.193428f, false, 57041000u },
+    { 0, 25, 63, 39.224865f, 717.023132f, 62.052124f, false, 57041000u },
+    { 0, 25, 63, 39.6227455f, 725.644165f, 62.7606812f, false, 57041000u },
+    { 0, 25, 63, 42.4759331f, 787.925049f, 67.8673401f, false, 57041000u },
+    { 0, 25, 63, 42.8933258f, 797.102173f, 68.6180573f, false, 57041000u },
+    { 0, 26, 63, 42.7124596f, 793.123474f, 68.2926407f, false, 57046000u },
+    { 0, 26, 63, 41.4823685f, 766.146729f, 66.0840225f, false, 57046000u },
+    { 0, 26, 63, 43.1273232f, 802.254211f, 69.0393295f, false, 57046000u },
+    { 0, 26, 63, 44.3864632f, 830.06543f, 71.3110504f, false, 57046000u },
+    { 0, 26, 63, 43.1273232f, 802.254211f, 69.0393295f, false, 57046000u },
+    { 0, 26, 63, 43.5446091f, 811.454712f, 69.7912903f, false, 57051000u },
+    { 0, 27, 63, 44.2484016f, 827.00885f, 71.0615692f, false, 57051000u },
+    { 0, 27, 63, 45.9432259f, 864.651489f, 74.1308823f, false, 57051000u },
+    { 0, 27, 63, 45.5158997f, 855.135864f, 73.3556366f, false, 57051000u },
+    { 0, 27, 63, 47.676796f, 903.420166f, 77.2850418f, false, 57051000u },
+    { 0, 27, 63, 47.676796f, 903.420166f, 77.2850418f, false, 57056000u },
+    { 0, 27, 63, 49.0026207f, 933.246582f, 79.7070465f, false, 57056000u },
+    { 0, 28, 63, 48.8852005f, 930.598938f, 79.4922104f, false, 57056000u },
+    { 0, 28, 63, 47.5718536f, 901.065857f, 77.093689f, false, 57056000u },
+    { 0, 28, 63, 50.6702576f, 970.973694f, 82.7650986f, false, 57056000u },
+    { 0, 28, 63, 49.7728577f, 950.642761f, 81.1178894f, false, 57061000u },
+    { 0, 28, 63, 50.2203369f, 960.772217f, 81.938797f, false, 57061000u },
+    { 0, 28, 63, 52.4944382f, 1012.505f, 86.124649f, false, 57061000u },
+    { 0, 29, 63, 52.4223328f, 1010.85822f, 85.9915695f, false, 57061000u },
+    { 0, 29, 63, 51.9663467f, 1000.45404f, 85.1505432f, false, 57061000u },
+    { -2, -99, -99, 54.2706375f, 1053.2002f, 89.4098816f, false, 57066000u },
+    { 0, 29, 63, 53.3416023f, 1031.88354f, 87.6898499f, false, 57066000u },
+    { 0, 29, 63, 56.1582184f, 1096.71704f, 92.9158859f, false, 57066000u },
+    { 0, 29, 63, 54.7388458f, 1063.96875f, 90.2781296f, false, 57066000u },
+    { 0, 30, 63, 56.6183014f, 1107.36511f, 93.7727051f, false, 57066000u },
+    { 0, 30, 63, 56.1434898f, 1096.37634f, 92.8884735f, false, 57071000u },
+    { 0, 30, 63, 58.057476f, 1140.77576f, 96.4584732f, false, 57071000u },
+    { 0, 30, 63, 57.5752831f, 1129.56433f, 95.5576782f, false, 57071000u },
+    { 0, 30, 63, 59.0292473f, 1163.42224f, 98.2767181f, false, 57071000u },
+    { 0, 30, 63, 60.5055046f, 1197.95679f, 101.046028f, false, 57071000u },
+    { 0, 31, 63, 60.066803f, 1187.67773f, 100.222176f, false, 57076000u },
+    { 0, 31, 63, 60.5587006f, 1199.20422f, 101.145981f, false, 57076000u },
+    { 0, 31, 63, 64.0715027f, 1282.01318f, 107.770027f, false, 57076000u },
+    { 0, 31, 63, 62.5510902f, 1246.06628f, 104.897285f, false, 57076000u },
+    { 0, 31, 63, 64.583313f, 1294.14941f, 108.738998f, false, 57076000u },
+    { 0, 31, 63, 65.6144714f, 1318.6543f, 110.694122f, false, 57081000u },
+    { 0, 32, 63, 67.3086777f, 1359.07019f, 113.914742f, false, 57081000u },
+    { 0, 32, 63, 67.3086777f, 1359.07019f, 113.914742f, false, 57081000u },
+    { 0, 32, 63, 67.8335037f, 1371.6283f, 114.914482f, false, 57081000u },
+    { 0, 32, 63, 70.495575f, 1435.60059f, 120.000237f, false, 57081000u },
+    { 0, 32, 63, 69.4231262f, 1409.77405f, 117.948441f, false, 57087000u },
+    { 0, 32, 63, 72.6711121f, 1488.21301f, 124.174377f, false, 57087000u },
+    { 0, 33, 63, 71.8120193f, 1467.40186f, 122.524162f, false, 57087000u },
+    { 0, 33, 63, 72.3557968f, 1480.56946f, 123.56842f, false, 57087000u },
+    { 0, 33, 63, 74.5564957f, 1534.04431f, 127.804504f, false, 57087000u },
+    { 0, 33, 63, 75.1130753f, 1547.61523f, 128.878357f, false, 57087000u },
+    { 0, 33, 63, 76.7982864f, 1588.8175f, 132.135788f, false, 57092000u },
+    { 0, 33, 63, 77.3652039f, 1602.71594f, 133.233627f, false, 57092000u },
+    { 0, 34, 63, 79.435463f, 1653.62866f, 137.251221f, false, 57092000u },
+    { 0, 34, 63, 81.1735382f, 1696.56152f, 140.634308f, false, 57092000u },
+    { 0, 34, 63, 82.3452988f, 1725.60156f, 142.920212f, false, 57092000u },
+    { 0, 36, 63, 93.9163742f, 2016.33142f, 165.704376f, false, 57106000u },
+    { 0, 36, 63, 93.9163742f, 2016.33142f, 165.704376f, false, 57106000u },
+    { 0, 36, 63, 95.8354111f, 2065.21313f, 169.518372f, false, 57106000u },
+    { 0, 36, 63, 98.4322586f, 2131.64673f, 174.694656f, false, 57106000u },
+    { 0, 36, 63, 97.1283569f, 2098.24902f, 172.09343f, false, 57106000u },
+    { 0, 36, 63, 100.408722f, 2182.42676f, 178.645813f, false, 57112000u },
+    { 0, 37, 63, 102.625969f, 2239.61255f, 183.089905f, false, 57112000u },
+    { 0, 37, 63, 105.332497f, 2309.72656f, 188.53096f, false, 57112000u },
+    { 0, 37, 63, 106.016121f, 2327.48877f, 189.908051f, false, 57112000u },
+    { 0, 37, 63, 105.332497f, 2309.72656f, 188.53096f, false, 57112000u },
+    { 0, 37, 63, 110.880219f, 2454.47485f, 199.738052f, false, 57112000u },
+    { 0, 37, 63, 108.778648f, 2399.48096f, 195.484161f, false, 57118000u },
+    { 0, 38, 63, 112.010849f, 2484.14111f, 202.030807f, false, 57118000u },
+    { 0, 38, 63, 114.868408f, 2559.36426f, 207.838333f, false, 57118000u },
+    { 0, 38, 63, 116.314377f, 2597.56055f, 210.783951f, false, 57118000u },
+    { 0, 38, 63, 117.771904f, 2636.15088f, 213.757767f, false, 57118000u },
+    { 0, 38, 63, 118.505005f, 2655.59424f, 215.255249f, false, 57118000u },
+    { 0, 38, 63, 121.466492f, 2734.36328f, 221.31636f, false, 57123000u },
+    { 0, 39, 63, 122.887543f, 2772.28638f, 224.231339f, false, 57123000u },
+    { 0, 39, 63, 125.917458f, 2853.41382f, 230.460587f, false, 57123000u },
+    { 0, 39, 63, 124.396568f, 2812.646f, 227.331406f, false, 57123000u },
+    { 0, 38, 63, 126.761902f, 2876.08887f, 232.200058f, false, 57123000u },
+    { 0, 38, 63, 132.991959f, 3044.22876f, 245.07756f, false, 57129000u },
+    { 0, 38, 63, 132.991959f, 3044.22876f, 245.07756f, false, 57129000u },
+    { 0, 38, 63, 134.579544f, 3087.3103f, 248.371307f, false, 57129000u },
+    { 0, 38, 63, 138.601532f, 3196.87134f, 256.737335f, false, 57129000u },
+    { 0, 38, 63, 137.791031f, 3174.74512f, 255.04895f, false, 57129000u },
+    { 0, 38, 63, 141.051376f, 3263.89478f, 261.848114f, false, 57129000u },
+    { 0, 38, 63, 146.875702f, 3424.09521f, 274.042969f, false, 57135000u },
+    { 0, 38, 63, 146.034332f, 3400.87939f, 272.277527f, false, 57135000u },
+    { 0, 38, 63, 147.720169f, 3447.42114f, 275.816193f, false, 57135000u },
+    { 0, 38, 63, 151.989609f, 3565.72534f, 284.800415f, false, 57135000u },
+    { 0, 38, 63, 155.461975f, 3662.396f, 292.130676f, false, 57135000u },
+    { 0, 38, 63, 158.09964f, 3736.0957f, 297.712616f, false, 57135000u },
+    { 0, 38, 63, 160.766159f, 3810.83203f, 303.367432f, false, 57139000u },
+    { 0, 38, 63, 161.661438f, 3835.97583f, 305.268646f, false, 57139000u },
+    { 0, 38, 63, 167.101074f, 3989.29639f, 316.84845f, false, 57139000u },
+    { 0, 38, 63, 168.019135f, 4015.2644f, 318.807526f, false, 57139000u },
+    { 0, 38, 63, 173.596146f, 4173.57129f, 330.736847f, false, 57143000u },
+    { 0, 38, 63, 170.792816f, 4093.87793f, 324.734375f, false, 57143000u },
+    { 0, 38, 63, 175.481644f, 4227.30566f, 334.780853f, false, 57143000u },
+    { 0, 38, 63, 180.253571f, 4363.77441f, 345.039886f, false, 57143000u },
+    { 0, 38, 63, 184.131607f, 4475.17188f, 353.402283f, false, 57149000u },
+    { 0, 38, 63, 183.157013f, 4447.13525f, 351.298615f, false, 57149000u },
+    { 0, 38, 63, 188.063736f, 4588.56494f, 361.903809f, false, 57149000u },
+    { 0, 37, 63, 194.557632f, 4776.7876f, 375.992584f, false, 57149000u },
+    { 0, 37, 63, 199.666138f, 4925.67285f, 387.117157f, false, 57149000u },
+    { 0, 37, 63, 197.612305f, 4865.72949f, 382.640289f, false, 57149000u },
+    { 0, 37, 63, 202.773178f, 5016.57129f, 393.900726f, false, 57155000u },
+    { -2, -99, -99, 204.862076f, 5077.82812f, 398.468719f, false, 57155000u },
+    { 0, 37, 63, 209.082306f, 5201.93652f, 407.71521f, false, 57155000u },
+    { 0, 37, 63, 212.284836f, 5296.4248f, 414.747528f, false, 57155000u },
+    { 0, 37, 63, 214.437714f, 5360.09229f, 419.482422f, false, 57155000u },
+    { 0, 37, 63, 217.694f, 5456.61426f, 426.655365f, false, 57155000u },
+    { 0, 37, 63, 224.304398f, 5653.37402f, 441.257874f, false, 57160000u },
+    { 0, 37, 63, 232.183029f, 5889.28076f, 458.732239f, false, 57160000u },
+    { 0, 37, 63, 236.766479f, 6027.20361f, 468.932343f, false, 57160000u },
+    { 0, 37, 63, 240.243301f, 6132.15576f, 476.686279f, false, 57160000u },
+    { 0, 37, 63, 244.931625f, 6274.12207f, 487.164276f, false, 57160000u },
+    { 0, 37, 63, 246.113159f, 6309.97949f, 489.808899f, false, 57165000u },
+    { 0, 37, 63, 252.077896f, 6491.479f, 503.183716f, false, 57165000u },
+    { 0, 37, 63, 254.490601f, 6565.12012f, 508.605042f, false, 57165000u },
+    { 0, 37, 63, 263.056458f, 6827.604f, 527.904114f, false, 57165000u },
+    { 0, 37, 63, 261.821136f, 6789.65137f, 525.115967f, false, 57165000u },
+    { 0, 37, 63, 270.550476f, 7058.54053f, 544.852905f, false, 57170000u },
+    { 0, 37, 63, 271.813232f, 7097.57129f, 547.714722f, false, 57170000u },
+    { 0, 37, 63, 282.058258f, 7415.45703f, 570.993469f, false, 57170000u },
+    { 0, 37, 63, 285.966095f, 7537.27588f, 579.90094f, false, 57170000u },
+    { 0, 37, 63, 287.276794f, 7578.20361f, 582.891968f, false, 57170000u },
+    { 0, 36, 64, 297.770325f, 7907.10156f, 606.89917f, false, 57174000u },
+    { 0, 36, 64, 303.181854f, 8077.55566f, 619.321411f, false, 57174000u },
+    { 0, 36, 64, 305.912415f, 8163.77734f, 625.599976f, false, 57174000u },
+    { 0, 36, 64, 311.423431f, 8338.22754f, 638.293091f, false, 57174000u },
+    { 0, 36, 64, 312.811615f, 8382.25977f, 641.494873f, false, 57180000u },
+    { 0, 36, 64, 322.646637f, 8695.24805f, 664.229248f, false, 57180000u },
+    { 0, 36, 64, 324.068573f, 8740.64648f, 667.523376f, false, 57180000u },
+    { 0, 36, 64, 331.242218f, 8970.2373f, 684.169739f, false, 57180000u },
+    { 0, 36, 64, 342.943817f, 9346.70703f, 711.419617f, false, 57180000u },
+    { 0, 36, 64, 344.426025f, 9394.56348f, 714.879578f, false, 57180000u },
+    { 0, 36, 64, 353.411499f, 9685.49219f, 735.894775f, false, 57185000u },
+    { -1, -99, -99, 361.020874f, 9932.93457f, 753.743896f, false, 57185000u },
+    { 0, 36, 64, 370.299377f, 10235.9551f, 775.571899f, false, 57185000u },
+    { 0, 36, 64, 374.999451f, 10389.9883f, 786.655212f, false, 57185000u },
+    { 0, 36, 64, 381.329742f, 10598.0098f, 801.610168f, false, 57185000u },
+    { 0, 36, 64, 381.329742f, 10598.0098f, 801.610168f, false, 57191000u },
+    { 0, 36, 64, 397.476898f, 11131.4922f, 839.896667f, false, 57191000u },
+    { 0, 36, 64, 399.117126f, 11185.9102f, 843.796814f, false, 57191000u },
+    { 0, 36, 64, 402.41156f, 11295.333f, 851.636353f, false, 57191000u },
+    { 0, 36, 64, 412.407562f, 11628.3525f, 875.47229f, false, 57191000u },
+    { 0, 36, 64, 422.574188f, 11968.585f, 899.789185f, false, 57191000u },
+    { 0, 36, 64, 427.722046f, 12141.4404f, 912.130127f, false, 57196000u },
+    { 0, 36, 64, 436.398438f, 12433.6416f, 932.971863f, false, 57196000u },
+    { 0, 36, 64, 446.970764f, 12791.1426f, 958.437866f, false, 57196000u },
+    { 0, 35, 64, 455.203033f, 13070.5957f, 978.319519f, false, 57196000u },
+    { 0, 35, 64, 471.63269f, 13631.0957f, 1018.13257f, false, 57196000u },
+    { 0, 35, 64, 517.470276f, 15213.6191f, 1130.11084f, false, 57205000u },
+    { 0, 35, 64, 525.403015f, 15490.1914f, 1149.61938f, false, 57205000u },
+    { 0, 35, 64, 525.403015f, 15490.1914f, 1149.61938f, false, 57205000u },
+    { 0, 35, 64, 541.525146f, 16054.6494f, 1189.38074f, false, 57205000u },
+    { 0, 35, 64, 545.609741f, 16198.1523f, 1199.47803f, false, 57205000u },
+    { 0, 35, 64, 553.844177f, 16488.0527f, 1219.86279f, false, 57209000u },
+    { 0, 35, 64, 566.360535f, 16930.2188f, 1250.92004f, false, 57209000u },
+    { 0, 35, 64, 581.215088f, 17457.3262f, 1287.8905f, false, 57209000u },
+    { 0, 35, 64, NAN, NAN, NAN, false, 57209000u },
+    { 0, 35, 64, 605.115601f, 18310.623f, 1347.62195f, false, 57213000u },
+    { 0, 35, 64, 616.207764f, 18708.7656f, 1375.44421f, false, 57213000u },
+    { 0, 35, 64, 618.44342f, 18789.1758f, 1381.05969f, false, 57213000u },
+    { 0, 35, 64, 641.121765f, 19607.8223f, 1438.16272f, false, 57213000u },
+    { 0, 35, 64, 645.727905f, 19774.7559f, 1449.79199f, false, 57219000u },
+    { 0, 35, 64, 659.688965f, 20282.0586f, 1485.10291f, false, 57219000u },
+    { 0, 35, 64, 676.249817f, 20886.3984f, 1527.1106f, false, 57219000u },
+    { 0, 35, 64, 681.035889f, 21061.5625f, 1539.2749f, false, 57219000u },
+    { 0, 35, 64, 700.425232f, 21773.502f, 1588.6637f, false, 57219000u },
+    { 0, 34, 64, NAN, NAN, NAN, false, 57224000u },
+    { 0, 34, 64, 726.159241f, 22724.0098f, 1654.47729f, false, 57224000u },
+    { 0, 34, 64, 728.681274f, 22817.498f, 1660.94299f, false, 57224000u },
+    { 0, 34, 64, 751.665894f, 23672.2637f, 1719.9978f, false, 57224000u },
+    { 0, 34, 64, 754.251831f, 23768.7344f, 1726.65613f, false, 57224000u },
+    { 0, 34, 64, 780.468445f, 24750.1895f, 1794.31921f, false, 57224000u },
+    { 0, 34, 64, 796.513794f, 25353.8867f, 1835.87207f, false, 57230000u },
+    { 0, 34, 64, 793.823059f, 25252.4902f, 1828.89648f, false, 57230000u },
+    { 0, 34, 64, 823.789917f, 26385.2637f, 1906.74878f, false, 57230000u },
+    { 0, 34, 64, 823.789917f, 26385.2637f, 1906.74878f, false, 57230000u },
+    { 0, 34, 64, 843.286194f, 27126.3418f, 1957.59021f, false, 57230000u },
+    { 0, 34, 64, 860.265076f, 27774.3125f, 2001.98706f, false, 57235000u },
+    { 0, 34, 64, 863.119202f, 27883.4688f, 2009.46094f, false, 57235000u },
+    { 0, 34, 64, 886.203247f, 28768.7422f, 2070.02197f, false, 57235000u },
+    { 0, 34, 64, 900.860291f, 29333.0566f, 2108.57739f, false, 57235000u },
+    { 0, 34, 64, 915.695496f, 29905.9551f, 2147.68164f, false, 57235000u },
+    { 0, 34, 64, 936.767334f, 30722.6348f, 2203.36084f, false, 57235000u },
+    { 0, 34, 64, 936.767334f, 30722.6348f, 2203.36084f, false, 57239000u },
+    { 0, 34, 64, 955.113525f, 31436.4414f, 2251.96606f, false, 57239000u },
+    { 0, 34, 64, 973.725037f, 32163.1543f, 2301.39307f, false, 57239000u },
+    { 0, 34, 64, 983.131348f, 32531.4141f, 2326.41895f, false, 57239000u },
+    { 0, 34, 64, 1011.75677f, 33656.0898f, 2402.76099f, false, 57245000u },
+    { 0, 34, 64, 1018.20154f, 33910.1133f, 2419.98633f, false, 57245000u },
+    { 0, 34, 64, 1031.18286f, 34422.6836f, 2454.72339f, false, 57245000u },
+    { 0, 33, 64, 1058.20129f, 35493.3047f, 2527.19775f, false, 57245000u },
+    { 0, 33, 64, 1088.51819f, 36700.6445f, 2608.7959f, false, 57245000u },
+    { 0, 33, 64, 1105.63989f, 37385.25f, 2655.00513f, false, 57245000u },
+    { 0, 33, 64, 1105.63989f, 37385.25f, 2655.00513f, false, 57251000u },
+    { 0, 33, 64, 1129.94983f, 38360.6211f, 2720.76782f, false, 57251000u },
+    { 0, 33, 64, 1151.10571f, 39212.6055f, 2778.14258f, false, 57251000u },
+    { 0, 33, 64, 1154.66077f, 39356.0586f, 2787.79688f, false, 57251000u },
+    { 0, 33, 64, 1183.39893f, 40518.668f, 2865.97559f, false, 57251000u },
+    { 0, 33, 64, 1201.63281f, 41259.0352f, 2915.70239f, false, 57255000u },
+    { 0, 33, 64, 1201.63281f, 41259.0352f, 2915.70239f, false, 57255000u },
+    { 0, 33, 64, 1231.24988f, 42466.0039f, 2996.67334f, false, 57255000u },
+    { 0, 33, 64, 1250.04004f, 43234.5312f, 3048.17114f, false, 57255000u },
+    { 0, 33, 64, 1261.41821f, 43700.9453f, 3079.4021f, false, 57255000u },
+    { -2, -99, -99, 1261.41821f, 43700.9453f, 3079.4021f, false, 57259000u },
+    { 0, 33, 64, 1292.14624f, 44964.4062f, 3163.92041f, false, 57259000u },
+    { 0, 33, 64, 1296.02698f, 45124.375f, 3174.61255f, false, 57259000u },
+    { 0, 33, 64, 1311.63953f, 45768.8086f, 3217.66797f, false, 57259000u },
+    { 0, 33, 64, 1335.32703f, 46749.2539f, 3283.1145f, false, 57264000u },
+    { 0, 33, 64, 1335.32703f, 46749.2539f, 3283.1145f, false, 57264000u },
+    { 0, 33, 64, 1375.53308f, 48420.7266f, 3394.53149f, false, 57264000u },
+    { 0, 33, 64, 1367.4187f, 48082.6562f, 3372.01196f, false, 57264000u },
+    { 0, 33, 64, 1383.68457f, 48760.7148f, 3417.17065f, false, 57264000u },
+    { 0, 33, 64, 1404.22546f, 49619.082f, 3474.29248f, false, 57269000u },
+    { 0, 33, 64, 1429.18372f, 50665.1562f, 3543.83911f, false, 57269000u },
+    { 0, 32, 64, 1459.07678f, 51922.4922f, 3627.33643f, false, 57269000u },
+    { 0, 32, 64, 1471.92114f, 52464.207f, 3663.2793f, false, 57269000u },
+    { 0, 32, 64, 1524.17505f, 54676.9453f, 3809.90479f, false, 57278000u },
+    { 0, 32, 64, 1550.83496f, 55811.3125f, 3884.95703f, false, 57278000u },
+    { 0, 32, 64, 1550.83496f, 55811.3125f, 3884.95703f, false, 57278000u },
+    { 0, 32, 64, 1555.31299f, 56002.2031f, 3897.57935f, false, 57278000u },
+    { 0, 32, 64, 1573.32654f, 56771.1172f, 3948.40015f, false, 57278000u },
+    { 0, 32, 64, 1605.23999f, 58137.3242f, 4038.61426f, false, 57278000u },
+    { -2, -99, -99, 1591.50171f, 57548.5742f, 3999.75073f, false, 57283000u },
+    { 0, 32, 64, 1623.70093f, 58929.9297f, 4090.90332f, false, 57283000u },
+    { 0, 32, 64, 1628.34204f, 59129.4531f, 4104.06055f, false, 57283000u },
+    { 0, 32, 64, 1628.34204f, 59129.4531f, 4104.06055f, false, 57283000u },
+    { 0, 32, 64, 1637.65527f, 59530.1523f, 4130.47754f, false, 57287000u },
+    { 0, 32, 64, 1647.00964f, 59933.0391f, 4157.0293f, false, 57287000u },
+    { 0, 32, 64, 1661.11987f, 60541.5586f, 4197.1167f, false, 57287000u },
+    { 0, 32, 64, 1656.40601f, 60338.1602f, 4183.71973f, false, 57287000u },
+    { 0, 32, 64, 1684.84619f, 61566.9297f, 4264.61914f, false, 57292000u },
+    { 0, 32, 64, 1680.08008f, 61360.7383f, 4251.04932f, false, 57292000u },
+    { -1, -99, -99, 1675.32422f, 61155.1016f, 4237.51416f, false, 57292000u },
+    { 0, 31, 64, 1698.47156f, 62156.9766f, 4303.4375f, false, 57292000u },
+    { 0, 31, 64, 1712.96863f, 62785.7305f, 4344.78223f, false, 57292000u },
+    { 0, 31, 64, 1703.29321f, 62365.9883f, 4317.18359f, false, 57292000u },
+    { 0, 31, 64, 1732.44788f, 63632.1133f, 4400.40479f, false, 57297000u },
+    { 0, 31, 64, 1727.56165f, 63419.6406f, 4386.44482f, false, 57297000u },
+    { 0, 31, 64, 1732.44788f, 63632.1133f, 4400.40479f, false, 57297000u },
+    { 0, 31, 64, 1722.68665f, 63207.7617f, 4372.52197f, false, 57297000u },
+    { 0, 31, 64, 1732.44788f, 63632.1133f, 4400.40479f, false, 57297000u },
+    { 0, 31, 64, 1742.25244f, 64058.793f, 4428.43115f, false, 57302000u },
+    { 0, 31, 64, 1712.96863f, 62785.7305f, 4344.78223f, false, 57302000u },
+    { 0, 31, 64, 1722.68665f, 63207.7617f, 4372.52197f, false, 57302000u },
+    { 0, 31, 64, 1722.68665f, 63207.7617f, 4372.52197f, false, 57302000u },
+    { 0, 31, 64, 1722.68665f, 63207.7617f, 4372.52197f, false, 57302000u },
+    { 0, 31, 64, 1712.96863f, 62785.7305f, 4344.78223f, false, 57307000u },
+    { 0, 31, 64, 1717.8219f, 62996.4414f, 4358.6333f, false, 57307000u },
+    { 0, 31, 64, 1708.12549f, 62575.5664f, 4330.96484f, false, 57307000u },
+    { 0, 31, 64, 1717.8219f, 62996.4414f, 4358.6333f, false, 57307000u },
+    { 0, 31, 64, 1698.47156f, 62156.9766f, 4303.4375f, false, 57307000u },
+    { 0, 31, 64, 1698.47156f, 62156.9766f, 4303.4375f, false, 57312000u },
+    { 0, 31, 64, 1708.12549f, 62575.5664f, 4330.96484f, false, 57312000u },
+    { 0, 31, 64, 1703.29321f, 62365.9883f, 4317.18359f, false, 57312000u },
+    { 0, 31, 64, 1688.86047f, 61740.6797f, 4276.05127f, false, 57312000u },
+    { 0, 31, 64, 1665.0188f, 60709.8711f, 4208.20068f, false, 57316000u },
+    { 0, 31, 64, 1655.55603f, 60301.4961f, 4181.3042f, false, 57316000u },
+    { 0, 30, 64, 1686.20374f, 61625.6797f, 4268.48486f, false, 57316000u },
+    { 0, 30, 64, 1671.83582f, 61004.3359f, 4227.58887f, false, 57316000u },
+    { 0, 30, 64, 1648.10168f, 59980.1016f, 4160.13037f, false, 57316000u },
+    { 0, 30, 64, 1662.31018f, 60592.9375f, 4200.5f, false, 57322000u },
+    { 0, 30, 64, 1629.30396f, 59170.8164f, 4106.78809f, false, 57322000u },
+    { 0, 30, 64, 1643.38647f, 59776.9375f, 4146.74268f, false, 57322000u },
+    { 0, 30, 64, 1606.04199f, 58171.7227f, 4040.88428f, false, 57322000u },
+    { 0, 30, 64, 1601.42041f, 57973.543f, 4027.80493f, false, 57322000u },
+    { 0, 30, 64, 1583.03821f, 57186.3359f, 3975.82959f, false, 57322000u },
+    { 0, 30, 64, 1583.03821f, 57186.3359f, 3975.82959f, false, 57328000u },
+    { 0, 30, 64, 1578.46851f, 56990.9023f, 3962.92041f, false, 57328000u },
+    { 0, 30, 64, 1564.82019f, 56407.8164f, 3924.39233f, false, 57328000u },
+    { 0, 30, 64, 1542.27649f, 55446.7578f, 3860.8457f, false, 57328000u },
+    { 0, 30, 64, 1542.27649f, 55446.7578f, 3860.8457f, false, 57328000u },
+    { 0, 30, 64, 1524.4231f, 54687.4844f, 3810.60254f, false, 57328000u },
+    { 0, 30, 64, 1489.19531f, 53194.1172f, 3711.68018f, false, 57332000u },
+    { 0, 30, 64, 1471.81885f, 52459.8867f, 3662.99292f, false, 57332000u },
+    { 0, 30, 64, 1476.14832f, 52642.6758f, 3675.11694f, false, 57332000u },
+    { 0, 30, 64, 1450.31787f, 51553.5859f, 3602.84863f, false, 57332000u },
+    { 0, 30, 64, 1446.04675f, 51373.8438f, 3590.91431f, false, 57337000u },
+    { 0, 30, 64, 1408.04089f, 49778.7773f, 3484.91431f, false, 57337000u },
+    { 0, 30, 64, 1408.04089f, 49778.7773f, 3484.91431f, false, 57337000u },
+    { 0, 30, 64, 1379.01416f, 48565.875f, 3404.19751f, false, 57337000u },
+    { 0, 30, 64, 1374.90515f, 48394.5508f, 3392.78809f, false, 57342000u },
+    { 0, 29, 64, 1378.03381f, 48524.9883f, 3401.47485f, false, 57342000u },
+    { 0, 29, 64, 1361.59644f, 47840.3125f, 3355.8645f, false, 57342000u },
+    { 0, 29, 64, 1337.22168f, 46827.8125f, 3288.35547f, false, 57342000u },
+    { 0, 29, 64, 1337.22168f, 46827.8125f, 3288.35547f, false, 57342000u },
+    { -2, -99, -99, 1313.18042f, 45832.4883f, 3221.9209f, false, 57342000u },
+    { 0, 29, 64, 1285.54956f, 44692.6992f, 3145.75488f, false, 57348000u },
+    { 0, 29, 64, 1266.08496f, 43892.4727f, 3092.22192f, false, 57348000u },
+    { 0, 29, 64, 1273.84363f, 44211.1758f, 3113.54785f, false, 57348000u },
+    { 0, 29, 64, 1239.21045f, 42791.332f, 3018.47876f, false, 57348000u },
+    { 0, 29, 64, 1220.28003f, 42018.3242f, 2966.65381f, false, 57348000u },
+    { 0, 29, 64, 1220.28003f, 42018.3242f, 2966.65381f, false, 57354000u },
+    { 0, 29, 64, 1190.44666f, 40804.5859f, 2885.18457f, false, 57354000u },
+    { 0, 29, 64, 1168.43481f, 39912.6367f, 2825.23755f, false, 57354000u },
+    { 0, 29, 64, 1168.43481f, 39912.6367f, 2825.23755f, false, 57354000u },
+    { 0, 29, 64, 1150.32666f, 39181.1836f, 2776.02734f, false, 57354000u },
+    { 0, 29, 64, 1114.74292f, 37750.0273f, 2679.60938f, false, 57354000u },
+    { 0, 29, 64, 1114.74292f, 37750.0273f, 2679.60938f, false, 57358000u },
+    { 0, 29, 64, 1086.87476f, 36635.0352f, 2604.36523f, false, 57358000u },
+    { 0, 29, 64, 1076.55957f, 36223.6523f, 2576.57471f, false, 57358000u },
+    { 0, 29, 64, 1042.70239f, 34878.5273f, 2485.59473f, false, 57358000u },
+    { 0, 29, 64, 1036.02734f, 34614.2734f, 2467.70117f, false, 57362000u },
+    { 0, 29, 64, 1029.38391f, 34351.5781f, 2449.90625f, false, 57362000u },
+    { 0, 29, 64, 999.879944f, 33188.7383f, 2371.05322f, false, 57362000u },
+    { 0, 29, 64, 993.409668f, 32934.5586f, 2353.79883f, false, 57362000u },
+    { 0, 28, 64, 989.551208f, 32783.1289f, 2343.51636f, false, 57362000u },
+    { 0, 28, 64, NAN, NAN, NAN, false, 57367000u },
+    { 0, 28, 64, 963.92804f, 31780.2949f, 2275.36011f, false, 57367000u },
+    { 0, 28, 64, 941.912292f, 30922.5547f, 2216.97949f, false, 57367000u },
+    { 0, 28, 64, 914.152588f, 29846.291f, 2143.61084f, false, 57367000u },
+    { 0, 28, 64, 898.992737f, 29261.0586f, 2103.6604f, false, 57371000u },
+    { 0, 28, 64, 892.980835f, 29029.4766f, 2087.84058f, false, 57371000u },
+    { 0, 28, 64, 884.018127f, 28684.7598f, 2064.28076f, false, 57371000u },
+    { 0, 28, 64, 866.290283f, 28004.8223f, 2017.76831f, false, 57371000u },
+    { 0, 28, 64, 843.058716f, 27117.6777f, 1956.99622f, false, 57376000u },
+    { 0, 28, 64, 823.106689f, 26359.3516f, 1904.96985f, false, 57376000u },
+    { 0, 28, 64, 811.86084f, 25933.4102f, 1875.71448f, false, 57376000u },
+    { 0, 28, 64, 792.449646f, 25200.7598f, 1825.33704f, false, 57376000u },
+    { 0, 28, 64, 784.234436f, 24891.6777f, 1804.0625f, false, 57376000u },
+    { 0, 28, 64, 776.081055f, 24585.5117f, 1782.97559f, false, 57376000u },
+    { 0, 28, 64, 762.628723f, 24081.6621f, 1748.24475f, false, 57382000u },
+    { 0, 28, 64, 744.079468f, 23389.5938f, 1700.48059f, false, 57382000u },
+    { 0, 28, 64, 731.03064f, 22904.6426f, 1666.96875f, false, 57382000u },
+    { 0, 28, 64, 723.280945f, 22617.3828f, 1647.10132f, false, 57382000u },
+    { 0, 28, 64, 713.039978f, 22238.6465f, 1620.88818f, false, 57382000u },
+    { 0, 28, 64, 690.378967f, 21404.1641f, 1563.05212f, false, 57382000u },
+    { 0, 28, 64, 670.673157f, 20682.5879f, 1512.95056f, false, 57387000u },
+    { 0, 28, 64, 673.114197f, 20771.7617f, 1519.14697f, false, 57387000u },
+    { 0, 28, 64, 646.609985f, 19806.748f, 1452.02014f, false, 57387000u },
+    { 0, 27, 64, 660.045288f, 20295.0332f, 1486.00537f, false, 57387000u },
+    { 0, 27, 64, 638.480957f, 19512.2168f, 1431.50012f, false, 57391000u },
+    { 0, 27, 64, 633.757629f, 19341.3965f, 1419.59204f, false, 57391000u },
+    { 0, 27, 64, 612.809692f, 18586.6562f, 1366.91431f, false, 57391000u },
+    { 0, 27, 64, 603.658752f, 18258.4316f, 1343.97253f, false, 57391000u },
+    { 0, 27, 64, 599.11969f, 18095.9629f, 1332.60901f, false, 57391000u },
+    { 0, 27, 64, 587.877747f, 17694.5566f, 1304.51123f, false, 57397000u },
+    { 0, 27, 64, 576.7854f, 17299.877f, 1276.85327f, false, 57397000u },
+    { 0, 27, 64, 557.19165f, 16606.1289f, 1228.16052f, false, 57397000u },
+    { 0, 27, 64, 548.635315f, 16304.5781f, 1206.96362f, false, 57397000u },
+    { 0, 27, 64, 538.070251f, 15933.4248f, 1180.84741f, false, 57397000u },
+    { 0, 27, 64, 529.721313f, 15641.0732f, 1160.25464f, false, 57397000u },
+    { 0, 27, 64, 515.329285f, 15139.1084f, 1124.85205f, false, 57402000u },
+    { 0, 27, 64, 515.329285f, 15139.1084f, 1124.85205f, false, 57402000u },
+    { 0, 27, 64, 499.21814f, 14580.2422f, 1085.36694f, false, 57402000u },
+    { 0, 27, 64, 491.295624f, 14306.6338f, 1066.00854f, false, 57402000u },
+    { 0, 27, 64, 487.36731f, 14171.2686f, 1056.42432f, false, 57402000u },
+    { 0, 27, 64, 477.642273f, 13837.0195f, 1032.73889f, false, 57407000u },
+    { 0, 27, 64, 458.597046f, 13186.082f, 986.529602f, false, 57407000u },
+    { 0, 27, 64, 454.852112f, 13058.665f, 977.471191f, false, 57407000u },
+    { 0, 27, 64, 440.083527f, 12558.0723f, 941.8396f, false, 57407000u },
+    { 0, 27, 64, 438.261017f, 12496.5098f, 937.452759f, false, 57407000u },
+    { 0, 27, 64, 425.648834f, 12071.7793f, 907.157776f, false, 57413000u },
+    { 0, 27, 64, 422.091858f, 11952.4092f, 898.63385f, false, 57413000u },
+    { 0, 26, 64, 422.551788f, 11967.834f, 899.735596f, false, 57413000u },
+    { 0, 26, 64, 408.420044f, 11495.3271f, 865.955139f, false, 57413000u },
+    { 0, 26, 64, 403.20517f, 11321.7168f, 853.526123f, false, 57413000u },
+    { 0, 26, 64, 399.754028f, 11207.0518f, 845.311768f, false, 57413000u },
+    { 0, 26, 64, 384.473053f, 10701.541f, 809.047668f, false, 57418000u },
+    { 0, 26, 64, 384.473053f, 10701.541f, 809.047668f, false, 57418000u },
+    { 0, 26, 64, 374.509918f, 10373.9287f, 785.5f, false, 57418000u },
+    { 0, 26, 64, NAN, NAN, NAN, false, 57418000u },
+    { 0, 26, 64, 358.29715f, 9844.25293f, 747.349487f, false, 57424000u },
+    { 0, 26, 64, 348.801544f, 9536.06055f, 725.104614f, false, 57424000u },
+    { 0, 26, 64, 347.235687f, 9485.38574f, 721.443604f, false, 57424000u },
+    { 0, 26, 64, 341.019836f, 9284.64258f, 706.93103f, false, 57424000u },
+    { 0, 26, 64, 336.407562f, 9136.12207f, 696.183838f, false, 57424000u },
+    { 0, 26, 64, 324.314209f, 8748.49219f, 668.09259f, false, 57424000u },
+    { 0, 26, 64, 324.314209f, 8748.49219f, 668.09259f, false, 57428000u },
+    { 0, 26, 64, 309.613129f, 8280.85938f, 634.120422f, false, 57428000u },
+    { 0, 26, 64, 311.062714f, 8326.79102f, 637.461426f, false, 57428000u },
+    { 0, 26, 64, 306.727631f, 8189.5459f, 627.475769f, false, 57428000u },
+    { -2, -99, -99, 296.770355f, 7875.66602f, 604.606873f, false, 57428000u },
+    { 0, 26, 64, 295.365845f, 7831.5459f, 601.388672f, false, 57434000u },
+    { 0, 26, 64, 285.658051f, 7527.6626f, 579.198242f, false, 57434000u },
+    { 0, 26, 64, 281.563599f, 7400.05908f, 569.867065f, false, 57434000u },
+    { 0, 26, 64, 270.836609f, 7067.38135f, 545.501221f, false, 57434000u },
+    { 0, 26, 64, 273.492371f, 7149.52295f, 551.522583f, false, 57434000u },
+    { 0, 25, 64, 273.290802f, 7143.2832f, 551.065308f, false, 57439000u },
+    { 0, 25, 64, 269.283813f, 7019.42383f, 541.98407f, false, 57439000u },
+    { 0, 25, 64, 261.387177f, 6776.32666f, 524.136902f, false, 57439000u },
+    { 0, 25, 64, 257.496979f, 6657.0625f, 515.369385f, false, 57439000u },
+    { 0, 25, 64, 249.831848f, 6423.04053f, 498.14267f, false, 57439000u },
+    { 0, 25, 64, 242.318848f, 6194.94287f, 481.321838f, false, 57439000u },
+    { 0, 25, 64, 239.848038f, 6120.21045f, 475.804077f, false, 57445000u },
+    { 0, 25, 64, 234.956207f, 5972.67041f, 464.900757f, false, 57445000u },
+    { 0, 25, 64, 233.743576f, 5936.18359f, 462.202301f, false, 57445000u },
+    { 0, 25, 64, 230.130417f, 5827.67578f, 454.172394f, false, 57445000u },
+    { 0, 25, 64, 224.190231f, 5649.9668f, 441.005219f, false, 57445000u },
+    { 0, 25, 64, 223.014389f, 5614.89209f, 438.403961f, false, 57445000u },
+    { 0, 25, 64, 212.613052f, 5306.12354f, 415.468994f, false, 57450000u },
+    { 0, 25, 64, 210.345596f, 5239.17725f, 410.48761f, false, 57450000u },
+    { 0, 25, 64, 205.858078f, 5107.07617f, 400.648804f, false, 57450000u },
+    { 0, 25, 64, 208.093948f, 5172.8291f, 405.547607f, false, 57450000u },
+    { 0, 25, 64, 197.071228f, 4849.95654f, 381.461823f, false, 57450000u },
+    { 0, 25, 64, 194.9133f, 4787.13037f, 376.76593f, false, 57455000u },
+    { 0, 25, 64, 195.990356f, 4818.47217f, 379.108917f, false, 57455000u },
+    { 0, 25, 64, 189.585846f, 4632.57666f, 365.200714f, false, 57455000u },
+    { 0, 25, 64, 184.353729f, 4481.56543f, 353.881927f, false, 57455000u },
+    { 0, 25, 64, 183.318665f, 4451.78369f, 351.647461f, false, 57460000u },
+    { 0, 25, 64, 179.216003f, 4334.04492f, 342.806366f, false, 57460000u },
+    { 0, 25, 64, 173.174026f, 4161.55566f, 329.832214f, false, 57460000u },
+    { 0, 24, 64, 177.596741f, 4287.71094f, 339.323822f, false, 57460000u },
+    { 0, 24, 64, 176.577301f, 4258.58008f, 337.133362f, false, 57460000u },
+    { 0, 24, 64, 170.539978f, 4086.70215f, 324.193634f, false, 57465000u },
+    { 0, 24, 64, 170.539978f, 4086.70215f, 324.193634f, false, 57465000u },
+    { 0, 24, 64, 163.666214f, 3892.37329f, 309.530823f, false, 57465000u },
+    { 0, 24, 64, 163.666214f, 3892.37329f, 309.530823f, false, 57465000u },
+    { 0, 24, 64, 159.81955f, 3784.27417f, 301.358612f, false, 57465000u },
+    { 0, 24, 64, 157.918167f, 3731.01782f, 297.328186f, false, 57469000u },
+    { 0, 24, 64, 151.377487f, 3548.72559f, 283.510345f, false, 57469000u },
+    { -2, -99, -99, 150.457489f, 3523.19946f, 281.572662f, false, 57469000u },
+    { 0, 24, 64, 149.541138f, 3497.80347f, 279.644165f, false, 57469000u },
+    { 0, 24, 64, 146.813339f, 3422.37354f, 273.912079f, false, 57469000u },
+    { 0, 24, 64, 144.117508f, 3348.0813f, 268.260254f, false, 57474000u },
+    { 0, 24, 64, 143.225967f, 3323.56787f, 266.394012f, false, 57474000u },
+    { 0, 24, 64, 137.950409f, 3179.09399f, 255.380844f, false, 57474000u },
+    { 0, 24, 64, 135.359634f, 3108.51392f, 249.991547f, false, 57474000u },
+    { 0, 24, 64, 135.359634f, 3108.51392f, 249.991547f, false, 57474000u },
+    { -2, -99, -99, 131.95372f, 3016.10547f, 242.926178f, false, 57479000u },
+    { 0, 24, 64, 130.271332f, 2970.62036f, 239.444534f, false, 57479000u },
+    { 0, 24, 64, 128.602631f, 2925.6123f, 235.99678f, false, 57479000u },
+    { -1, -99, -99, 124.490211f, 2815.15332f, 227.523926f, false, 57479000u },
+    { 0, 24, 64, 125.305946f, 2837.01123f, 229.201859f, false, 57479000u },
+    { 0, 23, 64, 116.485321f, 2602.08203f, 211.132492f, false, 57489000u },
+    { 0, 23, 64, 114.13533f, 2540.03345f, 206.346725f, false, 57489000u },
+    { 0, 23, 64, 111.815369f, 2479.00806f, 201.634186f, false, 57489000u },
+    { 0, 23, 64, 107.264748f, 2359.98633f, 192.426178f, false, 57489000u },
+    { 0, 23, 64, 107.264748f, 2359.98633f, 192.426178f, false, 57489000u },
+    { 0, 23, 64, 107.264748f, 2359.98633f, 192.426178f, false, 57494000u },
+    { 0, 23, 64, 105.033714f, 2301.96997f, 187.929428f, false, 57494000u },
+    { 0, 23, 64, 101.380295f, 2207.45679f, 180.591675f, true, 57494000u },
+    { 0, 23, 64, 97.807312f, 2115.62939f, 173.447372f, true, 57494000u },
+    { 0, 23, 64, 97.807312f, 2115.62939f, 173.447372f, true, 57494000u },
+    { 0, 23, 64, 95.0062714f, 2044.07092f, 167.869308f, false, 57500000u },
+    { 0, 23, 64, 94.3139038f, 2026.44226f, 166.493652f, false, 57500000u },
+    { 0, 23, 64, 92.9386368f, 1991.49707f, 163.764908f, false, 57500000u },
+    { 0, 23, 64, 90.2256927f, 1922.84167f, 158.396835f, false, 57500000u },
+    { 0, 23, 64, 90.2256927f, 1922.84167f, 158.396835f, false, 57500000u },
+    { 0, 23, 64, 90.2256927f, 1922.84167f, 158.396835f, false, 57504000u },
+    { 0, 23, 64, 85.5974731f, 1806.5979f, 149.285828f, false, 57504000u },
+    { 0, 23, 64, 88.2236481f, 1872.41943f, 154.448303f, false, 57504000u },
+    { 0, 23, 64, 83.0202942f, 1742.36487f, 144.238861f, false, 57504000u },
+    { 0, 23, 64, 82.3836136f, 1726.55237f, 142.995026f, false, 57508000u },
+    { 0, 23, 64, 81.7499466f, 1710.83728f, 141.75827f, false, 57508000u },
+    { 0, 22, 64, 82.782074f, 1736.44592f, 143.773331f, false, 57508000u },
+    { 0, 22, 64, 80.8641739f, 1688.90735f, 140.031479f, false, 57508000u },
+    { 0, 22, 64, 80.8641739f, 1688.90735f, 140.031479f, false, 57508000u },
+    { 0, 22, 64, NAN, NAN, NAN, false, 57513000u },
+    { -2, -99, -99, 78.9739609f, 1642.25781f, 136.354477f, false, 57513000u },
+    { 0, 22, 64, 75.8845901f, 1566.45728f, 130.36853f, false, 57513000u },
+    { 0, 22, 64, 75.8845901f, 1566.45728f, 130.36853f, false, 57513000u },
+    { 0, 22, 64, 73.4675064f, 1507.54614f, 125.706352f, false, 57513000u },
+    { 0, 22, 64, 75.2758179f, 1551.58679f, 129.192535f, false, 57518000u },
+    { 0, 22, 64, 71.0983582f, 1450.14856f, 121.15519f, false, 57518000u },
+    { 0, 22, 64, 72.8707504f, 1493.05591f, 124.55822f, false, 57518000u },
+    { 0, 22, 64, 71.0983582f, 1450.14856f, 121.15519f, false, 57518000u },
+    { 0, 22, 64, 70.513504f, 1436.03296f, 120.034561f, false, 57524000u },
+    { 0, 22, 64, 68.7766647f, 1394.24146f, 116.713539f, false, 57524000u },
+    { 0, 22, 64, 67.0663147f, 1353.27686f, 113.453392f, false, 57524000u },
+    { 0, 22, 64, 67.0663147f, 1353.27686f, 113.453392f, false, 57524000u },
+    { 0, 22, 64, 64.2740707f, 1286.81445f, 108.153419f, false, 57524000u },
+    { 0, 22, 64, 64.8266983f, 1299.927f, 109.200127f, false, 57524000u },
+    { 0, 22, 64, 64.2740707f, 1286.81445f, 108.153419f, false, 57529000u },
+    { 0, 22, 64, 63.1774216f, 1260.85535f, 106.079666f, false, 57529000u },
+    { 0, 22, 64, 61.0186157f, 1209.99683f, 102.010559f, false, 57529000u },
+    { 0, 22, 64, 62.092289f, 1235.25037f, 104.032104f, false, 57529000u },
+    { 0, 22, 64, 60.4860573f, 1197.50085f, 101.009491f, false, 57529000u },
+    { 0, 22, 64, 57.3501511f, 1124.33582f, 95.1374207f, false, 57529000u },
+    { 0, 21, 64, 61.2021904f, 1214.30884f, 102.355888f, false, 57534000u },
+    { 0, 21, 64, 60.6625099f, 1201.63879f, 101.341049f, false, 57534000u },
+    { 0, 21, 64, 59.5918427f, 1176.5647f, 99.3310776f, false, 57534000u },
+    { -2, -99, -99, 56.9657593f, 1115.41724f, 94.4203491f, false, 57534000u },
+    { 0, 21, 64, 56.9657593f, 1115.41724f, 94.4203491f, false, 57539000u },
+    { 0, 21, 64, 55.4244766f, 1079.76855f, 91.5512543f, false, 57539000u },
+    { 0, 21, 64, 53.9087715f, 1044.88916f, 88.7394791f, false, 57539000u },
+    { 0, 21, 64, 53.9087715f, 1044.88916f, 88.7394791f, false, 57539000u },
+    { 0, 21, 64, 53.4091988f, 1033.43225f, 87.8148727f, false, 57539000u },
+    { 0, 21, 64, 52.4184761f, 1010.77014f, 85.9844513f, false, 57545000u },
+    { 0, 21, 64, 51.9273148f, 999.564331f, 85.0786057f, false, 57545000u },
+    { 0, 21, 64, 50.953392f, 977.402039f, 83.2855606f, false, 57545000u },
+    { 0, 21, 64, 49.9905853f, 955.569336f, 81.5171967f, false, 57545000u },
+    { 0, 21, 64, 49.5133476f, 944.776062f, 80.6422348f, false, 57545000u },
+    { 0, 21, 64, 48.5671387f, 923.433167f, 78.9105988f, false, 57545000u },
+    { 0, 21, 64, 45.3416862f, 851.261292f, 73.039856f, false, 57554000u },
+    { 0, 21, 64, 45.7943001f, 861.333374f, 73.8606033f, false, 57554000u },
+    { 0, 21, 64, 44.444561f, 831.352234f, 71.416069f, false, 57554000u },
+    { 0, 21, 64, 42.6825523f, 792.465881f, 68.2388458f, false, 57554000u },
+    { 0, 21, 64, 42.2487335f, 782.936584f, 67.4590836f, false, 57554000u },
+    { 0, 20, 64, 44.9149208f, 841.781311f, 72.2669067f, false, 57554000u },
+    { 0, 20, 64, 43.5646667f, 811.897278f, 69.827446f, false, 57559000u },
+    { 0, 20, 64, 44.4620781f, 831.740295f, 71.4477386f, false, 57559000u },
+    { 0, 20, 64, 43.1200752f, 802.094604f, 69.0262756f, false, 57559000u },
+    { 0, 20, 64, 40.9379997f, 754.255005f, 65.1092072f, false, 57559000u },
+    { 0, 20, 64, 42.6782112f, 792.370361f, 68.2310333f, false, 57564000u },
+    { 0, 20, 64, 39.6612282f, 726.47876f, 62.829258f, false, 57564000u },
+    { 0, 20, 64, 39.6612282f, 726.47876f, 62.829258f, false, 57564000u },
+    { 0, 20, 64, 39.6612282f, 726.47876f, 62.829258f, false, 57564000u },
+    { 0, 20, 64, 39.2410126f, 717.372681f, 62.080864f, false, 57564000u },
+    { 0, 20, 64, 37.5868416f, 681.702515f, 59.1446266f, false, 57564000u },
+    { 0, 20, 64, 37.9963951f, 690.507568f, 59.8701248f, false, 57569000u },
+    { 0, 20, 64, 37.1799316f, 672.971802f, 58.4247932f, false, 57569000u },
+    { 0, 20, 64, 36.7756691f, 664.315247f, 57.7106094f, false, 57569000u },
+    { 0, 20, 64, 36.3740349f, 655.732361f, 57.0020447f, false, 57569000u },
+    { 0, 20, 64, 35.5786629f, 638.786926f, 55.6017342f, false, 57573000u },
+    { 0, 20, 64, 37.1799316f, 672.971802f, 58.4247932f, false, 57573000u },
+    { 0, 20, 64, 36.3740349f, 655.732361f, 57.0020447f, false, 57573000u },
+    { 0, 20, 64, 33.255127f, 589.687439f, 51.5336533f, false, 57577000u },
+    { 0, 20, 64, 34.019268f, 605.767212f, 52.8677254f, false, 57577000u },
+    { 0, 20, 64, 34.019268f, 605.767212f, 52.8677254f, false, 57577000u },
+    { 0, 19, 64, 32.7869072f, 579.868286f, 50.7181053f, false, 57582000u },
+    { 0, 19, 64, 32.0297661f, 564.044739f, 49.4023972f, false, 57582000u },
+    { 0, 19, 64, 32.7869072f, 579.868286f, 50.7181053f, false, 57582000u },
+    { 0, 19, 64, 32.4070244f, 571.920532f, 50.0574913f, false, 57582000u },
+    { 0, 19, 64, 31.2831154f, 548.50769f, 48.1087151f, false, 57586000u },
+    { 0, 19, 64, 32.0297661f, 564.044739f, 49.4023972f, false, 57586000u },
+    { 0, 19, 64, 31.2831154f, 548.50769f, 48.1087151f, false, 57586000u },
+    { 0, 19, 64, 30.182663f, 525.733154f, 46.2090721f, false, 57586000u },
+    { 0, 19, 64, 29.4619694f, 510.900299f, 44.9696465f, false, 57590000u },
+    { 0, 19, 64, 30.182663f, 525.733154f, 46.2090721f, false, 57590000u },
+    { 0, 19, 64, 28.7515621f, 496.344391f, 43.7516174f, false, 57590000u },
+    { 0, 19, 64, 28.4002018f, 489.169556f, 43.1505775f, false, 57590000u },
+    { 0, 19, 64, 28.0514011f, 482.063141f, 42.5548325f, false, 57595000u },
+    { 0, 19, 64, 28.4002018f, 489.169556f, 43.1505775f, false, 57595000u },
+    { -1, -99, -99, 29.1054821f, 503.587891f, 44.3579674f, false, 57595000u },
+    { 0, 19, 64, 27.7051373f, 475.024475f, 41.9643364f, false, 57595000u },
+    { 0, 19, 64, 28.0514011f, 482.063141f, 42.5548325f, false, 57595000u },
+    { 0, 19, 64, 26.3454247f, 447.543213f, 39.654583f, false, 57600000u },
+    { 0, 19, 64, 26.6815662f, 454.313232f, 40.2242317f, false, 57600000u },
+    { 0, 19, 64, 26.6815662f, 454.313232f, 40.2242317f, false, 57600000u },
+    { 0, 19, 64, 26.6815662f, 454.313232f, 40.2242317f, false, 57605000u },
+    { 0, 19, 64, 26.011795f, 440.839478f, 39.0900841f, false, 57605000u },
+    { 0, 19, 64, 26.011795f, 440.839478f, 39.0900841f, false, 57620000u },
+    { 0, 19, 64, 27.0202332f, 461.149994f, 40.7990685f, false, 57631000u },
+    { 0, 19, 64, 25.6806698f, 434.201752f, 38.5307236f, false, 57651000u },
+    { 0, 19, 64, 26.6815662f, 454.313232f, 40.2242317f, false, 57672000u },
+    { 0, 19, 64, 25.6806698f, 434.201752f, 38.5307236f, false, 57701000u },
+    { 0, 19, 64, 26.3454247f, 447.543213f, 39.654583f, false, 57730000u },
+    { 0, 19, 64, 26.3454247f, 447.543213f, 39.654583f, false, 57753000u },
+    { 0, 19, 64, 25.352047f, 427.629761f, 37.9764748f, false, 57781000u },
+    { 0, 19, 64, 26.6815662f, 454.313232f, 40.2242317f, false, 57811000u },
+    { 0, 19, 64, 26.6815662f, 454.313232f, 40.2242317f, false, 57835000u },
+    { 0, 18, 64, 27.2308712f, 465.410156f, 41.1570473f, false, 57864000u },
+    { 0, 18, 64, 27.2308712f, 465.410156f, 41.1570473f, false, 57875000u },
+    { 0, 18, 64, 27.9283581f, 479.56015f, 42.3448982f, false, 57893000u },
+    { 0, 18, 64, 26.8860245f, 458.438751f, 40.5711594f, false, 57933000u },
+    { 0, 18, 64, 27.9283581f, 479.56015f, 42.3448982f, false, 57948000u },
+    { -2, -99, -99, 27.5783081f, 472.450439f, 41.7482796f, false, 58012000u },
+    { 0, 18, 64, 26.5437717f, 451.536072f, 39.9906044f, false, 58037000u },
+    { 0, 18, 64, 27.5783081f, 472.450439f, 41.7482796f, false, 58063000u },
+    { 0, 18, 64, 26.5437717f, 451.536072f, 39.9906044f, false, 58084000u },
+    { 0, 18, 64, 27.5783081f, 472.450439f, 41.7482796f, false, 58109000u },
+    { 0, 18, 64, 27.9283581f, 479.56015f, 42.3448982f, false, 58139000u },
+    { 0, 18, 64, 27.9283581f, 479.56015f, 42.3448982f, false, 58160000u },
+    { 0, 18, 64, 26.2041035f, 444.701691f, 39.4153595f, false, 58190000u },
+    { 0, 18, 64, 28.0600891f, 482.23996f, 42.5696602f, false, 58215000u },
+    { 0, 18, 64, 26.3277016f, 447.186676f, 39.6245728f, false, 58240000u },
+    { 0, 18, 64, 27.708395f, 475.090637f, 41.9698868f, false, 58296000u },
+    { 0, 18, 64, 28.0600891f, 482.23996f, 42.5696602f, false, 58320000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, false, 58372000u },
+    { 0, 18, 64, 28.0600891f, 482.23996f, 42.5696602f, false, 58399000u },
+    { 0, 18, 64, 27.3593159f, 468.010986f, 41.375515f, false, 58429000u },
+    { 0, 18, 64, 27.3593159f, 468.010986f, 41.375515f, false, 58484000u },
+    { 0, 18, 64, 28.0600891f, 482.23996f, 42.5696602f, false, 58509000u },
+    { 0, 18, 64, 28.0600891f, 482.23996f, 42.5696602f, false, 58534000u },
+    { 0, 18, 64, 26.6689758f, 454.059357f, 40.202877f, false, 58564000u },
+    { 0, 18, 64, 26.3277016f, 447.186676f, 39.6245728f, false, 58589000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, false, 58617000u },
+    { 0, 18, 64, 26.3277016f, 447.186676f, 39.6245728f, false, 58642000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, false, 58672000u },
+    { 0, 18, 64, 27.3593159f, 468.010986f, 41.375515f, false, 58698000u },
+    { 0, 18, 64, 27.708395f, 475.090637f, 41.9698868f, false, 58724000u },
+    { 0, 18, 64, 25.9890156f, 440.382385f, 39.0515785f, false, 58752000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, false, 58783000u },
+    { 0, 18, 64, 26.6689758f, 454.059357f, 40.202877f, true, 58808000u },
+    { 0, 18, 64, 25.6529179f, 433.646149f, 38.4838791f, true, 58832000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, false, 58861000u },
+    { 0, 18, 64, 27.3593159f, 468.010986f, 41.375515f, false, 58890000u },
+    { 0, 18, 64, 25.6529179f, 433.646149f, 38.4838791f, false, 58913000u },
+    { 0, 18, 64, 25.6529179f, 433.646149f, 38.4838791f, false, 58941000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, false, 58968000u },
+    { 0, 18, 64, 27.708395f, 475.090637f, 41.9698868f, false, 58993000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, true, 59019000u },
+    { 0, 18, 64, 25.6529179f, 433.646149f, 38.4838791f, false, 59048000u },
+    { 0, 18, 64, 27.708395f, 475.090637f, 41.9698868f, false, 59070000u },
+    { 0, 18, 64, 27.3593159f, 468.010986f, 41.375515f, false, 59100000u },
+    { 0, 18, 64, 26.6689758f, 454.059357f, 40.202877f, false, 59124000u },
+    { 0, 18, 64, 26.6689758f, 454.059357f, 40.202877f, false, 59178000u },
+    { 0, 18, 64, 25.6529179f, 433.646149f, 38.4838791f, false, 59206000u },
+    { 0, 18, 64, 27.3593159f, 468.010986f, 41.375515f, false, 59231000u },
+    { 0, 18, 64, 25.6529179f, 433.646149f, 38.4838791f, false, 59261000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, false, 59284000u },
+    { 0, 18, 64, 27.3593159f, 468.010986f, 41.375515f, false, 59309000u },
+    { 0, 18, 64, 27.708395f, 475.090637f, 41.9698868f, false, 59335000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, false, 59364000u },
+    { 0, 18, 64, 25.9890156f, 440.382385f, 39.0515785f, false, 59389000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, false, 59420000u },
+    { 0, 18, 64, 27.708395f, 475.090637f, 41.9698868f, false, 59446000u },
+    { 0, 18, 64, 26.3277016f, 447.186676f, 39.6245728f, false, 59470000u },
+    { 0, 18, 64, 26.6689758f, 454.059357f, 40.202877f, false, 59499000u },
+    { 0, 18, 64, 26.6689758f, 454.059357f, 40.202877f, false, 59550000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, false, 59581000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, false, 59608000u },
+    { 0, 18, 64, 26.3277016f, 447.186676f, 39.6245728f, false, 59636000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, false, 59663000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, false, 59718000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, false, 59747000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, true, 59775000u },
+    { 0, 18, 64, 25.6529179f, 433.646149f, 38.4838791f, false, 59834000u },
+    { 0, 18, 64, 25.9890156f, 440.382385f, 39.0515785f, false, 59859000u },
+    { 0, 18, 64, 27.0128441f, 461.000641f, 40.7865143f, false, 59884000u },
+    { 0, 18, 64, 27.3593159f, 468.010986f, 41.375515f, false, 59914000u },
+    { 0, 18, 64, 26.6689758f, 454.059357f, 40.202877f, false, 59936000u },
+    { 0, 18, 64, 27.708395f, 475.090637f, 41.9698868f, false, 59967000u },
+    { 0, 18, 64, 25.9890156f, 440.382385f, 39.0515785f, false, 59992000u },
+};
+
+#define BENCH_CODEC_TRACE_SAMPLES (sizeof(bench_codec_trace) / sizeof(bench_codec_trace[0]))
+
+#endif // BENCH_CODEC_TRACE_H
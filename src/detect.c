@@ -0,0 +1,150 @@
+// src/detect.c
+#include <math.h>
+#include <string.h>
+#include "esp_log.h"
+
+#include "detect.h"
+
+static const char *TAG = "DETECT";
+
+// --- Signal Filters ---
+
+static float median_of(const float *values, uint8_t n) {
+    float sorted[DETECT_MEDIAN_N];
+    for (uint8_t i = 0; i < n; i++) { // Insertion sort, n <= DETECT_MEDIAN_N
+        float v = values[i];
+        int j = i - 1;
+        while (j >= 0 && sorted[j] > v) {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = v;
+    }
+    return (n & 1) ? sorted[n / 2] : 0.5f * (sorted[n / 2 - 1] + sorted[n / 2]);
+}
+
+// Least-squares slope of the median ring, in units per minute (times relative to the newest point)
+static float slope_of(const detect_signal_t *s) {
+    if (s->med_n < 3) return 0.0f;
+    uint8_t newest = (s->med_head + DETECT_SLOPE_N - 1) % DETECT_SLOPE_N;
+    float sx = 0, sy = 0;
+    for (uint8_t i = 0; i < s->med_n; i++) {
+        sx += (float)(s->med_us[i] - s->med_us[newest]) / 60e6f;
+        sy += s->med[i];
+    }
+    float mx = sx / s->med_n, my = sy / s->med_n;
+    float sxx = 0, sxy = 0;
+    for (uint8_t i = 0; i < s->med_n; i++) {
+        float dx = (float)(s->med_us[i] - s->med_us[newest]) / 60e6f - mx;
+        sxx += dx * dx;
+        sxy += dx * (s->med[i] - my);
+    }
+    return sxx > 0.0f ? sxy / sxx : 0.0f;
+}
+
+static void signal_update(detect_signal_t *s, float x, int64_t now_us) {
+    if (isnan(x)) return;
+    s->window[s->window_head] = x;
+    s->window_head = (s->window_head + 1) % DETECT_MEDIAN_N;
+    if (s->window_n < DETECT_MEDIAN_N) s->window_n++;
+    s->value = median_of(s->window, s->window_n);
+
+    s->med[s->med_head] = s->value;
+    s->med_us[s->med_head] = now_us;
+    s->med_head = (s->med_head + 1) % DETECT_SLOPE_N;
+    if (s->med_n < DETECT_SLOPE_N) s->med_n++;
+    s->slope_per_min = slope_of(s);
+
+    if (!s->primed) {
+        s->primed = true;
+        s->baseline = s->value;
+        s->last_us = now_us;
+    }
+}
+
+// Pulls the baseline towards the current median; only called while nothing looks wrong
+static void signal_track_baseline(detect_signal_t *s, int64_t now_us) {
+    if (!s->primed) return;
+    float dt_s = (float)(now_us - s->last_us) / 1e6f;
+    if (dt_s <= 0.0f) return;
+    s->baseline += (1.0f - expf(-dt_s / DETECT_BASELINE_TAU_S)) * (s->value - s->baseline);
+    s->last_us = now_us;
+}
+
+// --- Signatures ---
+
+static alarm_kind_t detect_classify(const detect_t *det) {
+    bool gas = false;
+    if (det->smoke.primed) {
+        float delta = det->smoke.value - det->smoke.baseline;
+        gas = delta >= DETECT_GAS_DELTA_PPM ||
+              (det->smoke.slope_per_min >= DETECT_GAS_ROR_PPM_MIN && delta >= DETECT_GAS_DELTA_PPM / 3);
+    }
+    if (det->temp.primed) {
+        float rise = det->temp.value - det->temp.baseline;
+        float ror = det->temp.slope_per_min;
+        if ((ror >= DETECT_FIRE_ROR_C_MIN && rise >= DETECT_FIRE_RISE_C) || det->temp.value >= DETECT_FIRE_FIXED_C ||
+            (gas && ror >= DETECT_FIRE_COMBINED_ROR && rise >= DETECT_FIRE_RISE_C)) {
+            return ALARM_FIRE;
+        }
+    }
+    return gas ? ALARM_GAS : ALARM_NONE;
+}
+
+// --- Public API ---
+
+void detect_init(detect_t *det) {
+    memset(det, 0, sizeof(*det));
+    det->state = ALARM_NONE;
+    det->candidate = ALARM_NONE;
+}
+
+bool detect_update(detect_t *det, const sensor_data_t *sample, int64_t now_us) {
+    float smoke = sample->mq2_smoke_ppm < 0 ? NAN : sample->mq2_smoke_ppm; // MQ2 error codes are negative
+    float temp = sample->dht_status == 0 ? (float)sample->temperature : NAN; // DHT11_OK
+    signal_update(&det->smoke, smoke, now_us);
+    signal_update(&det->temp, temp, now_us);
+
+    alarm_kind_t kind = detect_classify(det);
+    alarm_kind_t before = det->state;
+    if (kind != ALARM_NONE) {
+        det->clear_run = 0;
+        if (det->candidate_run == 0 || kind > det->candidate) det->candidate = kind;
+        if (det->candidate_run < UINT8_MAX) det->candidate_run++;
+        if (det->candidate_run >= DETECT_CONFIRM_SAMPLES && det->candidate > det->state) {
+            det->state = det->candidate; // Raise or escalate, never step down
+        }
+    } else {
+        det->candidate_run = 0;
+        det->candidate = ALARM_NONE;
+        if (det->state != ALARM_NONE && ++det->clear_run >= DETECT_CLEAR_SAMPLES) {
+            det->state = ALARM_NONE;
+            det->clear_run = 0;
+        }
+        if (det->state == ALARM_NONE) {
+            signal_track_baseline(&det->smoke, now_us);
+            signal_track_baseline(&det->temp, now_us);
+        }
+    }
+
+    if (det->state == before) return false;
+    ESP_LOGW(TAG, "%s: smoke %.0f ppm (baseline %.0f, %+.0f/min), %.1f C (%+.1f C/min)",
+             det->state == ALARM_FIRE ? "FIRE" : det->state == ALARM_GAS ? "GAS" : "Alarm cleared",
+             det->smoke.value, det->smoke.baseline, det->smoke.slope_per_min,
+             det->temp.value, det->temp.slope_per_min);
+    return true;
+}
+
+void detect_fill_frame(const detect_t *det, uint8_t seq, uint32_t timestamp_ms, alarm_frame_t *frame) {
+    memset(frame, 0, sizeof(*frame));
+    frame->hdr.magic = ESPNOW_CTRL_MAGIC;
+    frame->hdr.type = CTRL_ALARM;
+    frame->kind = (uint8_t)det->state;
+    frame->seq = seq;
+    frame->timestamp_ms = timestamp_ms;
+    frame->temperature = det->temp.primed ? det->temp.value : NAN;
+    frame->temp_slope_per_min = det->temp.slope_per_min;
+    frame->smoke_ppm = det->smoke.primed ? det->smoke.value : NAN;
+    frame->smoke_baseline_ppm = det->smoke.primed ? det->smoke.baseline : NAN;
+    frame->smoke_slope_per_min = det->smoke.slope_per_min;
+}
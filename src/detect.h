@@ -0,0 +1,76 @@
+// detect.h
+#ifndef DETECT_H
+#define DETECT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "shared_header.h"
+
+// Streaming fire/gas detection on the slave, run on every sample.
+//
+// MQ2 smoke ppm and DHT temperature each go through a rolling median (drops single
+// bad reads), a slow EMA baseline (follows sensor drift and the daily swing, frozen
+// while anything looks wrong) and a least-squares slope over the last few medians.
+// All state is fixed-size, so the sampling path stays allocation-free.
+//
+// Signatures, checked per sample and confirmed by DETECT_CONFIRM_SAMPLES in a row:
+//   ALARM_GAS  - smoke/gas reading well above its baseline, or rising fast
+//   ALARM_FIRE - rate-of-rise heat, a fixed-temperature limit, or moderate heat rise
+//                together with the gas signature
+// An alarm escalates from GAS to FIRE but never steps down; it clears after
+// DETECT_CLEAR_SAMPLES quiet samples. Every state change is one CTRL_ALARM frame.
+
+// --- Configuration ---
+#define DETECT_MEDIAN_N          5       // Rolling median window (samples)
+#define DETECT_SLOPE_N           6       // Medians in the slope fit
+#define DETECT_BASELINE_TAU_S    1800    // Baseline EMA time constant
+#define DETECT_CONFIRM_SAMPLES   2
+#define DETECT_CLEAR_SAMPLES     10
+#define DETECT_GAS_DELTA_PPM     150.0f  // Smoke ppm above baseline
+#define DETECT_GAS_ROR_PPM_MIN   300.0f  // Smoke ppm/min that counts with a third of the delta
+#define DETECT_FIRE_ROR_C_MIN    8.0f    // Rate-of-rise heat detector (class A1 is ~8 C/min)
+#define DETECT_FIRE_RISE_C       3.0f    // Rise over baseline the rate-of-rise also needs (DHT11 is 1 C steps)
+#define DETECT_FIRE_FIXED_C      50.0f   // Fixed-temperature limit (top of the DHT11 range)
+#define DETECT_FIRE_COMBINED_ROR 3.0f    // C/min that is a fire when the gas signature is present too
+
+// One filtered signal
+typedef struct {
+    float window[DETECT_MEDIAN_N];  // Raw input ring
+    uint8_t window_n;
+    uint8_t window_head;
+    float med[DETECT_SLOPE_N];      // Median output ring with its times
+    int64_t med_us[DETECT_SLOPE_N];
+    uint8_t med_n;
+    uint8_t med_head;
+    bool primed;
+    float value;            // Latest median
+    float baseline;
+    float slope_per_min;
+    int64_t last_us;
+} detect_signal_t;
+
+typedef struct {
+    detect_signal_t smoke;
+    detect_signal_t temp;
+    alarm_kind_t state;     // Confirmed alarm (ALARM_NONE when quiet)
+    alarm_kind_t candidate; // Strongest signature in the current run
+    uint8_t candidate_run;
+    uint8_t clear_run;
+} detect_t;
+
+void detect_init(detect_t *det);
+
+/**
+ * @brief Feeds one sample (NAN/negative ppm and failed DHT reads are skipped per signal).
+ *
+ * @param now_us Acquisition time (only differences are used).
+ * @return true if det->state changed (raised, escalated or cleared).
+ */
+bool detect_update(detect_t *det, const sensor_data_t *sample, int64_t now_us);
+
+/**
+ * @brief Fills a CTRL_ALARM frame with the current state and filtered signals.
+ */
+void detect_fill_frame(const detect_t *det, uint8_t seq, uint32_t timestamp_ms, alarm_frame_t *frame);
+
+#endif // DETECT_H
@@ -0,0 +1,134 @@
+// src/memstats.c
+#include <string.h>
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "sdkconfig.h"
+
+#include "memstats.h"
+
+static const char *TAG = "MEMSTATS";
+
+// --- Task Registry ---
+typedef struct {
+    TaskHandle_t handle;  // NULL once the task has exited
+    char name[MEM_REPORT_NAME_LEN];
+    uint16_t stack_size;
+    uint16_t final_hwm;
+} memstats_task_t;
+
+static memstats_task_t tasks[MEM_REPORT_MAX_TASKS];
+static uint8_t task_count;
+static portMUX_TYPE registry_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void memstats_register_task(TaskHandle_t task, uint32_t stack_size) {
+    if (task == NULL) return;
+    portENTER_CRITICAL(&registry_lock);
+    if (task_count < MEM_REPORT_MAX_TASKS) {
+        memstats_task_t *t = &tasks[task_count++];
+        t->handle = task;
+        t->stack_size = stack_size > UINT16_MAX ? UINT16_MAX : (uint16_t)stack_size;
+        t->final_hwm = 0;
+        strncpy(t->name, pcTaskGetName(task), sizeof(t->name));
+    }
+    portEXIT_CRITICAL(&registry_lock);
+}
+
+void memstats_task_exiting(void) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    UBaseType_t hwm = uxTaskGetStackHighWaterMark(NULL);
+    portENTER_CRITICAL(&registry_lock);
+    for (uint8_t i = 0; i < task_count; i++) {
+        if (tasks[i].handle == self) {
+            tasks[i].final_hwm = hwm > UINT16_MAX ? UINT16_MAX : (uint16_t)hwm;
+            tasks[i].handle = NULL;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&registry_lock);
+}
+
+// --- Zero-Heap Guard ---
+// The heap calls esp_heap_trace_alloc_hook() on every successful allocation when
+// CONFIG_HEAP_USE_HOOKS is set. It may run with the cache disabled, so it stays in
+// IRAM and only compares a handle and bumps counters.
+static volatile TaskHandle_t guarded_task;
+static volatile uint32_t guard_allocs;      // Since the current guard_begin
+static volatile uint32_t guard_total;       // Since boot
+static volatile size_t guard_last_size;
+
+#if CONFIG_HEAP_USE_HOOKS
+void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps) {
+    if (guarded_task != NULL && xTaskGetCurrentTaskHandle() == guarded_task) {
+        guard_allocs++;
+        guard_last_size = size;
+    }
+}
+#endif
+
+void memstats_guard_begin(void) {
+    guard_allocs = 0;
+    guarded_task = xTaskGetCurrentTaskHandle();
+}
+
+uint32_t memstats_guard_end(void) {
+    guarded_task = NULL;
+    uint32_t allocs = guard_allocs;
+    if (allocs > 0) {
+        guard_total += allocs;
+        ESP_LOGE(TAG, "%lu heap allocation(s) in zero-heap region (last %u bytes)",
+                 (unsigned long)allocs, (unsigned)guard_last_size);
+    }
+    return allocs;
+}
+
+uint32_t memstats_guard_violations(void) {
+    return guard_total;
+}
+
+// --- Report ---
+
+void memstats_build_report(mem_report_frame_t* report) {
+    memset(report, 0, sizeof(*report));
+    report->hdr.magic = ESPNOW_CTRL_MAGIC;
+    report->hdr.type = CTRL_MEM_REPORT;
+    report->uptime_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    report->free_heap = esp_get_free_heap_size();
+    report->min_free_heap = esp_get_minimum_free_heap_size();
+    report->largest_free_block = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    report->steady_heap_allocs = guard_total > UINT16_MAX ? UINT16_MAX : (uint16_t)guard_total;
+
+    portENTER_CRITICAL(&registry_lock);
+    memstats_task_t snapshot[MEM_REPORT_MAX_TASKS];
+    uint8_t count = task_count;
+    memcpy(snapshot, tasks, sizeof(snapshot));
+    portEXIT_CRITICAL(&registry_lock);
+
+    // Stack figures are read outside the critical section; a task exiting in between
+    // only means this report still shows it as running with its live HWM.
+    for (uint8_t i = 0; i < count; i++) {
+        mem_task_stat_t *out = &report->tasks[i];
+        memcpy(out->name, snapshot[i].name, sizeof(out->name));
+        out->stack_size = snapshot[i].stack_size;
+        if (snapshot[i].handle != NULL) {
+            UBaseType_t hwm = uxTaskGetStackHighWaterMark(snapshot[i].handle);
+            out->stack_hwm = hwm > UINT16_MAX ? UINT16_MAX : (uint16_t)hwm;
+            out->running = 1;
+        } else {
+            out->stack_hwm = snapshot[i].final_hwm;
+        }
+    }
+    report->task_count = count;
+}
+
+void memstats_log_report(const mem_report_frame_t* report) {
+    ESP_LOGI(TAG, "Heap: free %lu, min free %lu, largest block %lu; zero-heap violations %u",
+             (unsigned long)report->free_heap, (unsigned long)report->min_free_heap,
+             (unsigned long)report->largest_free_block, report->steady_heap_allocs);
+    for (uint8_t i = 0; i < report->task_count; i++) {
+        const mem_task_stat_t *t = &report->tasks[i];
+        ESP_LOGI(TAG, "Stack %-*.*s %5u/%5u bytes free%s", MEM_REPORT_NAME_LEN, MEM_REPORT_NAME_LEN,
+                 t->name, t->stack_hwm, t->stack_size, t->running ? "" : " (exited)");
+    }
+}
@@ -0,0 +1,54 @@
+// memstats.h
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "shared_header.h"
+
+/**
+ * @brief Adds a task to the memory report. Call once per task after creating it.
+ *
+ * @param task Task handle (from xTaskCreateStatic).
+ * @param stack_size Stack size in bytes, as passed to xTaskCreateStatic.
+ */
+void memstats_register_task(TaskHandle_t task, uint32_t stack_size);
+
+/**
+ * @brief Records the calling task's final stack high-water mark. Call right before
+ *        vTaskDelete(NULL) so the report keeps the figure after the handle is gone.
+ */
+void memstats_task_exiting(void);
+
+/**
+ * @brief Marks the start of a region of the calling task that must not touch the heap.
+ *        With CONFIG_HEAP_USE_HOOKS every allocation made by this task until
+ *        memstats_guard_end() is counted; without it the guard is a no-op.
+ */
+void memstats_guard_begin(void);
+
+/**
+ * @brief Ends the zero-heap region.
+ * @return Number of allocations made inside this region (0 when hooks are disabled).
+ */
+uint32_t memstats_guard_end(void);
+
+/**
+ * @brief Total allocations seen inside guarded regions since boot.
+ */
+uint32_t memstats_guard_violations(void);
+
+/**
+ * @brief Fills a CTRL_MEM_REPORT frame with current stack and heap figures.
+ */
+void memstats_build_report(mem_report_frame_t* report);
+
+/**
+ * @brief Logs a report in human-readable form.
+ */
+void memstats_log_report(const mem_report_frame_t* report);
+
+#endif // MEMSTATS_H
@@ -0,0 +1,326 @@
+// src/pairing.c
+#include <inttypes.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_wifi.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "nvs.h"
+
+#include "shared_header.h"
+#include "auth.h"
+#include "memstats.h"
+#include "pairing.h"
+
+static const char *TAG = "PAIRING";
+
+static const uint8_t broadcast_mac[ESP_NOW_ETH_ALEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+// Cached pairing as stored in NVS
+typedef struct {
+    uint8_t master_mac[6];   // Primary
+    uint8_t channel;
+    uint8_t standby_mac[6];  // All zeros if there is no standby
+} pairing_record_t;
+
+static const uint8_t no_mac[6] = {0};
+
+static pairing_record_t paired;          // Current master pair
+static volatile bool on_standby = false; // Standby is the active master after a failover
+static volatile int failovers_since_success = 0;
+static int64_t first_failure_us = 0;
+static pairing_record_t reply_pending;   // Filled by the receive callback during a scan
+static volatile uint32_t probe_nonce;
+static SemaphoreHandle_t reply_sem = NULL;
+static StaticSemaphore_t reply_sem_buf;
+static volatile int consecutive_send_failures = 0;
+static volatile bool have_master = false; // paired holds a master (cached or found by a scan)
+static volatile bool scanning = false;    // A scan is requested or running: the channel is not the master's
+static TaskHandle_t scan_task = NULL;
+
+// --- NVS Cache ---
+
+static bool pairing_load(pairing_record_t *rec) {
+    nvs_handle_t nvs;
+    if (nvs_open(PAIRING_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) return false;
+    size_t len = sizeof(*rec);
+    esp_err_t ret = nvs_get_blob(nvs, "master", rec, &len);
+    nvs_close(nvs);
+    return ret == ESP_OK && len == sizeof(*rec) &&
+           rec->channel >= PAIRING_CHANNEL_MIN && rec->channel <= PAIRING_CHANNEL_MAX;
+}
+
+static void pairing_store(const pairing_record_t *rec) {
+    nvs_handle_t nvs;
+    if (nvs_open(PAIRING_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) return;
+    if (nvs_set_blob(nvs, "master", rec, sizeof(*rec)) != ESP_OK || nvs_commit(nvs) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to cache pairing in NVS.");
+    }
+    nvs_close(nvs);
+}
+
+// --- Peer Management ---
+
+static bool pairing_has_standby(const pairing_record_t *rec) {
+    return memcmp(rec->standby_mac, no_mac, 6) != 0;
+}
+
+static esp_err_t pairing_add_peer(const uint8_t *mac) {
+    esp_now_peer_info_t peer_info = {};
+    memcpy(peer_info.peer_addr, mac, ESP_NOW_ETH_ALEN);
+    peer_info.channel = 0; // Follow the current channel
+    peer_info.ifidx = WIFI_IF_STA;
+    peer_info.encrypt = false;
+    esp_err_t ret = esp_now_add_peer(&peer_info);
+    if (ret == ESP_ERR_ESPNOW_EXIST) {
+        ret = esp_now_mod_peer(&peer_info);
+    }
+    return ret;
+}
+
+static esp_err_t pairing_apply(const pairing_record_t *rec) {
+    esp_err_t ret = esp_wifi_set_channel(rec->channel, WIFI_SECOND_CHAN_NONE);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "esp_wifi_set_channel(%d) failed: %s", rec->channel, esp_err_to_name(ret));
+        return ret;
+    }
+
+    // Drop the previous masters if we are switching
+    const uint8_t *old_macs[2] = { paired.master_mac, paired.standby_mac };
+    for (int i = 0; i < 2; i++) {
+        if (memcmp(old_macs[i], no_mac, 6) != 0 && esp_now_is_peer_exist(old_macs[i]) &&
+            memcmp(old_macs[i], rec->master_mac, 6) != 0 && memcmp(old_macs[i], rec->standby_mac, 6) != 0) {
+            esp_now_del_peer(old_macs[i]);
+        }
+    }
+
+    ret = pairing_add_peer(rec->master_mac);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add master peer: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    if (pairing_has_standby(rec)) {
+        ret = pairing_add_peer(rec->standby_mac); // Added up front so failover is just a switch
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to add standby master peer: %s", esp_err_to_name(ret));
+        }
+    }
+
+    paired = *rec;
+    on_standby = false;
+    failovers_since_success = 0;
+    consecutive_send_failures = 0;
+    if (pairing_has_standby(rec)) {
+        ESP_LOGI(TAG, "Standby master " MACSTR " on the same channel.", MAC2STR(rec->standby_mac));
+    }
+    return ESP_OK;
+}
+
+// --- Channel Scan ---
+
+// One probe per channel. Returns ESP_OK once a master answered (and was applied),
+// ESP_ERR_NOT_FOUND if none did.
+static esp_err_t pairing_sweep(void) {
+    pair_probe_t probe = {
+        .hdr = { .magic = ESPNOW_CTRL_MAGIC, .type = CTRL_PAIR_PROBE },
+    };
+    esp_read_mac(probe.slave_mac, ESP_MAC_WIFI_STA);
+
+    for (uint8_t ch = PAIRING_CHANNEL_MIN; ch <= PAIRING_CHANNEL_MAX; ch++) {
+        if (esp_wifi_set_channel(ch, WIFI_SECOND_CHAN_NONE) != ESP_OK) continue;
+
+        xSemaphoreTake(reply_sem, 0); // Discard any late reply from the previous channel
+        probe_nonce = esp_random();
+        probe.channel = ch;
+        probe.nonce = probe_nonce;
+        esp_err_t ret = esp_now_send(broadcast_mac, (const uint8_t *)&probe, sizeof(probe));
+        if (ret != ESP_OK) {
+            ESP_LOGD(TAG, "Probe on channel %d not sent: %s", ch, esp_err_to_name(ret));
+            continue;
+        }
+
+        if (xSemaphoreTake(reply_sem, pdMS_TO_TICKS(PAIRING_PROBE_WAIT_MS)) == pdTRUE) {
+            pairing_record_t rec = reply_pending;
+            rec.channel = ch; // The channel the reply arrived on is the one that works
+            if (reply_pending.channel != ch) {
+                ESP_LOGW(TAG, "Master reports channel %d but answered on %d; using %d.", reply_pending.channel, ch, ch);
+            }
+            esp_err_t apply_ret = pairing_apply(&rec);
+            if (apply_ret == ESP_OK) {
+                pairing_store(&rec);
+            }
+            return apply_ret;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+// Runs requested scans so that the sensor task never blocks on discovery. Without a
+// usable pairing it sweeps until a master answers; with one (a rescan after send
+// failures) it gives up after PAIRING_RESCAN_SWEEPS and goes back to the old master.
+static void pairing_task(void *pvParameter) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        int64_t start_us = esp_timer_get_time();
+        scanning = true;
+        for (int sweep = 1;; sweep++) {
+            if (pairing_sweep() == ESP_OK) {
+                ESP_LOGI(TAG, "Paired with master " MACSTR " on channel %d in %" PRId64 " ms (%s).",
+                         MAC2STR(paired.master_mac), paired.channel, (esp_timer_get_time() - start_us) / 1000,
+                         have_master ? "rescan" : "cold scan");
+                have_master = true;
+                break;
+            }
+            if (have_master && sweep >= PAIRING_RESCAN_SWEEPS) {
+                pairing_record_t old = paired;
+                esp_err_t ret = pairing_apply(&old); // Back to its channel; failures count afresh
+                ESP_LOGW(TAG, "No master answered after %d sweeps, keeping " MACSTR " on channel %d%s.",
+                         sweep, MAC2STR(old.master_mac), old.channel, ret == ESP_OK ? "" : " (channel switch failed)");
+                break;
+            }
+            ESP_LOGW(TAG, "No master answered on channels %d-%d, retrying in %d ms.",
+                     PAIRING_CHANNEL_MIN, PAIRING_CHANNEL_MAX, PAIRING_SCAN_RETRY_MS);
+            vTaskDelay(pdMS_TO_TICKS(PAIRING_SCAN_RETRY_MS));
+        }
+        scanning = false;
+    }
+}
+
+// --- Public API ---
+
+esp_err_t pairing_init(void) {
+    if (reply_sem == NULL) {
+        reply_sem = xSemaphoreCreateBinaryStatic(&reply_sem_buf);
+    }
+    if (scan_task == NULL) {
+        static StaticTask_t scan_tcb;
+        static StackType_t scan_stack[PAIRING_TASK_STACK_SIZE];
+        scan_task = xTaskCreateStatic(pairing_task, "pairing", PAIRING_TASK_STACK_SIZE, NULL, 4, scan_stack, &scan_tcb);
+        memstats_register_task(scan_task, PAIRING_TASK_STACK_SIZE);
+    }
+
+    esp_now_peer_info_t peer_info = {};
+    memcpy(peer_info.peer_addr, broadcast_mac, ESP_NOW_ETH_ALEN);
+    peer_info.channel = 0;
+    peer_info.ifidx = WIFI_IF_STA;
+    peer_info.encrypt = false;
+    esp_err_t ret = esp_now_add_peer(&peer_info);
+    if (ret != ESP_OK && ret != ESP_ERR_ESPNOW_EXIST) {
+        ESP_LOGE(TAG, "Failed to add broadcast peer: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    return ESP_OK;
+}
+
+esp_err_t pairing_connect(void) {
+    int64_t start_us = esp_timer_get_time();
+    pairing_record_t rec;
+
+    if (pairing_load(&rec) && pairing_apply(&rec) == ESP_OK) {
+        have_master = true;
+        ESP_LOGI(TAG, "Paired with cached master " MACSTR " on channel %d in %" PRId64 " ms (warm).",
+                 MAC2STR(paired.master_mac), paired.channel, (esp_timer_get_time() - start_us) / 1000);
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "No cached master, scanning channels %d-%d in the background...", PAIRING_CHANNEL_MIN, PAIRING_CHANNEL_MAX);
+    scanning = true; // Until the task picks the request up
+    xTaskNotifyGive(scan_task);
+    return ESP_OK;
+}
+
+void pairing_use_master(const uint8_t *mac, const uint8_t *standby_mac, uint8_t channel) {
+    memset(&paired, 0, sizeof(paired));
+    memcpy(paired.master_mac, mac, 6);
+    if (standby_mac != NULL) memcpy(paired.standby_mac, standby_mac, 6);
+    paired.channel = channel;
+    on_standby = false;
+    failovers_since_success = 0;
+    consecutive_send_failures = 0;
+    have_master = true;
+}
+
+void pairing_rescan(void) {
+    if (scanning || scan_task == NULL) return; // No scan task: pairing_use_master without pairing_init
+    ESP_LOGW(TAG, "%d consecutive send failures to " MACSTR ", rescanning.",
+             consecutive_send_failures, MAC2STR(paired.master_mac));
+    scanning = true;
+    xTaskNotifyGive(scan_task);
+}
+
+bool pairing_ready(void) {
+    return have_master && !scanning;
+}
+
+const uint8_t *pairing_master_mac(void) {
+    return on_standby ? paired.standby_mac : paired.master_mac;
+}
+
+const uint8_t *pairing_primary_mac(void) {
+    return paired.master_mac;
+}
+
+const uint8_t *pairing_standby_mac(void) {
+    return paired.standby_mac;
+}
+
+bool pairing_is_master(const uint8_t *mac) {
+    return memcmp(mac, paired.master_mac, 6) == 0 ||
+           (pairing_has_standby(&paired) && memcmp(mac, paired.standby_mac, 6) == 0);
+}
+
+uint8_t pairing_channel(void) {
+    return paired.channel;
+}
+
+void pairing_report_send_result(bool success) {
+    if (success) {
+        consecutive_send_failures = 0;
+        failovers_since_success = 0;
+        return;
+    }
+    if (consecutive_send_failures == 0) {
+        first_failure_us = esp_timer_get_time();
+    }
+    if (consecutive_send_failures < PAIRING_MAX_SEND_FAILURES) {
+        consecutive_send_failures++;
+    }
+
+    // Try the other master once each way; if both stay silent, fall through to a rescan
+    if (consecutive_send_failures >= PAIRING_FAILOVER_FAILURES && pairing_has_standby(&paired) &&
+        failovers_since_success < 2) {
+        on_standby = !on_standby;
+        failovers_since_success++;
+        consecutive_send_failures = 0;
+        ESP_LOGW(TAG, "Failover to %s master " MACSTR " %" PRId64 " ms after the first failed send.",
+                 on_standby ? "standby" : "primary", MAC2STR(pairing_master_mac()),
+                 (esp_timer_get_time() - first_failure_us) / 1000);
+    }
+}
+
+bool pairing_needs_rescan(void) {
+    return consecutive_send_failures >= PAIRING_MAX_SEND_FAILURES;
+}
+
+bool pairing_handle_frame(const esp_now_recv_info_t *info, const uint8_t *data, int len) {
+    if (!ctrl_frame_is(data, len, CTRL_PAIR_REPLY, sizeof(pair_reply_t) + FA_TRAILER_LEN)) return false;
+
+    pair_reply_t reply;
+    memcpy(&reply, data, sizeof(reply));
+    if (!scanning || reply.nonce != probe_nonce) {
+        return false; // Stale, or another slave's reply that a relay may pass on
+    }
+    if (auth_verify(data, len, NULL) != ESP_OK) { // The nonce makes it fresh, the tag makes it the master's
+        ESP_LOGW(TAG, "Pairing reply from " MACSTR " failed authentication, ignored.", MAC2STR(info->src_addr));
+        return true;
+    }
+    memcpy(reply_pending.master_mac, reply.master_mac, 6);
+    memcpy(reply_pending.standby_mac, reply.standby_mac, 6);
+    reply_pending.channel = reply.channel;
+    xSemaphoreGive(reply_sem);
+    return true;
+}
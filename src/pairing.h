@@ -0,0 +1,109 @@
+// pairing.h
+#ifndef PAIRING_H
+#define PAIRING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_now.h"
+
+// --- Configuration ---
+#define PAIRING_CHANNEL_MIN        1
+#define PAIRING_CHANNEL_MAX        13
+#define PAIRING_PROBE_WAIT_MS      120 // Time to wait for a reply on each channel
+#define PAIRING_SCAN_RETRY_MS      2000 // Pause between full scans when no master answered
+#define PAIRING_RESCAN_SWEEPS      2   // Full scans a rescan tries before falling back to the known master
+#define PAIRING_TASK_STACK_SIZE    3072
+#define PAIRING_MAX_SEND_FAILURES  5   // Consecutive failed sends before the cached master is dropped
+#define PAIRING_FAILOVER_FAILURES  2   // Consecutive failed sends before switching to the standby master
+#define PAIRING_NVS_NAMESPACE      "pairing"
+
+/**
+ * @brief Prepares pairing state, starts the scan task and registers the broadcast peer
+ *        used for probes. Call once after esp_now_init() and auth_init() (pairing replies
+ *        are signed with this slave's key). NVS must already be initialised.
+ */
+esp_err_t pairing_init(void);
+
+/**
+ * @brief Finds the master and adds it as an ESP-NOW peer.
+ *
+ * Uses the (MAC, channel) cached in NVS if present (warm boot, no radio traffic),
+ * otherwise starts a background scan that broadcasts probes across channels until
+ * a master replies, and caches the result. Never blocks on the master: sampling goes
+ * on while it is down, and pairing_ready() tells when frames can be sent.
+ * Logs time-to-paired for both paths.
+ */
+esp_err_t pairing_connect(void);
+
+/**
+ * @brief Takes mac (and standby_mac, NULL for none) as the masters on channel without a
+ *        scan, an NVS entry or any radio call: the soak's modelled pair (soak.h). Send
+ *        results and failover work as usual; without pairing_init there is no scan task,
+ *        so a rescan is a no-op.
+ */
+void pairing_use_master(const uint8_t *mac, const uint8_t *standby_mac, uint8_t channel);
+
+/**
+ * @brief Starts a background channel scan (no-op if one is running). The current
+ *        master stays cached, and is used again if no master answers within
+ *        PAIRING_RESCAN_SWEEPS scans; it is only replaced by one that answered.
+ */
+void pairing_rescan(void);
+
+/**
+ * @brief True while a master is known and no scan has the radio on another channel.
+ */
+bool pairing_ready(void);
+
+/**
+ * @brief Returns the MAC of the master currently in use (primary, or standby after a
+ *        failover), valid after pairing_connect() succeeded.
+ */
+const uint8_t *pairing_master_mac(void);
+
+/**
+ * @brief Returns the primary master's MAC, which identifies the site (route adverts,
+ *        proxied pairing replies) regardless of which master is in use.
+ */
+const uint8_t *pairing_primary_mac(void);
+
+/**
+ * @brief Returns the standby master's MAC (all zeros if the site has a single master).
+ */
+const uint8_t *pairing_standby_mac(void);
+
+/**
+ * @brief True if mac is the primary or the standby master.
+ */
+bool pairing_is_master(const uint8_t *mac);
+
+/**
+ * @brief Returns the paired master's channel, valid after pairing_connect() succeeded.
+ */
+uint8_t pairing_channel(void);
+
+/**
+ * @brief Feeds a send result (from the ESP-NOW send callback) into the failure counter.
+ *        After PAIRING_FAILOVER_FAILURES consecutive failures the other master of a
+ *        redundant pair becomes active (no scan, both are already peers); the switch
+ *        happens at most once each way before a rescan is requested.
+ *        Safe to call from the Wi-Fi task.
+ */
+void pairing_report_send_result(bool success);
+
+/**
+ * @brief True once PAIRING_MAX_SEND_FAILURES consecutive sends have failed.
+ *        The sending task should then call pairing_rescan().
+ */
+bool pairing_needs_rescan(void);
+
+/**
+ * @brief Handles a received pairing reply. Only replies to the running scan's probe
+ *        whose auth_verify() tag checks out are used.
+ * @return true if the frame was consumed, false otherwise (including replies to other
+ *         slaves' probes, which relay_handle_frame() may pass on).
+ */
+bool pairing_handle_frame(const esp_now_recv_info_t *info, const uint8_t *data, int len);
+
+#endif // PAIRING_H
@@ -0,0 +1,312 @@
+// src/profile.c
+#include "profile.h"
+
+#if CONFIG_SLAVE_PROFILE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gptimer.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+#include "xtensa_context.h"
+#elif CONFIG_IDF_TARGET_ARCH_RISCV
+#include "riscv/rvruntime-frames.h"
+#endif
+
+static const char *TAG = "PROFILE";
+
+#define PROFILE_TIMER_HZ   1000000
+#define PROFILE_MAX_TASKS  16
+#define PROFILE_PC_SLOTS   256    // Power of two
+#define PROFILE_PC_PROBES  8
+#define PROFILE_RT_TASKS   24     // Tasks read from the FreeRTOS runtime stats
+#define PROFILE_PCS_PER_LINE 8
+#define PROFILE_DUMP_INTERVAL_US ((int64_t)CONFIG_SLAVE_PROFILE_DUMP_S * 1000000)
+
+// --- Sampler ---
+
+typedef struct {
+    TaskHandle_t handle;
+    char name[configMAX_TASK_NAME_LEN];
+    uint32_t samples;
+} profile_task_t;
+
+typedef struct {
+    uint32_t pc;
+    uint32_t count;
+} profile_pc_t;
+
+typedef struct {
+    profile_task_t tasks[PROFILE_MAX_TASKS];
+    uint8_t task_count;
+    profile_pc_t pcs[PROFILE_PC_SLOTS];
+    uint32_t samples;
+    uint32_t pc_overflow;       // Samples whose PC found no free slot
+    uint32_t task_overflow;     // Samples of tasks beyond PROFILE_MAX_TASKS
+} profile_window_t;
+
+static gptimer_handle_t timer;
+static int sampler_core;
+static portMUX_TYPE sample_lock = portMUX_INITIALIZER_UNLOCKED;
+static profile_window_t window;     // Filled by the timer ISR
+static profile_window_t snapshot;   // Copy being printed
+static int64_t window_start_us;
+static int64_t next_dump_us;
+static const sensor_driver_t *const *sensor_table;
+
+// Level-1 interrupt entry saves the interrupted task's registers on its own stack
+// and stores that stack pointer in the TCB's first word (pxTopOfStack), so the saved
+// frame holds the PC the task was interrupted at.
+static inline uint32_t IRAM_ATTR interrupted_pc(TaskHandle_t task) {
+    const uint8_t *frame = *(uint8_t *const *)task;
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+    return *(const uint32_t *)(frame + XT_STK_PC);
+#elif CONFIG_IDF_TARGET_ARCH_RISCV
+    return *(const uint32_t *)(frame + RV_STK_MEPC);
+#else
+    (void)frame;
+    return 0;
+#endif
+}
+
+static bool IRAM_ATTR profile_on_alarm(gptimer_handle_t t, const gptimer_alarm_event_data_t *edata, void *ctx) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    uint32_t pc = interrupted_pc(task);
+
+    portENTER_CRITICAL_ISR(&sample_lock);
+    window.samples++;
+    uint8_t i = 0;
+    while (i < window.task_count && window.tasks[i].handle != task) i++;
+    if (i == window.task_count && i < PROFILE_MAX_TASKS) {
+        window.tasks[i].handle = task;
+        strncpy(window.tasks[i].name, pcTaskGetName(task), sizeof(window.tasks[i].name) - 1);
+        window.task_count++;
+    }
+    if (i < window.task_count) window.tasks[i].samples++;
+    else window.task_overflow++;
+
+    uint32_t slot = ((pc >> 2) * 2654435761u) >> 24; // Fibonacci hash into 256 slots
+    int probe = 0;
+    for (; probe < PROFILE_PC_PROBES; probe++, slot = (slot + 1) & (PROFILE_PC_SLOTS - 1)) {
+        profile_pc_t *e = &window.pcs[slot];
+        if (e->count == 0) e->pc = pc;
+        if (e->pc == pc) {
+            e->count++;
+            break;
+        }
+    }
+    if (probe == PROFILE_PC_PROBES) window.pc_overflow++;
+    portEXIT_CRITICAL_ISR(&sample_lock);
+    return false;
+}
+
+// --- Zones ---
+
+typedef struct {
+    uint32_t calls;
+    uint32_t migrated;          // Calls that ended on the other core (timed with esp_timer)
+    uint64_t cycles;
+    uint32_t max_cycles;
+} profile_zone_stat_t;
+
+static portMUX_TYPE zone_lock = portMUX_INITIALIZER_UNLOCKED;
+static profile_zone_stat_t zones[PROFILE_ZONE_COUNT];
+static profile_zone_stat_t zones_snapshot[PROFILE_ZONE_COUNT];
+
+profile_mark_t profile_enter(void) {
+    return (profile_mark_t){ .cycles = esp_cpu_get_cycle_count(), .core = esp_cpu_get_core_id(), .us = esp_timer_get_time() };
+}
+
+void profile_exit(profile_zone_t zone, profile_mark_t mark) {
+    if ((unsigned)zone >= PROFILE_ZONE_COUNT) return;
+    uint32_t cycles = esp_cpu_get_cycle_count() - mark.cycles;
+    bool migrated = esp_cpu_get_core_id() != mark.core; // Each core has its own cycle counter
+    if (migrated) cycles = (uint32_t)((esp_timer_get_time() - mark.us) * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+
+    portENTER_CRITICAL(&zone_lock);
+    profile_zone_stat_t *z = &zones[zone];
+    z->calls++;
+    z->cycles += cycles;
+    if (cycles > z->max_cycles) z->max_cycles = cycles;
+    if (migrated) z->migrated++;
+    portEXIT_CRITICAL(&zone_lock);
+}
+
+// esp_log hands every formatted line to this; the time covers formatting and the console UART
+static vprintf_like_t log_vprintf;
+
+static int profile_log_vprintf(const char *fmt, va_list args) {
+    profile_mark_t mark = profile_enter();
+    int n = log_vprintf(fmt, args);
+    profile_exit(PROFILE_ZONE_LOG, mark);
+    return n;
+}
+
+static const char *zone_name(int zone) {
+    static const char *const names[PROFILE_ZONE_SENSOR] = { "log", "encode", "sign", "send", "detect" };
+    if (zone < PROFILE_ZONE_SENSOR) return names[zone];
+    // Sensor zones follow the table actually sampled (soak mode swaps in its models)
+    for (int i = 0; sensor_table != NULL && sensor_table[i] != NULL; i++) {
+        if (i == zone - PROFILE_ZONE_SENSOR) return sensor_table[i]->name;
+    }
+    return "sensor";
+}
+
+// --- Runtime Stats ---
+
+typedef struct {
+    TaskHandle_t handle;
+    configRUN_TIME_COUNTER_TYPE run_time;
+} profile_rt_t;
+
+static TaskStatus_t rt_status[PROFILE_RT_TASKS];
+static profile_rt_t rt_prev[PROFILE_RT_TASKS];
+static UBaseType_t rt_prev_count;
+
+// Prints each task's run time since the previous call and remembers the totals
+static void dump_runtime(void) {
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t n = uxTaskGetSystemState(rt_status, PROFILE_RT_TASKS, &total);
+    if (n == 0) {
+        printf("PROF rt_overflow %d\n", PROFILE_RT_TASKS); // More tasks than the array holds
+        return;
+    }
+    for (UBaseType_t i = 0; i < n; i++) {
+        configRUN_TIME_COUNTER_TYPE prev = 0;
+        for (UBaseType_t j = 0; j < rt_prev_count; j++) {
+            if (rt_prev[j].handle == rt_status[i].xHandle) {
+                prev = rt_prev[j].run_time;
+                break;
+            }
+        }
+        printf("PROF rt %llu %s\n", (unsigned long long)(configRUN_TIME_COUNTER_TYPE)(rt_status[i].ulRunTimeCounter - prev),
+               rt_status[i].pcTaskName);
+    }
+    for (UBaseType_t i = 0; i < n; i++) {
+        rt_prev[i].handle = rt_status[i].xHandle;
+        rt_prev[i].run_time = rt_status[i].ulRunTimeCounter;
+    }
+    rt_prev_count = n;
+}
+
+static void rt_baseline(void) {
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    rt_prev_count = uxTaskGetSystemState(rt_status, PROFILE_RT_TASKS, &total);
+    for (UBaseType_t i = 0; i < rt_prev_count; i++) {
+        rt_prev[i].handle = rt_status[i].xHandle;
+        rt_prev[i].run_time = rt_status[i].ulRunTimeCounter;
+    }
+}
+
+// --- Dump ---
+
+static int pc_count_desc(const void *a, const void *b) {
+    uint32_t x = ((const profile_pc_t *)a)->count, y = ((const profile_pc_t *)b)->count;
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+void profile_dump(void) {
+    if (timer == NULL) return;
+    gptimer_stop(timer); // The dump's own printing stays out of both windows
+    int64_t end_us = esp_timer_get_time();
+    portENTER_CRITICAL(&sample_lock);
+    snapshot = window;
+    memset(&window, 0, sizeof(window));
+    portEXIT_CRITICAL(&sample_lock);
+    portENTER_CRITICAL(&zone_lock);
+    memcpy(zones_snapshot, zones, sizeof(zones));
+    memset(zones, 0, sizeof(zones));
+    portEXIT_CRITICAL(&zone_lock);
+
+    printf("PROF begin v=1 core=%d cores=%d hz=%d mhz=%d window_us=%lld samples=%lu\n", sampler_core,
+           portNUM_PROCESSORS, CONFIG_SLAVE_PROFILE_SAMPLE_HZ, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+           (long long)(end_us - window_start_us), (unsigned long)snapshot.samples);
+    for (uint8_t i = 0; i < snapshot.task_count; i++) {
+        printf("PROF task %lu %s\n", (unsigned long)snapshot.tasks[i].samples, snapshot.tasks[i].name);
+    }
+    if (snapshot.task_overflow > 0) printf("PROF task %lu (other)\n", (unsigned long)snapshot.task_overflow);
+    dump_runtime();
+
+    qsort(snapshot.pcs, PROFILE_PC_SLOTS, sizeof(profile_pc_t), pc_count_desc);
+    uint32_t other = snapshot.pc_overflow;
+    char line[16 + PROFILE_PCS_PER_LINE * 20];
+    int len = 0, on_line = 0;
+    for (int i = 0; i < PROFILE_PC_SLOTS && snapshot.pcs[i].count > 0; i++) {
+        if (i >= PROFILE_DUMP_PCS) {
+            other += snapshot.pcs[i].count;
+            continue;
+        }
+        if (on_line == 0) len = snprintf(line, sizeof(line), "PROF pc");
+        len += snprintf(line + len, sizeof(line) - len, " %08lx:%lu", (unsigned long)snapshot.pcs[i].pc,
+                        (unsigned long)snapshot.pcs[i].count);
+        if (++on_line == PROFILE_PCS_PER_LINE) {
+            printf("%s\n", line);
+            on_line = 0;
+        }
+    }
+    if (on_line > 0) printf("%s\n", line);
+    if (other > 0) printf("PROF pc_other %lu\n", (unsigned long)other);
+
+    for (int z = 0; z < PROFILE_ZONE_COUNT; z++) {
+        const profile_zone_stat_t *s = &zones_snapshot[z];
+        if (s->calls == 0) continue;
+        printf("PROF zone %lu %llu %lu %lu %s\n", (unsigned long)s->calls, (unsigned long long)s->cycles,
+               (unsigned long)s->max_cycles, (unsigned long)s->migrated, zone_name(z));
+    }
+    printf("PROF end\n");
+
+    window_start_us = esp_timer_get_time();
+    next_dump_us = window_start_us + PROFILE_DUMP_INTERVAL_US;
+    gptimer_start(timer);
+}
+
+void profile_poll(void) {
+    if (timer != NULL && esp_timer_get_time() >= next_dump_us) profile_dump();
+}
+
+// --- Start ---
+
+void profile_start(const sensor_driver_t *const *sensors) {
+    if (timer != NULL) return;
+    sensor_table = sensors;
+    sampler_core = esp_cpu_get_core_id();
+
+    const gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = PROFILE_TIMER_HZ,
+    };
+    const gptimer_alarm_config_t alarm = {
+        .alarm_count = PROFILE_TIMER_HZ / CONFIG_SLAVE_PROFILE_SAMPLE_HZ,
+        .reload_count = 0,
+        .flags.auto_reload_on_alarm = true,
+    };
+    const gptimer_event_callbacks_t callbacks = { .on_alarm = profile_on_alarm };
+    gptimer_handle_t t = NULL;
+    esp_err_t ret = gptimer_new_timer(&timer_config, &t);
+    if (ret == ESP_OK) ret = gptimer_set_alarm_action(t, &alarm);
+    if (ret == ESP_OK) ret = gptimer_register_event_callbacks(t, &callbacks, NULL); // Interrupt lands on this core
+    if (ret == ESP_OK) ret = gptimer_enable(t);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Sampler timer setup failed: %s. Profiling disabled.", esp_err_to_name(ret));
+        if (t != NULL) gptimer_del_timer(t);
+        return;
+    }
+    timer = t;
+
+    log_vprintf = esp_log_set_vprintf(profile_log_vprintf);
+    rt_baseline();
+    window_start_us = esp_timer_get_time();
+    next_dump_us = window_start_us + PROFILE_DUMP_INTERVAL_US;
+    gptimer_start(timer);
+    ESP_LOGI(TAG, "Sampling core %d at %d Hz, dump every %d s (decode with tools/profile_report.py)",
+             sampler_core, CONFIG_SLAVE_PROFILE_SAMPLE_HZ, CONFIG_SLAVE_PROFILE_DUMP_S);
+}
+
+#endif // CONFIG_SLAVE_PROFILE
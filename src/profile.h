@@ -0,0 +1,90 @@
+// profile.h
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include "sdkconfig.h"
+
+#include "sensors.h"
+
+// CPU profiler for profiling builds (CONFIG_SLAVE_PROFILE, "Slave profiling" in
+// menuconfig). Three views of where the time goes, dumped together:
+//
+//  - Samples: a hardware timer interrupts the core that called profile_start at
+//    CONFIG_SLAVE_PROFILE_SAMPLE_HZ and records the running task and the PC it was
+//    interrupted at. Shares of samples are shares of that core's CPU, idle included.
+//    Code that runs with interrupts masked (critical sections, other ISRs, the
+//    Wi-Fi blob's own interrupt handlers) is not sampled; its time is billed to
+//    the first PC after it unmasks.
+//  - Runtime stats: FreeRTOS run time per task on both cores (the option selects
+//    CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS).
+//  - Zones: cycle counts around the sensor drivers' sample() calls, frame encoding,
+//    signing, sending and log output. These are elapsed time per call, blocking
+//    included (the MQ2 read sleeps between ADC samples); compare with the samples
+//    to tell busy-waiting from sleeping.
+//
+// Every CONFIG_SLAVE_PROFILE_DUMP_S, profile_poll prints the window since the previous
+// dump as "PROF ..." lines on the console; tools/profile_report.py resolves the PCs
+// against the firmware ELF and prints the per-task, per-function and per-zone breakdown.
+//
+// Without CONFIG_SLAVE_PROFILE every call below compiles to nothing.
+
+#define PROFILE_DUMP_PCS 96   // Most-hit PCs listed per dump; the rest are summed as "other"
+
+typedef enum {
+    PROFILE_ZONE_LOG = 0,     // esp_log output (formatting and console UART), any task
+    PROFILE_ZONE_ENCODE,      // Data frame / sample batch encoding
+    PROFILE_ZONE_SIGN,        // auth_sign of data frames
+    PROFILE_ZONE_SEND,        // send_upstream of data frames, including the wait for the MAC-layer result
+    PROFILE_ZONE_DETECT,      // Fire/gas detector update
+    PROFILE_ZONE_SENSOR,      // sensors[i]->sample() is zone PROFILE_ZONE_SENSOR + i
+    PROFILE_ZONE_COUNT = PROFILE_ZONE_SENSOR + SENSOR_COUNT,
+} profile_zone_t;
+
+// Start of a timed zone (from profile_enter)
+typedef struct {
+    uint32_t cycles;
+    int core;
+    int64_t us;               // Fallback when the task moved to the other core (separate cycle counters)
+} profile_mark_t;
+
+#if CONFIG_SLAVE_PROFILE
+
+/**
+ * @brief Starts the sampler on the calling core and hooks log output. Call once,
+ *        from app_main after the sensor table is chosen.
+ *
+ * @param sensors Driver table being sampled (names the sensor zones); NULL-terminated.
+ */
+void profile_start(const sensor_driver_t *const *sensors);
+
+profile_mark_t profile_enter(void);
+
+/**
+ * @brief Adds the time since mark to a zone. Safe from any task.
+ */
+void profile_exit(profile_zone_t zone, profile_mark_t mark);
+
+/**
+ * @brief Prints the profile of the window since the previous dump (or profile_start)
+ *        and starts a new window. Sampling pauses while it prints.
+ */
+void profile_dump(void);
+
+/**
+ * @brief Dumps once CONFIG_SLAVE_PROFILE_DUMP_S have passed since the last dump.
+ *        Call from the sensor task's loop.
+ */
+void profile_poll(void);
+
+#else
+
+static inline void profile_start(const sensor_driver_t *const *sensors) {}
+static inline profile_mark_t profile_enter(void) { return (profile_mark_t){ 0 }; }
+static inline void profile_exit(profile_zone_t zone, profile_mark_t mark) {}
+static inline void profile_dump(void) {}
+static inline void profile_poll(void) {}
+
+#endif // CONFIG_SLAVE_PROFILE
+
+#endif // PROFILE_H
@@ -0,0 +1,495 @@
+// src/relay.c
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+
+#include "shared_header.h"
+#include "frame_auth.h"
+#include "sample_batch.h"
+#include "pairing.h"
+#include "auth.h"
+#include "relay.h"
+
+static const char *TAG = "RELAY";
+
+static const uint8_t broadcast_mac[ESP_NOW_ETH_ALEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+// Every frame this module sends leaves through here (the soak swaps in its radio model)
+static relay_radio_send_t radio_send = esp_now_send;
+
+_Static_assert(sizeof(relay_hdr_t) + SAMPLE_BATCH_MAX_FRAME_BYTES + FA_TRAILER_LEN <= ESP_NOW_MAX_DATA_LEN,
+               "worst-case relayed batch must fit one ESP-NOW frame");
+
+// --- Routing State (guarded by route_lock) ---
+typedef struct {
+    uint8_t mac[6];
+    uint8_t hops;          // advertised hops to the master
+    int8_t path_rssi;      // advertised bottleneck
+    int16_t link_rssi;     // our smoothed RSSI of this neighbour
+    uint8_t send_failures;
+    int64_t last_heard_us;
+    fa_replay_t adverts;   // replay window for its signed adverts
+} relay_neighbor_t;
+
+static portMUX_TYPE route_lock = portMUX_INITIALIZER_UNLOCKED;
+static relay_neighbor_t neighbors[RELAY_MAX_NEIGHBORS];
+static int16_t master_rssi;
+static int64_t master_heard_us;    // 0 = never heard
+static int uplink = -1;            // -1 = master direct, else index into neighbors
+static uint8_t route_hops = 1;
+static int8_t route_rssi;
+
+// --- Forwarding State ---
+typedef struct {
+    uint16_t len;
+    int64_t rx_us;
+    uint8_t data[ESP_NOW_MAX_DATA_LEN];
+} relay_item_t;
+
+static bool forward_enabled;
+static QueueHandle_t forward_queue;
+static StaticQueue_t forward_queue_buf;
+static uint8_t forward_queue_storage[RELAY_QUEUE_DEPTH * sizeof(relay_item_t)];
+
+typedef struct {
+    uint8_t origin[6];
+    uint16_t msg_id;
+} relay_dup_t;
+
+static relay_dup_t dup_cache[RELAY_DUP_CACHE];
+static uint8_t dup_next;
+static uint8_t self_mac[6];
+static uint16_t own_msg_id;
+static int64_t next_advert_us;
+
+// Nonces of pairing probes passed towards the master, so its signed reply is passed back
+static uint32_t proxied_nonce[RELAY_PROXY_NONCES];
+static uint8_t proxied_next;
+
+// Origins of alarm frames passed towards the master, so its CTRL_ALARM_ACK is passed back
+static uint8_t alarm_origin[RELAY_PROXY_NONCES][6];
+static uint8_t alarm_origin_next;
+
+// Counters for relay_log_stats()
+static uint32_t stat_originated, stat_forwarded, stat_duplicates, stat_ttl_drops, stat_queue_drops;
+static uint32_t stat_advert_rejects;
+
+static bool link_fresh(int64_t heard_us, int64_t now_us) {
+    return heard_us != 0 && now_us - heard_us < (int64_t)RELAY_LINK_EXPIRY_MS * 1000;
+}
+
+static int16_t rssi_ema(int16_t old, int8_t sample, bool primed) {
+    return primed ? old + ((sample - old) >> RELAY_RSSI_EMA_SHIFT) : sample;
+}
+
+// --- Route Selection ---
+
+// Picks the uplink; called with route_lock held. Returns true if it changed.
+static bool relay_route_update_locked(int64_t now_us) {
+    int best = -2;              // -2 = none found, -1 = master
+    int best_score = -1000;
+    int current_score = -1000;
+
+    if (link_fresh(master_heard_us, now_us)) {
+        best = -1;
+        best_score = master_rssi;
+        if (uplink == -1) current_score = best_score;
+    }
+    for (int i = 0; i < RELAY_MAX_NEIGHBORS; i++) {
+        relay_neighbor_t *n = &neighbors[i];
+        if (!link_fresh(n->last_heard_us, now_us) || n->link_rssi < RELAY_RSSI_MIN ||
+            n->hops >= RELAY_TTL || n->send_failures >= RELAY_MAX_SEND_FAILURES) continue;
+        int bottleneck = n->link_rssi < n->path_rssi ? n->link_rssi : n->path_rssi;
+        int score = bottleneck - n->hops * RELAY_HOP_PENALTY_DB;
+        if (i == uplink) current_score = score;
+        if (score > best_score) {
+            best = i;
+            best_score = score;
+        }
+    }
+
+    if (best == -2) {
+        best = -1; // Nothing heard yet: talk to the master directly, as without relaying
+    } else if (best != uplink && current_score > -1000 && best_score < current_score + RELAY_HYSTERESIS_DB) {
+        best = uplink; // Not enough better to be worth switching
+    }
+
+    bool changed = best != uplink;
+    uplink = best;
+    if (uplink == -1) {
+        route_hops = 1;
+        route_rssi = (int8_t)(master_heard_us ? master_rssi : RELAY_RSSI_MIN);
+    } else {
+        relay_neighbor_t *n = &neighbors[uplink];
+        route_hops = n->hops + 1;
+        route_rssi = (int8_t)(n->link_rssi < n->path_rssi ? n->link_rssi : n->path_rssi);
+    }
+    return changed;
+}
+
+// Updates the route and copies the MAC to send to (so the table may change). Returns true
+// if that is the master, from the same snapshot as the MAC.
+static bool relay_next_hop(uint8_t mac[6]) {
+    int64_t now_us = esp_timer_get_time();
+    portENTER_CRITICAL(&route_lock);
+    bool changed = relay_route_update_locked(now_us);
+    int hop = uplink;
+    uint8_t hops = route_hops;
+    if (hop >= 0) memcpy(mac, neighbors[hop].mac, 6);
+    portEXIT_CRITICAL(&route_lock);
+
+    if (hop < 0) {
+        memcpy(mac, pairing_master_mac(), 6);
+    } else if (!esp_now_is_peer_exist(mac)) {
+        esp_now_peer_info_t peer_info = {};
+        memcpy(peer_info.peer_addr, mac, ESP_NOW_ETH_ALEN);
+        peer_info.channel = 0;
+        peer_info.ifidx = WIFI_IF_STA;
+        peer_info.encrypt = false; // Relayed frames carry the origin's frame_auth tag
+        esp_err_t ret = esp_now_add_peer(&peer_info);
+        if (ret != ESP_OK) ESP_LOGW(TAG, "Failed to add relay peer " MACSTR ": %s", MAC2STR(mac), esp_err_to_name(ret));
+    }
+    if (changed) {
+        if (hop < 0) {
+            ESP_LOGI(TAG, "Uplink: master direct.");
+        } else {
+            ESP_LOGI(TAG, "Uplink: via " MACSTR " (%u hops to master).", MAC2STR(mac), hops);
+        }
+    }
+    return hop < 0;
+}
+
+// --- Receive Path (Wi-Fi task) ---
+
+void relay_on_master_frame(int8_t rssi, int64_t rx_us) {
+    portENTER_CRITICAL(&route_lock);
+    master_rssi = rssi_ema(master_rssi, rssi, master_heard_us != 0);
+    master_heard_us = rx_us;
+    portEXIT_CRITICAL(&route_lock);
+}
+
+// Index of src in the neighbour table, or -1; called with route_lock held
+static int relay_find_neighbor_locked(const uint8_t *src) {
+    for (int i = 0; i < RELAY_MAX_NEIGHBORS; i++) {
+        if (neighbors[i].last_heard_us != 0 && memcmp(neighbors[i].mac, src, 6) == 0) return i;
+    }
+    return -1;
+}
+
+// Checks an advert's tag and freshness against the sender's replay window. Only the Wi-Fi
+// task touches the windows, so the window is checked on a copy outside route_lock (SipHash
+// is too slow for a spinlock) and stored by relay_on_advert().
+static bool relay_advert_authentic(const uint8_t *src, const uint8_t *data, int len, fa_replay_t *window) {
+    portENTER_CRITICAL(&route_lock);
+    int slot = relay_find_neighbor_locked(src);
+    if (slot >= 0) {
+        *window = neighbors[slot].adverts;
+    } else {
+        memset(window, 0, sizeof(*window)); // New neighbour: its first advert sets the starting point
+    }
+    portEXIT_CRITICAL(&route_lock);
+    return auth_verify_group(data, len, window) == ESP_OK;
+}
+
+static void relay_on_advert(const uint8_t *src, const route_advert_t *adv, const fa_replay_t *window, int8_t rssi,
+                            int64_t rx_us) {
+    if (memcmp(adv->master_mac, pairing_primary_mac(), 6) != 0) return; // Another site's mesh
+    if (adv->hops == 0 && !pairing_is_master(src)) return; // Only a master is zero hops from itself
+    portENTER_CRITICAL(&route_lock);
+    int slot = relay_find_neighbor_locked(src), oldest = 0;
+    for (int i = 1; slot < 0 && i < RELAY_MAX_NEIGHBORS; i++) {
+        if (neighbors[i].last_heard_us < neighbors[oldest].last_heard_us) oldest = i;
+    }
+    if (slot < 0) {
+        slot = oldest; // Replace the stalest entry (or an empty one)
+        if (slot == uplink) uplink = -1;
+        memset(&neighbors[slot], 0, sizeof(neighbors[slot]));
+        memcpy(neighbors[slot].mac, src, 6);
+    }
+    relay_neighbor_t *n = &neighbors[slot];
+    n->link_rssi = rssi_ema(n->link_rssi, rssi, n->last_heard_us != 0);
+    n->hops = adv->hops;
+    n->path_rssi = adv->path_rssi;
+    n->last_heard_us = rx_us;
+    n->adverts = *window;
+    n->send_failures = 0; // Alive again: worth another try, or a streak of losses strands us for good
+    portEXIT_CRITICAL(&route_lock);
+}
+
+// True if (origin, msg_id) was taken on recently
+static bool relay_seen(const uint8_t origin[6], uint16_t msg_id) {
+    for (int i = 0; i < RELAY_DUP_CACHE; i++) {
+        if (dup_cache[i].msg_id == msg_id && memcmp(dup_cache[i].origin, origin, 6) == 0) return true;
+    }
+    return false;
+}
+
+// Records a frame once it is queued or sent, so a retry of one we had to drop still gets through
+static void relay_remember(const uint8_t origin[6], uint16_t msg_id) {
+    memcpy(dup_cache[dup_next].origin, origin, 6);
+    dup_cache[dup_next].msg_id = msg_id;
+    dup_next = (dup_next + 1) % RELAY_DUP_CACHE;
+}
+
+// Copies the current next hop without updating the route (Wi-Fi task). Returns false without one.
+static bool relay_current_hop(uint8_t mac[6], int64_t now_us) {
+    portENTER_CRITICAL(&route_lock);
+    bool have_route = link_fresh(master_heard_us, now_us) || uplink >= 0;
+    int hop = uplink;
+    if (hop >= 0) memcpy(mac, neighbors[hop].mac, 6);
+    portEXIT_CRITICAL(&route_lock);
+    if (hop < 0) memcpy(mac, pairing_master_mac(), 6);
+    return have_route;
+}
+
+// Updates a queued relay frame's header for the next hop and sends it
+static esp_err_t relay_forward(relay_item_t *item, const uint8_t next_hop[6], int64_t now_us) {
+    relay_hdr_t hdr;
+    memcpy(&hdr, item->data, sizeof(hdr));
+    uint32_t delay_ms = hdr.delay_ms + (uint32_t)((now_us - item->rx_us) / 1000);
+    hdr.delay_ms = delay_ms > UINT16_MAX ? UINT16_MAX : (uint16_t)delay_ms;
+    hdr.hops++;
+    hdr.ttl--;
+    memcpy(item->data, &hdr, sizeof(hdr));
+    esp_err_t ret = radio_send(next_hop, item->data, item->len);
+    if (ret == ESP_OK) stat_forwarded++;
+    return ret;
+}
+
+// A pairing probe on its way to the master goes at once, outside our slot: the prober
+// only waits PAIRING_PROBE_WAIT_MS per channel. The reply is passed back by nonce.
+static esp_err_t relay_forward_probe(relay_item_t *item, const pair_probe_t *probe) {
+    uint8_t next_hop[6];
+    if (!relay_current_hop(next_hop, item->rx_us)) return ESP_ERR_NOT_FOUND;
+    proxied_nonce[proxied_next] = probe->nonce;
+    proxied_next = (proxied_next + 1) % RELAY_PROXY_NONCES;
+    return relay_forward(item, next_hop, item->rx_us);
+}
+
+static void relay_on_relay_frame(const uint8_t *data, int len, int64_t rx_us) {
+    relay_hdr_t hdr;
+    memcpy(&hdr, data, sizeof(hdr));
+    if (memcmp(hdr.origin_mac, self_mac, 6) == 0 || relay_seen(hdr.origin_mac, hdr.msg_id)) {
+        stat_duplicates++; // Looped back to us, or a retry of a frame we already queued
+        return;
+    }
+    if (hdr.ttl == 0) {
+        stat_ttl_drops++;
+        return;
+    }
+    relay_item_t item = { .len = (uint16_t)len, .rx_us = rx_us };
+    memcpy(item.data, data, len);
+    const uint8_t *inner = data + sizeof(hdr);
+    if (ctrl_frame_is(inner, len - sizeof(hdr), CTRL_PAIR_PROBE, sizeof(pair_probe_t))) {
+        pair_probe_t probe;
+        memcpy(&probe, inner, sizeof(probe));
+        if (relay_forward_probe(&item, &probe) == ESP_OK) relay_remember(hdr.origin_mac, hdr.msg_id);
+        return;
+    }
+    if (xQueueSend(forward_queue, &item, 0) != pdTRUE) {
+        stat_queue_drops++;
+        return;
+    }
+    relay_remember(hdr.origin_mac, hdr.msg_id);
+    if (ctrl_frame_is(inner, len - sizeof(hdr), CTRL_ALARM, sizeof(alarm_frame_t) + FA_TRAILER_LEN)) {
+        memcpy(alarm_origin[alarm_origin_next], hdr.origin_mac, 6);
+        alarm_origin_next = (alarm_origin_next + 1) % RELAY_PROXY_NONCES;
+    }
+}
+
+// Carries a neighbour's probe to the master, which answers with a reply signed with the
+// prober's key; relays cannot answer on its behalf without making replies forgeable
+static void relay_proxy_probe(const pair_probe_t *probe, int64_t rx_us) {
+    relay_hdr_t hdr = {
+        .hdr = { .magic = ESPNOW_CTRL_MAGIC, .type = CTRL_RELAY },
+        .msg_id = (uint16_t)probe->nonce,
+        .hops = 0,
+        .ttl = RELAY_TTL,
+        .delay_ms = 0,
+    };
+    memcpy(hdr.origin_mac, probe->slave_mac, 6);
+    relay_item_t item = { .len = sizeof(hdr) + sizeof(*probe), .rx_us = rx_us };
+    memcpy(item.data, &hdr, sizeof(hdr));
+    memcpy(item.data + sizeof(hdr), probe, sizeof(*probe));
+    relay_forward_probe(&item, probe);
+}
+
+// Passes the master's reply to a probe we forwarded back towards the prober (once)
+static bool relay_on_pair_reply(const uint8_t *data, int len) {
+    pair_reply_t reply;
+    memcpy(&reply, data, sizeof(reply));
+    for (int i = 0; i < RELAY_PROXY_NONCES; i++) {
+        if (proxied_nonce[i] == reply.nonce && reply.nonce != 0) {
+            proxied_nonce[i] = 0;
+            radio_send(broadcast_mac, data, len); // Unchanged: the prober checks the master's tag
+            return true;
+        }
+    }
+    return false;
+}
+
+// Passes the master's ack of an alarm we forwarded back towards its origin (once)
+static bool relay_on_alarm_ack(const uint8_t *data, int len) {
+    alarm_ack_t ack;
+    memcpy(&ack, data, sizeof(ack));
+    for (int i = 0; i < RELAY_PROXY_NONCES; i++) {
+        if (memcmp(alarm_origin[i], ack.slave_mac, 6) == 0) {
+            memset(alarm_origin[i], 0, 6);
+            radio_send(broadcast_mac, data, len); // Unchanged: the origin checks the master's tag
+            return true;
+        }
+    }
+    return false;
+}
+
+bool relay_handle_frame(const esp_now_recv_info_t *info, const uint8_t *data, int len, int64_t rx_us) {
+    int8_t rssi = info->rx_ctrl ? info->rx_ctrl->rssi : RELAY_RSSI_MIN;
+    if (ctrl_frame_is(data, len, CTRL_ROUTE_ADVERT, sizeof(route_advert_t) + FA_TRAILER_LEN)) {
+        fa_replay_t window;
+        if (!relay_advert_authentic(info->src_addr, data, len, &window)) {
+            stat_advert_rejects++;
+            return true;
+        }
+        route_advert_t adv;
+        memcpy(&adv, data, sizeof(adv));
+        relay_on_advert(info->src_addr, &adv, &window, rssi, rx_us);
+        return true;
+    }
+    if (len > (int)sizeof(relay_hdr_t) && data[0] == ESPNOW_CTRL_MAGIC && data[1] == CTRL_RELAY) {
+        if (forward_enabled && forward_queue != NULL) relay_on_relay_frame(data, len, rx_us);
+        return true;
+    }
+    if (forward_enabled && ctrl_frame_is(data, len, CTRL_PAIR_PROBE, sizeof(pair_probe_t))) {
+        portENTER_CRITICAL(&route_lock);
+        bool have_route = link_fresh(master_heard_us, rx_us) || uplink >= 0;
+        portEXIT_CRITICAL(&route_lock);
+        if (have_route) {
+            pair_probe_t probe;
+            memcpy(&probe, data, sizeof(probe));
+            relay_proxy_probe(&probe, rx_us);
+        }
+        return true;
+    }
+    if (forward_enabled && ctrl_frame_is(data, len, CTRL_PAIR_REPLY, sizeof(pair_reply_t) + FA_TRAILER_LEN)) {
+        return relay_on_pair_reply(data, len);
+    }
+    if (forward_enabled && ctrl_frame_is(data, len, CTRL_ALARM_ACK, sizeof(alarm_ack_t) + FA_TRAILER_LEN)) {
+        return relay_on_alarm_ack(data, len);
+    }
+    return false;
+}
+
+bool relay_report_send_result(const uint8_t *mac, bool success) {
+    bool consumed = false;
+    portENTER_CRITICAL(&route_lock);
+    if (uplink >= 0 && memcmp(neighbors[uplink].mac, mac, 6) == 0) {
+        relay_neighbor_t *n = &neighbors[uplink];
+        if (success) {
+            n->send_failures = 0;
+        } else if (n->send_failures < RELAY_MAX_SEND_FAILURES) {
+            n->send_failures++; // At the limit the next route update skips this neighbour
+        }
+        consumed = true;
+    }
+    portEXIT_CRITICAL(&route_lock);
+    return consumed;
+}
+
+// --- Send Path (sending task) ---
+
+esp_err_t relay_init(bool forward) {
+    forward_enabled = forward;
+    esp_read_mac(self_mac, ESP_MAC_WIFI_STA);
+    own_msg_id = (uint16_t)esp_random(); // Neighbours still caching our pre-reboot ids must not drop new frames
+    if (forward && forward_queue == NULL) {
+        forward_queue = xQueueCreateStatic(RELAY_QUEUE_DEPTH, sizeof(relay_item_t), forward_queue_storage, &forward_queue_buf);
+    }
+    next_advert_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "Relay mode %s.", forward ? "on (forwarding for neighbours)" : "off (may still use relays)");
+    return ESP_OK;
+}
+
+void relay_use_radio(relay_radio_send_t send) {
+    radio_send = send != NULL ? send : esp_now_send;
+}
+
+esp_err_t relay_send(const uint8_t *frame, size_t len) {
+    uint8_t next_hop[6];
+    if (relay_next_hop(next_hop)) {
+        return radio_send(next_hop, frame, len);
+    }
+
+    uint8_t wrapped[ESP_NOW_MAX_DATA_LEN];
+    if (len + sizeof(relay_hdr_t) > sizeof(wrapped)) return ESP_ERR_INVALID_SIZE;
+    relay_hdr_t hdr = {
+        .hdr = { .magic = ESPNOW_CTRL_MAGIC, .type = CTRL_RELAY },
+        .msg_id = own_msg_id++,
+        .hops = 0,
+        .ttl = RELAY_TTL,
+        .delay_ms = 0,
+    };
+    memcpy(hdr.origin_mac, self_mac, 6);
+    memcpy(wrapped, &hdr, sizeof(hdr));
+    memcpy(wrapped + sizeof(hdr), frame, len);
+    stat_originated++;
+    return radio_send(next_hop, wrapped, sizeof(hdr) + len);
+}
+
+void relay_flush(void) {
+    if (!forward_enabled || forward_queue == NULL) return;
+
+    uint8_t next_hop[6];
+    relay_next_hop(next_hop);
+
+    relay_item_t item;
+    while (xQueueReceive(forward_queue, &item, 0) == pdTRUE) {
+        esp_err_t ret = relay_forward(&item, next_hop, esp_timer_get_time());
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Forward failed: %s", esp_err_to_name(ret));
+        }
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    if (now_us >= next_advert_us) {
+        next_advert_us = now_us + (int64_t)RELAY_ADVERT_INTERVAL_MS * 1000;
+        portENTER_CRITICAL(&route_lock);
+        bool have_route = link_fresh(master_heard_us, now_us) || uplink >= 0;
+        route_advert_t adv = {
+            .hdr = { .magic = ESPNOW_CTRL_MAGIC, .type = CTRL_ROUTE_ADVERT },
+            .hops = route_hops,
+            .path_rssi = route_rssi,
+        };
+        portEXIT_CRITICAL(&route_lock);
+        if (have_route) {
+            memcpy(adv.master_mac, pairing_primary_mac(), 6);
+            adv.channel = pairing_channel();
+            uint8_t frame[sizeof(adv) + FA_TRAILER_LEN];
+            memcpy(frame, &adv, sizeof(adv));
+            size_t frame_len = auth_sign_group(frame, sizeof(adv), sizeof(frame));
+            if (frame_len > 0) radio_send(broadcast_mac, frame, frame_len);
+        }
+    }
+}
+
+bool relay_uplink_is_master(void) {
+    portENTER_CRITICAL(&route_lock);
+    bool direct = uplink < 0;
+    portEXIT_CRITICAL(&route_lock);
+    return direct;
+}
+
+void relay_log_stats(void) {
+    portENTER_CRITICAL(&route_lock);
+    uint8_t hops = route_hops;
+    int8_t rssi = route_rssi;
+    portEXIT_CRITICAL(&route_lock);
+    ESP_LOGI(TAG, "Route: %u hop(s), bottleneck %d dBm. Originated %lu via relays, forwarded %lu, "
+             "dropped %lu duplicate / %lu TTL / %lu queue-full, %lu advert(s) failed authentication.", hops, rssi,
+             (unsigned long)stat_originated, (unsigned long)stat_forwarded, (unsigned long)stat_duplicates,
+             (unsigned long)stat_ttl_drops, (unsigned long)stat_queue_drops, (unsigned long)stat_advert_rejects);
+}
@@ -0,0 +1,96 @@
+// relay.h
+#ifndef RELAY_H
+#define RELAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_now.h"
+
+// --- Configuration ---
+#define RELAY_MAX_NEIGHBORS       8
+#define RELAY_QUEUE_DEPTH         4      // Frames waiting for our next slot
+#define RELAY_TTL                 4      // Max relays a frame may traverse
+#define RELAY_DUP_CACHE           32     // Recently forwarded (origin, msg_id) pairs
+#define RELAY_PROXY_NONCES        4      // Pairing probes (and alarms) forwarded whose reply (ack) is still awaited
+#define RELAY_LINK_EXPIRY_MS      60000  // Forget a neighbour / the master link after this much silence
+#define RELAY_ADVERT_INTERVAL_MS  10000
+#define RELAY_RSSI_MIN            (-88)  // Links weaker than this are not used as uplinks
+#define RELAY_HOP_PENALTY_DB      8      // Each extra hop must buy at least this much link margin
+#define RELAY_HYSTERESIS_DB       4      // A new uplink must beat the current one by this much
+#define RELAY_MAX_SEND_FAILURES   3      // Consecutive failures before a neighbour is skipped (until its next advert)
+#define RELAY_RSSI_EMA_SHIFT      2      // Link RSSI smoothing: new = old + (sample - old) / 4
+
+// Routing: every slave tracks the master link (RSSI of beacons and other master frames)
+// and the route adverts of its neighbours. Its uplink is whichever of "master direct" or
+// "via neighbour" has the best score: the weakest RSSI on the path, minus
+// RELAY_HOP_PENALTY_DB per extra hop. Frames sent through a neighbour are wrapped in a
+// relay_hdr_t; relays forward them in their own TDMA slot. Adverts are signed with the
+// site's group key and checked against a replay window per neighbour, and only a master
+// may claim zero hops, so a stranger cannot pull the mesh's traffic towards itself.
+//
+// Slaves in relay mode (forwarding enabled) also advertise their route, forward frames
+// for others, and carry pairing probes to the master and its signed replies back, so
+// that slaves out of the master's range can still pair. The master's alarm acks
+// travel back the same way.
+
+// Sends one frame to peer, as esp_now_send does: ESP_OK once queued, the MAC-layer
+// result arrives through the registered ESP-NOW send callback
+typedef esp_err_t (*relay_radio_send_t)(const uint8_t *peer, const uint8_t *data, size_t len);
+
+/**
+ * @brief Sets up the forward queue. Call after pairing (needs the master MAC).
+ *
+ * @param forward true to act as a relay for other slaves, false to only use relays.
+ */
+esp_err_t relay_init(bool forward);
+
+/**
+ * @brief Records that a frame from the master was heard. Safe to call from the Wi-Fi task.
+ */
+void relay_on_master_frame(int8_t rssi, int64_t rx_us);
+
+/**
+ * @brief Handles route adverts, relay frames and (in relay mode) pairing probes,
+ *        pairing replies and alarm acks to pass back. Call after pairing_handle_frame().
+ *        Safe to call from the Wi-Fi task.
+ * @return true if the frame was consumed.
+ */
+bool relay_handle_frame(const esp_now_recv_info_t *info, const uint8_t *data, int len, int64_t rx_us);
+
+/**
+ * @brief Sends every frame through send instead of esp_now_send (NULL restores it).
+ *        The soak (soak.h) models the ESP-NOW driver this way.
+ */
+void relay_use_radio(relay_radio_send_t send);
+
+/**
+ * @brief Sends one of this slave's own frames towards the master, directly or via the
+ *        current uplink neighbour.
+ */
+esp_err_t relay_send(const uint8_t *frame, size_t len);
+
+/**
+ * @brief Forwards queued frames and sends the periodic route advert. Call from the
+ *        sending task, inside this slave's transmit slot.
+ */
+void relay_flush(void);
+
+/**
+ * @brief Feeds an ESP-NOW send result. Safe to call from the Wi-Fi task.
+ * @return true if mac is the current uplink neighbour (the result was consumed).
+ */
+bool relay_report_send_result(const uint8_t *mac, bool success);
+
+/**
+ * @brief True while frames go straight to the master (pairing failure handling applies).
+ */
+bool relay_uplink_is_master(void);
+
+/**
+ * @brief Logs route and forwarding counters.
+ */
+void relay_log_stats(void);
+
+#endif // RELAY_H
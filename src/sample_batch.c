@@ -0,0 +1,142 @@
+// src/sample_batch.c
+#include <string.h>
+#include "ts_codec.h"
+#include "esp_now.h"
+#include "frame_auth.h"
+#include "sample_batch.h"
+
+_Static_assert(SAMPLE_BATCH_MAX <= 8, "motion bitmap is one byte");
+_Static_assert(SAMPLE_BATCH_MAX_FRAME_BYTES + FA_TRAILER_LEN <= ESP_NOW_MAX_DATA_LEN, "worst-case signed batch must fit one ESP-NOW frame");
+
+// --- Column Helpers ---
+
+// Field accessors so each column is gathered/scattered with the same loop
+#define GATHER(dst, samples, n, field)  for (size_t i = 0; i < (n); i++) (dst)[i] = (samples)[i].field
+#define SCATTER(src, samples, n, field) for (size_t i = 0; i < (n); i++) (samples)[i].field = (src)[i]
+
+// Unsigned LEB128; values are below 2^21 so at most 3 bytes
+static size_t put_uvarint(uint32_t v, uint8_t *out, size_t cap) {
+    size_t pos = 0;
+    do {
+        if (pos >= cap) return 0;
+        uint8_t b = v & 0x7F;
+        v >>= 7;
+        out[pos++] = v ? (b | 0x80) : b;
+    } while (v);
+    return pos;
+}
+
+static size_t get_uvarint(const uint8_t *in, size_t len, uint32_t *v) {
+    *v = 0;
+    for (size_t pos = 0; pos < len && pos < 3; pos++) {
+        *v |= (uint32_t)(in[pos] & 0x7F) << (7 * pos);
+        if (!(in[pos] & 0x80)) return pos + 1;
+    }
+    return 0;
+}
+
+size_t sample_batch_encode(const sensor_data_t *samples, size_t n, uint8_t *buf, size_t buf_len) {
+    if (samples == NULL || buf == NULL || n == 0 || n > SAMPLE_BATCH_MAX) return 0;
+    if (buf_len < sizeof(ctrl_hdr_t) + 1) return 0;
+
+    int32_t ints[SAMPLE_BATCH_MAX];
+    float floats[SAMPLE_BATCH_MAX];
+    size_t pos = 0, used;
+
+    buf[pos++] = ESPNOW_CTRL_MAGIC;
+    buf[pos++] = CTRL_SAMPLE_BATCH;
+    buf[pos++] = (uint8_t)n;
+
+    GATHER(ints, samples, n, dht_status);
+    if ((used = tsc_encode_ints(ints, n, buf + pos, buf_len - pos)) == 0) return 0;
+    pos += used;
+    GATHER(ints, samples, n, temperature);
+    if ((used = tsc_encode_ints(ints, n, buf + pos, buf_len - pos)) == 0) return 0;
+    pos += used;
+    GATHER(ints, samples, n, humidity);
+    if ((used = tsc_encode_ints(ints, n, buf + pos, buf_len - pos)) == 0) return 0;
+    pos += used;
+
+    if (pos >= buf_len) return 0;
+    uint8_t motion = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (samples[i].motion_detected) motion |= (uint8_t)(1u << i);
+    }
+    buf[pos++] = motion;
+
+    GATHER(floats, samples, n, mq2_lpg_ppm);
+    if ((used = tsc_encode_floats(floats, n, buf + pos, buf_len - pos)) == 0) return 0;
+    pos += used;
+    GATHER(floats, samples, n, mq2_co_ppm);
+    if ((used = tsc_encode_floats(floats, n, buf + pos, buf_len - pos)) == 0) return 0;
+    pos += used;
+    GATHER(floats, samples, n, mq2_smoke_ppm);
+    if ((used = tsc_encode_floats(floats, n, buf + pos, buf_len - pos)) == 0) return 0;
+    pos += used;
+
+    uint32_t newest = samples[n - 1].timestamp_ms;
+    if (buf_len - pos < sizeof(newest)) return 0;
+    memcpy(buf + pos, &newest, sizeof(newest));
+    pos += sizeof(newest);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t age = newest - samples[i].timestamp_ms; // Wraps correctly across the 32-bit rollover
+        if (newest == 0 || samples[i].timestamp_ms == 0 || age > SAMPLE_BATCH_AGE_UNKNOWN) age = SAMPLE_BATCH_AGE_UNKNOWN;
+        if ((used = put_uvarint(age, buf + pos, buf_len - pos)) == 0) return 0;
+        pos += used;
+    }
+
+    return pos;
+}
+
+size_t sample_batch_decode(const uint8_t *buf, size_t len, sensor_data_t *out, size_t max_n) {
+    if (buf == NULL || out == NULL || len < sizeof(ctrl_hdr_t) + 1) return 0;
+    if (buf[0] != ESPNOW_CTRL_MAGIC || buf[1] != CTRL_SAMPLE_BATCH) return 0;
+
+    size_t n = buf[2];
+    if (n == 0 || n > SAMPLE_BATCH_MAX || n > max_n) return 0;
+
+    int32_t ints[SAMPLE_BATCH_MAX];
+    float floats[SAMPLE_BATCH_MAX];
+    size_t pos = 3, used;
+
+    memset(out, 0, n * sizeof(sensor_data_t));
+
+    if ((used = tsc_decode_ints(buf + pos, len - pos, ints, n)) == 0) return 0;
+    pos += used;
+    SCATTER(ints, out, n, dht_status);
+    if ((used = tsc_decode_ints(buf + pos, len - pos, ints, n)) == 0) return 0;
+    pos += used;
+    SCATTER(ints, out, n, temperature);
+    if ((used = tsc_decode_ints(buf + pos, len - pos, ints, n)) == 0) return 0;
+    pos += used;
+    SCATTER(ints, out, n, humidity);
+
+    if (pos >= len) return 0;
+    uint8_t motion = buf[pos++];
+    for (size_t i = 0; i < n; i++) {
+        out[i].motion_detected = (motion >> i) & 1u;
+    }
+
+    if ((used = tsc_decode_floats(buf + pos, len - pos, floats, n)) == 0) return 0;
+    pos += used;
+    SCATTER(floats, out, n, mq2_lpg_ppm);
+    if ((used = tsc_decode_floats(buf + pos, len - pos, floats, n)) == 0) return 0;
+    pos += used;
+    SCATTER(floats, out, n, mq2_co_ppm);
+    if ((used = tsc_decode_floats(buf + pos, len - pos, floats, n)) == 0) return 0;
+    pos += used;
+    SCATTER(floats, out, n, mq2_smoke_ppm);
+
+    uint32_t newest;
+    if (len - pos < sizeof(newest)) return 0;
+    memcpy(&newest, buf + pos, sizeof(newest));
+    pos += sizeof(newest);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t age;
+        if ((used = get_uvarint(buf + pos, len - pos, &age)) == 0) return 0;
+        pos += used;
+        out[i].timestamp_ms = age >= SAMPLE_BATCH_AGE_UNKNOWN ? 0 : newest - age;
+    }
+
+    return pos == len ? n : 0;
+}
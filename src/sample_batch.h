@@ -0,0 +1,45 @@
+// sample_batch.h
+#ifndef SAMPLE_BATCH_H
+#define SAMPLE_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "shared_header.h"
+#include "ts_codec.h"
+
+// Most samples per CTRL_SAMPLE_BATCH frame. Chosen so the worst-case encoding
+// (every value changing by a large amount) still fits in one ESP-NOW frame.
+#define SAMPLE_BATCH_MAX 6
+
+// Timestamp ages are varints of at most 3 bytes; this value (~35 min) or more means "no stamp"
+#define SAMPLE_BATCH_AGE_UNKNOWN 0x1FFFFFu
+
+// Worst-case frame size for SAMPLE_BATCH_MAX samples; size send buffers with this.
+#define SAMPLE_BATCH_MAX_FRAME_BYTES (sizeof(ctrl_hdr_t) + 1 + 3 * TSC_INT_SERIES_MAX_BYTES(SAMPLE_BATCH_MAX) + \
+                                      1 + 3 * TSC_FLOAT_SERIES_MAX_BYTES(SAMPLE_BATCH_MAX) + \
+                                      4 + 3 * SAMPLE_BATCH_MAX)
+
+/*
+ * Frame layout (after ctrl_hdr_t and a one-byte sample count), column by column:
+ *   dht_status, temperature, humidity  - tsc_encode_ints (delta + zigzag varint)
+ *   motion_detected                    - bitmap, one bit per sample, LSB first
+ *   mq2_lpg_ppm, mq2_co_ppm, smoke_ppm - tsc_encode_floats (XOR compression)
+ *   timestamp_ms                       - the newest sample's stamp (4 bytes, little endian), then
+ *                                        each sample's age against it in ms as an unsigned
+ *                                        LEB128 varint, SAMPLE_BATCH_AGE_UNKNOWN if unstamped
+ * Samples are in acquisition order, oldest first.
+ */
+
+/**
+ * @brief Compresses n samples into a CTRL_SAMPLE_BATCH frame.
+ * @return Frame length in bytes, or 0 if n is out of range or buf is too small.
+ */
+size_t sample_batch_encode(const sensor_data_t *samples, size_t n, uint8_t *buf, size_t buf_len);
+
+/**
+ * @brief Decodes a CTRL_SAMPLE_BATCH frame (master side).
+ * @return Number of samples written to out, or 0 if the frame is malformed or has more than max_n.
+ */
+size_t sample_batch_decode(const uint8_t *buf, size_t len, sensor_data_t *out, size_t max_n);
+
+#endif // SAMPLE_BATCH_H
@@ -0,0 +1,41 @@
+// src/sensor_dht11.c
+#include "sensors.h"
+
+#if SENSOR_HAS_DHT11
+#include "esp_log.h"
+#include "DHT.h"
+
+static const char *TAG = "DHT11";
+
+static struct dht11_reading last = { DHT11_TIMEOUT_ERROR, -1, -1 };
+
+static esp_err_t dht11_sensor_init(void) {
+    DHT11_init(CONFIG_SLAVE_DHT11_GPIO); // Blocks ~1 s while the sensor stabilises
+    ESP_LOGI(TAG, "DHT11 Initialized on GPIO %d.", CONFIG_SLAVE_DHT11_GPIO);
+    return ESP_OK;
+}
+
+static void dht11_sensor_sample(const sensor_data_t *data) {
+    last = DHT11_read();
+    if (last.status == DHT11_OK) {
+        ESP_LOGD(TAG, "DHT Read OK: T=%d C, H=%d %%", last.temperature, last.humidity);
+    } else {
+        ESP_LOGW(TAG, "DHT Read Failed. Status: %d", last.status);
+    }
+}
+
+static void dht11_sensor_encode(sensor_data_t *data) {
+    data->dht_status = last.status;
+    if (last.status == DHT11_OK) {
+        data->temperature = last.temperature;
+        data->humidity = last.humidity;
+    }
+}
+
+const sensor_driver_t sensor_dht11 = {
+    .name = "DHT11",
+    .init = dht11_sensor_init,
+    .sample = dht11_sensor_sample,
+    .encode = dht11_sensor_encode,
+};
+#endif // SENSOR_HAS_DHT11
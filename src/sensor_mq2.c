@@ -0,0 +1,77 @@
+// src/sensor_mq2.c
+#include "sensors.h"
+
+#if SENSOR_HAS_MQ2
+#include <math.h>
+#include "esp_log.h"
+#include "MQ2.h"
+
+static const char *TAG = "MQ2";
+
+// Must use ADC1 with Wi-Fi; channel from menuconfig (6 = GPIO34)
+#define MQ2_ADC_UNIT    ADC_UNIT_1
+#define MQ2_ADC_CHANNEL ((adc_channel_t)CONFIG_SLAVE_MQ2_ADC1_CHANNEL)
+#define MQ2_ADC_ATTEN   ADC_ATTEN_DB_12 // Full 0-3.3 V range (the old DB_11)
+
+static MQ2 mq2_sensor;
+static float last[3] = { NAN, NAN, NAN }; // LPG, CO, smoke ppm; negative = calculation error
+static uint32_t ro_updates_logged;
+
+static esp_err_t mq2_sensor_init(void) {
+    ESP_LOGI(TAG, "Initializing MQ2 Sensor on ADC Unit %d, Channel %d, Attenuation %d...",
+             MQ2_ADC_UNIT, MQ2_ADC_CHANNEL, MQ2_ADC_ATTEN);
+
+    esp_err_t ret = mq2_init(&mq2_sensor, MQ2_ADC_UNIT, MQ2_ADC_CHANNEL, MQ2_ADC_ATTEN);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "MQ2 ADC Initialization FAILED! Error: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "MQ2 ADC Initialized successfully.");
+    // MQ2 Calibration (Requires sensor pre-heating!)
+    ESP_LOGW(TAG, "MQ2 requires pre-heating before calibration for accuracy!");
+    ESP_LOGI(TAG, "Starting MQ2 Calibration in background... Ensure clean air environment.");
+    if (!mq2_begin(&mq2_sensor)) {
+        ESP_LOGE(TAG, "MQ2 Calibration FAILED! Readings will not be available.");
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "MQ2 Calibrated successfully. Ro = %.3f kOhm", mq2_sensor.Ro);
+    return ESP_OK;
+}
+
+static void mq2_sensor_sample(const sensor_data_t *data) {
+    // This cycle's DHT11 reading, taken just before (DHT11_OK); the last one is kept on failures
+    if (data->dht_status == 0) mq2_set_ambient(&mq2_sensor, data->temperature, data->humidity);
+    float *values = mq2_read(&mq2_sensor, false);
+    if (values == NULL) {
+        ESP_LOGW(TAG, "MQ2 Read Failed (mq2_read returned NULL).");
+        for (int i = 0; i < 3; i++) last[i] = NAN;
+        return;
+    }
+    for (int i = 0; i < 3; i++) last[i] = values[i];
+    if (mq2_sensor.ro_track.updates != ro_updates_logged) {
+        ro_updates_logged = mq2_sensor.ro_track.updates;
+        ESP_LOGI(TAG, "Ro tracked to %.3f kOhm (calibrated %.3f)", mq2_sensor.Ro, mq2_sensor.ro_track.ro_calibrated);
+    }
+
+    ESP_LOGD(TAG, "MQ2 Read: LPG=%.2f ppm, CO=%.2f ppm, Smoke=%.2f ppm",
+             last[0] < 0 ? NAN : last[0], // Print NAN if error
+             last[1] < 0 ? NAN : last[1],
+             last[2] < 0 ? NAN : last[2]);
+    if (last[0] < 0) ESP_LOGW(TAG, "MQ2 LPG calculation error (Code %.1f)", last[0]);
+    if (last[1] < 0) ESP_LOGW(TAG, "MQ2 CO calculation error (Code %.1f)", last[1]);
+    if (last[2] < 0) ESP_LOGW(TAG, "MQ2 Smoke calculation error (Code %.1f)", last[2]);
+}
+
+static void mq2_sensor_encode(sensor_data_t *data) {
+    data->mq2_lpg_ppm = last[0];
+    data->mq2_co_ppm = last[1];
+    data->mq2_smoke_ppm = last[2];
+}
+
+const sensor_driver_t sensor_mq2 = {
+    .name = "MQ2",
+    .init = mq2_sensor_init,
+    .sample = mq2_sensor_sample,
+    .encode = mq2_sensor_encode,
+};
+#endif // SENSOR_HAS_MQ2
@@ -0,0 +1,51 @@
+// src/sensor_pir.c
+#include "sensors.h"
+
+#if SENSOR_HAS_PIR
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "mjd_hcsr501.h"
+
+static const char *TAG = "PIR";
+
+static mjd_hcsr501_config_t pir_config = { .data_gpio_num = CONFIG_SLAVE_PIR_GPIO };
+static bool motion_latched; // Set by a trigger, cleared once a frame carrying it was delivered
+
+static esp_err_t pir_sensor_init(void) {
+    esp_err_t ret = mjd_hcsr501_init(&pir_config); // Blocks ~5 s for stabilisation
+    if (ret == ESP_OK && pir_config.isr_semaphore == NULL) ret = ESP_FAIL;
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "PIR Initialization Failed on GPIO %d: %s", CONFIG_SLAVE_PIR_GPIO, esp_err_to_name(ret));
+        return ret;
+    }
+    if (xSemaphoreTake(pir_config.isr_semaphore, pdMS_TO_TICKS(10)) == pdTRUE) {
+        ESP_LOGI(TAG, "PIR cleared initial trigger.");
+    }
+    ESP_LOGI(TAG, "PIR Initialized on GPIO %d.", CONFIG_SLAVE_PIR_GPIO);
+    return ESP_OK;
+}
+
+static void pir_sensor_sample(const sensor_data_t *data) {
+    if (xSemaphoreTake(pir_config.isr_semaphore, 0) == pdTRUE) {
+        motion_latched = true;
+        ESP_LOGI(TAG, "PIR Motion Detected!");
+    }
+}
+
+static void pir_sensor_encode(sensor_data_t *data) {
+    data->motion_detected = motion_latched;
+}
+
+static void pir_sensor_frame_sent(void) {
+    motion_latched = false;
+}
+
+const sensor_driver_t sensor_pir = {
+    .name = "PIR",
+    .init = pir_sensor_init,
+    .sample = pir_sensor_sample,
+    .encode = pir_sensor_encode,
+    .frame_sent = pir_sensor_frame_sent,
+};
+#endif // SENSOR_HAS_PIR
@@ -0,0 +1,34 @@
+// src/sensors.c
+#include <math.h>
+#include <string.h>
+
+#include "sensors.h"
+
+extern const sensor_driver_t sensor_dht11;
+extern const sensor_driver_t sensor_mq2;
+extern const sensor_driver_t sensor_pir;
+
+// Sampling order: the DHT11 comes first so the MQ2 can compensate with its reading
+const sensor_driver_t *const sensor_registry[SENSOR_COUNT + 1] = {
+#if SENSOR_HAS_DHT11
+    &sensor_dht11,
+#endif
+#if SENSOR_HAS_MQ2
+    &sensor_mq2,
+#endif
+#if SENSOR_HAS_PIR
+    &sensor_pir,
+#endif
+    NULL,
+};
+
+void sensor_data_clear(sensor_data_t *data) {
+    memset(data, 0, sizeof(sensor_data_t));
+    data->dht_status = -1; // DHT11_TIMEOUT_ERROR, without depending on the driver
+    data->temperature = -99;
+    data->humidity = -99;
+    data->mq2_lpg_ppm = NAN;
+    data->mq2_co_ppm = NAN;
+    data->mq2_smoke_ppm = NAN;
+    data->motion_detected = false;
+}
@@ -0,0 +1,70 @@
+// sensors.h
+#ifndef SENSORS_H
+#define SENSORS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include "shared_header.h"
+
+// Sensor registry: the drivers fitted to this node, chosen in menuconfig
+// ("Slave sensors", src/Kconfig.projbuild).
+//
+// Each driver is a sensor_driver_t in its own src/sensor_<name>.c, built only when
+// its CONFIG_SLAVE_SENSOR_* option is set, so a node without a sensor carries
+// neither its code nor its warm-up at boot. app_main starts one init task per
+// driver, and sensor_task samples whatever is ready through the table, so adding
+// a sensor type means a Kconfig option, a driver file and a line in sensors.c.
+
+#ifdef CONFIG_SLAVE_SENSOR_DHT11
+#define SENSOR_HAS_DHT11 1
+#else
+#define SENSOR_HAS_DHT11 0
+#endif
+#ifdef CONFIG_SLAVE_SENSOR_MQ2
+#define SENSOR_HAS_MQ2 1
+#else
+#define SENSOR_HAS_MQ2 0
+#endif
+#ifdef CONFIG_SLAVE_SENSOR_PIR
+#define SENSOR_HAS_PIR 1
+#else
+#define SENSOR_HAS_PIR 0
+#endif
+
+// Drivers in sensor_registry (sizes the static init task stacks)
+#define SENSOR_COUNT (SENSOR_HAS_DHT11 + SENSOR_HAS_MQ2 + SENSOR_HAS_PIR)
+
+typedef struct {
+    const char *name;
+
+    // Warm-up and calibration, in its own short-lived task (may block for seconds).
+    // The driver is sampled only after this returned ESP_OK. NULL = ready at once.
+    esp_err_t (*init)(void);
+
+    // Reads the hardware into the driver's last reading (sensor task, keep it short).
+    // data is the sample being built: fields of drivers earlier in the table are
+    // already filled in (e.g. the DHT11's temperature for MQ2 compensation).
+    void (*sample)(const sensor_data_t *data);
+
+    // Writes the last reading, or its error status, into the driver's fields of a sample.
+    void (*encode)(sensor_data_t *data);
+
+    // Optional: a frame carrying the readings was delivered (e.g. clear a latched event).
+    void (*frame_sent)(void);
+} sensor_driver_t;
+
+/**
+ * @brief Compiled-in drivers, in sampling order, NULL-terminated.
+ */
+extern const sensor_driver_t *const sensor_registry[SENSOR_COUNT + 1];
+
+/**
+ * @brief Sets every field to its "no reading" value (dht_status timeout, temperature
+ *        and humidity -99, ppm NAN, no motion). Fields of absent or warming-up sensors
+ *        keep these.
+ */
+void sensor_data_clear(sensor_data_t *data);
+
+#endif // SENSORS_H
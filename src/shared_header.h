@@ -3,6 +3,10 @@
 #define SHARED_DATA_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
 
 // Define a structure to hold sensor data
 typedef struct struct_sensor_data {
@@ -13,6 +17,241 @@ typedef struct struct_sensor_data {
     float mq2_co_ppm;       // ppm
     float mq2_smoke_ppm;    // ppm
     bool motion_detected;   // true if motion detected since last send
+    uint32_t timestamp_ms;  // acquisition time on the master's clock (timesync.h), ms, wraps; 0 = not synced
 } sensor_data_t;
 
+// --- Frame Encoding / Decoding ---
+// Both ends are ESP32 (same endianness and struct layout), so the wire format
+// is the packed struct itself. These helpers keep the length checks in one place.
+
+// Copies a sample into an outgoing ESP-NOW buffer. Returns bytes written, 0 if buf is too small.
+static inline size_t sensor_data_encode(const sensor_data_t *data, uint8_t *buf, size_t buf_len) {
+    if (data == NULL || buf == NULL || buf_len < sizeof(sensor_data_t)) return 0;
+    memcpy(buf, data, sizeof(sensor_data_t));
+    return sizeof(sensor_data_t);
+}
+
+// Decodes a received frame (master side). Returns false if the length is wrong
+// or a field is out of its physical range, so corrupted frames are dropped early.
+static inline bool sensor_data_decode(const uint8_t *buf, size_t len, sensor_data_t *out) {
+    if (buf == NULL || out == NULL || len != sizeof(sensor_data_t)) return false;
+    memcpy(out, buf, sizeof(sensor_data_t));
+    if (out->dht_status < -2 || out->dht_status > 0) return false;
+    if (out->dht_status == 0 && (out->temperature < -40 || out->temperature > 125 ||
+                                 out->humidity < 0 || out->humidity > 100)) return false;
+    if (isinf(out->mq2_lpg_ppm) || isinf(out->mq2_co_ppm) || isinf(out->mq2_smoke_ppm)) return false;
+    return true;
+}
+
+// --- Control Frames ---
+// Non-sample traffic starts with ESPNOW_CTRL_MAGIC and a type byte. Sample frames
+// are told apart by length (sizeof(sensor_data_t)) and never start with the magic
+// because dht_status is 0, -1 or -2.
+//
+// Everything a slave sends to its master after pairing (samples, batches, memory
+// reports) carries a frame_auth.h trailer: strip FA_TRAILER_LEN bytes after
+// fa_verify() before applying the rules above. Pairing probes are not signed.
+// Pairing replies go the other way and are signed by the master with the probing
+// slave's key (derived from pair_probe_t.slave_mac), so only the site's master can
+// pair a slave. The master signs what it broadcasts (slot beacons, time sync) with
+// the site's group key (fa_derive_group_key()); slaves keep a replay window per master.
+#define ESPNOW_CTRL_MAGIC 0xA5
+
+typedef enum {
+    CTRL_PAIR_PROBE = 1,    // slave -> broadcast: looking for a master on this channel
+    CTRL_PAIR_REPLY = 2,    // master -> slave: unicast answer to a probe
+    CTRL_SLOT_BEACON = 3,   // master -> broadcast: marks the start of each TDMA superframe
+    CTRL_SLOT_ASSIGN = 4,   // master -> slave: the slave's transmit slot
+    CTRL_SAMPLE_BATCH = 5,  // slave -> master: several compressed samples (sample_batch.h)
+    CTRL_SAMPLING_CONFIG = 6, // master -> slave: adaptive sampling limits (stored in NVS)
+    CTRL_MEM_REPORT = 7,    // slave -> master: periodic stack/heap budget (memstats.h)
+    CTRL_ROUTE_ADVERT = 8,  // relay slave -> broadcast: "I can reach the master in N hops"
+    CTRL_RELAY = 9,         // slave -> relay -> ... -> master: a frame forwarded for another slave
+    CTRL_MASTER_SYNC = 10,  // master <-> master: per-slave replay windows (dual-master failover)
+    CTRL_TIME_SYNC = 11,    // master -> broadcast: master clock for sample timestamps (timesync.h)
+    CTRL_ALARM = 12,        // slave -> master: fire/gas detection raised or cleared (detect.h)
+    CTRL_ALARM_ACK = 13,    // master -> slave: an alarm frame arrived (end-to-end, through relays too)
+} ctrl_type_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t magic;          // ESPNOW_CTRL_MAGIC
+    uint8_t type;           // ctrl_type_t
+} ctrl_hdr_t;
+
+// The master answers a probe with a reply echoing the nonce, from the channel it
+// is listening on, and adds the slave as a peer. The reply is followed by a
+// frame_auth.h trailer under the slave's key; the nonce, not the sequence number,
+// makes it fresh. In a redundant pair both masters answer with the same master_mac
+// (the primary) and standby_mac (all zero if none); they must share a channel so
+// that failover needs no rescan. A probe may also arrive wrapped in a CTRL_RELAY
+// frame (msg_id = low 16 bits of the nonce); the reply then goes to the relay the
+// frame came from, and the relays pass it back unchanged.
+typedef struct __attribute__((packed)) {
+    ctrl_hdr_t hdr;
+    uint8_t slave_mac[6];
+    uint8_t channel;        // channel the probe was sent on
+    uint32_t nonce;         // echoed in the reply so stale replies are ignored
+} pair_probe_t;
+
+typedef struct __attribute__((packed)) {
+    ctrl_hdr_t hdr;
+    uint8_t master_mac[6];
+    uint8_t channel;        // master's operating channel
+    uint32_t nonce;
+    uint8_t standby_mac[6]; // redundant master on the same channel, or zeros
+} pair_reply_t;
+
+// Sent by the master at the start of every superframe. Slot n starts at
+// beacon time + n * slot_ms; slaves transmit only inside their own slot.
+// Followed by a frame_auth.h trailer under the site's group key.
+typedef struct __attribute__((packed)) {
+    ctrl_hdr_t hdr;
+    uint16_t superframe_ms;  // period between beacons (= each slave's report period)
+    uint16_t slot_ms;        // width of one transmit slot
+    uint16_t slot_count;     // slots in use this superframe
+    uint16_t beacon_seq;
+} slot_beacon_t;
+
+// Broadcast by the master alongside its slot beacons (every few seconds is plenty).
+// master_us is the master's esp_timer_get_time() taken just before esp_now_send().
+// The master unwraps a sample's timestamp_ms against its own clock: age in ms is
+// (uint32_t)(now_ms - timestamp_ms) with now_ms = esp_timer_get_time() / 1000.
+// Followed by a frame_auth.h trailer under the site's group key.
+typedef struct __attribute__((packed)) {
+    ctrl_hdr_t hdr;
+    uint16_t seq;
+    int64_t master_us;
+} time_sync_t;
+
+// Sent by the master after pairing, and again whenever it sees a frame from a
+// slave transmitting outside its slot or without an assignment. Followed by a
+// frame_auth.h trailer under the slave's key.
+typedef struct __attribute__((packed)) {
+    ctrl_hdr_t hdr;
+    uint16_t slot_index;
+    uint16_t slot_count;
+    uint16_t slot_ms;
+    uint16_t superframe_ms;
+} slot_assign_t;
+
+// Limits for the slave's adaptive sampling controller. The slave samples at
+// min_period_ms while any trigger is exceeded and backs off towards
+// max_period_ms while signals are stable. Followed by a frame_auth.h trailer
+// under the slave's key; the slave keeps a replay window for the master and
+// persists its top with the limits.
+typedef struct __attribute__((packed)) {
+    ctrl_hdr_t hdr;
+    uint32_t min_period_ms;
+    uint32_t max_period_ms;
+    float ppm_slope_per_min;   // MQ2 smoke slope that counts as "active"
+    float ppm_std;             // MQ2 smoke standard deviation that counts as "active"
+    float temp_slope_per_min;  // DHT temperature slope (C/min) that counts as "active"
+    float temp_std;            // DHT temperature standard deviation (C)
+} sampling_config_frame_t;
+
+// Periodic memory budget from a slave. Stack figures are in bytes; a task that
+// has exited reports the high-water mark it had when it finished.
+#define MEM_REPORT_MAX_TASKS 6
+#define MEM_REPORT_NAME_LEN  10
+
+typedef struct __attribute__((packed)) {
+    char name[MEM_REPORT_NAME_LEN]; // NUL-padded task name
+    uint16_t stack_size;
+    uint16_t stack_hwm;             // least free stack ever seen
+    uint8_t running;                // 0 once the task has deleted itself
+} mem_task_stat_t;
+
+typedef struct __attribute__((packed)) {
+    ctrl_hdr_t hdr;
+    uint32_t uptime_s;
+    uint32_t free_heap;
+    uint32_t min_free_heap;         // low-water mark since boot
+    uint32_t largest_free_block;    // free_heap - largest_free_block ~ fragmentation
+    uint16_t steady_heap_allocs;    // allocations inside the zero-heap sampling path (should be 0)
+    uint8_t task_count;
+    mem_task_stat_t tasks[MEM_REPORT_MAX_TASKS];
+} mem_report_frame_t;
+
+// Relay routing (relay.h). A slave that reaches the master advertises its hop count
+// and the weakest RSSI along its path; out-of-range slaves pick the best neighbour.
+// Followed by a frame_auth.h trailer under the site's group key; receivers keep a
+// replay window per neighbour. Only a master may advertise hops == 0.
+typedef struct __attribute__((packed)) {
+    ctrl_hdr_t hdr;
+    uint8_t master_mac[6];
+    uint8_t channel;
+    uint8_t hops;           // hops from the advertiser to the master (1 = direct)
+    int8_t path_rssi;       // weakest link RSSI (dBm) on the advertiser's path
+} route_advert_t;
+
+// Header prepended to a frame that travels through relays. The inner frame is the
+// origin's signed frame, unchanged, so the master verifies it with the origin's key.
+// hops and delay_ms are updated at every relay: delay_ms / hops is the added latency
+// per hop, and gaps in msg_id per origin give the delivery rate.
+typedef struct __attribute__((packed)) {
+    ctrl_hdr_t hdr;
+    uint8_t origin_mac[6];
+    uint16_t msg_id;        // per-origin counter, used for duplicate suppression
+    uint8_t hops;           // relays traversed so far
+    uint8_t ttl;            // decremented per relay, dropped at 0
+    uint16_t delay_ms;      // accumulated queueing delay in relays
+} relay_hdr_t;
+
+// Exchanged between a primary and standby master (signed with frame_auth like slave
+// frames) so both accept each slave sequence number exactly once: after a failover the
+// standby neither re-delivers frames the primary already passed upstream nor treats
+// the continuing sequence as a gap.
+#define MASTER_SYNC_MAX_ENTRIES 12
+
+typedef struct __attribute__((packed)) {
+    uint8_t slave_mac[6];
+    uint32_t top;           // fa_replay_t.top
+    uint64_t seen;          // fa_replay_t.seen
+} master_sync_entry_t;
+
+typedef struct __attribute__((packed)) {
+    ctrl_hdr_t hdr;
+    uint8_t count;
+    master_sync_entry_t entries[MASTER_SYNC_MAX_ENTRIES];
+} master_sync_frame_t;
+
+// Sent (signed) as soon as the slave's detector changes state, outside the TDMA
+// slot, so the master must not answer it with a slot assignment. Repeated in
+// later cycles until delivery is confirmed; seq tells repeats apart. A direct send
+// is confirmed by the master's MAC-layer ack, a relayed one only by the master's
+// alarm_ack_t: the master answers every CTRL_ALARM with one, to the address the
+// frame came from, and relays that forwarded an alarm for the slave pass it back.
+typedef enum {
+    ALARM_NONE = 0,         // The previous alarm cleared
+    ALARM_GAS = 1,          // Smoke or gas leak (MQ2) without heat
+    ALARM_FIRE = 2,         // Rate-of-rise or fixed-temperature heat, or heat plus smoke
+} alarm_kind_t;
+
+typedef struct __attribute__((packed)) {
+    ctrl_hdr_t hdr;
+    uint8_t kind;               // alarm_kind_t
+    uint8_t seq;                // Incremented per state change
+    uint32_t timestamp_ms;      // Master time of the deciding sample (as sensor_data_t), 0 = not synced
+    float temperature;          // Median-filtered C (NAN if no DHT)
+    float temp_slope_per_min;
+    float smoke_ppm;            // Median-filtered (NAN if no MQ2)
+    float smoke_baseline_ppm;
+    float smoke_slope_per_min;
+} alarm_frame_t;
+
+// Followed by a frame_auth.h trailer under the alarming slave's key. The ack names
+// the alarm frame by its frame_auth.h sequence number, which the slave never reuses
+// (not even across reboots), so a recorded ack cannot confirm a later alarm.
+typedef struct __attribute__((packed)) {
+    ctrl_hdr_t hdr;
+    uint8_t slave_mac[6];       // The slave that sent the alarm
+    uint32_t frame_seq;         // Trailer sequence number of the alarm frame being acknowledged
+} alarm_ack_t;
+
+// Returns true if buf holds a control frame of the given type and exact size
+static inline bool ctrl_frame_is(const uint8_t *buf, size_t len, uint8_t type, size_t frame_len) {
+    return buf != NULL && len == frame_len && len >= sizeof(ctrl_hdr_t) &&
+           buf[0] == ESPNOW_CTRL_MAGIC && buf[1] == type;
+}
+
 #endif // SHARED_DATA_H
\ No newline at end of file
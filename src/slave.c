@@ -1,9 +1,12 @@
 // src/slave.c
+#include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/event_groups.h"
 #include "esp_system.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
@@ -11,65 +14,245 @@
 #include "nvs_flash.h"
 #include "esp_now.h"
 #include "esp_mac.h"
+#include "esp_timer.h"
+#include "esp_bit_defs.h"
+#include "esp_rom_sys.h"
 // #include "driver/adc.h" // No longer needed here if MQ2.h includes new ones
 
-// Component Headers
-#include "DHT.h"
-#include "MQ2.h"         // Using updated MQ2 library
-#include "mjd_hcsr501.h"
-
 // Shared Data Structure
 #include "shared_header.h"
+#include "sensors.h"
+#include "bench.h"
+#include "pairing.h"
+#include "tdma.h"
+#include "sample_batch.h"
+#include "adaptive.h"
+#include "memstats.h"
+#include "auth.h"
+#include "relay.h"
+#include "soak.h"
+#include "timesync.h"
+#include "detect.h"
+#include "trace.h"
+#include "profile.h"
 
 static const char *TAG = "SLAVE";
 
 // --- Configuration ---
 #define ESPNOW_WIFI_MODE WIFI_MODE_STA
 #define ESPNOW_WIFI_IF   ESP_IF_WIFI_STA
-#define SEND_INTERVAL_MS 5000 // Send data every 5 seconds
-
-// --- GPIO Pins & ADC Configuration (!!! REVIEW/CHANGE THESE !!!) ---
-#define DHT11_GPIO_PIN  GPIO_NUM_4
-#define PIR_GPIO_PIN    GPIO_NUM_5
-
-// MQ2 Sensor ADC Configuration:
-#define MQ2_ADC_UNIT    ADC_UNIT_1 // Must use ADC1 with WiFi
-#define MQ2_ADC_CHANNEL ADC_CHANNEL_6 // e.g., GPIO36 is ADC1_CHANNEL_0
-// *** Use the NEW Attenuation Definition ***
-#define MQ2_ADC_ATTEN   ADC_ATTEN_DB_12 // Equivalent to old DB_11, use this now
-
-// --- Master MAC Address (!!! REPLACE THIS !!!) ---
-static uint8_t master_mac_addr[] = {0xD8, 0xBC, 0x38, 0xE4, 0x1E, 0x20}; // MUST REPLACE
-
-// --- Sensor Component Instances ---
-MQ2 mq2_sensor;
-mjd_hcsr501_config_t pir_config = { .data_gpio_num = PIR_GPIO_PIN };
+#define SEND_INTERVAL_MS 5000 // Send data every 5 seconds (fallback period until the master assigns a TDMA slot)
+#define SAMPLES_PER_FRAME 1  // Minimum queued samples before a slot is used (max SAMPLE_BATCH_MAX)
+
+// Adaptive sampling defaults; the master can override them with CTRL_SAMPLING_CONFIG (kept in NVS)
+#define SAMPLE_PERIOD_MIN_MS  1000  // While a leak/fire/door signature is developing
+#define SAMPLE_PERIOD_MAX_MS  30000 // While all signals are stable
+#define TRIGGER_PPM_SLOPE     20.0f // MQ2 smoke ppm per minute
+#define TRIGGER_PPM_STD       10.0f // MQ2 smoke ppm
+#define TRIGGER_TEMP_SLOPE    1.0f  // C per minute
+#define TRIGGER_TEMP_STD      1.0f  // C
+#define SEND_CONFIRM_TIMEOUT_MS 50 // Wait this long for the MAC-layer result of a frame sent to the master
+#define RELAY_MODE 0 // Set to 1 on nodes that should forward frames for out-of-range neighbours (relay.h)
+#define RUN_BENCHMARKS_AT_BOOT 0 // Set to 1 to run the kernel microbenchmarks (bench.c) before sampling starts
+#ifndef SOAK_MODE
+#define SOAK_MODE 0 // Set to 1 to run sensor_task for a simulated day against modelled sensors and radio (soak.h)
+#endif
+
+// Memory budget: all tasks and sync objects are statically allocated; the sampling
+// path is checked for heap use when CONFIG_HEAP_USE_HOOKS is enabled.
+#define SENSOR_TASK_STACK_SIZE 3584
+#define MEM_REPORT_INTERVAL_MS 600000 // Stack/heap report to the master every 10 minutes
+#define ZERO_HEAP_ENFORCE      0      // Set to 1 to abort on any heap allocation in the sampling path
+
+// --- Frame Authentication ---
+// The frame key is provisioned in NVS or derived from CONFIG_SLAVE_AUTH_SITE_KEY (auth.h);
+// a node with neither samples but sends nothing.
+
+// --- Master Address ---
+// Discovered at runtime by pairing.c (channel scan, cached in NVS); see pairing_master_mac().
+
+// --- Sensors ---
+// Selected in menuconfig ("Slave sensors"); each driver lives in src/sensor_<name>.c (sensors.h).
+// Replaced by the soak's models in SOAK_MODE.
+static const sensor_driver_t *const *sensors = sensor_registry;
 
 // --- Global Variables ---
-volatile bool motion_flag = false;
-bool is_mq2_calibrated = false; // Flag to track if MQ2 calibration was successful
-bool is_pir_initialized = false;
+static tdma_slave_t tdma_schedule; // Transmit slot handed out by the master
+static adaptive_t sampling;         // Sample period controller
+static detect_t detector;           // Fire/gas signatures over the sample stream; sensor task only
+static TaskHandle_t sensor_task_handle; // Receives send results for frames to the master
+static timesync_t master_clock;     // Master time estimate for sample timestamps
+static trace_t latency_trace;       // Slave-side hops (acquisition -> enqueue -> send callback); sensor task only
+static volatile int64_t send_cb_us; // esp_timer time of the last send result for the master
+static volatile uint32_t alarm_acked_end; // One past the highest alarm frame seq the master acknowledged, 0 = none
+
+// Send results delivered to sensor_task by task notification
+#define SEND_RESULT_OK   1
+#define SEND_RESULT_FAIL 2
+
+// --- Boot Readiness ---
+// Each subsystem comes up in its own task and sets its bit when usable, so the
+// slow sensor warm-ups (DHT 1 s, PIR 5 s, MQ2 calibration ~25 s) overlap with
+// radio init and sensor_task can send partial frames from the first second.
+#define READY_RADIO BIT0
+#define READY_SENSOR(i) (BIT1 << (i)) // sensors[i] initialised (calibrated, stabilised)
+#define INIT_TASK_STACK_SIZE 3072
+
+_Static_assert(SENSOR_COUNT <= 16, "sensor ready bits must fit the event group");
+
+static EventGroupHandle_t ready_group;
+static StaticEventGroup_t ready_group_buf;
+static int64_t boot_start_us;
+static volatile bool first_frame_logged = false;
+
+static inline bool sensor_ready(EventBits_t bit) {
+    return (xEventGroupGetBits(ready_group) & bit) != 0;
+}
+
+// Records a boot timeline entry relative to app_main start
+static void boot_mark(const char *subsystem, bool ok) {
+    int64_t ms = (esp_timer_get_time() - boot_start_us) / 1000;
+    if (ok) {
+        ESP_LOGI(TAG, "Boot timeline: %-12s ready  at +%" PRId64 " ms", subsystem, ms);
+    } else {
+        ESP_LOGE(TAG, "Boot timeline: %-12s FAILED at +%" PRId64 " ms", subsystem, ms);
+    }
+}
 
 // --- ESP-NOW Send Callback ---
 static void espnow_send_cb(const uint8_t *mac_addr, esp_now_send_status_t status) {
+    int64_t cb_us = esp_timer_get_time();
+    if (relay_report_send_result(mac_addr, status == ESP_NOW_SEND_SUCCESS)) {
+        return; // Sent to our relay neighbour; it tracks its own link failures
+    }
+    if (memcmp(mac_addr, pairing_master_mac(), ESP_NOW_ETH_ALEN) != 0) {
+        return; // Pairing probes (broadcast) and late results from a master we failed over from
+    }
+    pairing_report_send_result(status == ESP_NOW_SEND_SUCCESS); // May switch to the standby master
+    if (sensor_task_handle != NULL) {
+        send_cb_us = cb_us; // Read by send_upstream once the notification arrives
+        xTaskNotify(sensor_task_handle, status == ESP_NOW_SEND_SUCCESS ? SEND_RESULT_OK : SEND_RESULT_FAIL,
+                    eSetValueWithOverwrite);
+    }
     if (status == ESP_NOW_SEND_SUCCESS) {
         ESP_LOGD(TAG, "Data sent successfully to " MACSTR, MAC2STR(mac_addr));
+        if (!first_frame_logged) {
+            first_frame_logged = true;
+            boot_mark("first frame", true);
+        }
     } else {
         ESP_LOGW(TAG, "Data send failed to " MACSTR, MAC2STR(mac_addr));
     }
 }
 
-// --- WiFi & ESP-NOW Initialization ---
-static void wifi_espnow_init(void) {
-    // (Initialization code remains the same)
-    // Initialize NVS
+#if !SOAK_MODE // The soak models the radio below relay_send and delivers nothing back
+// CTRL_ALARM_ACK from the master, directly or passed back by a relay (Wi-Fi task)
+static bool alarm_handle_ack(const uint8_t *data, int len) {
+    if (!ctrl_frame_is(data, len, CTRL_ALARM_ACK, sizeof(alarm_ack_t) + FA_TRAILER_LEN)) return false;
+    alarm_ack_t ack;
+    memcpy(&ack, data, sizeof(ack));
+    uint8_t self_mac[6];
+    esp_read_mac(self_mac, ESP_MAC_WIFI_STA);
+    if (memcmp(ack.slave_mac, self_mac, 6) != 0) return false; // A neighbour's; relay_handle_frame may pass it on
+    if (auth_verify(data, len, NULL) == ESP_OK) { // Replaying an old ack only names an old frame
+        if (ack.frame_seq + 1 > alarm_acked_end) alarm_acked_end = ack.frame_seq + 1; // Acks may overtake
+    } else {
+        ESP_LOGW(TAG, "Alarm ack failed authentication, ignored.");
+    }
+    return true;
+}
+
+// --- Master Frame Authentication ---
+// Slot beacons and time sync are broadcast under the site's group key, slot assignments
+// are unicast under ours. Each master of a redundant pair counts its own sequence, so
+// each gets a replay window per key. The windows are RAM only: after a reboot the first
+// frame of each kind sets the starting point.
+typedef struct {
+    uint8_t mac[ESP_NOW_ETH_ALEN];
+    fa_replay_t group;
+    fa_replay_t unicast;
+} master_windows_t;
+
+static master_windows_t master_windows[2]; // Primary, standby (Wi-Fi task only)
+
+static fa_replay_t *master_window(const uint8_t *mac, bool group) {
+    master_windows_t *w = &master_windows[memcmp(mac, pairing_primary_mac(), ESP_NOW_ETH_ALEN) == 0 ? 0 : 1];
+    if (memcmp(w->mac, mac, ESP_NOW_ETH_ALEN) != 0) { // Re-paired: the new master's counters are unrelated
+        memset(w, 0, sizeof(*w));
+        memcpy(w->mac, mac, ESP_NOW_ETH_ALEN);
+    }
+    return group ? &w->group : &w->unicast;
+}
+
+// --- ESP-NOW Receive Callback ---
+// Runs in the Wi-Fi task: hand control frames to their module and return quickly.
+static void espnow_recv_cb(const esp_now_recv_info_t *info, const uint8_t *data, int len) {
+    int64_t rx_us = esp_timer_get_time(); // Take the timestamp first, beacons align the TDMA schedule
+    if (pairing_handle_frame(info, data, len)) return;
+    if (alarm_handle_ack(data, len)) return;
+    if (relay_handle_frame(info, data, len, rx_us)) return;
+
+    // Slot frames are only accepted from the paired masters (either one of a redundant pair),
+    // and only once they authenticate: the source MAC alone is trivially spoofed
+    if (pairing_is_master(info->src_addr)) {
+        bool group = ctrl_frame_is(data, len, CTRL_TIME_SYNC, sizeof(time_sync_t) + FA_TRAILER_LEN) ||
+                     ctrl_frame_is(data, len, CTRL_SLOT_BEACON, sizeof(slot_beacon_t) + FA_TRAILER_LEN);
+        bool unicast = ctrl_frame_is(data, len, CTRL_SLOT_ASSIGN, sizeof(slot_assign_t) + FA_TRAILER_LEN);
+        if (group || unicast) {
+            fa_replay_t *window = master_window(info->src_addr, group);
+            esp_err_t ret = group ? auth_verify_group(data, len, window) : auth_verify(data, len, window);
+            if (ret != ESP_OK) {
+                ESP_LOGW(TAG, "Type %u frame from " MACSTR " failed authentication (%s), ignored.",
+                         data[1], MAC2STR(info->src_addr), esp_err_to_name(ret));
+                return;
+            }
+            len -= FA_TRAILER_LEN;
+            if (info->rx_ctrl) relay_on_master_frame(info->rx_ctrl->rssi, rx_us); // Direct link quality
+            if (timesync_handle_frame(&master_clock, data, len, rx_us)) return;
+            if (ctrl_frame_is(data, len, CTRL_SLOT_BEACON, sizeof(slot_beacon_t))) {
+                slot_beacon_t beacon;
+                memcpy(&beacon, data, sizeof(beacon));
+                if (!tdma_slave_on_beacon(&tdma_schedule, beacon.superframe_ms, beacon.slot_ms, beacon.slot_count,
+                                          rx_us)) {
+                    ESP_LOGD(TAG, "Ignoring beacon for %u slots (malformed, or our slot was reclaimed).",
+                             beacon.slot_count);
+                }
+                return;
+            }
+            slot_assign_t assign;
+            memcpy(&assign, data, sizeof(assign));
+            if (tdma_slave_on_assign(&tdma_schedule, assign.slot_index, assign.slot_count, assign.slot_ms,
+                                     assign.superframe_ms)) {
+                ESP_LOGI(TAG, "Assigned TDMA slot %u/%u (%u ms slots, %u ms superframe).",
+                         assign.slot_index, assign.slot_count, assign.slot_ms, assign.superframe_ms);
+            } else {
+                ESP_LOGW(TAG, "Ignoring slot assignment %u/%u (%u ms slots, %u ms superframe).",
+                         assign.slot_index, assign.slot_count, assign.slot_ms, assign.superframe_ms);
+            }
+            return;
+        }
+        if (adaptive_handle_frame(&sampling, data, len)) return;
+    }
+    ESP_LOGD(TAG, "Ignoring unexpected %d-byte frame from " MACSTR, len, MAC2STR(info->src_addr));
+}
+#endif
+
+// --- NVS Initialization ---
+// Pairing cache, frame key and sequence counter, sampling limits
+static void storage_init(void) {
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
         ESP_ERROR_CHECK(nvs_flash_erase());
         ret = nvs_flash_init();
     }
     ESP_ERROR_CHECK(ret);
+}
 
+#if !SOAK_MODE
+// --- WiFi & ESP-NOW Initialization ---
+// Returns false if pairing could not be set up (ESP-NOW is deinitialised). A master
+// that is down is not a failure: the pairing task keeps looking for it.
+static bool wifi_espnow_init(void) {
     // Initialize Network Stack and Event Loop
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
@@ -82,22 +265,17 @@ static void wifi_espnow_init(void) {
     // Initialize ESP-NOW
     ESP_ERROR_CHECK(esp_now_init());
     ESP_ERROR_CHECK(esp_now_register_send_cb(espnow_send_cb));
+    ESP_ERROR_CHECK(esp_now_register_recv_cb(espnow_recv_cb));
 
-    // Add Master Peer
-    esp_now_peer_info_t peer_info = {};
-    memcpy(peer_info.peer_addr, master_mac_addr, ESP_NOW_ETH_ALEN);
-    peer_info.ifidx = ESPNOW_WIFI_IF;
-    peer_info.encrypt = false; // Set to true if using encryption
-    esp_err_t add_peer_result = esp_now_add_peer(&peer_info);
-    if (add_peer_result != ESP_OK && add_peer_result != ESP_ERR_ESPNOW_EXIST) {
-        ESP_LOGE(TAG, "Failed to add master peer: %s", esp_err_to_name(add_peer_result));
-        esp_now_deinit(); // Cleanup ESP-NOW if peer add fails
-        // Handle failure appropriately - maybe halt or retry
-        return;
-    } else if (add_peer_result == ESP_ERR_ESPNOW_EXIST) {
-         ESP_LOGW(TAG, "Master peer " MACSTR " already exists.", MAC2STR(master_mac_addr));
-    } else {
-         ESP_LOGI(TAG, "Master peer " MACSTR " added.", MAC2STR(master_mac_addr));
+    // Find the master (cached in NVS, or by a background channel scan) and add it as a peer
+    esp_err_t pair_ret = pairing_init();
+    if (pair_ret == ESP_OK) {
+        pair_ret = pairing_connect();
+    }
+    if (pair_ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to pair with master: %s", esp_err_to_name(pair_ret));
+        esp_now_deinit(); // Cleanup ESP-NOW if pairing fails
+        return false;
     }
 
      // Print own MAC for debugging
@@ -106,157 +284,377 @@ static void wifi_espnow_init(void) {
      ESP_LOGI(TAG, "Slave MAC Address: " MACSTR, MAC2STR(self_mac));
 
     ESP_LOGI(TAG, "WiFi and ESP-NOW Initialized.");
+    return true;
 }
+#endif
 
 // --- Sensor Initialization ---
+// One short-lived task per driver; each deletes itself once its warm-up is done.
+
+static void sensor_init_task(void *pvParameter) {
+    size_t i = (size_t)pvParameter;
+    const sensor_driver_t *drv = sensors[i];
+    esp_err_t ret = drv->init != NULL ? drv->init() : ESP_OK;
+    if (ret == ESP_OK) xEventGroupSetBits(ready_group, READY_SENSOR(i));
+    boot_mark(drv->name, ret == ESP_OK);
+    memstats_task_exiting();
+    vTaskDelete(NULL);
+}
+
+// Starts a bring-up task for every compiled-in sensor and returns immediately
 void sensors_init() {
-    ESP_LOGI(TAG, "Initializing Sensors...");
-
-    // DHT11 Initialization
-    DHT11_init(DHT11_GPIO_PIN);
-    ESP_LOGI(TAG, "DHT11 Initialized on GPIO %d.", DHT11_GPIO_PIN);
-
-    // MQ2 Initialization (Using new ADC Driver)
-    ESP_LOGI(TAG, "Initializing MQ2 Sensor on ADC Unit %d, Channel %d, Attenuation %d...",
-             MQ2_ADC_UNIT, MQ2_ADC_CHANNEL, MQ2_ADC_ATTEN);
-
-    // *** Call updated mq2_init ***
-    esp_err_t mq2_init_ret = mq2_init(&mq2_sensor, MQ2_ADC_UNIT, MQ2_ADC_CHANNEL, MQ2_ADC_ATTEN);
-
-    if (mq2_init_ret == ESP_OK) {
-         ESP_LOGI(TAG, "MQ2 ADC Initialized successfully.");
-         // MQ2 Calibration (Requires sensor pre-heating!)
-         ESP_LOGW(TAG, "MQ2 requires pre-heating before calibration for accuracy!");
-         ESP_LOGI(TAG, "Starting MQ2 Calibration (blocking)... Ensure clean air environment.");
-         // mq2_begin now returns bool
-         is_mq2_calibrated = mq2_begin(&mq2_sensor);
-         if (is_mq2_calibrated) {
-             ESP_LOGI(TAG, "MQ2 Calibrated successfully. Ro = %.3f kOhm", mq2_sensor.Ro);
-         } else {
-             ESP_LOGE(TAG, "MQ2 Calibration FAILED! Readings will not be available.");
-             // Optionally deinit ADC if calibration fails and sensor is unusable
-             // mq2_deinit(&mq2_sensor);
-         }
-    } else {
-         ESP_LOGE(TAG, "MQ2 ADC Initialization FAILED! Error: %s", esp_err_to_name(mq2_init_ret));
-         is_mq2_calibrated = false; // Ensure flag is false if init fails
+    ESP_LOGI(TAG, "Initializing %d sensor(s) (concurrently)...", SENSOR_COUNT);
+    static StaticTask_t init_tcb[SENSOR_COUNT > 0 ? SENSOR_COUNT : 1];
+    static StackType_t init_stack[SENSOR_COUNT > 0 ? SENSOR_COUNT : 1][INIT_TASK_STACK_SIZE];
+    for (size_t i = 0; sensors[i] != NULL; i++) {
+        memstats_register_task(xTaskCreateStatic(sensor_init_task, "sensor_init", INIT_TASK_STACK_SIZE, (void *)i, 4,
+                                                 init_stack[i], &init_tcb[i]),
+                               INIT_TASK_STACK_SIZE);
+    }
+}
+
+
+_Static_assert(SAMPLES_PER_FRAME >= 1 && SAMPLES_PER_FRAME <= SAMPLE_BATCH_MAX, "SAMPLES_PER_FRAME out of range");
+
+// Time base of the sampling/transmit loop: esp_timer, or the soak's virtual clock
+static inline int64_t now_us(void) {
+#if SOAK_MODE
+    return soak_now_us();
+#else
+    return esp_timer_get_time();
+#endif
+}
+
+// Sleeps until the given esp_timer time: whole ticks via the scheduler, the sub-tick remainder busy-waited
+static void delay_until_us(int64_t target_us) {
+#if SOAK_MODE
+    soak_sleep_until_us(target_us); // Skips ahead instead of sleeping
+#else
+    int64_t remaining_us = target_us - esp_timer_get_time();
+    if (remaining_us <= 0) return;
+    TickType_t ticks = (TickType_t)(remaining_us / 1000 / portTICK_PERIOD_MS);
+    if (ticks > 0) vTaskDelay(ticks);
+    remaining_us = target_us - esp_timer_get_time();
+    if (remaining_us > 0) esp_rom_delay_us((uint32_t)remaining_us);
+#endif
+}
+
+// --- Sample Acquisition ---
+// Reads every ready sensor into one sample; fields of absent or warming-up sensors keep their invalid markers
+static void acquire_sample(sensor_data_t *data) {
+    sensor_data_clear(data);
+    for (size_t i = 0; sensors[i] != NULL; i++) {
+        if (!sensor_ready(READY_SENSOR(i))) continue;
+        profile_mark_t mark = profile_enter();
+        sensors[i]->sample(data);
+        profile_exit((profile_zone_t)(PROFILE_ZONE_SENSOR + i), mark);
+        sensors[i]->encode(data);
     }
+}
 
+// --- Zero-Heap Guard ---
+// Brackets the steady-state sampling/encoding path. Radio sends, NVS writes and
+// pairing rescans are outside it: they belong to IDF drivers that allocate internally.
+static inline void zero_heap_begin(void) {
+    memstats_guard_begin();
+}
 
-    // PIR Initialization
-    esp_err_t pir_init_result = mjd_hcsr501_init(&pir_config);
-    is_pir_initialized = (pir_init_result == ESP_OK && pir_config.isr_semaphore != NULL);
-    if (is_pir_initialized) {
-        if(xSemaphoreTake(pir_config.isr_semaphore, pdMS_TO_TICKS(10)) == pdTRUE) {
-             ESP_LOGI(TAG, "PIR cleared initial trigger.");
+static inline void zero_heap_end(void) {
+    uint32_t allocs = memstats_guard_end();
+#if ZERO_HEAP_ENFORCE
+    if (allocs > 0) abort();
+#else
+    (void)allocs;
+#endif
+}
+
+// Sends a frame towards the master. Direct sends wait for the MAC-layer result: if the
+// failure made pairing fail over to the standby master, the frame is sent again there
+// instead of being lost, so failover completes within PAIRING_FAILOVER_FAILURES slots.
+// Returns ESP_OK once the frame is on its way; delivered (may be NULL) is set only when
+// the master's MAC layer acknowledged it within SEND_CONFIRM_TIMEOUT_MS, never for a
+// frame handed to a relay neighbour. ESP_ERR_INVALID_STATE while no master is known
+// or a scan holds the radio.
+static esp_err_t send_upstream(const uint8_t *frame, size_t len, bool *delivered) {
+    if (delivered != NULL) *delivered = false;
+    if (len == 0) return ESP_ERR_INVALID_SIZE; // auth_sign refused: no key, or the frame did not fit
+    if (!pairing_ready()) return ESP_ERR_INVALID_STATE;
+    if (!relay_uplink_is_master()) {
+        return relay_send(frame, len); // The relay neighbour handles delivery from here
+    }
+    for (int attempt = 0; attempt < 2; attempt++) {
+        uint8_t target[ESP_NOW_ETH_ALEN];
+        memcpy(target, pairing_master_mac(), ESP_NOW_ETH_ALEN);
+        xTaskNotifyWait(0, UINT32_MAX, NULL, 0); // Drop any stale result
+        int64_t enqueue_us = esp_timer_get_time();
+        esp_err_t ret = relay_send(frame, len);
+        if (ret != ESP_OK) return ret;
+
+        uint32_t result = 0;
+        if (xTaskNotifyWait(0, UINT32_MAX, &result, pdMS_TO_TICKS(SEND_CONFIRM_TIMEOUT_MS)) != pdTRUE) {
+            return ESP_OK; // Queued; the result arrives late and still feeds the failure counter
         }
-        motion_flag = false; // Start with no motion detected
-        ESP_LOGI(TAG, "PIR Initialized on GPIO %d.", PIR_GPIO_PIN);
-    } else {
-        ESP_LOGE(TAG, "PIR Initialization Failed on GPIO %d: %s", PIR_GPIO_PIN, esp_err_to_name(pir_init_result));
+        trace_record(&latency_trace, TRACE_HOP_MAC, send_cb_us - enqueue_us);
+        if (result == SEND_RESULT_OK) {
+            if (delivered != NULL) *delivered = true;
+            return ESP_OK;
+        }
+        if (memcmp(target, pairing_master_mac(), ESP_NOW_ETH_ALEN) == 0) return ESP_FAIL; // No failover (yet)
     }
+    return ESP_FAIL;
+}
 
-    ESP_LOGI(TAG, "Sensor Initialization Complete.");
+// Sends a CTRL_MEM_REPORT frame (and logs it locally)
+static void send_mem_report(void) {
+    mem_report_frame_t report;
+    memstats_build_report(&report);
+    memstats_log_report(&report);
+    uint8_t frame[sizeof(report) + FA_TRAILER_LEN];
+    memcpy(frame, &report, sizeof(report));
+    size_t frame_len = auth_sign(frame, sizeof(report), sizeof(frame));
+    esp_err_t result = send_upstream(frame, frame_len, NULL);
+    relay_log_stats();
+    timesync_log(&master_clock, esp_timer_get_time());
+    trace_log(&latency_trace);
+    if (result != ESP_OK) {
+        ESP_LOGW(TAG, "Memory report not sent: %s", esp_err_to_name(result));
+    }
 }
 
+// --- Alarm Frames ---
+// A detector state change goes out at once, outside our TDMA slot, and is repeated
+// every cycle until it is confirmed: by the master's MAC-layer ack when sent directly,
+// by the master's CTRL_ALARM_ACK (which also covers relayed sends) otherwise. A result
+// that only arrives after SEND_CONFIRM_TIMEOUT_MS costs one repeat; seq lets the
+// master drop it. Only frames of the current alarm are signed from its first frame on,
+// so an ack naming that frame or a later one confirms it.
+static uint8_t alarm_seq;
+static uint32_t alarm_timestamp_ms; // Stamp of the sample that changed the state
+static bool alarm_pending;
+static bool alarm_signed;           // The current alarm went out at least once
+static uint32_t alarm_first_frame_seq; // Trailer seq of its first frame
+
+static bool alarm_acknowledged(void) {
+    return alarm_signed && alarm_acked_end > alarm_first_frame_seq;
+}
 
-// --- Sensor Reading Task ---
-void sensor_task(void *pvParameter) {
-    sensor_data_t data_to_send;
+static void send_alarm(void) {
+    if (alarm_acknowledged()) {
+        alarm_pending = false; // Acknowledged end to end since the last attempt
+        return;
+    }
+    alarm_frame_t alarm;
+    detect_fill_frame(&detector, alarm_seq, alarm_timestamp_ms, &alarm);
+    uint8_t frame[sizeof(alarm) + FA_TRAILER_LEN];
+    memcpy(frame, &alarm, sizeof(alarm));
+    size_t frame_len = auth_sign(frame, sizeof(alarm), sizeof(frame));
+    if (frame_len > 0 && !alarm_signed) {
+        alarm_first_frame_seq = fa_frame_seq(frame, frame_len);
+        alarm_signed = true;
+    }
+    bool delivered;
+    esp_err_t result = send_upstream(frame, frame_len, &delivered);
+    if (delivered || alarm_acknowledged()) {
+        alarm_pending = false;
+    } else if (result != ESP_OK) {
+        ESP_LOGW(TAG, "Alarm frame not sent (%s), retrying next cycle.", esp_err_to_name(result));
+    } else {
+        ESP_LOGD(TAG, "Alarm frame %u not confirmed yet, repeating next cycle.", alarm_seq);
+    }
+}
 
-    while(1) {
-        // --- Prepare data structure with default error/invalid values ---
-        memset(&data_to_send, 0, sizeof(sensor_data_t));
-        data_to_send.temperature = -99;
-        data_to_send.humidity = -99;
-        data_to_send.mq2_lpg_ppm = NAN; // Use NAN as default invalid value
-        data_to_send.mq2_co_ppm = NAN;
-        data_to_send.mq2_smoke_ppm = NAN;
-        //data_to_send.dht_status = STATUS_ERR_OTHER; // Assuming this exists
-        data_to_send.motion_detected = motion_flag;
-
-        // --- Read DHT11 ---
-        struct dht11_reading dht_data = DHT11_read();
-        data_to_send.dht_status = dht_data.status;
-        if (dht_data.status == DHT11_OK) {
-            data_to_send.temperature = dht_data.temperature;
-            data_to_send.humidity = dht_data.humidity;
-            ESP_LOGD(TAG, "DHT Read OK: T=%d C, H=%d %%", data_to_send.temperature, data_to_send.humidity);
-        } else {
-            ESP_LOGW(TAG, "DHT Read Failed. Status: %d", dht_data.status);
+// --- Frame Transmission ---
+// Sends the queued samples as one frame (plain for a single sample, compressed batch otherwise).
+// acquired_us holds each sample's acquisition time for the queueing hop of the latency trace.
+static void send_batch(const sensor_data_t *batch, const int64_t *acquired_us, size_t batch_count) {
+    uint8_t frame[SAMPLE_BATCH_MAX_FRAME_BYTES + FA_TRAILER_LEN];
+    zero_heap_begin();
+    profile_mark_t mark = profile_enter();
+    size_t frame_len = batch_count == 1
+                     ? sensor_data_encode(&batch[0], frame, sizeof(frame)) // Plain frame, as before batching
+                     : sample_batch_encode(batch, batch_count, frame, sizeof(frame));
+    profile_exit(PROFILE_ZONE_ENCODE, mark);
+    zero_heap_end();
+    mark = profile_enter();
+    frame_len = auth_sign(frame, frame_len, sizeof(frame)); // Sequence number + truncated SipHash tag
+    profile_exit(PROFILE_ZONE_SIGN, mark);
+    ESP_LOGD(TAG, "Frame: %u sample(s), %u bytes (%u uncompressed)", (unsigned)batch_count,
+             (unsigned)frame_len, (unsigned)(batch_count * sizeof(sensor_data_t)));
+    if (relay_uplink_is_master() && pairing_needs_rescan()) {
+        pairing_rescan(); // Master moved channel or was replaced; scans in the background
+    }
+    int64_t enqueue_us = now_us();
+    for (size_t i = 0; i < batch_count; i++) {
+        trace_record(&latency_trace, TRACE_HOP_QUEUE, enqueue_us - acquired_us[i]);
+    }
+    mark = profile_enter();
+    esp_err_t result = send_upstream(frame, frame_len, NULL); // Direct, or wrapped for our relay neighbour
+    profile_exit(PROFILE_ZONE_SEND, mark);
+    if (result == ESP_OK) {
+        ESP_LOGI(TAG, "Data packet sent via ESP-NOW.");
+        for (size_t i = 0; sensors[i] != NULL; i++) {
+            if (sensors[i]->frame_sent != NULL) sensors[i]->frame_sent(); // e.g. the PIR's motion latch
         }
+    } else {
+        ESP_LOGE(TAG, "ESP-NOW send error: %s. Data not sent.", esp_err_to_name(result));
+    }
+}
 
-        // --- Read MQ2 ---
-        if (is_mq2_calibrated) { // Only read if ADC init and calibration were successful
-            float* mq2_values = mq2_read(&mq2_sensor, false);
-            if (mq2_values != NULL) {
-                // Assign values; negative values indicate calculation errors
-                data_to_send.mq2_lpg_ppm = mq2_values[0];
-                data_to_send.mq2_co_ppm = mq2_values[1];
-                data_to_send.mq2_smoke_ppm = mq2_values[2];
-
-                ESP_LOGD(TAG, "MQ2 Read: LPG=%.2f ppm, CO=%.2f ppm, Smoke=%.2f ppm",
-                         data_to_send.mq2_lpg_ppm < 0 ? NAN : data_to_send.mq2_lpg_ppm, // Print NAN if error
-                         data_to_send.mq2_co_ppm < 0 ? NAN : data_to_send.mq2_co_ppm,
-                         data_to_send.mq2_smoke_ppm < 0 ? NAN : data_to_send.mq2_smoke_ppm);
-
-                // Log specific warnings for calculation errors if needed
-                if(mq2_values[0] < 0) ESP_LOGW(TAG, "MQ2 LPG calculation error (Code %.1f)", mq2_values[0]);
-                if(mq2_values[1] < 0) ESP_LOGW(TAG, "MQ2 CO calculation error (Code %.1f)", mq2_values[1]);
-                if(mq2_values[2] < 0) ESP_LOGW(TAG, "MQ2 Smoke calculation error (Code %.1f)", mq2_values[2]);
+// --- Sensor Reading Task ---
+// Sampling and transmission run on separate clocks: samples are taken at the adaptive
+// period and queued, and the queue is flushed in this node's TDMA slot.
+void sensor_task(void *pvParameter) {
+    sensor_data_t batch[SAMPLE_BATCH_MAX];
+    int64_t batch_acquired_us[SAMPLE_BATCH_MAX];
+    size_t batch_count = 0;
+    bool batch_has_motion = false;
+    bool batch_priority = false; // An alarm was raised: flush the queue with it, outside the slot
+    int64_t next_sample_us = now_us();
+    int64_t next_tx_us = next_sample_us; // First frame goes out immediately
+    int64_t next_report_us = next_sample_us + (int64_t)MEM_REPORT_INTERVAL_MS * 1000;
+    // Before the first send: the task may run before xTaskCreateStatic has returned a handle
+    sensor_task_handle = xTaskGetCurrentTaskHandle();
 
-            } else {
-                 ESP_LOGW(TAG, "MQ2 Read Failed (mq2_read returned NULL).");
-                 // Keep NAN values set earlier
+    while(1) {
+        // Wake for whichever comes first: the next sample or our transmit slot
+        int64_t wake_us = next_sample_us < next_tx_us ? next_sample_us : next_tx_us;
+        delay_until_us(wake_us);
+#if SOAK_MODE
+        soak_cycle_begin(wake_us);
+#endif
+
+        if (now_us() >= next_sample_us) {
+            int64_t acquired_us = now_us();
+            if (batch_count == SAMPLE_BATCH_MAX) {
+                // Sampling outran the slot schedule: flush now rather than drop data
+                if (sensor_ready(READY_RADIO)) send_batch(batch, batch_acquired_us, batch_count);
+                batch_count = 0;
+                batch_has_motion = false;
+                batch_priority = false;
             }
-        } else {
-            ESP_LOGD(TAG, "MQ2 Skipping read (sensor not calibrated or ADC init failed)");
-            // Keep NAN values set earlier
-        }
-
-        // --- Check PIR ---
-        if (is_pir_initialized) {
-            if (xSemaphoreTake(pir_config.isr_semaphore, 0) == pdTRUE) {
-                motion_flag = true;
-                data_to_send.motion_detected = true;
-                ESP_LOGI(TAG, "PIR Motion Detected!");
-            } else {
-                 data_to_send.motion_detected = motion_flag;
+            batch_acquired_us[batch_count] = acquired_us;
+            sensor_data_t *sample = &batch[batch_count++];
+            zero_heap_begin();
+            acquire_sample(sample);
+            sample->timestamp_ms = timesync_master_ms(&master_clock, acquired_us);
+            zero_heap_end();
+            batch_has_motion |= sample->motion_detected;
+            profile_mark_t mark = profile_enter();
+            bool alarm_changed = detect_update(&detector, sample, acquired_us);
+            profile_exit(PROFILE_ZONE_DETECT, mark);
+            if (alarm_changed) {
+                alarm_seq++; // A pending repeat of the previous state is superseded
+                alarm_signed = false;
+                alarm_timestamp_ms = sample->timestamp_ms;
+                alarm_pending = true;
+                if (detector.state != ALARM_NONE) {
+                    batch_priority = true; // The samples that led up to it follow the alarm frame
+                    next_tx_us = now_us();
+                }
             }
-        } else {
-             data_to_send.motion_detected = false;
+            uint32_t period_ms = adaptive_update(&sampling, sample->mq2_smoke_ppm,
+                                                 sample->dht_status == 0 ? (float)sample->temperature : NAN, // DHT11_OK
+                                                 acquired_us);
+            next_sample_us = acquired_us + (int64_t)period_ms * 1000;
+        }
+        if (alarm_pending && sensor_ready(READY_RADIO)) {
+            send_alarm(); // Does not wait for our slot
         }
 
-
-        // --- Send Data via ESP-NOW ---
-        esp_err_t result = esp_now_send(master_mac_addr, (uint8_t *)&data_to_send, sizeof(sensor_data_t));
-        if (result == ESP_OK) {
-            ESP_LOGI(TAG, "Data packet queued for sending via ESP-NOW.");
-             if (motion_flag) {
-                motion_flag = false; // Reset internal flag for next detection cycle
-                ESP_LOGD(TAG, "Motion flag reset after successful send.");
+        if (now_us() >= next_tx_us) {
+            // Send when enough samples are queued, or straight away if one carries motion or an alarm was raised
+            if (batch_count >= SAMPLES_PER_FRAME || (batch_count > 0 && (batch_has_motion || batch_priority))) {
+                if (sensor_ready(READY_RADIO)) {
+                    send_batch(batch, batch_acquired_us, batch_count);
+                } else {
+                    ESP_LOGE(TAG, "ESP-NOW not initialised. Data not sent.");
+                }
+                batch_count = 0;
+                batch_has_motion = false;
+                batch_priority = false;
+            }
+            if (sensor_ready(READY_RADIO) && pairing_ready()) {
+                relay_flush(); // Frames queued for neighbours share our slot
             }
-        } else {
-            ESP_LOGE(TAG, "ESP-NOW send error: %s. Data not sent.", esp_err_to_name(result));
+            if (now_us() >= next_report_us && sensor_ready(READY_RADIO)) {
+                send_mem_report(); // Shares our slot with the data frame
+                next_report_us += (int64_t)MEM_REPORT_INTERVAL_MS * 1000;
+            }
+            profile_poll(); // Profiling builds: dump over the console UART when due
+            next_tx_us = tdma_slave_next_tx_us(&tdma_schedule, now_us());
         }
-
-        // --- Task Delay ---
-        vTaskDelay(pdMS_TO_TICKS(SEND_INTERVAL_MS));
+#if SOAK_MODE
+        soak_cycle_end();
+        if (soak_finished()) {
+            soak_report();
+            trace_log(&latency_trace);
+            memstats_task_exiting();
+            vTaskDelete(NULL);
+        }
+#endif
     }
 }
 
 // --- Main Application Entry Point ---
 void app_main(void) {
+    boot_start_us = esp_timer_get_time();
     ESP_LOGI(TAG, "Starting Slave Application...");
 
-    wifi_espnow_init();  // Initialize WiFi stack and ESP-NOW communication
-    sensors_init();      // Initialize all connected sensors
+    ready_group = xEventGroupCreateStatic(&ready_group_buf);
+    tdma_slave_init(&tdma_schedule, SEND_INTERVAL_MS);
+    timesync_init(&master_clock);
+    detect_init(&detector);
+    trace_init(&latency_trace);
+    storage_init();
+    // Frame key and replay counter, before pairing: pairing replies are checked with the key
+    if (auth_init() == ESP_ERR_INVALID_STATE && SOAK_MODE) {
+        auth_use_ephemeral_key(); // The modelled master does not check tags
+    }
+#if SOAK_MODE
+    // Sensors and the ESP-NOW driver are modelled (soak.c): nothing to warm up. Frames take
+    // the normal path through relay_send, and the model reports each MAC-layer result to
+    // espnow_send_cb, so the result wait and the failure counting run as on the air.
+    sensors = soak_sensors;
+    soak_radio_register_send_cb(espnow_send_cb);
+    relay_use_radio(soak_radio_send);
+    relay_init(false);
+    pairing_use_master(soak_master_mac, soak_standby_mac, PAIRING_CHANNEL_MIN);
+    xEventGroupSetBits(ready_group, READY_RADIO);
+    for (size_t i = 0; sensors[i] != NULL; i++) xEventGroupSetBits(ready_group, READY_SENSOR(i));
+#else
+    sensors_init();      // Start sensor warm-ups in the background
+    bool radio_ok = wifi_espnow_init(); // Initialize WiFi stack and ESP-NOW communication (overlaps with sensor warm-up)
+    if (radio_ok) {
+        relay_init(RELAY_MODE);
+        xEventGroupSetBits(ready_group, READY_RADIO);
+    }
+    boot_mark("radio", radio_ok);
+#endif
+    profile_start(sensors); // Profiling builds only; samples this core (with the Wi-Fi task)
+
+    const adaptive_config_t sampling_defaults = {
+        .min_period_ms = SAMPLE_PERIOD_MIN_MS,
+        .max_period_ms = SAMPLE_PERIOD_MAX_MS,
+        .ppm_slope_per_min = TRIGGER_PPM_SLOPE,
+        .ppm_std = TRIGGER_PPM_STD,
+        .temp_slope_per_min = TRIGGER_TEMP_SLOPE,
+        .temp_std = TRIGGER_TEMP_STD,
+    };
+    adaptive_init(&sampling, &sampling_defaults); // After NVS init; loads stored limits
+
+#if RUN_BENCHMARKS_AT_BOOT
+    bench_run_all(false); // NVS is already initialised by wifi_espnow_init
+#endif
+#if SOAK_MODE
+    soak_init(SOAK_SEED); // Last, so the virtual clock starts with the sensor task
+#endif
 
     // Create the main sensor reading and data sending task
-    xTaskCreate(sensor_task, "sensor_task", 3584, NULL, 5, NULL);
+    static StaticTask_t sensor_tcb;
+    static StackType_t sensor_stack[SENSOR_TASK_STACK_SIZE];
+    TaskHandle_t task = xTaskCreateStatic(sensor_task, "sensor_task", SENSOR_TASK_STACK_SIZE, NULL, 5,
+                                          sensor_stack, &sensor_tcb);
+    memstats_register_task(task, SENSOR_TASK_STACK_SIZE);
 
-    ESP_LOGI(TAG, "Initialization complete. Sensor task started.");
-    // Example of how to deinit MQ2 if needed (e.g., on shutdown command)
-    // vTaskDelay(pdMS_TO_TICKS(60000)); // Run for a minute
-    // mq2_deinit(&mq2_sensor); // Clean up ADC resources
+    ESP_LOGI(TAG, "Radio up, sensor task started; sensors join as their warm-up completes.");
 }
\ No newline at end of file
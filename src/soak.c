@@ -0,0 +1,485 @@
+// src/soak.c
+#include <math.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "sensors.h"
+#if SENSOR_HAS_DHT11
+#include "DHT.h"
+#endif
+#if SENSOR_HAS_MQ2
+#include "MQ2.h"
+#endif
+#include "shared_header.h"
+#include "sample_batch.h"
+#include "frame_auth.h"
+#include "soak.h"
+
+static const char *TAG = "SOAK";
+
+#define SOAK_YIELD_EVERY      256   // Virtual sleeps between real one-tick yields
+#define SOAK_PROGRESS_EVERY_S 3600
+#define SOAK_DAY_S            (24 * 3600)
+#define SOAK_PLUME_EVERY_S    (8 * 3600) // One smoke plume (MQ2 ramps up and back over SOAK_PLUME_S) per period
+#define SOAK_PLUME_S          600
+#define SOAK_FIRE_ROR_C_MIN   10    // Odd plumes are fires: heat rises this fast for SOAK_FIRE_RISE_S,
+#define SOAK_FIRE_RISE_S      120   // then falls back over the rest of the plume. Even plumes are gas leaks.
+#define SOAK_RO               10.0f // MQ2 clean-air resistance at reference conditions (kOhm) at the start,
+#define SOAK_RO_DRIFT_PCT     20    // rising this much over the run (heater ageing, accelerated)
+
+static soak_stats_t stats;
+
+// --- Deterministic Randomness ---
+static uint32_t rng_state;
+
+// xorshift32: the same seed replays the same faults and triggers
+static uint32_t rng_next(void) {
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return rng_state = x;
+}
+
+static inline bool rng_pct(uint32_t pct) {
+    return rng_next() % 100 < pct;
+}
+
+static inline uint32_t rng_range(uint32_t lo, uint32_t hi) {
+    return lo + rng_next() % (hi - lo + 1);
+}
+
+// --- Virtual Clock ---
+// Only soak_sleep_until_us moves it, so real stalls (scheduling, a send result wait that
+// times out) never reach the simulated trajectory: one seed, one run.
+static int64_t virtual_us;
+static int64_t start_us;
+static int64_t start_real_us;
+static uint32_t sleeps;
+static int64_t cycle_start_real_us;
+static int64_t cycle_busy_until_us; // Virtual time the last cycle would have ended on its real CPU time
+static int64_t next_progress_us;
+
+int64_t soak_now_us(void) {
+    return virtual_us;
+}
+
+// Seconds of simulated operation so far
+static inline uint32_t sim_s(void) {
+    return (uint32_t)((soak_now_us() - start_us) / 1000000);
+}
+
+void soak_sleep_until_us(int64_t target_us) {
+    if (++sleeps % SOAK_YIELD_EVERY == 0) vTaskDelay(1); // Lets the idle task feed the watchdog
+    if (target_us > virtual_us) virtual_us = target_us;
+}
+
+bool soak_finished(void) {
+    return soak_now_us() - start_us >= (int64_t)SOAK_DURATION_S * 1000000;
+}
+
+// --- Fire/Gas Events ---
+// Plume k covers the last SOAK_PLUME_S of period k. Returns seconds into the current
+// plume (and its index), or -1 outside one.
+static int32_t plume_elapsed_s(uint32_t *index) {
+    uint32_t s = sim_s();
+    uint32_t t = s % SOAK_PLUME_EVERY_S;
+    if (index != NULL) *index = s / SOAK_PLUME_EVERY_S;
+    return t >= SOAK_PLUME_EVERY_S - SOAK_PLUME_S ? (int32_t)(t - (SOAK_PLUME_EVERY_S - SOAK_PLUME_S)) : -1;
+}
+
+static inline bool plume_is_fire(uint32_t index) { return index & 1; }
+
+// Detection is scored on CTRL_ALARM frames the master actually receives
+static int32_t event_index = -1;    // Plume being scored, -1 = none yet
+static bool event_detected;
+static int64_t event_start_us;
+
+static void event_close(void) {
+    if (event_index >= 0 && !event_detected) stats.events_missed++;
+    event_index = -1;
+}
+
+static void event_advance(int64_t now) {
+    uint32_t index;
+    int32_t elapsed = plume_elapsed_s(&index);
+    if (elapsed < 0 || (int32_t)index == event_index) return;
+    event_close();
+    event_index = (int32_t)index;
+    event_detected = false;
+    event_start_us = now - (int64_t)elapsed * 1000000;
+    stats.events++;
+}
+
+static void event_alarm_delivered(const alarm_frame_t *alarm) {
+    if (alarm->kind == ALARM_NONE) return;
+    int64_t now = soak_now_us();
+    if (event_index < 0 || now - event_start_us >= (int64_t)(SOAK_PLUME_S + SOAK_EVENT_DEADLINE_S) * 1000000) {
+        stats.false_alarms++;
+        return;
+    }
+    alarm_kind_t expected = plume_is_fire((uint32_t)event_index) ? ALARM_FIRE : ALARM_GAS;
+    if (alarm->kind != expected) {
+        if (alarm->kind == ALARM_FIRE) stats.misclassified++; // GAS first in a fire is fine: it escalates
+        return;
+    }
+    if (event_detected) return;
+    event_detected = true;
+    stats.events_detected++;
+    int64_t latency = now - event_start_us;
+    stats.detect_latency_total_us += latency;
+    if (latency > stats.detect_latency_max_us) stats.detect_latency_max_us = latency;
+}
+
+// --- PIR Model ---
+// Bursts of triggers; each burst is one motion event the master must hear about.
+static int64_t next_trigger_us;
+static uint32_t burst_left;      // Triggers left in the current burst, 0 = next trigger starts a burst
+static bool trigger_latched;     // Like the ISR semaphore: set by triggers, cleared by soak_pir_take
+static int64_t pending_since_us = -1; // First trigger of the oldest undelivered burst
+static uint32_t pending_bursts;
+
+static void pir_schedule_burst(int64_t after_us) {
+    // Exponential gaps, so bursts sometimes land back to back
+    float u = (float)(rng_next() % 10000 + 1) / 10001.0f;
+    next_trigger_us = after_us + (int64_t)(-logf(u) * SOAK_PIR_BURST_MEAN_S * 1e6f);
+    burst_left = 0;
+}
+
+// Fires every trigger due by now, whether or not the firmware is looking
+static void pir_advance(int64_t now) {
+    while (next_trigger_us <= now) {
+        trigger_latched = true;
+        if (burst_left == 0) {
+            burst_left = rng_range(1, SOAK_PIR_BURST_MAX);
+            stats.motion_events++;
+            if (pending_bursts++ == 0) pending_since_us = next_trigger_us;
+        }
+        if (--burst_left > 0) {
+            next_trigger_us += (int64_t)rng_range(2, 10) * 1000000;
+        } else {
+            pir_schedule_burst(next_trigger_us);
+        }
+    }
+    if (pending_bursts > 0 && now - pending_since_us > (int64_t)SOAK_EVENT_DEADLINE_S * 1000000) {
+        stats.motion_lost += pending_bursts;
+        pending_bursts = 0;
+    }
+}
+
+static bool soak_pir_take(void) {
+    pir_advance(soak_now_us());
+    bool triggered = trigger_latched;
+    trigger_latched = false;
+    return triggered;
+}
+
+#if SENSOR_HAS_DHT11 || SENSOR_HAS_MQ2
+// --- Ambient Model ---
+// Daily temperature/humidity swing, plus the heat of fire plumes
+static void soak_ambient(float *temp_c, float *humidity_pct) {
+    float phase = 2.0f * (float)M_PI * (float)(sim_s() % SOAK_DAY_S) / SOAK_DAY_S;
+    float heat = 0.0f;
+    uint32_t plume;
+    int32_t elapsed = plume_elapsed_s(&plume);
+    if (elapsed >= 0 && plume_is_fire(plume)) {
+        const float peak = SOAK_FIRE_ROR_C_MIN * SOAK_FIRE_RISE_S / 60.0f;
+        heat = elapsed < SOAK_FIRE_RISE_S ? peak * elapsed / SOAK_FIRE_RISE_S
+                                          : peak * (float)(SOAK_PLUME_S - elapsed) / (SOAK_PLUME_S - SOAK_FIRE_RISE_S);
+    }
+    *temp_c = 22.0f + 4.0f * sinf(phase) + heat;
+    *humidity_pct = 55.0f - 10.0f * sinf(phase);
+}
+#endif
+
+#if SENSOR_HAS_DHT11
+// --- DHT11 Model ---
+// The ambient model delivered as the pulse train DHT11_read would capture
+static struct dht11_reading soak_dht_read(void) {
+    uint32_t roll = rng_next() % 100;
+    bool fault = roll < SOAK_DHT_FAULT_PCT;
+    if (fault) {
+        stats.dht_faults++;
+        if (roll & 1) {
+            struct dht11_reading timeout = { DHT11_TIMEOUT_ERROR, -1, -1 };
+            return timeout;
+        }
+    }
+
+    float temp_c, humidity_pct;
+    soak_ambient(&temp_c, &humidity_pct);
+    uint8_t bytes[5];
+    bytes[0] = (uint8_t)lroundf(humidity_pct);
+    bytes[1] = 0;
+    bytes[2] = (uint8_t)lroundf(temp_c);
+    bytes[3] = 0;
+    bytes[4] = (uint8_t)(bytes[0] + bytes[1] + bytes[2] + bytes[3]);
+
+    int16_t pulses[DHT11_FRAME_BITS];
+    for (int i = 0; i < DHT11_FRAME_BITS; i++) {
+        bool one = bytes[i / 8] & (1 << (7 - (i % 8)));
+        pulses[i] = one ? 70 : 26;
+    }
+    if (fault) { // Line noise: one bit misread, caught by the checksum
+        int bit = (int)rng_range(0, DHT11_FRAME_BITS - 1);
+        pulses[bit] = pulses[bit] > DHT11_ONE_THRESHOLD_US ? 26 : 70;
+    }
+    return DHT11_decode(pulses);
+}
+#endif
+
+#if SENSOR_HAS_MQ2
+// --- MQ2 Model ---
+// Clean air with ADC noise, plus a periodic smoke plume, as conversions of the sensor's
+// AO voltage: the library reads, calibrates, compensates and tracks Ro as on target
+// (mq2_init_source). The sensor's true Ro drifts and its Rs follows the ambient model,
+// so the library's compensation and Ro tracking have something to follow.
+static MQ2 soak_mq2;
+static bool mq2_adc_failing; // Every conversion of the current reading fails
+
+static float soak_true_ro(void) {
+    return SOAK_RO * (1.0f + SOAK_RO_DRIFT_PCT / 100.0f * (float)sim_s() / SOAK_DURATION_S);
+}
+
+static esp_err_t soak_mq2_convert(void *ctx, int *raw) {
+    if (mq2_adc_failing) return ESP_ERR_TIMEOUT;
+    // Rs/Ro falls from clean air (RO_CLEAN_AIR_FACTOR) towards 1.5 at the plume's peak
+    int32_t elapsed = plume_elapsed_s(NULL);
+    float plume = elapsed >= 0 ? sinf((float)M_PI * (float)elapsed / SOAK_PLUME_S) : 0.0f;
+    float target_ratio = (float)RO_CLEAN_AIR_FACTOR + (1.5f - (float)RO_CLEAN_AIR_FACTOR) * plume;
+    float temp_c, humidity_pct;
+    soak_ambient(&temp_c, &humidity_pct);
+    float rs = target_ratio * soak_true_ro() * mq2_ambient_factor(temp_c, humidity_pct);
+    *raw = (int)lroundf(4095.0f * soak_mq2.rl_value / (rs + soak_mq2.rl_value)) + (int)rng_range(0, 6) - 3;
+    return ESP_OK;
+}
+
+static uint64_t soak_mq2_now_ms(void *ctx) {
+    return (uint64_t)(soak_now_us() / 1000);
+}
+#endif
+
+// --- Registry Drivers ---
+// Same contract as the real drivers (sensor_<name>.c): sample keeps the last reading, encode writes it
+
+static bool motion_latched;
+
+#if SENSOR_HAS_DHT11
+static struct dht11_reading dht_last = { DHT11_TIMEOUT_ERROR, -1, -1 };
+
+static void soak_dht_sample(const sensor_data_t *data) { dht_last = soak_dht_read(); }
+
+static void soak_dht_encode(sensor_data_t *data) {
+    data->dht_status = dht_last.status;
+    if (dht_last.status == DHT11_OK) {
+        data->temperature = dht_last.temperature;
+        data->humidity = dht_last.humidity;
+    }
+}
+#endif
+
+#if SENSOR_HAS_MQ2
+static float mq2_last[3] = { NAN, NAN, NAN };
+
+static void soak_mq2_sample(const sensor_data_t *data) {
+    if (data->dht_status == 0) mq2_set_ambient(&soak_mq2, data->temperature, data->humidity); // DHT11_OK
+    mq2_adc_failing = rng_pct(SOAK_MQ2_FAULT_PCT);
+    if (mq2_adc_failing) stats.mq2_faults++;
+    float *values = mq2_read(&soak_mq2, false);
+    for (int i = 0; i < 3; i++) mq2_last[i] = values != NULL ? values[i] : NAN;
+}
+
+static void soak_mq2_encode(sensor_data_t *data) {
+    data->mq2_lpg_ppm = mq2_last[0];
+    data->mq2_co_ppm = mq2_last[1];
+    data->mq2_smoke_ppm = mq2_last[2];
+}
+#endif
+
+static void soak_pir_sample(const sensor_data_t *data) { motion_latched |= soak_pir_take(); }
+static void soak_pir_encode(sensor_data_t *data) { data->motion_detected = motion_latched; }
+static void soak_pir_frame_sent(void) { motion_latched = false; }
+
+#if SENSOR_HAS_DHT11
+static const sensor_driver_t soak_dht_driver = { .name = "DHT11 (soak)", .sample = soak_dht_sample, .encode = soak_dht_encode };
+#endif
+#if SENSOR_HAS_MQ2
+static const sensor_driver_t soak_mq2_driver = { .name = "MQ2 (soak)", .sample = soak_mq2_sample, .encode = soak_mq2_encode };
+#endif
+static const sensor_driver_t soak_pir_driver = { .name = "PIR (soak)", .sample = soak_pir_sample, .encode = soak_pir_encode,
+                                                 .frame_sent = soak_pir_frame_sent };
+
+const sensor_driver_t *const soak_sensors[] = {
+#if SENSOR_HAS_DHT11
+    &soak_dht_driver,
+#endif
+#if SENSOR_HAS_MQ2
+    &soak_mq2_driver,
+#endif
+    &soak_pir_driver,
+    NULL,
+};
+
+// --- Radio Model ---
+
+static bool motion_in_frame(const uint8_t *frame, size_t len) {
+    if (len < FA_TRAILER_LEN) return false;
+    len -= FA_TRAILER_LEN; // Trailer is not checked here; auth has its own benchmarks
+    sensor_data_t samples[SAMPLE_BATCH_MAX];
+    size_t n = 0;
+    if (sensor_data_decode(frame, len, &samples[0])) {
+        n = 1;
+    } else if (ctrl_frame_is(frame, len, CTRL_SAMPLE_BATCH, len)) {
+        n = sample_batch_decode(frame, len, samples, SAMPLE_BATCH_MAX);
+    } else {
+        return false; // Memory report or other control frame
+    }
+    stats.samples_sent += n;
+    for (size_t i = 0; i < n; i++) {
+        if (samples[i].motion_detected) return true;
+    }
+    return false;
+}
+
+const uint8_t soak_master_mac[6] = { 0x02, 0x50, 0x4b, 0x00, 0x00, 0x01 }; // Locally administered
+const uint8_t soak_standby_mac[6] = { 0x02, 0x50, 0x4b, 0x00, 0x00, 0x02 };
+static esp_now_send_cb_t send_cb;
+
+void soak_radio_register_send_cb(esp_now_send_cb_t cb) {
+    send_cb = cb;
+}
+
+esp_err_t soak_radio_send(const uint8_t *peer, const uint8_t *frame, size_t len) {
+    bool to_primary = memcmp(peer, soak_master_mac, 6) == 0;
+    if (!to_primary && memcmp(peer, soak_standby_mac, 6) != 0) {
+        if (send_cb != NULL) send_cb(peer, ESP_NOW_SEND_FAIL); // Nobody else is on the air
+        return ESP_OK;
+    }
+    bool primary_down = sim_s() >= SOAK_PRIMARY_DOWN_S;
+    bool outage = sim_s() % SOAK_OUTAGE_EVERY_S >= SOAK_OUTAGE_EVERY_S - SOAK_OUTAGE_S;
+    if ((to_primary && primary_down) || outage || rng_pct(SOAK_SEND_FAIL_PCT)) {
+        stats.frames_failed++;
+        if (send_cb != NULL) send_cb(peer, ESP_NOW_SEND_FAIL);
+        return ESP_OK;
+    }
+    stats.frames_sent++;
+    if (primary_down && stats.failover_us < 0) { // First frame since the primary died: it took the standby
+        stats.failover_us = soak_now_us() - (start_us + (int64_t)SOAK_PRIMARY_DOWN_S * 1000000);
+    }
+    if (len >= FA_TRAILER_LEN && ctrl_frame_is(frame, len - FA_TRAILER_LEN, CTRL_ALARM, sizeof(alarm_frame_t))) {
+        alarm_frame_t alarm;
+        memcpy(&alarm, frame, sizeof(alarm));
+        event_alarm_delivered(&alarm);
+    }
+    if (motion_in_frame(frame, len) && pending_bursts > 0) {
+        int64_t latency = soak_now_us() - pending_since_us;
+        if (latency > stats.motion_latency_max_us) stats.motion_latency_max_us = latency;
+        stats.motion_delivered += pending_bursts;
+        pending_bursts = 0;
+    }
+    if (send_cb != NULL) send_cb(peer, ESP_NOW_SEND_SUCCESS);
+    return ESP_OK;
+}
+
+// --- Cycle Accounting ---
+
+void soak_init(uint32_t seed) {
+    memset(&stats, 0, sizeof(stats));
+    stats.failover_us = -1;
+    rng_state = seed ? seed : 1;
+    virtual_us = SOAK_START_US;
+    sleeps = 0;
+    start_us = virtual_us;
+    start_real_us = esp_timer_get_time();
+    cycle_busy_until_us = start_us;
+    next_progress_us = start_us + (int64_t)SOAK_PROGRESS_EVERY_S * 1000000;
+    pending_since_us = -1;
+    pending_bursts = 0;
+    trigger_latched = false;
+    event_index = -1;
+    pir_schedule_burst(start_us);
+
+#if SENSOR_HAS_MQ2
+    // Calibrated in the starting clean air, as sensor_mq2.c's init does; tracking from there
+    const mq2_source_t mq2_source = { .read = soak_mq2_convert, .now_ms = soak_mq2_now_ms };
+    mq2_adc_failing = false;
+    mq2_init_source(&soak_mq2, &mq2_source);
+    mq2_begin(&soak_mq2);
+#endif
+
+    ESP_LOGI(TAG, "Soak: %d h of virtual time, seed 0x%08lx", SOAK_DURATION_S / 3600, (unsigned long)seed);
+    esp_log_level_set("*", ESP_LOG_NONE);
+    esp_log_level_set(TAG, ESP_LOG_INFO);
+}
+
+void soak_cycle_begin(int64_t wake_us) {
+    int64_t now = soak_now_us();
+    int64_t late = cycle_busy_until_us - wake_us; // As on target, where the last cycle's CPU time is not skipped
+    if (late > stats.late_us_max) stats.late_us_max = late;
+    if (late > SOAK_DEADLINE_SLACK_US) stats.missed_deadlines++;
+    pir_advance(now);
+    event_advance(now);
+    cycle_start_real_us = esp_timer_get_time();
+}
+
+void soak_cycle_end(void) {
+    int64_t cpu = esp_timer_get_time() - cycle_start_real_us;
+    cycle_busy_until_us = soak_now_us() + cpu;
+    stats.cycles++;
+    stats.cpu_us_total += cpu;
+    if (cpu > stats.cpu_us_max) stats.cpu_us_max = cpu;
+
+    if (soak_now_us() >= next_progress_us) {
+        next_progress_us += (int64_t)SOAK_PROGRESS_EVERY_S * 1000000;
+        ESP_LOGI(TAG, "%2lu h: %lu cycles, %lu frames (%lu failed), motion %lu/%lu delivered, %lu lost",
+                 (unsigned long)(sim_s() / 3600), (unsigned long)stats.cycles, (unsigned long)stats.frames_sent,
+                 (unsigned long)stats.frames_failed, (unsigned long)stats.motion_delivered,
+                 (unsigned long)stats.motion_events, (unsigned long)stats.motion_lost);
+    }
+}
+
+void soak_get_stats(soak_stats_t *out) {
+    *out = stats;
+    out->motion_pending = pending_bursts;
+}
+
+void soak_report(void) {
+    event_close();
+    int64_t real_ms = (esp_timer_get_time() - start_real_us) / 1000;
+    ESP_LOGI(TAG, "Soak complete: %lu s simulated in %lld ms", (unsigned long)sim_s(), (long long)real_ms);
+    ESP_LOGI(TAG, "Cycles: %lu, CPU %lld us mean / %lld us max, %lu missed deadline(s) (worst %lld us late)",
+             (unsigned long)stats.cycles, (long long)(stats.cycles ? stats.cpu_us_total / stats.cycles : 0),
+             (long long)stats.cpu_us_max, (unsigned long)stats.missed_deadlines, (long long)stats.late_us_max);
+    ESP_LOGI(TAG, "Frames: %lu sent (%lu samples), %lu failed; faults: DHT %lu, MQ2 %lu",
+             (unsigned long)stats.frames_sent, (unsigned long)stats.samples_sent, (unsigned long)stats.frames_failed,
+             (unsigned long)stats.dht_faults, (unsigned long)stats.mq2_faults);
+    ESP_LOGI(TAG, "Failover: primary master down at %d s, frames reached the standby %lld ms later",
+             SOAK_PRIMARY_DOWN_S, (long long)(stats.failover_us / 1000));
+    ESP_LOGI(TAG, "Motion: %lu bursts, %lu delivered (worst %lld ms), %lu lost, %lu still pending",
+             (unsigned long)stats.motion_events, (unsigned long)stats.motion_delivered,
+             (long long)(stats.motion_latency_max_us / 1000), (unsigned long)stats.motion_lost,
+             (unsigned long)pending_bursts);
+#if SENSOR_HAS_MQ2
+    // Read as any other task would, from the last published reading
+    float true_ro = soak_true_ro();
+    mq2_snapshot_t snap;
+    mq2_snapshot(&soak_mq2, &snap);
+    ESP_LOGI(TAG, "MQ2 Ro: true %.3f kOhm, tracked %.3f (%+.1f%%, calibration alone %+.1f%%), %lu update(s)",
+             true_ro, snap.ro, 100.0f * (snap.ro / true_ro - 1.0f),
+             100.0f * (soak_mq2.ro_track.ro_calibrated / true_ro - 1.0f), (unsigned long)soak_mq2.ro_track.updates);
+#endif
+    ESP_LOGI(TAG, "Alarms: %lu fire/gas events, %lu detected (mean %lld ms, worst %lld ms), %lu missed, "
+             "%lu false, %lu misclassified",
+             (unsigned long)stats.events, (unsigned long)stats.events_detected,
+             (long long)(stats.events_detected ? stats.detect_latency_total_us / stats.events_detected / 1000 : 0),
+             (long long)(stats.detect_latency_max_us / 1000), (unsigned long)stats.events_missed,
+             (unsigned long)stats.false_alarms, (unsigned long)stats.misclassified);
+    if (stats.motion_lost > 0 || stats.missed_deadlines > 0 || stats.events_missed > 0 || stats.false_alarms > 0) {
+        ESP_LOGW(TAG, "Soak found %lu lost event(s), %lu missed deadline(s), %lu missed and %lu false alarm(s).",
+                 (unsigned long)stats.motion_lost, (unsigned long)stats.missed_deadlines,
+                 (unsigned long)stats.events_missed, (unsigned long)stats.false_alarms);
+    }
+}
@@ -0,0 +1,144 @@
+// soak.h
+#ifndef SOAK_H
+#define SOAK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_now.h"
+#include "sensors.h"
+
+// Accelerated soak of the sampling/transmit loop (SOAK_MODE in slave.c).
+//
+// sensor_task runs unchanged against a virtual clock that only soak_sleep_until_us()
+// moves: it skips ahead instead of sleeping, and no real time (CPU time, scheduling
+// stalls) leaks in, so a seed always replays the same run. A simulated day (17k+
+// transmit slots) completes in seconds. Sensors and the
+// radio are replaced by deterministic models with injected faults: DHT11 frames are
+// synthesised as pulse trains and decoded by DHT11_decode, the MQ2 is calibrated and
+// read by the library from modelled ADC conversions (mq2_init_source), PIR triggers arrive in bursts, and sends
+// fail at random and during outages. The modelled master has a standby, and the primary
+// dies for good at SOAK_PRIMARY_DOWN_S, so failover is timed end to end. Every 8 h a smoke plume replays a gas leak or,
+// alternately, a fire (plume plus a fast heat rise) against the detector (detect.h),
+// and the MQ2's clean-air resistance drifts for the library's Ro tracking to follow.
+// The radio model sits below relay_send in place of esp_now_send, so frames still go
+// through pairing, relaying and the wait for the MAC-layer result.
+//
+// At the end it logs per-cycle CPU time, missed deadlines (cycles that would have
+// started more than SOAK_DEADLINE_SLACK_US after their wake-up time because the cycle
+// before ran that long on the real CPU), lost motion events (PIR
+// bursts not delivered in a frame within SOAK_EVENT_DEADLINE_S), and for fire/gas
+// events the latency until the master received an alarm of the right kind, missed
+// events and false alarms (alarms with no event in progress).
+
+// --- Configuration ---
+#define SOAK_DURATION_S        (24 * 3600)
+#define SOAK_SEED              0x5EEDu
+#define SOAK_START_US          1000000 // Virtual time when the sensor task starts (1 s after boot)
+#define SOAK_DEADLINE_SLACK_US 2000
+#define SOAK_EVENT_DEADLINE_S  60     // A motion burst must reach the master within this
+#define SOAK_PIR_BURST_MEAN_S  600    // Mean gap between motion bursts
+#define SOAK_PIR_BURST_MAX     5      // Triggers per burst, 2-10 s apart
+#define SOAK_DHT_FAULT_PCT     3      // Split evenly between timeouts and CRC errors
+#define SOAK_MQ2_FAULT_PCT     1
+#define SOAK_SEND_FAIL_PCT     5
+#define SOAK_OUTAGE_EVERY_S    (6 * 3600) // All sends fail for SOAK_OUTAGE_S once per period
+#define SOAK_OUTAGE_S          45     // Shorter than SOAK_EVENT_DEADLINE_S: a burst starting in one can still be delivered
+#define SOAK_PRIMARY_DOWN_S    (15 * 3600 + 1800) // The primary master stops answering for the rest of the run
+#define SOAK_FAILOVER_DEADLINE_S 60   // PAIRING_FAILOVER_FAILURES sends; a stable slave still sends every 30 s
+
+_Static_assert(SOAK_OUTAGE_S < SOAK_EVENT_DEADLINE_S, "an outage must not by itself lose a motion burst");
+
+typedef struct {
+    uint32_t cycles;
+    uint32_t missed_deadlines;
+    int64_t cpu_us_total;
+    int64_t cpu_us_max;
+    int64_t late_us_max;
+    uint32_t frames_sent;
+    uint32_t frames_failed;
+    uint32_t samples_sent;
+    uint32_t dht_faults;
+    uint32_t mq2_faults;
+    uint32_t motion_events;     // PIR bursts injected
+    uint32_t motion_delivered;
+    uint32_t motion_lost;
+    uint32_t motion_pending;    // Bursts not delivered yet, still inside SOAK_EVENT_DEADLINE_S
+    int64_t motion_latency_max_us;
+    uint32_t events;            // Fire/gas plumes injected
+    uint32_t events_detected;   // Right-kind alarm delivered during the plume (+ SOAK_EVENT_DEADLINE_S)
+    uint32_t events_missed;
+    uint32_t false_alarms;
+    uint32_t misclassified;     // FIRE raised for a gas leak
+    int64_t detect_latency_total_us;
+    int64_t detect_latency_max_us;
+    int64_t failover_us;        // Primary down until the first frame reached the standby, -1 = not yet
+} soak_stats_t;
+
+/**
+ * @brief Starts the virtual clock at SOAK_START_US and seeds the fault models.
+ *        Lowers the log level of every other tag to keep UART time out of the cycles.
+ */
+void soak_init(uint32_t seed);
+
+/**
+ * @brief Virtual time in microseconds, from SOAK_START_US.
+ */
+int64_t soak_now_us(void);
+
+/**
+ * @brief Skips the virtual clock forward to target_us. Yields for one tick now and
+ *        then so the idle task still feeds the watchdog; that tick is not counted.
+ */
+void soak_sleep_until_us(int64_t target_us);
+
+/**
+ * @brief Brackets one loop iteration of sensor_task.
+ *
+ * @param wake_us Virtual time the iteration was scheduled for.
+ */
+void soak_cycle_begin(int64_t wake_us);
+void soak_cycle_end(void);
+
+/**
+ * @brief True once SOAK_DURATION_S of virtual time has passed.
+ */
+bool soak_finished(void);
+
+// --- Sensor and Radio Models ---
+
+/**
+ * @brief Modelled DHT11, MQ2 and PIR as registry drivers (NULL-terminated, no warm-up),
+ *        used in place of sensor_registry whatever sensors are selected in menuconfig.
+ */
+extern const sensor_driver_t *const soak_sensors[];
+
+/**
+ * @brief MACs of the modelled primary and standby master, for pairing_use_master.
+ */
+extern const uint8_t soak_master_mac[6];
+extern const uint8_t soak_standby_mac[6];
+
+/**
+ * @brief Registers the callback the radio model reports send results to, like
+ *        esp_now_register_send_cb.
+ */
+void soak_radio_register_send_cb(esp_now_send_cb_t cb);
+
+/**
+ * @brief Stands in for esp_now_send (relay_use_radio). Frames to the modelled masters
+ *        fail at random and during outages, and to the primary once it is down; delivered ones are checked for motion and
+ *        alarms. The result goes to the send callback before this returns.
+ * @return ESP_OK: the frame was accepted, as the driver queues it.
+ */
+esp_err_t soak_radio_send(const uint8_t *peer, const uint8_t *frame, size_t len);
+
+void soak_get_stats(soak_stats_t *out);
+
+/**
+ * @brief Logs the run summary.
+ */
+void soak_report(void);
+
+#endif // SOAK_H
@@ -0,0 +1,122 @@
+// src/timesync.c
+#include <string.h>
+#include "esp_log.h"
+
+#include "shared_header.h"
+#include "timesync.h"
+
+static const char *TAG = "TIMESYNC";
+
+// --- Offset/Drift Fit ---
+
+// Least-squares line through the window, relative to the newest beacon so the sums stay
+// small enough for float. Drift is the slope (us of offset per s = ppm).
+static void timesync_fit(const timesync_t* ts, int64_t* ref_rx_us, int64_t* ref_offset_us, float* drift_ppm) {
+    uint8_t newest = (ts->head + TIMESYNC_WINDOW - 1) % TIMESYNC_WINDOW;
+    *ref_rx_us = ts->rx_us[newest];
+    *ref_offset_us = ts->offset_us[newest];
+    *drift_ppm = 0.0f;
+    if (ts->count < 2) return;
+
+    float sx = 0, sy = 0;
+    for (uint8_t i = 0; i < ts->count; i++) {
+        sx += (float)(ts->rx_us[i] - *ref_rx_us) / 1e6f;
+        sy += (float)(ts->offset_us[i] - *ref_offset_us);
+    }
+    float mx = sx / ts->count, my = sy / ts->count;
+    float sxx = 0, sxy = 0;
+    for (uint8_t i = 0; i < ts->count; i++) {
+        float dx = (float)(ts->rx_us[i] - *ref_rx_us) / 1e6f - mx;
+        float dy = (float)(ts->offset_us[i] - *ref_offset_us) - my;
+        sxx += dx * dx;
+        sxy += dx * dy;
+    }
+    if (sxx < 1.0f) return; // Beacons too close together to see drift
+
+    float slope = sxy / sxx;
+    if (slope > TIMESYNC_MAX_DRIFT_PPM || slope < -TIMESYNC_MAX_DRIFT_PPM) return;
+    *drift_ppm = slope;
+    *ref_offset_us += (int64_t)(my - slope * mx); // Fitted offset at the newest beacon
+}
+
+static int64_t timesync_predict(const timesync_t* ts, int64_t local_us) {
+    return ts->ref_offset_us + (int64_t)(ts->drift_ppm * (float)(local_us - ts->ref_rx_us) / 1e6f);
+}
+
+// --- Public API ---
+
+void timesync_init(timesync_t* ts) {
+    memset(ts, 0, sizeof(*ts));
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    ts->lock = unlocked;
+}
+
+bool timesync_handle_frame(timesync_t* ts, const uint8_t* data, int len, int64_t rx_us) {
+    if (!ctrl_frame_is(data, len, CTRL_TIME_SYNC, sizeof(time_sync_t))) return false;
+
+    time_sync_t beacon;
+    memcpy(&beacon, data, sizeof(beacon));
+    int64_t offset_us = beacon.master_us - rx_us;
+
+    // Only the Wi-Fi task writes the estimate, so it can be read here without the lock
+    if (ts->valid && ts->count > 0) {
+        int64_t err = offset_us - timesync_predict(ts, rx_us);
+        if (err > TIMESYNC_OUTLIER_US || err < -TIMESYNC_OUTLIER_US) {
+            portENTER_CRITICAL(&ts->lock);
+            ts->outliers++;
+            portEXIT_CRITICAL(&ts->lock);
+            if (++ts->outliers_in_row < TIMESYNC_MAX_OUTLIERS) return true;
+            ESP_LOGW(TAG, "Master clock moved by %lld us; restarting sync.", (long long)err);
+            ts->count = 0;
+            ts->head = 0;
+        }
+    }
+    ts->outliers_in_row = 0;
+    ts->rx_us[ts->head] = rx_us;
+    ts->offset_us[ts->head] = offset_us;
+    ts->head = (ts->head + 1) % TIMESYNC_WINDOW;
+    if (ts->count < TIMESYNC_WINDOW) ts->count++;
+
+    int64_t ref_rx_us, ref_offset_us;
+    float drift_ppm;
+    timesync_fit(ts, &ref_rx_us, &ref_offset_us, &drift_ppm);
+
+    portENTER_CRITICAL(&ts->lock);
+    ts->ref_rx_us = ref_rx_us;
+    ts->ref_offset_us = ref_offset_us;
+    ts->drift_ppm = drift_ppm;
+    ts->valid = true;
+    ts->beacons++;
+    portEXIT_CRITICAL(&ts->lock);
+    return true;
+}
+
+bool timesync_to_master_us(timesync_t* ts, int64_t local_us, int64_t* master_us) {
+    portENTER_CRITICAL(&ts->lock);
+    bool ok = ts->valid && local_us - ts->ref_rx_us < (int64_t)TIMESYNC_MAX_AGE_S * 1000000;
+    int64_t offset_us = ok ? timesync_predict(ts, local_us) : 0;
+    portEXIT_CRITICAL(&ts->lock);
+    if (ok) *master_us = local_us + offset_us;
+    return ok;
+}
+
+uint32_t timesync_master_ms(timesync_t* ts, int64_t local_us) {
+    int64_t master_us;
+    if (!timesync_to_master_us(ts, local_us, &master_us)) return 0;
+    uint32_t ms = (uint32_t)(master_us / 1000);
+    return ms != 0 ? ms : 1;
+}
+
+void timesync_log(timesync_t* ts, int64_t now_us) {
+    portENTER_CRITICAL(&ts->lock);
+    timesync_t snap = *ts;
+    portEXIT_CRITICAL(&ts->lock);
+    if (!snap.valid) {
+        ESP_LOGI(TAG, "Not synchronised (%lu beacons, %lu outliers).", (unsigned long)snap.beacons,
+                 (unsigned long)snap.outliers);
+        return;
+    }
+    ESP_LOGI(TAG, "Offset %lld us, drift %.1f ppm, last beacon %lld s ago (%lu beacons, %lu outliers).",
+             (long long)snap.ref_offset_us, snap.drift_ppm, (long long)((now_us - snap.ref_rx_us) / 1000000),
+             (unsigned long)snap.beacons, (unsigned long)snap.outliers);
+}
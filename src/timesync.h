@@ -0,0 +1,72 @@
+// timesync.h
+#ifndef TIMESYNC_H
+#define TIMESYNC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+
+// Slave-side estimate of the master's clock from CTRL_TIME_SYNC beacons.
+//
+// Each beacon pairs the master's esp_timer time with our receive time. The offset
+// (master - local) of the last TIMESYNC_WINDOW beacons is fitted with a line, giving
+// the current offset and the relative drift of the two crystals, so stamps stay
+// accurate between beacons. The sync is one-way: the constant transmit path delay
+// (well under a millisecond) ends up in the offset. Beacons that arrive late against
+// the fit (queued in the master's Wi-Fi stack) are skipped; a run of them means the
+// master restarted or its clock jumped, and the window starts over.
+
+// --- Configuration ---
+#define TIMESYNC_WINDOW        8       // Beacons in the offset/drift fit
+#define TIMESYNC_OUTLIER_US    2000    // Beacon offset this far off the fit is ignored
+#define TIMESYNC_MAX_OUTLIERS  4       // Consecutive outliers that restart the fit
+#define TIMESYNC_MAX_AGE_S     600     // Estimate considered lost this long after the last beacon
+#define TIMESYNC_MAX_DRIFT_PPM 200.0f  // Fits steeper than this (bad window) fall back to offset only
+
+typedef struct {
+    // Window of (local receive time, master - local) pairs; written by the Wi-Fi task only
+    int64_t rx_us[TIMESYNC_WINDOW];
+    int64_t offset_us[TIMESYNC_WINDOW];
+    uint8_t count;
+    uint8_t head;
+    uint8_t outliers_in_row;
+
+    // Published estimate, read from the sensor task
+    portMUX_TYPE lock;
+    bool valid;
+    int64_t ref_rx_us;          // Local time the estimate refers to
+    int64_t ref_offset_us;      // master - local at ref_rx_us
+    float drift_ppm;            // Master clock rate relative to ours, minus one, in ppm
+    uint32_t beacons;
+    uint32_t outliers;
+} timesync_t;
+
+void timesync_init(timesync_t* ts);
+
+/**
+ * @brief Handles a CTRL_TIME_SYNC frame. Safe to call from the Wi-Fi task.
+ *
+ * @param rx_us Local esp_timer time taken first thing in the receive callback.
+ * @return true if the frame was a time sync frame (consumed), false otherwise.
+ */
+bool timesync_handle_frame(timesync_t* ts, const uint8_t* data, int len, int64_t rx_us);
+
+/**
+ * @brief Converts a local esp_timer time to master time.
+ * @return false (and leaves *master_us unchanged) while there is no usable estimate.
+ */
+bool timesync_to_master_us(timesync_t* ts, int64_t local_us, int64_t* master_us);
+
+/**
+ * @brief Master time in milliseconds, truncated to 32 bits (wraps every ~49 days), as
+ *        carried in sensor_data_t.timestamp_ms. 0 means "not synchronised", so a real
+ *        stamp of 0 is sent as 1.
+ */
+uint32_t timesync_master_ms(timesync_t* ts, int64_t local_us);
+
+/**
+ * @brief Logs the current offset, drift and beacon counts.
+ */
+void timesync_log(timesync_t* ts, int64_t now_us);
+
+#endif // TIMESYNC_H
@@ -0,0 +1,943 @@
+// IDF and FreeRTOS stand-ins for the native test env (host_idf.h)
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host.h"
+
+// --- Time ---
+
+static int64_t mono_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t start_us;
+
+__attribute__((constructor)) static void host_start(void) {
+    start_us = mono_us();
+}
+
+int64_t esp_timer_get_time(void) {
+    return mono_us() - start_us;
+}
+
+uint32_t esp_cpu_get_cycle_count(void) {
+    return (uint32_t)(esp_timer_get_time() * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+}
+
+void esp_rom_delay_us(uint32_t us) {
+    usleep(us);
+}
+
+void ets_delay_us(uint32_t us) {
+    usleep(us);
+}
+
+// Absolute CLOCK_MONOTONIC deadline ticks from now; NULL for portMAX_DELAY
+static const struct timespec *deadline(TickType_t ticks, struct timespec *ts) {
+    if (ticks == portMAX_DELAY) return NULL;
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    int64_t ns = ts->tv_nsec + (int64_t)pdTICKS_TO_MS(ticks) * 1000000;
+    ts->tv_sec += ns / 1000000000;
+    ts->tv_nsec = ns % 1000000000;
+    return ts;
+}
+
+static void cond_init(pthread_cond_t *cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+// Waits on cond until the deadline; false once it has passed
+static bool cond_wait(pthread_cond_t *cond, pthread_mutex_t *lock, const struct timespec *until) {
+    if (until == NULL) {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, lock, until) != ETIMEDOUT;
+}
+
+// --- Critical sections ---
+
+static pthread_mutex_t critical;
+
+__attribute__((constructor)) static void critical_init(void) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&critical, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+void host_critical_enter(void) {
+    pthread_mutex_lock(&critical);
+}
+
+void host_critical_exit(void) {
+    pthread_mutex_unlock(&critical);
+}
+
+void vTaskSuspendAll(void) {
+    host_critical_enter();
+}
+
+BaseType_t xTaskResumeAll(void) {
+    host_critical_exit();
+    return pdFALSE;
+}
+
+// --- Tasks ---
+
+struct host_task {
+    pthread_t thread;
+    char name[16];
+    TaskFunction_t fn;
+    void *arg;
+    bool exited;
+    pthread_mutex_t lock;      // Guards notify_value/notify_pending
+    pthread_cond_t notified;
+    uint32_t notify_value;
+    bool notify_pending;
+    struct host_task *next;
+};
+
+static pthread_mutex_t tasks_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tasks_changed;
+static struct host_task *tasks;
+static __thread struct host_task *self;
+
+__attribute__((constructor)) static void tasks_init(void) {
+    cond_init(&tasks_changed);
+}
+
+static struct host_task *task_new(const char *name) {
+    struct host_task *t = calloc(1, sizeof(*t));
+    if (t == NULL) abort();
+    strncpy(t->name, name, sizeof(t->name) - 1);
+    pthread_mutex_init(&t->lock, NULL);
+    cond_init(&t->notified);
+    pthread_mutex_lock(&tasks_lock);
+    t->next = tasks;
+    tasks = t;
+    pthread_mutex_unlock(&tasks_lock);
+    return t;
+}
+
+// The calling thread's task; threads the host did not start (the test runner) get one on first use
+static struct host_task *current(void) {
+    if (self == NULL) self = task_new("main");
+    return self;
+}
+
+static void task_exited(void *arg) {
+    struct host_task *t = arg;
+    pthread_mutex_lock(&tasks_lock);
+    t->exited = true;
+    pthread_cond_broadcast(&tasks_changed);
+    pthread_mutex_unlock(&tasks_lock);
+}
+
+static void *task_main(void *arg) {
+    struct host_task *t = arg;
+    self = t;
+    pthread_cleanup_push(task_exited, t);
+    t->fn(t->arg);
+    pthread_cleanup_pop(1);
+    return NULL;
+}
+
+static TaskHandle_t task_start(TaskFunction_t fn, const char *name, void *arg) {
+    struct host_task *t = task_new(name);
+    t->fn = fn;
+    t->arg = arg;
+    if (pthread_create(&t->thread, NULL, task_main, t) != 0) abort();
+    pthread_detach(t->thread);
+    return t;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg, UBaseType_t prio,
+                       TaskHandle_t *out) {
+    TaskHandle_t t = task_start(fn, name, arg);
+    if (out != NULL) *out = t;
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *out, BaseType_t core) {
+    return xTaskCreate(fn, name, stack_depth, arg, prio, out);
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                               UBaseType_t prio, StackType_t *stack, StaticTask_t *tcb) {
+    return task_start(fn, name, arg);
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                                           UBaseType_t prio, StackType_t *stack, StaticTask_t *tcb, BaseType_t core) {
+    return task_start(fn, name, arg);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task != NULL && task != self) {
+        fprintf(stderr, "vTaskDelete: only a task's own deletion is supported on the host\n");
+        abort();
+    }
+    pthread_exit(NULL); // task_exited runs as the cleanup handler
+}
+
+bool host_task_wait(const char *name, uint32_t timeout_ms) {
+    struct timespec ts;
+    const struct timespec *until = deadline(pdMS_TO_TICKS(timeout_ms), &ts);
+    pthread_mutex_lock(&tasks_lock);
+    bool done = false;
+    for (;;) {
+        bool found = false;
+        for (struct host_task *t = tasks; t != NULL; t = t->next) {
+            if (strcmp(t->name, name) == 0 && t->fn != NULL) {
+                found = true;
+                done = t->exited;
+            }
+        }
+        if (!found || done || !cond_wait(&tasks_changed, &tasks_lock, until)) break;
+    }
+    pthread_mutex_unlock(&tasks_lock);
+    return done;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    usleep((useconds_t)pdTICKS_TO_MS(ticks) * 1000);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(esp_timer_get_time() / 1000 / portTICK_PERIOD_MS);
+}
+
+BaseType_t xTaskDelayUntil(TickType_t *previous_wake, TickType_t increment) {
+    *previous_wake += increment;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(*previous_wake - now) <= 0) return pdFALSE;
+    vTaskDelay(*previous_wake - now);
+    return pdTRUE;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return current();
+}
+
+const char *pcTaskGetName(TaskHandle_t task) {
+    return (task != NULL ? task : current())->name;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    return 1024; // Threads have megabytes; report a healthy margin
+}
+
+// --- Task notifications ---
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    BaseType_t ret = pdPASS;
+    pthread_mutex_lock(&task->lock);
+    switch (action) {
+        case eSetBits:                  task->notify_value |= value; break;
+        case eIncrement:                task->notify_value++; break;
+        case eSetValueWithOverwrite:    task->notify_value = value; break;
+        case eSetValueWithoutOverwrite:
+            if (task->notify_pending) ret = pdFAIL;
+            else task->notify_value = value;
+            break;
+        case eNoAction:                 break;
+    }
+    task->notify_pending = true;
+    pthread_cond_broadcast(&task->notified);
+    pthread_mutex_unlock(&task->lock);
+    return ret;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    return xTaskNotify(task, 0, eIncrement);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {
+    xTaskNotify(task, 0, eIncrement);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value, TickType_t ticks) {
+    struct host_task *t = current();
+    struct timespec ts;
+    const struct timespec *until = deadline(ticks, &ts);
+    pthread_mutex_lock(&t->lock);
+    if (!t->notify_pending) t->notify_value &= ~clear_on_entry;
+    while (!t->notify_pending && ticks > 0 && cond_wait(&t->notified, &t->lock, until)) {}
+    BaseType_t ret = t->notify_pending ? pdTRUE : pdFALSE;
+    if (value != NULL) *value = t->notify_value;
+    if (ret == pdTRUE) t->notify_value &= ~clear_on_exit;
+    t->notify_pending = false;
+    pthread_mutex_unlock(&t->lock);
+    return ret;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    struct host_task *t = current();
+    struct timespec ts;
+    const struct timespec *until = deadline(ticks, &ts);
+    pthread_mutex_lock(&t->lock);
+    while (t->notify_value == 0 && ticks > 0 && cond_wait(&t->notified, &t->lock, until)) {}
+    uint32_t value = t->notify_value;
+    if (value > 0) t->notify_value = clear_on_exit ? 0 : value - 1;
+    t->notify_pending = false;
+    pthread_mutex_unlock(&t->lock);
+    return value;
+}
+
+// --- Semaphores (counting, so binaries and mutexes are the max = 1 case) ---
+
+struct host_sem {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    uint32_t count;
+};
+
+static SemaphoreHandle_t sem_new(uint32_t count) {
+    struct host_sem *s = calloc(1, sizeof(*s));
+    if (s == NULL) return NULL;
+    pthread_mutex_init(&s->lock, NULL);
+    cond_init(&s->changed);
+    s->count = count;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return sem_new(1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return sem_new(0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buf) {
+    return sem_new(1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buf) {
+    return sem_new(0);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    struct timespec ts;
+    const struct timespec *until = deadline(ticks, &ts);
+    pthread_mutex_lock(&sem->lock);
+    while (sem->count == 0 && ticks > 0 && cond_wait(&sem->changed, &sem->lock, until)) {}
+    BaseType_t ret = sem->count > 0 ? pdTRUE : pdFALSE;
+    if (ret == pdTRUE) sem->count--;
+    pthread_mutex_unlock(&sem->lock);
+    return ret;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    pthread_mutex_lock(&sem->lock);
+    BaseType_t ret = sem->count == 0 ? pdTRUE : pdFALSE;
+    if (ret == pdTRUE) {
+        sem->count = 1;
+        pthread_cond_signal(&sem->changed);
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ret;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken) {
+    return xSemaphoreGive(sem);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    if (sem == NULL) return;
+    pthread_mutex_destroy(&sem->lock);
+    pthread_cond_destroy(&sem->changed);
+    free(sem);
+}
+
+// --- Queues ---
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    uint32_t length;
+    uint32_t item_size;
+    uint32_t head;
+    uint32_t count;
+    uint8_t *items;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    struct host_queue *q = calloc(1, sizeof(*q));
+    if (q == NULL) return NULL;
+    q->items = calloc(length, item_size);
+    if (q->items == NULL) {
+        free(q);
+        return NULL;
+    }
+    pthread_mutex_init(&q->lock, NULL);
+    cond_init(&q->changed);
+    q->length = length;
+    q->item_size = item_size;
+    return q;
+}
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t *storage, StaticQueue_t *buf) {
+    return xQueueCreate(length, item_size);
+}
+
+static BaseType_t queue_put(QueueHandle_t q, const void *item, TickType_t ticks, bool front, bool overwrite) {
+    struct timespec ts;
+    const struct timespec *until = deadline(ticks, &ts);
+    pthread_mutex_lock(&q->lock);
+    if (overwrite && q->count == q->length) {
+        q->count--; // Length-1 mailbox: the new item replaces the old one
+    }
+    while (q->count == q->length && ticks > 0 && cond_wait(&q->changed, &q->lock, until)) {}
+    BaseType_t ret = q->count < q->length ? pdTRUE : pdFALSE;
+    if (ret == pdTRUE) {
+        uint32_t slot;
+        if (front) {
+            q->head = (q->head + q->length - 1) % q->length;
+            slot = q->head;
+        } else {
+            slot = (q->head + q->count) % q->length;
+        }
+        memcpy(q->items + (size_t)slot * q->item_size, item, q->item_size);
+        q->count++;
+        pthread_cond_broadcast(&q->changed);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ret;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    return queue_put(queue, item, ticks, false, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    return queue_put(queue, item, ticks, true, false);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *woken) {
+    return queue_put(queue, item, 0, false, false);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item) {
+    return queue_put(queue, item, 0, false, true);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks) {
+    struct timespec ts;
+    const struct timespec *until = deadline(ticks, &ts);
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0 && ticks > 0 && cond_wait(&q->changed, &q->lock, until)) {}
+    BaseType_t ret = q->count > 0 ? pdTRUE : pdFALSE;
+    if (ret == pdTRUE) {
+        memcpy(item, q->items + (size_t)q->head * q->item_size, q->item_size);
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+        pthread_cond_broadcast(&q->changed);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ret;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t count = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return count;
+}
+
+void vQueueDelete(QueueHandle_t q) {
+    if (q == NULL) return;
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->changed);
+    free(q->items);
+    free(q);
+}
+
+// --- Event groups ---
+
+struct host_events {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    EventBits_t bits;
+};
+
+EventGroupHandle_t xEventGroupCreate(void) {
+    struct host_events *g = calloc(1, sizeof(*g));
+    if (g == NULL) return NULL;
+    pthread_mutex_init(&g->lock, NULL);
+    cond_init(&g->changed);
+    return g;
+}
+
+EventGroupHandle_t xEventGroupCreateStatic(StaticEventGroup_t *buf) {
+    return xEventGroupCreate();
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t g, EventBits_t bits) {
+    pthread_mutex_lock(&g->lock);
+    g->bits |= bits;
+    EventBits_t now = g->bits;
+    pthread_cond_broadcast(&g->changed);
+    pthread_mutex_unlock(&g->lock);
+    return now;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t g, EventBits_t bits) {
+    pthread_mutex_lock(&g->lock);
+    EventBits_t before = g->bits;
+    g->bits &= ~bits;
+    pthread_mutex_unlock(&g->lock);
+    return before;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t g) {
+    pthread_mutex_lock(&g->lock);
+    EventBits_t now = g->bits;
+    pthread_mutex_unlock(&g->lock);
+    return now;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t g, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks) {
+    struct timespec ts;
+    const struct timespec *until = deadline(ticks, &ts);
+    pthread_mutex_lock(&g->lock);
+    for (;;) {
+        EventBits_t hit = g->bits & bits;
+        if (wait_for_all ? hit == bits : hit != 0) break;
+        if (ticks == 0 || !cond_wait(&g->changed, &g->lock, until)) break;
+    }
+    EventBits_t now = g->bits;
+    EventBits_t hit = now & bits;
+    if (clear_on_exit && (wait_for_all ? hit == bits : hit != 0)) g->bits &= ~bits;
+    pthread_mutex_unlock(&g->lock);
+    return now;
+}
+
+// --- Random (xorshift; fixed seed so runs repeat) ---
+
+static uint32_t rng_state = 0x2545f491;
+
+uint32_t esp_random(void) {
+    host_critical_enter();
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    host_critical_exit();
+    return x;
+}
+
+void esp_fill_random(void *buf, size_t len) {
+    uint8_t *p = buf;
+    while (len > 0) {
+        uint32_t r = esp_random();
+        size_t n = len < sizeof(r) ? len : sizeof(r);
+        memcpy(p, &r, n);
+        p += n;
+        len -= n;
+    }
+}
+
+// --- System, heap, MAC ---
+
+void esp_restart(void) {
+    fprintf(stderr, "esp_restart called\n");
+    exit(1);
+}
+
+// The esp32dev's internal heap after boot, as far as the code reading it cares
+#define HOST_FREE_HEAP (200 * 1024)
+
+uint32_t esp_get_free_heap_size(void) {
+    return HOST_FREE_HEAP;
+}
+
+uint32_t esp_get_minimum_free_heap_size(void) {
+    return HOST_FREE_HEAP;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    return HOST_FREE_HEAP;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+    return HOST_FREE_HEAP;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+    return HOST_FREE_HEAP / 2;
+}
+
+void *heap_caps_malloc(size_t size, uint32_t caps) {
+    return malloc(size);
+}
+
+// CONFIG_HEAP_USE_HOOKS: every successful allocation is passed to
+// esp_heap_trace_alloc_hook() when the program defines one (memstats.c does). The
+// hook may allocate itself (a thread's first task lookup does), so it is not re-entered.
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps) __attribute__((weak));
+
+static __thread bool in_alloc_hook;
+
+static void *alloc_hooked(void *ptr, size_t size) {
+    if (ptr != NULL && esp_heap_trace_alloc_hook != NULL && !in_alloc_hook) {
+        in_alloc_hook = true;
+        esp_heap_trace_alloc_hook(ptr, size, MALLOC_CAP_DEFAULT);
+        in_alloc_hook = false;
+    }
+    return ptr;
+}
+
+void *malloc(size_t size) {
+    return alloc_hooked(__libc_malloc(size), size);
+}
+
+void *calloc(size_t n, size_t size) {
+    return alloc_hooked(__libc_calloc(n, size), n * size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    return alloc_hooked(__libc_realloc(ptr, size), size);
+}
+
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type) {
+    static const uint8_t base[6] = { 0x02, 0x48, 0x53, 0x54, 0x00, 0x10 }; // Locally administered
+    memcpy(mac, base, 6);
+    mac[5] += (uint8_t)type;
+    return ESP_OK;
+}
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK:                      return "ESP_OK";
+        case ESP_FAIL:                    return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:              return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:         return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:       return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:        return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:           return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED:       return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:             return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_RESPONSE:    return "ESP_ERR_INVALID_RESPONSE";
+        case ESP_ERR_INVALID_CRC:         return "ESP_ERR_INVALID_CRC";
+        case ESP_ERR_INVALID_VERSION:     return "ESP_ERR_INVALID_VERSION";
+        case ESP_ERR_INVALID_MAC:         return "ESP_ERR_INVALID_MAC";
+        case ESP_ERR_NOT_FINISHED:        return "ESP_ERR_NOT_FINISHED";
+        case ESP_ERR_NVS_NOT_INITIALIZED: return "ESP_ERR_NVS_NOT_INITIALIZED";
+        case ESP_ERR_NVS_NOT_FOUND:       return "ESP_ERR_NVS_NOT_FOUND";
+        case ESP_ERR_NVS_INVALID_LENGTH:  return "ESP_ERR_NVS_INVALID_LENGTH";
+        case ESP_ERR_ESPNOW_NOT_INIT:     return "ESP_ERR_ESPNOW_NOT_INIT";
+        case ESP_ERR_ESPNOW_NOT_FOUND:    return "ESP_ERR_ESPNOW_NOT_FOUND";
+        case ESP_ERR_ESPNOW_EXIST:        return "ESP_ERR_ESPNOW_EXIST";
+        default:                          return "UNKNOWN ERROR";
+    }
+}
+
+// --- Logging ---
+
+#define LOG_TAGS 32
+
+static struct {
+    char tag[24];
+    esp_log_level_t level;
+} log_levels[LOG_TAGS];
+static esp_log_level_t log_default = ESP_LOG_WARN;
+
+void esp_log_level_set(const char *tag, esp_log_level_t level) {
+    host_critical_enter();
+    if (strcmp(tag, "*") == 0) {
+        log_default = level;
+    } else {
+        for (int i = 0; i < LOG_TAGS; i++) {
+            if (log_levels[i].tag[0] == '\0' || strcmp(log_levels[i].tag, tag) == 0) {
+                strncpy(log_levels[i].tag, tag, sizeof(log_levels[i].tag) - 1);
+                log_levels[i].level = level;
+                break;
+            }
+        }
+    }
+    host_critical_exit();
+}
+
+void host_log(esp_log_level_t level, const char *tag, const char *format, ...) {
+    static const char letters[] = "NEWIDV";
+    host_critical_enter();
+    esp_log_level_t limit = log_default;
+    for (int i = 0; i < LOG_TAGS && log_levels[i].tag[0] != '\0'; i++) {
+        if (strcmp(log_levels[i].tag, tag) == 0) limit = log_levels[i].level;
+    }
+    if (level <= limit) {
+        fprintf(stderr, "%c (%lld) %s: ", letters[level], (long long)(esp_timer_get_time() / 1000), tag);
+        va_list ap;
+        va_start(ap, format);
+        vfprintf(stderr, format, ap);
+        va_end(ap);
+        fputc('\n', stderr);
+    }
+    host_critical_exit();
+}
+
+// --- NVS (in RAM) ---
+
+#define NVS_ENTRIES   64
+#define NVS_MAX_BLOB  512
+
+typedef struct {
+    char name_space[16];
+    char key[16];
+    size_t len;
+    uint8_t value[NVS_MAX_BLOB];
+} nvs_entry_t;
+
+static nvs_entry_t nvs[NVS_ENTRIES];
+static char nvs_spaces[8][16]; // nvs_handle_t is the index + 1
+
+void host_nvs_reset(void) {
+    host_critical_enter();
+    memset(nvs, 0, sizeof(nvs));
+    host_critical_exit();
+}
+
+esp_err_t nvs_flash_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void) {
+    host_nvs_reset();
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *name_space, nvs_open_mode_t mode, nvs_handle_t *out) {
+    host_critical_enter();
+    esp_err_t ret = ESP_ERR_NVS_NO_FREE_PAGES;
+    for (size_t i = 0; i < sizeof(nvs_spaces) / sizeof(nvs_spaces[0]); i++) {
+        if (nvs_spaces[i][0] == '\0') strncpy(nvs_spaces[i], name_space, sizeof(nvs_spaces[i]) - 1);
+        if (strcmp(nvs_spaces[i], name_space) == 0) {
+            *out = (nvs_handle_t)(i + 1);
+            ret = ESP_OK;
+            break;
+        }
+    }
+    host_critical_exit();
+    return ret;
+}
+
+void nvs_close(nvs_handle_t handle) {}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    return ESP_OK;
+}
+
+// Caller holds the critical section
+static nvs_entry_t *nvs_find(nvs_handle_t handle, const char *key, bool create) {
+    const char *space = nvs_spaces[handle - 1];
+    nvs_entry_t *free_entry = NULL;
+    for (int i = 0; i < NVS_ENTRIES; i++) {
+        if (nvs[i].key[0] == '\0') {
+            if (free_entry == NULL) free_entry = &nvs[i];
+        } else if (strcmp(nvs[i].name_space, space) == 0 && strcmp(nvs[i].key, key) == 0) {
+            return &nvs[i];
+        }
+    }
+    if (!create || free_entry == NULL) return NULL;
+    strncpy(free_entry->name_space, space, sizeof(free_entry->name_space) - 1);
+    strncpy(free_entry->key, key, sizeof(free_entry->key) - 1);
+    return free_entry;
+}
+
+static esp_err_t nvs_get(nvs_handle_t handle, const char *key, void *out, size_t *len, bool exact) {
+    host_critical_enter();
+    nvs_entry_t *e = nvs_find(handle, key, false);
+    esp_err_t ret = ESP_OK;
+    if (e == NULL) {
+        ret = ESP_ERR_NVS_NOT_FOUND;
+    } else if (out == NULL) {
+        *len = e->len; // Size query
+    } else if (exact ? e->len != *len : e->len > *len) {
+        ret = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        memcpy(out, e->value, e->len);
+        *len = e->len;
+    }
+    host_critical_exit();
+    return ret;
+}
+
+static esp_err_t nvs_set(nvs_handle_t handle, const char *key, const void *value, size_t len) {
+    if (len > NVS_MAX_BLOB) return ESP_ERR_NVS_INVALID_LENGTH;
+    host_critical_enter();
+    nvs_entry_t *e = nvs_find(handle, key, true);
+    if (e != NULL) {
+        memcpy(e->value, value, len);
+        e->len = len;
+    }
+    host_critical_exit();
+    return e != NULL ? ESP_OK : ESP_ERR_NVS_NO_FREE_PAGES;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key) {
+    host_critical_enter();
+    nvs_entry_t *e = nvs_find(handle, key, false);
+    if (e != NULL) memset(e, 0, sizeof(*e));
+    host_critical_exit();
+    return e != NULL ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char *key, uint8_t *out) {
+    size_t len = sizeof(*out);
+    return nvs_get(handle, key, out, &len, true);
+}
+
+esp_err_t nvs_get_u16(nvs_handle_t handle, const char *key, uint16_t *out) {
+    size_t len = sizeof(*out);
+    return nvs_get(handle, key, out, &len, true);
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char *key, uint32_t *out) {
+    size_t len = sizeof(*out);
+    return nvs_get(handle, key, out, &len, true);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out, size_t *len) {
+    return nvs_get(handle, key, out, len, false);
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char *key, uint8_t value) {
+    return nvs_set(handle, key, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_u16(nvs_handle_t handle, const char *key, uint16_t value) {
+    return nvs_set(handle, key, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char *key, uint32_t value) {
+    return nvs_set(handle, key, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t len) {
+    return nvs_set(handle, key, value, len);
+}
+
+// --- Partitions (none) ---
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label) {
+    return NULL;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *part, size_t offset, void *dst, size_t len) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *part, size_t offset, const void *src, size_t len) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *part, size_t offset, size_t len) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+// --- Wi-Fi and ESP-NOW (no radio: the stack comes up, nothing goes out) ---
+
+static uint8_t wifi_channel = 1;
+
+esp_err_t esp_netif_init(void) { return ESP_OK; }
+esp_err_t esp_event_loop_create_default(void) { return ESP_OK; }
+esp_err_t esp_wifi_init(const wifi_init_config_t *config) { return ESP_OK; }
+esp_err_t esp_wifi_set_storage(wifi_storage_t storage) { return ESP_OK; }
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode) { return ESP_OK; }
+esp_err_t esp_wifi_start(void) { return ESP_OK; }
+
+esp_err_t esp_wifi_set_channel(uint8_t primary, wifi_second_chan_t second) {
+    wifi_channel = primary;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_channel(uint8_t *primary, wifi_second_chan_t *second) {
+    *primary = wifi_channel;
+    if (second != NULL) *second = WIFI_SECOND_CHAN_NONE;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_init(void) { return ESP_OK; }
+esp_err_t esp_now_deinit(void) { return ESP_OK; }
+esp_err_t esp_now_register_send_cb(esp_now_send_cb_t cb) { return ESP_OK; }
+esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t cb) { return ESP_OK; }
+esp_err_t esp_now_add_peer(const esp_now_peer_info_t *peer) { return ESP_OK; }
+esp_err_t esp_now_mod_peer(const esp_now_peer_info_t *peer) { return ESP_OK; }
+esp_err_t esp_now_del_peer(const uint8_t *peer_addr) { return ESP_OK; }
+bool esp_now_is_peer_exist(const uint8_t *peer_addr) { return true; }
+
+esp_err_t esp_now_send(const uint8_t *peer_addr, const uint8_t *data, size_t len) {
+    return ESP_ERR_ESPNOW_NOT_INIT;
+}
+
+// --- GPIO and ADC (no pins: configuration succeeds, inputs read low, no ADC unit) ---
+
+esp_err_t gpio_config(const gpio_config_t *config) { return ESP_OK; }
+esp_err_t gpio_reset_pin(gpio_num_t gpio) { return ESP_OK; }
+esp_err_t gpio_set_direction(gpio_num_t gpio, gpio_mode_t mode) { return ESP_OK; }
+esp_err_t gpio_set_level(gpio_num_t gpio, uint32_t level) { return ESP_OK; }
+int gpio_get_level(gpio_num_t gpio) { return 0; }
+esp_err_t gpio_set_intr_type(gpio_num_t gpio, gpio_int_type_t type) { return ESP_OK; }
+esp_err_t gpio_intr_enable(gpio_num_t gpio) { return ESP_OK; }
+esp_err_t gpio_intr_disable(gpio_num_t gpio) { return ESP_OK; }
+esp_err_t gpio_install_isr_service(int flags) { return ESP_OK; }
+void gpio_uninstall_isr_service(void) {}
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio, gpio_isr_t isr, void *arg) { return ESP_OK; }
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio) { return ESP_OK; }
+
+esp_err_t adc_oneshot_new_unit(const adc_oneshot_unit_init_cfg_t *config, adc_oneshot_unit_handle_t *out) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t adc_oneshot_config_channel(adc_oneshot_unit_handle_t unit, adc_channel_t channel,
+                                     const adc_oneshot_chan_cfg_t *config) {
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t adc_oneshot_read(adc_oneshot_unit_handle_t unit, adc_channel_t channel, int *out_raw) {
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t adc_oneshot_del_unit(adc_oneshot_unit_handle_t unit) {
+    return ESP_ERR_INVALID_STATE;
+}
+
+// --- I2C (no bus) ---
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t *config, i2c_master_bus_handle_t *out) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t i2c_del_master_bus(i2c_master_bus_handle_t bus) {
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus, const i2c_device_config_t *config,
+                                    i2c_master_dev_handle_t *out) {
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t dev, const uint8_t *data, size_t len, int timeout_ms) {
+    return ESP_ERR_INVALID_STATE;
+}
@@ -0,0 +1,24 @@
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "host_idf.h"
+
+// Controls the native tests use on top of the IDF stand-ins (host_idf.h). Log output
+// goes to stderr at ESP_LOG_WARN and above unless esp_log_level_set says otherwise.
+
+/**
+ * @brief Waits until the task called name has ended (vTaskDelete(NULL) or returned
+ *        from its function).
+ *
+ * @return true once it has, false if it had not after timeout_ms or never existed.
+ */
+bool host_task_wait(const char *name, uint32_t timeout_ms);
+
+/**
+ * @brief Drops every NVS entry, as if the flash had been erased.
+ */
+void host_nvs_reset(void);
+
+#endif // HOST_H
@@ -0,0 +1,16 @@
+#pragma once
+// Host build of the esp32dev configuration (sdkconfig.esp32dev): the options the
+// portable libraries and the slave's sampling loop read.
+
+#define CONFIG_FREERTOS_HZ 100
+#define CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ 160
+#define CONFIG_HEAP_USE_HOOKS 1
+
+#define CONFIG_SLAVE_SENSOR_DHT11 1
+#define CONFIG_SLAVE_DHT11_GPIO 4
+#define CONFIG_SLAVE_SENSOR_MQ2 1
+#define CONFIG_SLAVE_MQ2_ADC1_CHANNEL 6
+#define CONFIG_SLAVE_SENSOR_PIR 1
+#define CONFIG_SLAVE_PIR_GPIO 5
+
+#define CONFIG_SLAVE_AUTH_SITE_KEY ""
@@ -0,0 +1,169 @@
+// The kernel benchmark (src/bench.c) on the host: logs the same table as on target, and
+// fails when a kernel got slower than the committed host baseline allows or touches the heap.
+// The flash stores it benches run on RAM regions in place of their partitions.
+#include <string.h>
+#include <unity.h>
+#include "host.h"
+#include "nvs.h"
+#include "history.h"
+#include "journal.h"
+#include "bench.h"
+
+// Host baseline in centi-cycles/op (bench.c's unit, from the host's 160 MHz cycle clock):
+// the slowest of 20 runs of this suite on a single-core x86-64 build VM at -O1. Update it
+// in the same commit as a change that is meant to move a kernel's cost.
+static const struct {
+    const char *name;
+    uint32_t ccycles_per_op;
+} host_baseline[] = {
+    { "mq2_resist",       96 },
+    { "mq2_pct_lpg",     944 },
+    { "mq2_pct_co",      920 },
+    { "mq2_pct_smk",     912 },
+    { "mq2_snapshot",    104 },
+    { "mq2_ro_track",    144 },
+    { "dht_decode",     1264 },
+    { "dht_crc",          80 },
+    { "frame_enc",        48 },
+    { "frame_dec",        88 },
+    { "batch_enc",     61280 },
+    { "batch_dec",     26768 },
+    { "rules_500x50", 146864 },
+    { "auth_sign",      1848 },
+    { "auth_verify",    1864 },
+    { "trace_record",    136 },
+    { "detect_update",  2192 },
+    { "motion_ingest",   272 },
+};
+
+// Host noise tolerance, on top of bench.c's own BENCH_REGRESSION_PCT. Build machines
+// differ in clock and load: the fastest of BENCH_REPEATS runs still varied 2x across runs
+// on one VM, so the stored baseline is doubled. Kernels of a few cycles are below the
+// host clock's resolution (1 us over BENCH_ITERATIONS ops is 0.08 cycles/op) and jitter
+// by whole multiples, so no baseline is stored below HOST_BASELINE_FLOOR.
+#define HOST_HEADROOM_PCT    200
+#define HOST_BASELINE_FLOOR  400 // centi-cycles/op: 4 cycles, 25 ns
+
+// --- RAM Flash ---
+// Writes may only clear bits, as on NOR flash; erases are whole 4 KB sectors.
+
+#define RAM_SECTOR_SIZE 4096
+
+typedef struct {
+    uint8_t* mem;
+    size_t size;
+    uint32_t nor_violations;   // Writes that tried to set a cleared bit
+} ram_flash_t;
+
+static uint8_t history_mem[HIST_MIN_REGION_BYTES];
+static ram_flash_t history_flash = { history_mem, sizeof(history_mem) };
+static uint8_t journal_mem[128 * JOURNAL_SECTOR_SIZE]; // The "journal" entry of partitions.csv
+static ram_flash_t journal_flash = { journal_mem, sizeof(journal_mem) };
+
+static esp_err_t ram_read(void* ctx, size_t offset, void* dst, size_t len) {
+    ram_flash_t* f = ctx;
+    if (offset + len > f->size) return ESP_ERR_INVALID_ARG;
+    memcpy(dst, f->mem + offset, len);
+    return ESP_OK;
+}
+
+static esp_err_t ram_write(void* ctx, size_t offset, const void* src, size_t len) {
+    ram_flash_t* f = ctx;
+    if (offset + len > f->size) return ESP_ERR_INVALID_ARG;
+    const uint8_t* s = src;
+    for (size_t i = 0; i < len; i++) {
+        if ((f->mem[offset + i] & s[i]) != s[i]) f->nor_violations++;
+        f->mem[offset + i] &= s[i];
+    }
+    return ESP_OK;
+}
+
+static esp_err_t ram_erase(void* ctx, size_t offset, size_t len) {
+    ram_flash_t* f = ctx;
+    if (offset % RAM_SECTOR_SIZE != 0 || len % RAM_SECTOR_SIZE != 0 || offset + len > f->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(f->mem + offset, 0xFF, len);
+    return ESP_OK;
+}
+
+static bool count_record(const hist_record_t* rec, void* ctx) {
+    (*(uint32_t*)ctx)++;
+    return true;
+}
+
+typedef struct {
+    uint32_t n;
+    uint32_t last_seq;
+} seq_run_t;
+
+// Counts events and checks their seqs run on by one
+static bool follow_seq(const journal_record_t* rec, void* ctx) {
+    seq_run_t* run = ctx;
+    if (run->n > 0) TEST_ASSERT_EQUAL_UINT32(run->last_seq + 1, rec->seq);
+    run->last_seq = rec->seq;
+    run->n++;
+    return true;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_kernels_hold_host_baseline(void) {
+    esp_log_level_set("BENCH", ESP_LOG_INFO);
+    nvs_handle_t nvs;
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_open("bench", NVS_READWRITE, &nvs));
+    for (size_t i = 0; i < sizeof(host_baseline) / sizeof(host_baseline[0]); i++) {
+        uint32_t ccycles = host_baseline[i].ccycles_per_op * HOST_HEADROOM_PCT / 100;
+        if (ccycles < HOST_BASELINE_FLOOR) ccycles = HOST_BASELINE_FLOOR;
+        TEST_ASSERT_EQUAL(ESP_OK, nvs_set_u32(nvs, host_baseline[i].name, ccycles));
+    }
+    nvs_commit(nvs);
+    nvs_close(nvs);
+
+    const hist_backend_t history = { .size = history_flash.size, .read = ram_read, .write = ram_write,
+                                     .erase = ram_erase, .ctx = &history_flash };
+    bench_use_history(&history);
+    const journal_backend_t journal = { .size = journal_flash.size, .read = ram_read, .write = ram_write,
+                                        .erase = ram_erase, .ctx = &journal_flash };
+    bench_use_journal(&journal);
+
+    // Kernels flagged: slower than the baseline allows, or allocating
+    TEST_ASSERT_EQUAL(0, bench_run_all(false));
+
+    // The history bench ran: a day of one record a minute from each of 50 slaves, kept
+    // within NOR flash rules, and it mounts again from flash
+    TEST_ASSERT_EQUAL_UINT32(0, history_flash.nor_violations);
+    hist_store_t* store = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, hist_open(&history, &store));
+    uint32_t records = 0, n = 0;
+    hist_span(store, NULL, NULL, &records);
+    TEST_ASSERT_EQUAL_UINT32(24 * 60 * 50, records);
+    TEST_ASSERT_EQUAL(ESP_OK, hist_query(store, 7, 0, UINT32_MAX, count_record, &n));
+    TEST_ASSERT_EQUAL_UINT32(24 * 60, n);
+    hist_close(store);
+    bench_use_history(NULL);
+
+    // The journal bench ran: 20,000 taps through a ring of 128 sectors, the newest kept
+    // with no gap in their seqs, and they mount again from flash
+    TEST_ASSERT_EQUAL_UINT32(0, journal_flash.nor_violations);
+    const journal_config_t cfg = { .commit_window_ms = 200, .batch_records = 32, .task_priority = 5 };
+    journal_t* j = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, journal_open(&journal, &cfg, &j));
+    journal_stats_t st;
+    journal_get_stats(j, &st);
+    TEST_ASSERT_TRUE(st.records > 127 * 127 && st.records <= 128 * 127);
+    seq_run_t run = { 0 };
+    TEST_ASSERT_EQUAL(ESP_OK, journal_query(j, NULL, 0, 0, UINT32_MAX, follow_seq, &run));
+    TEST_ASSERT_EQUAL_UINT32(st.records, run.n);
+    TEST_ASSERT_EQUAL_UINT32(20000 - 1, run.last_seq);
+    journal_close(j);
+    bench_use_journal(NULL);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_kernels_hold_host_baseline);
+    return UNITY_END();
+}
@@ -0,0 +1,285 @@
+// The fire/gas detector (src/detect.c) replayed over labelled traces: false alarms on
+// quiet days with nuisances, misses and latency on gas leaks and fires
+#include <math.h>
+#include <string.h>
+#include <unity.h>
+#include "host.h"
+#include "detect.h"
+
+static const char *TAG = "DETECT_EVAL";
+
+// Traces are sampled as the slave does at its fastest, and replayed sample by sample.
+// They are synthetic: a seeded model of a warehouse aisle (daily swing, sun on the
+// enclosure, door draughts, cooking and exhaust puffs, single bad reads, sensor faults,
+// MQ2 drift) with labelled events laid on top. Anything recorded in the same form
+// (time, sample, label) replays through trace_replay() unchanged.
+#define EVAL_PERIOD_S          5
+#define EVAL_QUIET_DAYS        30
+#define EVAL_RUNS              50       // Per event kind
+#define EVAL_LEAD_S            7200     // Quiet time before each event, for the baselines
+#define EVAL_EVENT_S           600
+
+// Thresholds the detector must meet
+#define EVAL_MAX_FALSE_PER_30D 1        // False alarms over EVAL_QUIET_DAYS quiet days
+#define EVAL_MAX_LATE_SAMPLES  8        // Samples from the signature's onset in the raw signal to the alarm
+
+typedef enum {
+    LABEL_QUIET = 0,
+    LABEL_GAS,          // Leak: smoke/gas ramps up, no heat
+    LABEL_SMOULDER,     // Smoke first, slow heat: GAS, then FIRE
+    LABEL_FLAME,        // Fast heat and smoke: FIRE
+} label_t;
+
+typedef struct {
+    int64_t t_us;
+    sensor_data_t sample;
+    bool onset;         // The raw signal shows the event's signature from here on
+} trace_sample_t;
+
+// --- Trace Model ---
+
+static uint32_t rng_state;
+
+static uint32_t rng_next(void) {
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return rng_state = x;
+}
+
+static float rng_unit(void) {
+    return (float)(rng_next() % 10000) / 10000.0f;
+}
+
+static float rng_between(float lo, float hi) {
+    return lo + (hi - lo) * rng_unit();
+}
+
+typedef struct {
+    int64_t t0_s;       // Trace start (time of day matters for the swing)
+    float smoke_base;
+    float drift_per_day;
+    int64_t sun_s, door_s[2], puff_s; // Nuisances, seconds into each day
+    label_t label;
+    int64_t event_s;    // Event start, -1 = none
+    float heat_c_min, smoke_ppm_min, heat_delay_s;
+} trace_model_t;
+
+static void model_new_day(trace_model_t *m) {
+    m->sun_s = 10 * 3600 + rng_next() % (4 * 3600);
+    m->door_s[0] = 6 * 3600 + rng_next() % (4 * 3600);
+    m->door_s[1] = 15 * 3600 + rng_next() % (4 * 3600);
+    m->puff_s = 11 * 3600 + rng_next() % (3 * 3600);
+}
+
+// True signals at t seconds; onset set once the event's signature is in them
+static void model_truth(const trace_model_t *m, int64_t t, float *temp, float *smoke, bool *onset) {
+    int64_t day_t = t % 86400;
+    float phase = 2.0f * (float)M_PI * (float)day_t / 86400.0f;
+    *temp = 22.0f + 4.0f * sinf(phase);
+    *smoke = m->smoke_base * (1.0f + m->drift_per_day * (float)t / 86400.0f);
+
+    // Sun on the enclosure: +6 C over 30 min, an hour's plateau, 30 min back
+    int64_t sun = day_t - m->sun_s;
+    if (sun >= 0 && sun < 7200) {
+        *temp += 6.0f * (sun < 1800 ? sun / 1800.0f : sun < 5400 ? 1.0f : (7200 - sun) / 1800.0f);
+    }
+    // Dock door: a cold draught, -5 C within a minute, back over five
+    for (int i = 0; i < 2; i++) {
+        int64_t door = day_t - m->door_s[i];
+        if (door >= 0 && door < 360) *temp -= 5.0f * (door < 60 ? door / 60.0f : (360 - door) / 300.0f);
+    }
+    // Cooking or forklift exhaust: +90 ppm for two minutes
+    int64_t puff = day_t - m->puff_s;
+    if (puff >= 0 && puff < 120) *smoke += 90.0f;
+
+    *onset = false;
+    if (m->event_s < 0 || t < m->event_s) return;
+    float e_min = (float)(t - m->event_s) / 60.0f;
+    float smoke_rise = fminf(m->smoke_ppm_min * e_min, 2000.0f);
+    *smoke += smoke_rise;
+    float heat_min = fmaxf(0.0f, e_min - m->heat_delay_s / 60.0f);
+    float heat = m->label == LABEL_GAS ? 0.0f : m->heat_c_min * heat_min;
+    *temp += heat;
+    switch (m->label) {
+    case LABEL_GAS:
+        *onset = smoke_rise >= DETECT_GAS_DELTA_PPM;
+        break;
+    case LABEL_SMOULDER: // FIRE onset: the combined signature (gas plus moderate heat rise)
+        *onset = smoke_rise >= DETECT_GAS_DELTA_PPM && heat >= DETECT_FIRE_RISE_C;
+        break;
+    case LABEL_FLAME:
+        *onset = heat >= DETECT_FIRE_RISE_C;
+        break;
+    default:
+        break;
+    }
+}
+
+// What the slave would have sampled: DHT11 whole degrees (saturating at 50 C, 3% failed
+// reads, 5% off by one), MQ2 with noise, 1% failed reads and 0.5% single wild reads
+static void model_sample(trace_model_t *m, int64_t t, trace_sample_t *out) {
+    if (t % 86400 == 0) model_new_day(m);
+    float temp, smoke;
+    bool onset;
+    model_truth(m, t, &temp, &smoke, &onset);
+
+    sensor_data_t *s = &out->sample;
+    memset(s, 0, sizeof(*s));
+    uint32_t roll = rng_next() % 100;
+    s->dht_status = roll < 3 ? -1 : 0;
+    int deg = (int)lroundf(fminf(temp, 50.0f)) + (roll >= 3 && roll < 5 ? 1 : roll >= 5 && roll < 8 ? -1 : 0);
+    s->temperature = s->dht_status == 0 ? deg : -1;
+    s->humidity = 50;
+    roll = rng_next() % 1000;
+    float ppm = smoke * rng_between(0.95f, 1.05f);
+    s->mq2_smoke_ppm = roll < 10 ? -1.0f : roll < 15 ? rng_between(300.0f, 3000.0f) : ppm;
+    s->mq2_lpg_ppm = s->mq2_smoke_ppm;
+    s->mq2_co_ppm = s->mq2_smoke_ppm;
+    out->t_us = (m->t0_s + t) * 1000000;
+    out->onset = onset;
+}
+
+static void model_init(trace_model_t *m, uint32_t seed, label_t label) {
+    rng_state = seed;
+    memset(m, 0, sizeof(*m));
+    m->t0_s = rng_next() % 86400;
+    m->smoke_base = rng_between(15.0f, 60.0f);
+    m->drift_per_day = rng_between(-0.01f, 0.01f);
+    model_new_day(m);
+    m->label = label;
+    m->event_s = label == LABEL_QUIET ? -1 : EVAL_LEAD_S;
+    switch (label) {
+    case LABEL_GAS:
+        m->smoke_ppm_min = rng_between(60.0f, 400.0f);
+        break;
+    case LABEL_SMOULDER:
+        m->smoke_ppm_min = rng_between(80.0f, 250.0f);
+        m->heat_c_min = rng_between(3.5f, 6.0f);
+        m->heat_delay_s = rng_between(60.0f, 180.0f);
+        break;
+    case LABEL_FLAME:
+        m->smoke_ppm_min = rng_between(300.0f, 800.0f);
+        m->heat_c_min = rng_between(10.0f, 25.0f);
+        break;
+    default:
+        break;
+    }
+}
+
+// --- Replay ---
+
+typedef struct {
+    uint32_t alarms;            // Raised or escalated
+    int64_t first_gas_us;       // -1 = never
+    int64_t first_fire_us;
+} replay_result_t;
+
+// Feeds a trace through the detector as the sensor task does
+static void trace_replay(detect_t *det, const trace_sample_t *trace, size_t n, replay_result_t *r) {
+    for (size_t i = 0; i < n; i++) {
+        alarm_kind_t before = det->state;
+        if (!detect_update(det, &trace[i].sample, trace[i].t_us) || det->state <= before) continue;
+        r->alarms++;
+        if (det->state == ALARM_GAS && r->first_gas_us < 0) r->first_gas_us = trace[i].t_us;
+        if (det->state == ALARM_FIRE && r->first_fire_us < 0) r->first_fire_us = trace[i].t_us;
+    }
+}
+
+void setUp(void) {
+    esp_log_level_set("DETECT", ESP_LOG_ERROR); // One line per alarm otherwise
+    esp_log_level_set(TAG, ESP_LOG_INFO);
+}
+
+void tearDown(void) {}
+
+static trace_sample_t day_trace[86400 / EVAL_PERIOD_S];
+
+static void test_quiet_days_raise_no_alarm(void) {
+    trace_model_t m;
+    detect_t det;
+    replay_result_t r = { .first_gas_us = -1, .first_fire_us = -1 };
+    model_init(&m, 0x51A7E, LABEL_QUIET);
+    detect_init(&det);
+    for (int day = 0; day < EVAL_QUIET_DAYS; day++) {
+        size_t n = 0;
+        for (int64_t t = (int64_t)day * 86400; t < (int64_t)(day + 1) * 86400; t += EVAL_PERIOD_S) {
+            model_sample(&m, t, &day_trace[n++]);
+        }
+        trace_replay(&det, day_trace, n, &r);
+    }
+    ESP_LOGI(TAG, "Quiet: %d days, %lu false alarm(s) (limit %d)", EVAL_QUIET_DAYS, (unsigned long)r.alarms,
+             EVAL_MAX_FALSE_PER_30D);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(EVAL_MAX_FALSE_PER_30D * EVAL_QUIET_DAYS / 30, r.alarms);
+}
+
+// Replays EVAL_RUNS events of one kind; each must raise the expected alarm within
+// EVAL_MAX_LATE_SAMPLES of its onset, and nothing may fire before the event starts
+static void eval_events(label_t label, const char *name) {
+    static trace_sample_t trace[(EVAL_LEAD_S + EVAL_EVENT_S) / EVAL_PERIOD_S];
+    uint32_t early = 0, missed = 0, late = 0, misclassified = 0;
+    int64_t latency_sum_us = 0, latency_max_us = 0;
+
+    for (uint32_t run = 0; run < EVAL_RUNS; run++) {
+        trace_model_t m;
+        detect_t det;
+        replay_result_t r = { .first_gas_us = -1, .first_fire_us = -1 };
+        model_init(&m, 0xE7E47 + run * 7919 + label * 104729, label);
+        detect_init(&det);
+
+        size_t n = 0;
+        int64_t onset_us = -1, event_us = (m.t0_s + m.event_s) * 1000000;
+        for (int64_t t = 0; t < EVAL_LEAD_S + EVAL_EVENT_S; t += EVAL_PERIOD_S) {
+            model_sample(&m, t, &trace[n]);
+            if (trace[n].onset && onset_us < 0) onset_us = trace[n].t_us;
+            n++;
+        }
+        trace_replay(&det, trace, n, &r);
+
+        int64_t first_us = r.first_gas_us >= 0 && (r.first_fire_us < 0 || r.first_gas_us < r.first_fire_us)
+                               ? r.first_gas_us : r.first_fire_us;
+        if (first_us >= 0 && first_us < event_us) early++;
+        if (label == LABEL_GAS && r.first_fire_us >= 0) misclassified++;
+        int64_t detected_us = label == LABEL_GAS ? r.first_gas_us : r.first_fire_us;
+        if (detected_us < 0 || onset_us < 0) {
+            missed++;
+            continue;
+        }
+        int64_t latency_us = detected_us - onset_us;
+        if (latency_us > (int64_t)EVAL_MAX_LATE_SAMPLES * EVAL_PERIOD_S * 1000000) late++;
+        if (latency_us > latency_max_us) latency_max_us = latency_us;
+        latency_sum_us += latency_us;
+    }
+
+    uint32_t detected = EVAL_RUNS - missed;
+    ESP_LOGI(TAG, "%-9s %u runs: %lu missed, %lu late, %lu early, %lu misclassified; "
+             "from onset mean %lld s, worst %lld s", name, EVAL_RUNS, (unsigned long)missed,
+             (unsigned long)late, (unsigned long)early, (unsigned long)misclassified,
+             (long long)(detected ? latency_sum_us / detected / 1000000 : 0), (long long)(latency_max_us / 1000000));
+    TEST_ASSERT_EQUAL_UINT32(0, missed);
+    TEST_ASSERT_EQUAL_UINT32(0, late);
+    TEST_ASSERT_EQUAL_UINT32(0, early);
+    TEST_ASSERT_EQUAL_UINT32(0, misclassified);
+}
+
+static void test_gas_leaks(void) {
+    eval_events(LABEL_GAS, "Gas leak");
+}
+
+static void test_smouldering_fires(void) {
+    eval_events(LABEL_SMOULDER, "Smoulder");
+}
+
+static void test_flaming_fires(void) {
+    eval_events(LABEL_FLAME, "Flame");
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_quiet_days_raise_no_alarm);
+    RUN_TEST(test_gas_leaks);
+    RUN_TEST(test_smouldering_fires);
+    RUN_TEST(test_flaming_fires);
+    return UNITY_END();
+}
@@ -0,0 +1,297 @@
+// History store (lib/History) on a RAM backend with NOR flash rules: range queries per
+// slave, downsampled means, the segment ring wrapping, remounts rebuilding the index
+// from footers and the open segment, and torn record writes
+#include <string.h>
+#include <math.h>
+#include <unity.h>
+#include "host.h"
+#include "history.h"
+
+// --- RAM Backend ---
+// Writes may only clear bits, as on NOR flash; fail_writes_after injects a backend
+// failure (a write that stops half way, like a reset mid-record).
+
+#define RAM_SEGMENTS    6
+#define RAM_SECTOR_SIZE 4096
+
+typedef struct {
+    uint8_t mem[RAM_SEGMENTS * HIST_SEGMENT_SIZE];
+    size_t size;
+    int fail_writes_after;     // Writes left before one fails half written; -1 = never
+    uint32_t nor_violations;   // Writes that tried to set a cleared bit
+} ram_flash_t;
+
+static ram_flash_t flash;
+
+static esp_err_t ram_read(void* ctx, size_t offset, void* dst, size_t len) {
+    ram_flash_t* f = ctx;
+    if (offset + len > f->size) return ESP_ERR_INVALID_ARG;
+    memcpy(dst, f->mem + offset, len);
+    return ESP_OK;
+}
+
+static esp_err_t ram_write(void* ctx, size_t offset, const void* src, size_t len) {
+    ram_flash_t* f = ctx;
+    if (offset + len > f->size) return ESP_ERR_INVALID_ARG;
+    size_t n = len;
+    esp_err_t ret = ESP_OK;
+    if (f->fail_writes_after == 0) {
+        n = len / 2;
+        ret = ESP_FAIL;
+        f->fail_writes_after = -1;
+    } else if (f->fail_writes_after > 0) {
+        f->fail_writes_after--;
+    }
+    const uint8_t* s = src;
+    for (size_t i = 0; i < n; i++) {
+        if ((f->mem[offset + i] & s[i]) != s[i]) f->nor_violations++;
+        f->mem[offset + i] &= s[i];
+    }
+    return ret;
+}
+
+static esp_err_t ram_erase(void* ctx, size_t offset, size_t len) {
+    ram_flash_t* f = ctx;
+    if (offset % RAM_SECTOR_SIZE != 0 || len % RAM_SECTOR_SIZE != 0 || offset + len > f->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(f->mem + offset, 0xFF, len);
+    return ESP_OK;
+}
+
+static hist_backend_t ram_backend(size_t segments) {
+    flash.size = segments * HIST_SEGMENT_SIZE;
+    return (hist_backend_t){ .size = flash.size, .read = ram_read, .write = ram_write, .erase = ram_erase, .ctx = &flash };
+}
+
+// --- Helpers ---
+
+#define SLAVES 8
+#define RECORDS_MAX (RAM_SEGMENTS * HIST_SEGMENT_SIZE / sizeof(hist_record_t))
+
+typedef struct {
+    uint32_t n;
+    uint32_t t[RECORDS_MAX / SLAVES];
+    bool ordered;
+    uint32_t stop_after;       // 0 = visit everything
+} visited_t;
+
+static visited_t visited;
+
+static bool visit(const hist_record_t* rec, void* ctx) {
+    visited_t* v = ctx;
+    if (v->n > 0 && rec->t < v->t[v->n - 1]) v->ordered = false;
+    if (v->n < RECORDS_MAX / SLAVES) v->t[v->n] = rec->t;
+    v->n++;
+    return v->stop_after == 0 || v->n < v->stop_after;
+}
+
+static uint32_t query(hist_store_t* store, uint8_t slave, uint32_t t0, uint32_t t1) {
+    memset(&visited, 0, sizeof(visited));
+    visited.ordered = true;
+    TEST_ASSERT_EQUAL(ESP_OK, hist_query(store, slave, t0, t1, visit, &visited));
+    TEST_ASSERT_TRUE(visited.ordered);
+    return visited.n;
+}
+
+// One record a minute from each of SLAVES slaves, for minutes [m0, m1)
+static void append_minutes(hist_store_t* store, uint32_t m0, uint32_t m1) {
+    for (uint32_t m = m0; m < m1; m++) {
+        for (uint8_t k = 0; k < SLAVES; k++) {
+            hist_record_t rec;
+            hist_record_make(&rec, m * 60, k, 20.0f + k, 50.0f, 1.5f, 2.0f, 40.0f + m % 10, m % 7 == 0);
+            TEST_ASSERT_EQUAL(ESP_OK, hist_append(store, &rec));
+        }
+    }
+}
+
+void setUp(void) {
+    memset(flash.mem, 0xFF, sizeof(flash.mem));
+    flash.fail_writes_after = -1;
+    flash.nor_violations = 0;
+}
+
+void tearDown(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, flash.nor_violations);
+}
+
+// --- Tests ---
+
+static void test_range_query_per_slave(void) {
+    hist_backend_t be = ram_backend(RAM_SEGMENTS);
+    hist_store_t* store = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, hist_open(&be, &store));
+    append_minutes(store, 0, 2000); // 16,000 records over four segments
+
+    uint32_t oldest, newest, records;
+    hist_span(store, &oldest, &newest, &records);
+    TEST_ASSERT_EQUAL_UINT32(0, oldest);
+    TEST_ASSERT_EQUAL_UINT32(1999 * 60, newest);
+    TEST_ASSERT_EQUAL_UINT32(2000 * SLAVES, records);
+
+    TEST_ASSERT_EQUAL_UINT32(2000, query(store, 3, 0, UINT32_MAX));
+    // Both ends are inclusive, also across a segment boundary
+    TEST_ASSERT_EQUAL_UINT32(301, query(store, 3, 400 * 60, 700 * 60));
+    TEST_ASSERT_EQUAL_UINT32(400 * 60, visited.t[0]);
+    TEST_ASSERT_EQUAL_UINT32(700 * 60, visited.t[300]);
+    TEST_ASSERT_EQUAL_UINT32(58, query(store, 3, 400 * 60 + 1, 459 * 60 - 1));
+    TEST_ASSERT_EQUAL_UINT32(0, query(store, 3, 2000 * 60, UINT32_MAX));
+    TEST_ASSERT_EQUAL_UINT32(0, query(store, SLAVES, 0, UINT32_MAX)); // A slave never heard from
+
+    // The visitor can stop early
+    memset(&visited, 0, sizeof(visited));
+    visited.stop_after = 5;
+    TEST_ASSERT_EQUAL(ESP_OK, hist_query(store, 3, 0, UINT32_MAX, visit, &visited));
+    TEST_ASSERT_EQUAL_UINT32(5, visited.n);
+
+    // Out-of-order appends and bad ranges are refused
+    hist_record_t rec;
+    hist_record_make(&rec, 10, 0, 20.0f, 50.0f, 1.0f, 1.0f, 1.0f, false);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, hist_append(store, &rec));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, hist_query(store, 3, 100, 99, visit, &visited));
+    hist_close(store);
+}
+
+static void test_downsampled_means(void) {
+    hist_backend_t be = ram_backend(RAM_SEGMENTS);
+    hist_store_t* store = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, hist_open(&be, &store));
+
+    // Ten minutes of one slave, a record every 30 s; then a gap; then MQ2 failing
+    for (uint32_t i = 0; i < 20; i++) {
+        hist_record_t rec;
+        hist_record_make(&rec, i * 30, 1, i % 2 ? 22.0f : 20.0f, 50.0f, 1.0f, 2.0f, (float)(10 + i), i == 3);
+        TEST_ASSERT_EQUAL(ESP_OK, hist_append(store, &rec));
+    }
+    for (uint32_t i = 0; i < 4; i++) {
+        hist_record_t rec;
+        hist_record_make(&rec, 1200 + i * 30, 1, 30.0f, 40.0f, NAN, NAN, NAN, false);
+        TEST_ASSERT_EQUAL(ESP_OK, hist_append(store, &rec));
+    }
+
+    hist_point_t points[8];
+    size_t n = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, hist_query_downsampled(store, 1, 0, 1799, 300, points, 8, &n));
+    TEST_ASSERT_EQUAL(6, n);
+    TEST_ASSERT_EQUAL_UINT32(10, points[0].count);
+    TEST_ASSERT_EQUAL_UINT32(1, points[0].motion);
+    TEST_ASSERT_EQUAL_FLOAT(21.0f, points[0].temperature);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 14.5f, points[0].smoke);     // Mean of 10..19
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 19.0f, points[0].smoke_max);
+    TEST_ASSERT_EQUAL_UINT32(300, points[1].t);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 24.5f, points[1].smoke);
+    TEST_ASSERT_EQUAL_UINT32(0, points[2].count);                // The gap
+    TEST_ASSERT_TRUE(isnan(points[2].temperature));
+    TEST_ASSERT_EQUAL_UINT32(4, points[4].count);                // DHT valid, MQ2 not
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, points[4].temperature);
+    TEST_ASSERT_TRUE(isnan(points[4].smoke));
+
+    // max_points bounds the output
+    TEST_ASSERT_EQUAL(ESP_OK, hist_query_downsampled(store, 1, 0, 1799, 60, points, 8, &n));
+    TEST_ASSERT_EQUAL(8, n);
+    TEST_ASSERT_EQUAL_UINT32(2, points[7].count);
+    hist_close(store);
+}
+
+static void test_ring_wraps_over_oldest_segment(void) {
+    hist_backend_t be = ram_backend(3);
+    hist_store_t* store = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, hist_open(&be, &store));
+    // Far more than three segments hold (at most 4096 records each)
+    append_minutes(store, 0, 4 * HIST_SEGMENT_SIZE / sizeof(hist_record_t) / SLAVES);
+
+    uint32_t oldest, newest, records;
+    hist_span(store, &oldest, &newest, &records);
+    TEST_ASSERT_TRUE(oldest > 0);
+    TEST_ASSERT_TRUE(records <= 3 * HIST_SEGMENT_SIZE / sizeof(hist_record_t));
+    TEST_ASSERT_TRUE(records > 2 * HIST_SEGMENT_SIZE / sizeof(hist_record_t) * 9 / 10);
+    // Every slave's records are there from the oldest kept minute to the newest; a
+    // segment may start part way through a minute's slaves
+    uint32_t total = 0;
+    for (uint8_t k = 0; k < SLAVES; k++) {
+        uint32_t n = query(store, k, 0, UINT32_MAX);
+        TEST_ASSERT_TRUE(visited.t[0] - oldest <= 60);
+        TEST_ASSERT_EQUAL_UINT32(newest / 60 - visited.t[0] / 60 + 1, n);
+        total += n;
+    }
+    TEST_ASSERT_EQUAL_UINT32(records, total);
+    hist_close(store);
+
+    // Too small a region for a ring
+    be = ram_backend(1);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, hist_open(&be, &store));
+}
+
+static void test_remount_rebuilds_index(void) {
+    hist_backend_t be = ram_backend(RAM_SEGMENTS);
+    hist_store_t* store = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, hist_open(&be, &store));
+    append_minutes(store, 0, 1200); // Two sealed segments and an open one
+    uint32_t oldest, newest, records;
+    hist_span(store, &oldest, &newest, &records);
+    uint32_t before = query(store, 5, 300 * 60, 1100 * 60);
+    hist_close(store); // Power cut: nothing is flushed on close
+
+    TEST_ASSERT_EQUAL(ESP_OK, hist_open(&be, &store));
+    uint32_t oldest2, newest2, records2;
+    hist_span(store, &oldest2, &newest2, &records2);
+    TEST_ASSERT_EQUAL_UINT32(oldest, oldest2);
+    TEST_ASSERT_EQUAL_UINT32(newest, newest2);
+    TEST_ASSERT_EQUAL_UINT32(records, records2);
+    TEST_ASSERT_EQUAL_UINT32(before, query(store, 5, 300 * 60, 1100 * 60));
+
+    // Appends go on in the open segment, and nothing older than its newest is taken
+    hist_record_t rec;
+    hist_record_make(&rec, 10, 0, 20.0f, 50.0f, 1.0f, 1.0f, 1.0f, false);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, hist_append(store, &rec));
+    append_minutes(store, 1200, 1300);
+    hist_close(store);
+
+    TEST_ASSERT_EQUAL(ESP_OK, hist_open(&be, &store));
+    TEST_ASSERT_EQUAL_UINT32(1300, query(store, 5, 0, UINT32_MAX));
+    hist_close(store);
+}
+
+static void test_torn_write_recovery(void) {
+    hist_backend_t be = ram_backend(RAM_SEGMENTS);
+    hist_store_t* store = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, hist_open(&be, &store));
+    append_minutes(store, 0, 100);
+
+    // A record write stops half way: that append fails, the segment is closed
+    hist_record_t rec;
+    hist_record_make(&rec, 100 * 60, 2, 25.0f, 50.0f, 1.0f, 1.0f, 1.0f, false);
+    flash.fail_writes_after = 0;
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, hist_append(store, &rec));
+    // The next one is sealed off and appends start a new segment, never rewriting the slot
+    append_minutes(store, 101, 200);
+    TEST_ASSERT_EQUAL_UINT32(199, query(store, 2, 0, UINT32_MAX));
+    TEST_ASSERT_EQUAL_UINT32(0, query(store, 2, 100 * 60, 100 * 60));
+
+    // The same after a remount: the torn slot is counted as used but never returned
+    hist_close(store);
+    TEST_ASSERT_EQUAL(ESP_OK, hist_open(&be, &store));
+    TEST_ASSERT_EQUAL_UINT32(199, query(store, 2, 0, UINT32_MAX));
+    append_minutes(store, 200, 210);
+
+    // A reset mid-record in the open segment, found by the scan at the next mount
+    hist_record_make(&rec, 210 * 60, 2, 25.0f, 50.0f, 1.0f, 1.0f, 1.0f, false);
+    flash.fail_writes_after = 0;
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, hist_append(store, &rec));
+    hist_close(store);
+    TEST_ASSERT_EQUAL(ESP_OK, hist_open(&be, &store));
+    TEST_ASSERT_EQUAL_UINT32(209, query(store, 2, 0, UINT32_MAX));
+    append_minutes(store, 211, 220);
+    TEST_ASSERT_EQUAL_UINT32(218, query(store, 2, 0, UINT32_MAX));
+    hist_close(store);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_range_query_per_slave);
+    RUN_TEST(test_downsampled_means);
+    RUN_TEST(test_ring_wraps_over_oldest_segment);
+    RUN_TEST(test_remount_rebuilds_index);
+    RUN_TEST(test_torn_write_recovery);
+    return UNITY_END();
+}
@@ -0,0 +1,315 @@
+// Access journal (lib/Journal) on a RAM backend with NOR flash rules: taps grouped into
+// commits by batch size and window, seqs counted once across a failed batch write and a
+// remount, card lookups skipping sectors by their Bloom filter, and time-range scans
+#include <string.h>
+#include <unity.h>
+#include "host.h"
+#include "journal.h"
+
+// --- RAM Backend ---
+// Writes may only clear bits, as on NOR flash; fail_writes_after injects a backend
+// failure (a write that stops half way, like a reset mid-batch).
+
+#define RAM_SECTORS     16
+#define SECTOR_RECORDS  (JOURNAL_SECTOR_SIZE / sizeof(journal_record_t) - 1) // After the header slot
+
+typedef struct {
+    uint8_t mem[RAM_SECTORS * JOURNAL_SECTOR_SIZE];
+    int fail_writes_after;     // Writes left before one fails half written; -1 = never
+    uint32_t nor_violations;   // Writes that tried to set a cleared bit
+} ram_flash_t;
+
+static ram_flash_t flash;
+
+static esp_err_t ram_read(void* ctx, size_t offset, void* dst, size_t len) {
+    ram_flash_t* f = ctx;
+    if (offset + len > sizeof(f->mem)) return ESP_ERR_INVALID_ARG;
+    memcpy(dst, f->mem + offset, len);
+    return ESP_OK;
+}
+
+static esp_err_t ram_write(void* ctx, size_t offset, const void* src, size_t len) {
+    ram_flash_t* f = ctx;
+    if (offset + len > sizeof(f->mem)) return ESP_ERR_INVALID_ARG;
+    size_t n = len;
+    esp_err_t ret = ESP_OK;
+    if (f->fail_writes_after == 0) {
+        n = len / 2;
+        ret = ESP_FAIL;
+        f->fail_writes_after = -1;
+    } else if (f->fail_writes_after > 0) {
+        f->fail_writes_after--;
+    }
+    const uint8_t* s = src;
+    for (size_t i = 0; i < n; i++) {
+        if ((f->mem[offset + i] & s[i]) != s[i]) f->nor_violations++;
+        f->mem[offset + i] &= s[i];
+    }
+    return ret;
+}
+
+static esp_err_t ram_erase(void* ctx, size_t offset, size_t len) {
+    ram_flash_t* f = ctx;
+    if (offset % JOURNAL_SECTOR_SIZE != 0 || len % JOURNAL_SECTOR_SIZE != 0 || offset + len > sizeof(f->mem)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(f->mem + offset, 0xFF, len);
+    return ESP_OK;
+}
+
+static const journal_backend_t backend = {
+    .size = sizeof(flash.mem), .read = ram_read, .write = ram_write, .erase = ram_erase, .ctx = &flash
+};
+
+// Commits only on journal_flush (a window longer than any test, a batch never reached)
+static const journal_config_t manual = { .commit_window_ms = 60000, .batch_records = JOURNAL_RAM_RECORDS,
+                                         .task_priority = 5 };
+
+// --- Helpers ---
+
+#define VISITED_MAX 512
+
+typedef struct {
+    uint32_t n;
+    journal_record_t rec[VISITED_MAX];
+} visited_t;
+
+static visited_t visited;
+static journal_t* journal;
+
+// Checks every scan comes out oldest first with no seq twice
+static bool visit(const journal_record_t* rec, void* ctx) {
+    visited_t* v = ctx;
+    if (v->n > 0) TEST_ASSERT_TRUE(rec->seq > v->rec[(v->n - 1) % VISITED_MAX].seq);
+    v->rec[v->n % VISITED_MAX] = *rec;
+    v->n++;
+    return true;
+}
+
+static uint32_t query(const uint8_t* uid, uint8_t uid_len, uint32_t t0, uint32_t t1) {
+    memset(&visited, 0, sizeof(visited));
+    TEST_ASSERT_EQUAL(ESP_OK, journal_query(journal, uid, uid_len, t0, t1, visit, &visited));
+    return visited.n;
+}
+
+static void card_uid(uint32_t card, uint8_t uid[4]) {
+    uid[0] = 0x04;
+    uid[1] = (uint8_t)card;
+    uid[2] = 0x5A;
+    uid[3] = 0xC3;
+}
+
+// Event e: card 4 * (e / SECTOR_RECORDS) + e % 4 at t = 1000 + 2e, so each sector
+// written by fill() holds four cards and a known time range
+static uint32_t event_card(uint32_t e) {
+    return 4 * (e / SECTOR_RECORDS) + e % 4;
+}
+
+static uint32_t event_t(uint32_t e) {
+    return 1000 + 2 * e;
+}
+
+static void append_event(uint32_t e) {
+    uint8_t uid[4];
+    card_uid(event_card(e), uid);
+    TEST_ASSERT_EQUAL(ESP_OK, journal_append(journal, uid, sizeof(uid), (uint8_t)(e % 3),
+                                             e % 5 == 0 ? JOURNAL_DENIED : JOURNAL_GRANTED, event_t(e)));
+}
+
+// Whole sectors of events, one commit each
+static void fill(uint32_t sectors) {
+    for (uint32_t e = 0; e < sectors * SECTOR_RECORDS; e++) {
+        append_event(e);
+        if ((e + 1) % SECTOR_RECORDS == 0) TEST_ASSERT_EQUAL(ESP_OK, journal_flush(journal));
+    }
+}
+
+static journal_stats_t stats(void) {
+    journal_stats_t st;
+    journal_get_stats(journal, &st);
+    return st;
+}
+
+// Waits up to 2 s for the commit task to have committed n events
+static void wait_committed(uint32_t n) {
+    for (int i = 0; i < 200 && stats().committed < n; i++) vTaskDelay(pdMS_TO_TICKS(10));
+    TEST_ASSERT_EQUAL_UINT32(n, stats().committed);
+}
+
+void setUp(void) {
+    memset(flash.mem, 0xFF, sizeof(flash.mem));
+    flash.fail_writes_after = -1;
+    flash.nor_violations = 0;
+    journal = NULL;
+}
+
+void tearDown(void) {
+    journal_close(journal);
+    TEST_ASSERT_EQUAL_UINT32(0, flash.nor_violations);
+}
+
+// --- Tests ---
+
+static void test_commits_group_by_batch_and_window(void) {
+    const journal_config_t cfg = { .commit_window_ms = 100, .batch_records = 8, .task_priority = 5 };
+    TEST_ASSERT_EQUAL(ESP_OK, journal_open(&backend, &cfg, &journal));
+
+    // A full batch is committed at once, in one write
+    for (uint32_t e = 0; e < 8; e++) append_event(e);
+    wait_committed(8);
+    journal_stats_t st = stats();
+    TEST_ASSERT_EQUAL_UINT32(1, st.commits);
+    TEST_ASSERT_EQUAL_UINT32(0, st.pending);
+
+    // A short batch waits out the window; meanwhile scans see it in RAM
+    for (uint32_t e = 8; e < 11; e++) append_event(e);
+    TEST_ASSERT_EQUAL_UINT32(11, query(NULL, 0, 0, UINT32_MAX));
+    TEST_ASSERT_EQUAL_UINT32(8, stats().committed);
+    wait_committed(11);
+    st = stats();
+    TEST_ASSERT_EQUAL_UINT32(2, st.commits);
+    TEST_ASSERT_TRUE(st.window_ms_max >= cfg.commit_window_ms);
+    TEST_ASSERT_EQUAL_UINT32(11, st.records);
+    TEST_ASSERT_EQUAL_UINT32(11, query(NULL, 0, 0, UINT32_MAX));
+    TEST_ASSERT_EQUAL_UINT32(10, visited.rec[10].seq);
+    journal_close(journal);
+
+    // A flush commits whatever waits in one write per sector it touches
+    TEST_ASSERT_EQUAL(ESP_OK, journal_open(&backend, &manual, &journal));
+    for (uint32_t e = 11; e < 11 + 120; e++) append_event(e);
+    TEST_ASSERT_EQUAL_UINT32(0, stats().commits);
+    TEST_ASSERT_EQUAL(ESP_OK, journal_flush(journal));
+    st = stats();
+    TEST_ASSERT_EQUAL_UINT32(2, st.commits); // 116 slots left in the first sector, 4 in the next
+    TEST_ASSERT_EQUAL_UINT32(131, st.records);
+
+    // Bad arguments are refused without touching the buffer
+    uint8_t uid[JOURNAL_UID_MAX + 1] = { 0 };
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, journal_append(journal, uid, 0, 0, JOURNAL_GRANTED, 0));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, journal_append(journal, uid, sizeof(uid), 0, JOURNAL_GRANTED, 0));
+    TEST_ASSERT_EQUAL_UINT32(120, stats().appended);
+}
+
+static void test_seq_counted_once_across_failed_write_and_remount(void) {
+    TEST_ASSERT_EQUAL(ESP_OK, journal_open(&backend, &manual, &journal));
+    for (uint32_t e = 0; e < 10; e++) append_event(e);
+    TEST_ASSERT_EQUAL(ESP_OK, journal_flush(journal));
+
+    // The next batch write stops half way: four events land intact and one is torn. The
+    // batch stays in RAM and goes whole to a fresh sector on the next commit.
+    for (uint32_t e = 10; e < 19; e++) append_event(e);
+    flash.fail_writes_after = 0;
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, journal_flush(journal));
+    TEST_ASSERT_EQUAL_UINT32(9, stats().pending);
+    TEST_ASSERT_EQUAL_UINT32(19, query(NULL, 0, 0, UINT32_MAX));
+    TEST_ASSERT_EQUAL(ESP_OK, journal_flush(journal));
+    journal_stats_t st = stats();
+    TEST_ASSERT_EQUAL_UINT32(1, st.write_errors);
+    TEST_ASSERT_EQUAL_UINT32(19, st.records);
+    TEST_ASSERT_EQUAL_UINT32(19, query(NULL, 0, 0, UINT32_MAX));
+    for (uint32_t i = 0; i < 19; i++) TEST_ASSERT_EQUAL_UINT32(i, visited.rec[i].seq);
+    journal_close(journal);
+
+    // Mounting again indexes the first copy of each event only, and numbering goes on
+    // after the highest seq on flash
+    TEST_ASSERT_EQUAL(ESP_OK, journal_open(&backend, &manual, &journal));
+    TEST_ASSERT_EQUAL_UINT32(19, stats().records);
+    TEST_ASSERT_EQUAL_UINT32(19, query(NULL, 0, 0, UINT32_MAX));
+    uint8_t uid[4];
+    card_uid(event_card(12), uid);
+    TEST_ASSERT_EQUAL_UINT32(5, query(uid, sizeof(uid), 0, UINT32_MAX)); // 12 was written twice
+    TEST_ASSERT_EQUAL_UINT32(16, visited.rec[4].seq);
+    append_event(19);
+    TEST_ASSERT_EQUAL(ESP_OK, journal_flush(journal));
+    journal_close(journal);
+
+    TEST_ASSERT_EQUAL(ESP_OK, journal_open(&backend, &manual, &journal));
+    TEST_ASSERT_EQUAL_UINT32(20, query(NULL, 0, 0, UINT32_MAX));
+    TEST_ASSERT_EQUAL_UINT32(19, visited.rec[19].seq);
+    TEST_ASSERT_EQUAL_UINT32(event_t(19), visited.rec[19].t);
+}
+
+static void test_card_lookup_skips_sectors_by_filter(void) {
+    TEST_ASSERT_EQUAL(ESP_OK, journal_open(&backend, &manual, &journal));
+    fill(12);
+
+    // Card 21 taps only in the sector of events 5 * SECTOR_RECORDS onwards
+    uint8_t uid[4];
+    card_uid(21, uid);
+    uint32_t expected = 0;
+    for (uint32_t e = 0; e < 12 * SECTOR_RECORDS; e++) expected += event_card(e) == 21;
+    journal_stats_t before = stats();
+    TEST_ASSERT_EQUAL_UINT32(expected, query(uid, sizeof(uid), 0, UINT32_MAX));
+    journal_stats_t after = stats();
+    TEST_ASSERT_TRUE(after.scan_sectors_read - before.scan_sectors_read <= 2);
+    TEST_ASSERT_TRUE(after.scan_sectors_skipped - before.scan_sectors_skipped >= 10);
+    for (uint32_t i = 0; i < visited.n; i++) {
+        const journal_record_t* rec = &visited.rec[i];
+        TEST_ASSERT_EQUAL(4, rec->uid_len);
+        TEST_ASSERT_EQUAL_MEMORY(uid, rec->uid, 4);
+        TEST_ASSERT_EQUAL(rec->seq % 3, rec->reader);
+        TEST_ASSERT_EQUAL(rec->seq % 5 == 0 ? JOURNAL_DENIED : JOURNAL_GRANTED, rec->decision);
+        TEST_ASSERT_EQUAL_UINT32(event_t(rec->seq), rec->t);
+    }
+
+    // A card never seen reads next to nothing; a longer UID with the same first bytes
+    // is another card
+    card_uid(200, uid);
+    before = stats();
+    TEST_ASSERT_EQUAL_UINT32(0, query(uid, sizeof(uid), 0, UINT32_MAX));
+    after = stats();
+    TEST_ASSERT_TRUE(after.scan_sectors_read - before.scan_sectors_read <= 1);
+    uint8_t uid7[7] = { 0 };
+    card_uid(21, uid7);
+    TEST_ASSERT_EQUAL_UINT32(0, query(uid7, sizeof(uid7), 0, UINT32_MAX));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, journal_query(journal, uid7, 0, 0, UINT32_MAX, visit, &visited));
+
+    // The index is rebuilt on mount: the same answer after a remount
+    journal_close(journal);
+    TEST_ASSERT_EQUAL(ESP_OK, journal_open(&backend, &manual, &journal));
+    card_uid(21, uid);
+    before = stats();
+    TEST_ASSERT_EQUAL_UINT32(expected, query(uid, sizeof(uid), 0, UINT32_MAX));
+    after = stats();
+    TEST_ASSERT_TRUE(after.scan_sectors_read - before.scan_sectors_read <= 2);
+}
+
+static void test_time_range_scan(void) {
+    TEST_ASSERT_EQUAL(ESP_OK, journal_open(&backend, &manual, &journal));
+    fill(12);
+
+    // Both ends inclusive, across a sector boundary; only the sectors in range are read
+    journal_stats_t before = stats();
+    TEST_ASSERT_EQUAL_UINT32(101, query(NULL, 0, event_t(200), event_t(300)));
+    journal_stats_t after = stats();
+    TEST_ASSERT_EQUAL_UINT32(200, visited.rec[0].seq);
+    TEST_ASSERT_EQUAL_UINT32(300, visited.rec[100].seq);
+    TEST_ASSERT_EQUAL_UINT32(2, after.scan_sectors_read - before.scan_sectors_read);
+    TEST_ASSERT_EQUAL_UINT32(10, after.scan_sectors_skipped - before.scan_sectors_skipped);
+    TEST_ASSERT_EQUAL_UINT32(99, query(NULL, 0, event_t(200) + 1, event_t(300) - 1));
+    TEST_ASSERT_EQUAL_UINT32(0, query(NULL, 0, event_t(12 * SECTOR_RECORDS), UINT32_MAX));
+    TEST_ASSERT_EQUAL_UINT32(0, query(NULL, 0, 0, event_t(0) - 1));
+
+    // By card and time together
+    uint8_t uid[4];
+    card_uid(event_card(250), uid);
+    uint32_t expected = 0;
+    for (uint32_t e = 200; e <= 300; e++) expected += event_card(e) == event_card(250);
+    TEST_ASSERT_EQUAL_UINT32(expected, query(uid, sizeof(uid), event_t(200), event_t(300)));
+    TEST_ASSERT_EQUAL_UINT32(202, visited.rec[0].seq);
+
+    // Events still in RAM come after those on flash
+    for (uint32_t e = 12 * SECTOR_RECORDS; e < 12 * SECTOR_RECORDS + 5; e++) append_event(e);
+    TEST_ASSERT_EQUAL_UINT32(7, query(NULL, 0, event_t(12 * SECTOR_RECORDS - 2), UINT32_MAX));
+    TEST_ASSERT_EQUAL_UINT32(12 * SECTOR_RECORDS + 4, visited.rec[6].seq);
+    TEST_ASSERT_EQUAL_UINT32(5, stats().pending);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_commits_group_by_batch_and_window);
+    RUN_TEST(test_seq_counted_once_across_failed_write_and_remount);
+    RUN_TEST(test_card_lookup_skips_sectors_by_filter);
+    RUN_TEST(test_time_range_scan);
+    return UNITY_END();
+}
@@ -0,0 +1,248 @@
+// The live API over loopback: a whole fleet of stream clients, snapshots and error replies
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unity.h>
+#include "host.h"
+#include "live.h"
+
+#define STREAM_CLIENTS 63       // Plus one for snapshot requests: a full LIVE_MAX_SLAVES fleet of 64
+#define PUSH_DEADLINE_US 100000 // As bench.c's live load test: the fewest clients supported is STREAM_CLIENTS
+#define CLIENT_BUF     (48 * 1024)
+
+static uint16_t port;
+static live_server_t* server;
+
+typedef struct {
+    int fd;
+    size_t len;
+    char buf[CLIENT_BUF];
+} client_t;
+
+static client_t clients[STREAM_CLIENTS];
+
+// A port nothing listens on: bind to 0, read it back, release it
+static uint16_t free_port(void) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t len = sizeof(addr);
+    TEST_ASSERT_EQUAL(0, bind(fd, (struct sockaddr*)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL(0, getsockname(fd, (struct sockaddr*)&addr, &len));
+    close(fd);
+    return ntohs(addr.sin_port);
+}
+
+static void start(uint8_t max_clients) {
+    port = free_port();
+    const live_config_t cfg = { .port = port, .max_clients = max_clients, .task_priority = 5 };
+    TEST_ASSERT_EQUAL(ESP_OK, live_start(&cfg, &server));
+}
+
+// Reads time out after 5 s
+static void client_connect(client_t* c) {
+    c->len = 0;
+    c->buf[0] = '\0';
+    c->fd = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, c->fd);
+    struct timeval tv = { .tv_sec = 5 };
+    setsockopt(c->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port),
+                                .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    TEST_ASSERT_EQUAL(0, connect(c->fd, (struct sockaddr*)&addr, sizeof(addr)));
+}
+
+static void client_open(client_t* c, const char* request) {
+    client_connect(c);
+    TEST_ASSERT_EQUAL((ssize_t)strlen(request), send(c->fd, request, strlen(request), MSG_NOSIGNAL));
+}
+
+static size_t count(const client_t* c, const char* needle) {
+    size_t n = 0;
+    for (const char* p = c->buf; (p = strstr(p, needle)) != NULL; p += strlen(needle)) n++;
+    return n;
+}
+
+// Reads until needle occurs times times (NULL: until the server closes), or the read times out
+static void client_read_until(client_t* c, const char* needle, size_t times) {
+    while ((needle == NULL || count(c, needle) < times) && c->len < CLIENT_BUF - 1) {
+        ssize_t n = recv(c->fd, c->buf + c->len, CLIENT_BUF - 1 - c->len, 0);
+        if (n <= 0) break;
+        c->len += (size_t)n;
+        c->buf[c->len] = '\0';
+    }
+}
+
+static void client_close(client_t* c) {
+    if (c->fd >= 0) close(c->fd);
+    c->fd = -1;
+}
+
+static live_stats_t stats(void) {
+    live_stats_t st;
+    live_get_stats(server, &st);
+    return st;
+}
+
+// Polls the server's stats until field reaches want (or 5 s pass)
+#define WAIT_FOR(field, want)                                                    \
+    do {                                                                         \
+        for (int i_ = 0; i_ < 500 && stats().field < (want); i_++) usleep(10000); \
+        TEST_ASSERT_GREATER_OR_EQUAL((want), stats().field);                     \
+    } while (0)
+
+static live_reading_t reading(uint8_t slave, float temperature) {
+    return (live_reading_t){
+        .mac = { 0x02, 0, 0, 0, 0, slave },
+        .timestamp_ms = 1000u + slave,
+        .temperature = temperature,
+        .humidity = 40.0f,
+        .lpg_ppm = NAN,
+        .co_ppm = NAN,
+        .smoke_ppm = 1.5f,
+        .motion = slave % 2 == 0,
+    };
+}
+
+// A request answered with Connection: close
+static void get(client_t* c, const char* request) {
+    client_open(c, request);
+    client_read_until(c, NULL, 0);
+}
+
+void setUp(void) {
+    server = NULL;
+    for (int i = 0; i < STREAM_CLIENTS; i++) clients[i].fd = -1;
+}
+
+void tearDown(void) {
+    for (int i = 0; i < STREAM_CLIENTS; i++) client_close(&clients[i]);
+    live_stop(server);
+}
+
+static void test_every_stream_gets_every_update(void) {
+    start(STREAM_CLIENTS + 1);
+    // One at a time: the listen backlog is short, and a dropped SYN costs a second's retransmit
+    for (int i = 0; i < STREAM_CLIENTS; i++) {
+        client_open(&clients[i], "GET /api/events HTTP/1.1\r\nHost: master\r\n\r\n");
+        WAIT_FOR(streams, (uint32_t)i + 1);
+    }
+    for (int i = 0; i < STREAM_CLIENTS; i++) {
+        client_read_until(&clients[i], "event: snapshot\n", 1);
+        TEST_ASSERT_EQUAL(0, strncmp(clients[i].buf, "HTTP/1.1 200 OK\r\n", 17));
+        TEST_ASSERT_NOT_NULL(strstr(clients[i].buf, "Content-Type: text/event-stream\r\n"));
+    }
+
+    // One update at a time, each pushed to every stream before the next and within the deadline
+    for (int slave = 0; slave < LIVE_MAX_SLAVES; slave++) {
+        live_reading_t r = reading((uint8_t)slave, 20.0f + slave);
+        int64_t start = esp_timer_get_time();
+        TEST_ASSERT_EQUAL(ESP_OK, live_update(server, (uint8_t)slave, &r));
+        WAIT_FOR(events_pushed, (uint32_t)STREAM_CLIENTS * (slave + 1));
+        TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(PUSH_DEADLINE_US, (int)(esp_timer_get_time() - start), "push missed the deadline");
+    }
+    for (int i = 0; i < STREAM_CLIENTS; i++) {
+        client_read_until(&clients[i], "event: slave\n", LIVE_MAX_SLAVES);
+        TEST_ASSERT_EQUAL(LIVE_MAX_SLAVES, count(&clients[i], "event: slave\n"));
+        TEST_ASSERT_NOT_NULL(strstr(clients[i].buf, "{\"id\":63,\"mac\":\"02:00:00:00:00:3f\",\"t\":1063,"
+                                                    "\"temp\":83.0,\"hum\":40.0,\"lpg\":null,\"co\":null,"
+                                                    "\"smoke\":1.5,\"motion\":false,\"alarm\":0}"));
+    }
+
+    live_stats_t st = stats();
+    TEST_ASSERT_EQUAL_UINT32(STREAM_CLIENTS, st.streams);
+    TEST_ASSERT_EQUAL_UINT32(LIVE_MAX_SLAVES, st.updates);
+    TEST_ASSERT_EQUAL_UINT32(0, st.resyncs);
+    TEST_ASSERT_EQUAL_UINT32(0, st.rejected);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(PUSH_DEADLINE_US, st.push_latency_max_us);
+
+    // The 64th connection reads the whole fleet from the snapshot
+    client_t* snap = malloc(sizeof(client_t));
+    get(snap, "GET /api/snapshot HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL(0, strncmp(snap->buf, "HTTP/1.1 200 OK\r\n", 17));
+    char expect[48];
+    snprintf(expect, sizeof(expect), "Content-Length: %u\r\n", (unsigned)st.snapshot_bytes);
+    TEST_ASSERT_NOT_NULL(strstr(snap->buf, expect));
+    const char* body = strstr(snap->buf, "\r\n\r\n") + 4;
+    TEST_ASSERT_EQUAL(st.snapshot_bytes, strlen(body));
+    TEST_ASSERT_EQUAL(LIVE_MAX_SLAVES, count(snap, "{\"id\":"));
+    TEST_ASSERT_NOT_NULL(strstr(body, "],\"t\":1063}"));
+    client_close(snap);
+    free(snap);
+}
+
+static void test_snapshot_is_patched_in_place(void) {
+    start(2);
+    for (int slave = LIVE_MAX_SLAVES - 1; slave >= 0; slave -= 3) {
+        live_reading_t r = reading((uint8_t)slave, 10.0f);
+        TEST_ASSERT_EQUAL(ESP_OK, live_update(server, (uint8_t)slave, &r));
+    }
+    live_reading_t r = reading(6, -5.5f); // A longer fragment in the middle of the array
+    r.lpg_ppm = 12345.0f;
+    TEST_ASSERT_EQUAL(ESP_OK, live_update(server, 6, &r));
+
+    client_t* snap = malloc(sizeof(client_t));
+    get(snap, "GET /api/snapshot HTTP/1.1\r\n\r\n");
+    const char* body = strstr(snap->buf, "\r\n\r\n") + 4;
+    TEST_ASSERT_EQUAL(stats().snapshot_bytes, strlen(body));
+    // Slaves in index order, each once, the patched one with its new values
+    const char* p = body;
+    for (int slave = 0; slave < LIVE_MAX_SLAVES; slave++) {
+        char id[16];
+        snprintf(id, sizeof(id), "{\"id\":%d,", slave);
+        const char* at = strstr(body, id);
+        if ((LIVE_MAX_SLAVES - 1 - slave) % 3 != 0) {
+            TEST_ASSERT_NULL(at);
+            continue;
+        }
+        TEST_ASSERT_NOT_NULL(at);
+        TEST_ASSERT_TRUE(at > p);
+        p = at;
+    }
+    TEST_ASSERT_NOT_NULL(strstr(body, "{\"id\":6,\"mac\":\"02:00:00:00:00:06\",\"t\":1006,\"temp\":-5.5,"
+                                      "\"hum\":40.0,\"lpg\":12345.0,"));
+    TEST_ASSERT_EQUAL(1, count(snap, "{\"id\":6,"));
+    client_close(snap);
+    free(snap);
+}
+
+static void test_full_server_answers_503(void) {
+    start(2);
+    client_open(&clients[0], "GET /api/events HTTP/1.1\r\n\r\n");
+    client_open(&clients[1], "GET /api/events HTTP/1.1\r\n\r\n");
+    WAIT_FOR(streams, 2);
+    client_connect(&clients[2]); // Turned away at accept, before any request
+    client_read_until(&clients[2], NULL, 0);
+    TEST_ASSERT_EQUAL(0, strncmp(clients[2].buf, "HTTP/1.1 503 ", 13));
+    TEST_ASSERT_EQUAL_UINT32(1, stats().rejected);
+
+    // A stream leaving frees its place
+    client_close(&clients[0]);
+    for (int i = 0; i < 500 && stats().clients > 1; i++) usleep(10000);
+    client_close(&clients[2]);
+    get(&clients[2], "GET /api/snapshot HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL(0, strncmp(clients[2].buf, "HTTP/1.1 200 OK\r\n", 17));
+}
+
+static void test_unknown_path_and_method(void) {
+    start(4);
+    get(&clients[0], "GET /api/nope HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL(0, strncmp(clients[0].buf, "HTTP/1.1 404 ", 13));
+    get(&clients[1], "POST /api/snapshot HTTP/1.1\r\nContent-Length: 0\r\n\r\n");
+    TEST_ASSERT_EQUAL(0, strncmp(clients[1].buf, "HTTP/1.1 405 ", 13));
+    TEST_ASSERT_NOT_NULL(strstr(clients[1].buf, "Allow: GET\r\n"));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_every_stream_gets_every_update);
+    RUN_TEST(test_snapshot_is_patched_in_place);
+    RUN_TEST(test_full_server_answers_503);
+    RUN_TEST(test_unknown_path_and_method);
+    return UNITY_END();
+}
@@ -0,0 +1,255 @@
+// Cross-slave motion correlation (lib/Motion): one walk down an aisle reported hop by
+// hop with heading and speed, PIR retriggers absorbed, impossible hops refused; then
+// one to five people walking a warehouse grid at random, where the share of their hops
+// reported and the alerts that report no hop anyone made must stay within fixed bounds
+#include <math.h>
+#include <unity.h>
+#include "host.h"
+#include "motion.h"
+
+static const char *TAG = "MOTION_SIM";
+
+// A warehouse of SIM_SIDE x SIM_SIDE aisle sections 10 m apart, one PIR each, as in
+// bench.c. Each person stays 5-10 s in a section, then walks to a random neighbour
+// (not straight back if there is a choice). A PIR reports every SIM_HIT_MS while
+// someone is in its section and keeps retriggering for SIM_TRAIL_MS after they leave.
+#define SIM_SIDE        8
+#define SIM_ZONES       (SIM_SIDE * SIM_SIDE)
+#define SIM_RUN_S       600
+#define SIM_STEP_MS     250
+#define SIM_HIT_MS      1000
+#define SIM_TRAIL_MS    2000
+#define SIM_HOPS_MAX    1024
+#define SIM_MAX_PEOPLE  5
+#define SIM_SEEDS       8
+
+// Per crowd size: the least share of hops made that must be reported with their zones
+// and time, and the most of the reported hops that nobody made. People meeting merge
+// into one track and split as it suits the engine, so crowds get more slack.
+static const struct {
+    int people;
+    int tracked_pct;
+    int wrong_pct;
+} crowds[] = {
+    { 1, 98, 1 },
+    { 2, 90, 4 },
+    { 3, 85, 5 },               // bench.c's replay
+    { SIM_MAX_PEOPLE, 70, 10 },
+};
+
+static const motion_config_t sim_cfg = { .dwell_ms = 3000, .track_timeout_ms = 30000, .alert_zones = 2 };
+
+typedef struct {
+    uint16_t from;
+    uint16_t to;
+    int64_t t_ms;
+} hop_t;
+
+typedef struct {
+    hop_t hops[SIM_HOPS_MAX];
+    int n;
+} hops_t;
+
+static hops_t truth, alerted;
+static motion_alert_t alerts[16];
+static int alert_count;
+static uint32_t rng_state;
+
+static uint32_t rng_next(uint32_t n) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (rng_state >> 8) % n;
+}
+
+static void hop_add(hops_t *h, uint16_t from, uint16_t to, int64_t t_ms) {
+    if (h->n < SIM_HOPS_MAX) h->hops[h->n++] = (hop_t){ from, to, t_ms };
+}
+
+static void record_alert(void *ctx, const motion_alert_t *alert) {
+    if (alert_count < 16) alerts[alert_count++] = *alert;
+    if (alert->kind != MOTION_ALERT_END) hop_add(&alerted, alert->from, alert->to, alert->t_ms);
+}
+
+static motion_engine_t *grid_create(void) {
+    static motion_edge_t edges[2 * SIM_SIDE * (SIM_SIDE - 1)];
+    static motion_pos_t pos[SIM_ZONES];
+    uint16_t n = 0;
+    for (int z = 0; z < SIM_ZONES; z++) {
+        int row = z / SIM_SIDE, col = z % SIM_SIDE;
+        pos[z] = (motion_pos_t){ col * 10.0f, row * 10.0f };
+        if (col + 1 < SIM_SIDE) edges[n++] = (motion_edge_t){ z, z + 1, 3000, 20000 };
+        if (row + 1 < SIM_SIDE) edges[n++] = (motion_edge_t){ z, z + SIM_SIDE, 3000, 20000 };
+    }
+    motion_engine_t *engine = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, motion_create(edges, n, pos, SIM_ZONES, &sim_cfg, &engine));
+    motion_set_alert_cb(engine, record_alert, NULL);
+    return engine;
+}
+
+static uint16_t grid_next(uint16_t zone, uint16_t prev) {
+    uint16_t cand[4];
+    int n = 0;
+    int row = zone / SIM_SIDE, col = zone % SIM_SIDE;
+    if (col > 0) cand[n++] = zone - 1;
+    if (col + 1 < SIM_SIDE) cand[n++] = zone + 1;
+    if (row > 0) cand[n++] = zone - SIM_SIDE;
+    if (row + 1 < SIM_SIDE) cand[n++] = zone + SIM_SIDE;
+    for (;;) {
+        uint16_t next = cand[rng_next(n)];
+        if (next != prev || n == 1) return next;
+    }
+}
+
+// Walks people through the grid; returns how many of their hops were reported exactly
+static int sim_run(int people, uint32_t seed) {
+    motion_engine_t *engine = grid_create();
+    truth.n = alerted.n = 0;
+    rng_state = seed;
+
+    struct {
+        uint16_t zone, prev;
+        int64_t leave_ms, next_hit_ms, trail_until_ms, next_trail_ms;
+    } walkers[SIM_MAX_PEOPLE];
+    for (int w = 0; w < people; w++) {
+        walkers[w].zone = walkers[w].prev = (uint16_t)rng_next(SIM_ZONES);
+        walkers[w].leave_ms = 5000 + rng_next(5000);
+        walkers[w].next_hit_ms = 0;
+        walkers[w].trail_until_ms = walkers[w].next_trail_ms = -1;
+    }
+
+    for (int64_t t = 0; t < SIM_RUN_S * 1000LL; t += SIM_STEP_MS) {
+        for (int w = 0; w < people; w++) {
+            if (t >= walkers[w].leave_ms) {
+                uint16_t next = grid_next(walkers[w].zone, walkers[w].prev);
+                hop_add(&truth, walkers[w].zone, next, t);
+                walkers[w].prev = walkers[w].zone;
+                walkers[w].zone = next;
+                walkers[w].leave_ms = t + 5000 + rng_next(5000);
+                walkers[w].next_hit_ms = t;
+                walkers[w].trail_until_ms = t + SIM_TRAIL_MS;
+                walkers[w].next_trail_ms = t + SIM_HIT_MS;
+            }
+            if (t >= walkers[w].next_hit_ms) {
+                motion_ingest(engine, walkers[w].zone, t);
+                walkers[w].next_hit_ms += SIM_HIT_MS;
+            }
+            if (t <= walkers[w].trail_until_ms && t >= walkers[w].next_trail_ms) {
+                motion_ingest(engine, walkers[w].prev, t);
+                walkers[w].next_trail_ms += SIM_HIT_MS;
+            }
+        }
+        if (t % 5000 == 0) motion_tick(engine, t);
+    }
+    motion_destroy(engine);
+
+    int tracked = 0;
+    for (int i = 0; i < truth.n; i++) {
+        for (int j = 0; j < alerted.n; j++) {
+            const hop_t *a = &truth.hops[i], *b = &alerted.hops[j];
+            if (a->from == b->from && a->to == b->to && a->t_ms == b->t_ms) {
+                tracked++;
+                break;
+            }
+        }
+    }
+    return tracked;
+}
+
+void setUp(void) {
+    esp_log_level_set(TAG, ESP_LOG_INFO);
+    alert_count = 0;
+    truth.n = alerted.n = 0;
+}
+
+void tearDown(void) {}
+
+static void test_walk_down_an_aisle(void) {
+    motion_engine_t *engine = grid_create();
+
+    // 0 -> 1 -> 2 along the first row, 6 s per section, the PIR behind retriggering 2 s
+    for (int64_t t = 0; t < 6000; t += 1000) motion_ingest(engine, 0, t);
+    TEST_ASSERT_EQUAL(0, alert_count); // One zone is not a path yet
+    for (int64_t t = 6000; t < 12000; t += 1000) {
+        motion_ingest(engine, 1, t);
+        if (t > 6000 && t <= 8000) motion_ingest(engine, 0, t);
+    }
+    motion_ingest(engine, 2, 12000);
+
+    TEST_ASSERT_EQUAL(2, alert_count);
+    TEST_ASSERT_EQUAL(MOTION_ALERT_PATH, alerts[0].kind);
+    TEST_ASSERT_EQUAL(0, alerts[0].from);
+    TEST_ASSERT_EQUAL(1, alerts[0].to);
+    TEST_ASSERT_EQUAL_INT64(6000, alerts[0].t_ms);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 90.0f, alerts[0].heading_deg); // +x
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 10.0f / 6.0f, alerts[0].speed_m_s);
+    TEST_ASSERT_EQUAL(MOTION_ALERT_MOVE, alerts[1].kind);
+    TEST_ASSERT_EQUAL(alerts[0].track_id, alerts[1].track_id);
+    TEST_ASSERT_EQUAL(3, alerts[1].path_len);
+    TEST_ASSERT_EQUAL(0, alerts[1].path[0]);
+    TEST_ASSERT_EQUAL(2, alerts[1].path[2]);
+
+    motion_stats_t st;
+    motion_get_stats(engine, &st);
+    TEST_ASSERT_EQUAL_UINT32(1, st.tracks_started); // The retriggers started no one new
+    TEST_ASSERT_EQUAL_UINT32(2, st.absorbed);
+
+    // Quiet for the timeout: the track ends, reported at its last hit
+    motion_tick(engine, 12000 + sim_cfg.track_timeout_ms + 1);
+    TEST_ASSERT_EQUAL(3, alert_count);
+    TEST_ASSERT_EQUAL(MOTION_ALERT_END, alerts[2].kind);
+    TEST_ASSERT_EQUAL_INT64(12000, alerts[2].t_ms);
+    motion_destroy(engine);
+}
+
+static void test_refuses_impossible_hops(void) {
+    motion_engine_t *engine = grid_create();
+
+    motion_ingest(engine, 0, 0);
+    motion_ingest(engine, 1, 1000);  // Faster than the edge's 3 s walk: someone else
+    motion_ingest(engine, 20, 5000);
+    motion_ingest(engine, 29, 9000); // Diagonally across from 20: no edge
+    motion_ingest(engine, 8, 30000); // Next to 0, but longer after than the edge's 20 s
+    TEST_ASSERT_EQUAL(0, alert_count);
+    motion_stats_t st;
+    motion_get_stats(engine, &st);
+    TEST_ASSERT_EQUAL_UINT32(5, st.tracks_started);
+    TEST_ASSERT_EQUAL_UINT32(0, st.moves);
+    motion_destroy(engine);
+
+    // Malformed graphs and configs
+    const motion_edge_t loop = { 2, 2, 1000, 2000 };
+    const motion_edge_t slow = { 1, 2, 3000, 2000 };
+    const motion_config_t single = { .dwell_ms = 3000, .track_timeout_ms = 30000, .alert_zones = 1 };
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, motion_create(&loop, 1, NULL, 4, &sim_cfg, &engine));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, motion_create(&slow, 1, NULL, 4, &sim_cfg, &engine));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, motion_create(&slow, 1, NULL, 2, &sim_cfg, &engine));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, motion_create(NULL, 0, NULL, 4, &single, &engine));
+}
+
+static void test_people_walking_the_grid(void) {
+    ESP_LOGI(TAG, "%dx%d sections, %d s, %d seeds; hops made, reported (%%), reported wrong (%%):",
+             SIM_SIDE, SIM_SIDE, SIM_RUN_S, SIM_SEEDS);
+    for (size_t c = 0; c < sizeof(crowds) / sizeof(crowds[0]); c++) {
+        int made = 0, tracked = 0, reported = 0;
+        for (uint32_t seed = 0; seed < SIM_SEEDS; seed++) {
+            tracked += sim_run(crowds[c].people, 12345 + seed);
+            made += truth.n;
+            reported += alerted.n;
+            TEST_ASSERT_LESS_THAN(SIM_HOPS_MAX, truth.n);
+            TEST_ASSERT_LESS_THAN(SIM_HOPS_MAX, alerted.n);
+        }
+        int wrong = reported - tracked;
+        ESP_LOGI(TAG, "%d people: %5d hops, %5d (%5.1f%%), %4d (%4.1f%%)", crowds[c].people, made, tracked,
+                 100.0 * tracked / made, wrong, 100.0 * wrong / (reported ? reported : 1));
+
+        TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE(crowds[c].tracked_pct * made, 100 * tracked, "share of hops reported");
+        TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(crowds[c].wrong_pct * reported, 100 * wrong, "reported hops nobody made");
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_walk_down_an_aisle);
+    RUN_TEST(test_refuses_impossible_hops);
+    RUN_TEST(test_people_walking_the_grid);
+    return UNITY_END();
+}
@@ -0,0 +1,133 @@
+// MQ2 Ro drift tracking (lib/MQ2): the median of hourly clean-air peaks, slew-limited and
+// kept near calibration, and readings through a modelled sensor (mq2_init_source)
+#include <unity.h>
+#include "host.h"
+#include "MQ2.h"
+
+#define BUCKET_READINGS 13 // A reading every 5 min; the one an hour after the first closes the bucket
+
+static MQ2 mq2;
+static int adc_raw;
+static uint64_t clock_ms;
+
+static esp_err_t test_convert(void* ctx, int* raw) {
+    if (adc_raw <= 0) return ESP_ERR_TIMEOUT;
+    *raw = adc_raw;
+    return ESP_OK;
+}
+
+static uint64_t test_now_ms(void* ctx) {
+    return clock_ms;
+}
+
+// One bucket whose cleanest reading is peak; returns whether closing it moved Ro
+static bool feed_bucket(float peak, int readings) {
+    bool changed = false;
+    for (int i = 0; i < readings; i++) {
+        changed = mq2_ro_track(&mq2, i == readings / 2 ? peak : peak * 0.8f, clock_ms);
+        if (i < readings - 1) clock_ms += MQ2_RO_BUCKET_MS / (readings - 1);
+    }
+    clock_ms += 1000;
+    return changed;
+}
+
+// The clean-air Rs that makes ro the tracker's target
+static float peak_for(float ro) {
+    return ro * RO_CLEAN_AIR_FACTOR;
+}
+
+void setUp(void) {
+    const mq2_source_t source = { .read = test_convert, .now_ms = test_now_ms };
+    clock_ms = 1000;
+    adc_raw = 200; // Rs = 5 * 3895 / 200 = 97.4 kOhm, Ro = 97.4 / 9.83
+    TEST_ASSERT_EQUAL(ESP_OK, mq2_init_source(&mq2, &source));
+    TEST_ASSERT_TRUE(mq2_begin(&mq2));
+}
+
+void tearDown(void) {
+    mq2_deinit(&mq2);
+}
+
+static void test_calibrates_and_reads_through_source(void) {
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 5.0f * 3895.0f / 200.0f / RO_CLEAN_AIR_FACTOR, mq2.Ro);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, mq2.Ro, mq2.ro_track.ro_calibrated);
+
+    mq2_snapshot_t snap;
+    TEST_ASSERT_FALSE(mq2_snapshot(&mq2, &snap));
+    clock_ms = 5000;
+    TEST_ASSERT_NOT_NULL(mq2_read(&mq2, false));
+    TEST_ASSERT_TRUE(mq2_snapshot(&mq2, &snap));
+    TEST_ASSERT_EQUAL_UINT32(1, snap.seq);
+    TEST_ASSERT_EQUAL_UINT64(5000, snap.timestamp_ms); // The source's clock
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, RO_CLEAN_AIR_FACTOR, snap.ratio);
+    TEST_ASSERT_EQUAL_FLOAT(mq2.values[2], snap.values[2]);
+
+    adc_raw = 0; // Every conversion fails: no reading, nothing new published
+    TEST_ASSERT_NULL(mq2_read(&mq2, false));
+    TEST_ASSERT_TRUE(mq2_snapshot(&mq2, &snap));
+    TEST_ASSERT_EQUAL_UINT32(1, snap.seq);
+}
+
+static void test_waits_for_enough_buckets(void) {
+    float ro0 = mq2.Ro;
+    for (int b = 0; b < MQ2_RO_MIN_BUCKETS - 1; b++) {
+        TEST_ASSERT_FALSE(feed_bucket(peak_for(ro0 * 1.2f), BUCKET_READINGS));
+    }
+    TEST_ASSERT_EQUAL_FLOAT(ro0, mq2.Ro);
+    // A bucket with too few readings (sensor mostly failing) is not a candidate
+    TEST_ASSERT_FALSE(feed_bucket(peak_for(ro0 * 1.2f), MQ2_RO_MIN_SAMPLES - 1));
+    TEST_ASSERT_EQUAL_FLOAT(ro0, mq2.Ro);
+    TEST_ASSERT_TRUE(feed_bucket(peak_for(ro0 * 1.2f), BUCKET_READINGS));
+    TEST_ASSERT_EQUAL_UINT32(1, mq2.ro_track.updates);
+}
+
+static void test_follows_median_slew_limited(void) {
+    float ro0 = mq2.Ro;
+    float target = ro0 * 1.1f;
+    float prev = ro0;
+    int updates = 0;
+    for (int b = 0; b < MQ2_RO_WINDOW_BUCKETS; b++) {
+        if (feed_bucket(peak_for(target), BUCKET_READINGS)) updates++;
+        // Never more than MQ2_RO_MAX_STEP of Ro per bucket, never past the target
+        TEST_ASSERT_TRUE(mq2.Ro <= prev * (1.0f + MQ2_RO_MAX_STEP) * 1.0001f);
+        TEST_ASSERT_TRUE(mq2.Ro <= target * 1.0001f);
+        prev = mq2.Ro;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(target * 1e-4f, target, mq2.Ro);
+    // 1.02^4 < 1.1 <= 1.02^5: five steps, the last one short
+    TEST_ASSERT_EQUAL(5, updates);
+}
+
+static void test_gas_in_a_minority_of_hours_is_not_learned(void) {
+    float ro0 = mq2.Ro;
+    for (int b = 0; b < MQ2_RO_WINDOW_BUCKETS; b++) feed_bucket(peak_for(ro0), BUCKET_READINGS);
+    TEST_ASSERT_FLOAT_WITHIN(ro0 * 1e-4f, ro0, mq2.Ro);
+
+    // Gas all through 11 of the 24 hours in the window: the median is still clean air
+    for (int b = 0; b < MQ2_RO_WINDOW_BUCKETS / 2 - 1; b++) {
+        TEST_ASSERT_FALSE(feed_bucket(peak_for(ro0) * 0.3f, BUCKET_READINGS));
+    }
+    TEST_ASSERT_FLOAT_WITHIN(ro0 * 1e-4f, ro0, mq2.Ro);
+
+    // Half the window: Ro starts to move, one step at a time
+    TEST_ASSERT_TRUE(feed_bucket(peak_for(ro0) * 0.3f, BUCKET_READINGS));
+    TEST_ASSERT_FLOAT_WITHIN(ro0 * 1e-4f, ro0 * (1.0f - MQ2_RO_MAX_STEP), mq2.Ro);
+}
+
+static void test_clamped_near_calibration(void) {
+    float ro0 = mq2.Ro;
+    for (int b = 0; b < 100; b++) feed_bucket(peak_for(ro0 * 3.0f), BUCKET_READINGS);
+    TEST_ASSERT_FLOAT_WITHIN(ro0 * 1e-4f, ro0 * (1.0f + MQ2_RO_MAX_DRIFT), mq2.Ro);
+    for (int b = 0; b < 200; b++) feed_bucket(peak_for(ro0 * 0.1f), BUCKET_READINGS);
+    TEST_ASSERT_FLOAT_WITHIN(ro0 * 1e-4f, ro0 * (1.0f - MQ2_RO_MAX_DRIFT), mq2.Ro);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_calibrates_and_reads_through_source);
+    RUN_TEST(test_waits_for_enough_buckets);
+    RUN_TEST(test_follows_median_slew_limited);
+    RUN_TEST(test_gas_in_a_minority_of_hours_is_not_learned);
+    RUN_TEST(test_clamped_near_calibration);
+    return UNITY_END();
+}
@@ -0,0 +1,52 @@
+// One node's copy of src/relay.c: include with RELAY_SIM_NODE defined, once per file.
+// relay.c's public names get the node number appended, and its MAC and clock come from
+// the simulation. Everything relay.c includes is included first, so the renames below
+// only reach relay.c's own code.
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "shared_header.h"
+#include "frame_auth.h"
+#include "sample_batch.h"
+#include "pairing.h"
+#include "auth.h"
+#include "relay.h"
+#include "relay_sim.h"
+
+#define RELAY_SIM_CAT_(a, b) a##b
+#define RELAY_SIM_CAT(a, b) RELAY_SIM_CAT_(a, b)
+
+#define relay_init                RELAY_SIM_CAT(relay_init_, RELAY_SIM_NODE)
+#define relay_on_master_frame     RELAY_SIM_CAT(relay_on_master_frame_, RELAY_SIM_NODE)
+#define relay_handle_frame        RELAY_SIM_CAT(relay_handle_frame_, RELAY_SIM_NODE)
+#define relay_use_radio           RELAY_SIM_CAT(relay_use_radio_, RELAY_SIM_NODE)
+#define relay_send                RELAY_SIM_CAT(relay_send_, RELAY_SIM_NODE)
+#define relay_flush               RELAY_SIM_CAT(relay_flush_, RELAY_SIM_NODE)
+#define relay_report_send_result  RELAY_SIM_CAT(relay_report_send_result_, RELAY_SIM_NODE)
+#define relay_uplink_is_master    RELAY_SIM_CAT(relay_uplink_is_master_, RELAY_SIM_NODE)
+#define relay_log_stats           RELAY_SIM_CAT(relay_log_stats_, RELAY_SIM_NODE)
+
+#define esp_read_mac(mac, type)   relay_sim_read_mac(RELAY_SIM_NODE, (mac))
+#define esp_timer_get_time()      relay_sim_now_us()
+
+#include "relay.c"
+
+static esp_err_t relay_sim_radio(const uint8_t *peer, const uint8_t *data, size_t len) {
+    return relay_sim_send(RELAY_SIM_NODE, peer, data, len);
+}
+
+const relay_sim_node_t RELAY_SIM_CAT(relay_sim_node_, RELAY_SIM_NODE) = {
+    .init = relay_init,
+    .on_master_frame = relay_on_master_frame,
+    .handle_frame = relay_handle_frame,
+    .use_radio = relay_use_radio,
+    .send = relay_send,
+    .flush = relay_flush,
+    .report_send_result = relay_report_send_result,
+    .uplink_is_master = relay_uplink_is_master,
+    .radio = relay_sim_radio,
+};
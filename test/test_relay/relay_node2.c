@@ -0,0 +1,3 @@
+// Relay slave 2 of the simulated line (relay_sim.h)
+#define RELAY_SIM_NODE 2
+#include "relay_node.h"
@@ -0,0 +1,3 @@
+// Relay slave 4 of the simulated line (relay_sim.h)
+#define RELAY_SIM_NODE 4
+#include "relay_node.h"
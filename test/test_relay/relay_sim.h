@@ -0,0 +1,36 @@
+#ifndef RELAY_SIM_H
+#define RELAY_SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "host_idf.h"
+#include "relay.h"
+
+// A line of relay slaves for test_relay. Each relay_node_N.c builds its own copy of
+// src/relay.c (relay_node.h), so every node keeps its own routing table and queue; the
+// test wires them together through a radio model.
+
+#define RELAY_SIM_NODES 4 // Slaves 1..4; node 0 is the master
+
+// relay.h's API of one node
+typedef struct {
+    esp_err_t (*init)(bool forward);
+    void (*on_master_frame)(int8_t rssi, int64_t rx_us);
+    bool (*handle_frame)(const esp_now_recv_info_t *info, const uint8_t *data, int len, int64_t rx_us);
+    void (*use_radio)(relay_radio_send_t send);
+    esp_err_t (*send)(const uint8_t *frame, size_t len);
+    void (*flush)(void);
+    bool (*report_send_result)(const uint8_t *mac, bool success);
+    bool (*uplink_is_master)(void);
+    relay_radio_send_t radio; // This node's transmitter: relay_sim_send() from it
+} relay_sim_node_t;
+
+extern const relay_sim_node_t relay_sim_node_1, relay_sim_node_2, relay_sim_node_3, relay_sim_node_4;
+
+// Provided by the test
+int64_t relay_sim_now_us(void);
+esp_err_t relay_sim_read_mac(int node, uint8_t *mac);
+esp_err_t relay_sim_send(int node, const uint8_t *peer, const uint8_t *data, size_t len);
+
+#endif // RELAY_SIM_H
@@ -0,0 +1,248 @@
+// Relay routing (src/relay.c): advert authentication on the slave's own instance, and a
+// line of relay slaves down an aisle with delivery rate and added latency per hop
+#include <string.h>
+#include <unity.h>
+#include "host.h"
+#include "shared_header.h"
+#include "frame_auth.h"
+#include "auth.h"
+#include "pairing.h"
+#include "relay.h"
+#include "relay_sim.h"
+
+static const char *TAG = "RELAY_SIM";
+
+static const uint8_t master_mac[6] = { 0x02, 0x52, 0x4c, 0x00, 0x00, 0x00 };
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// --- Advert Authentication (this slave's relay.c) ---
+
+static const uint8_t neighbour_mac[6] = { 0x02, 0x52, 0x4c, 0x00, 0x01, 0x00 };
+static uint8_t last_peer[6];
+
+static esp_err_t capture_radio(const uint8_t *peer, const uint8_t *data, size_t len) {
+    memcpy(last_peer, peer, 6);
+    return ESP_OK;
+}
+
+// Builds a route advert for the test site, signed under the group key or (forged) another key
+static size_t make_advert(uint8_t *frame, size_t cap, uint8_t hops, int8_t path_rssi, bool forged) {
+    route_advert_t adv = {
+        .hdr = { .magic = ESPNOW_CTRL_MAGIC, .type = CTRL_ROUTE_ADVERT },
+        .channel = 1,
+        .hops = hops,
+        .path_rssi = path_rssi,
+    };
+    memcpy(adv.master_mac, master_mac, 6);
+    memcpy(frame, &adv, sizeof(adv));
+    if (!forged) return auth_sign_group(frame, sizeof(adv), cap);
+    fa_key_t other = { .k0 = 0x0123456789abcdefULL, .k1 = 0xfedcba9876543210ULL };
+    return fa_sign(&other, 1, frame, sizeof(adv), cap);
+}
+
+static void hear(const uint8_t *src, int8_t rssi, const uint8_t *frame, size_t len) {
+    wifi_pkt_rx_ctrl_t rx_ctrl = { .rssi = rssi };
+    esp_now_recv_info_t info = { .src_addr = (uint8_t *)src, .rx_ctrl = &rx_ctrl };
+    TEST_ASSERT_TRUE(relay_handle_frame(&info, frame, (int)len, esp_timer_get_time()));
+}
+
+// Sends a frame and returns whether it went to the master directly
+static bool uplink_is_master(void) {
+    static const uint8_t payload[4] = { 0 };
+    TEST_ASSERT_EQUAL(ESP_OK, relay_send(payload, sizeof(payload)));
+    return memcmp(last_peer, master_mac, 6) == 0;
+}
+
+// A weak master link and a neighbour with a far better route: only adverts that
+// authenticate, are fresh and do not claim to be the master may move the uplink
+static void test_adverts_are_authenticated(void) {
+    uint8_t good[sizeof(route_advert_t) + FA_TRAILER_LEN];
+    uint8_t frame[sizeof(route_advert_t) + FA_TRAILER_LEN];
+    size_t len;
+
+    relay_use_radio(capture_radio);
+    TEST_ASSERT_EQUAL(ESP_OK, relay_init(false));
+    relay_on_master_frame(-85, esp_timer_get_time());
+    TEST_ASSERT_TRUE(uplink_is_master());
+
+    len = make_advert(frame, sizeof(frame), 1, -40, true);
+    hear(neighbour_mac, -50, frame, len);
+    TEST_ASSERT_TRUE_MESSAGE(uplink_is_master(), "forged advert accepted");
+
+    len = make_advert(frame, sizeof(frame), 0, -40, false);
+    hear(neighbour_mac, -50, frame, len);
+    TEST_ASSERT_TRUE_MESSAGE(uplink_is_master(), "hops == 0 accepted from a slave");
+
+    size_t good_len = make_advert(good, sizeof(good), 1, -40, false);
+    hear(neighbour_mac, -50, good, good_len);
+    TEST_ASSERT_FALSE_MESSAGE(uplink_is_master(), "genuine advert ignored");
+    TEST_ASSERT_EQUAL_MEMORY(neighbour_mac, last_peer, 6);
+
+    // The neighbour loses its route; replaying its earlier advert must not bring it back
+    len = make_advert(frame, sizeof(frame), RELAY_TTL, -40, false);
+    hear(neighbour_mac, -50, frame, len);
+    TEST_ASSERT_TRUE(uplink_is_master());
+    hear(neighbour_mac, -50, good, good_len);
+    TEST_ASSERT_TRUE_MESSAGE(uplink_is_master(), "replayed advert accepted");
+}
+
+// --- Relay Line Simulation ---
+// Node 0 is the master, nodes 1..RELAY_SIM_NODES stand one hop apart down an aisle and
+// hear only their direct neighbours. Every slave reports once per superframe in its own
+// TDMA slot (node n in slot n), where it also forwards what it queued for others. Each
+// transmission is lost with SIM_LOSS_PCT probability, after ESP-NOW's own retries.
+
+#define SIM_SUPERFRAME_MS   1000
+#define SIM_SLOT_MS         100
+#define SIM_SUPERFRAMES     3600    // One hour
+#define SIM_WARMUP          60      // Superframes for the routes to settle, not counted
+#define SIM_LOSS_PCT        3
+#define SIM_LINK_RSSI       (-72)
+
+static const relay_sim_node_t *const nodes[RELAY_SIM_NODES + 1] = {
+    NULL, &relay_sim_node_1, &relay_sim_node_2, &relay_sim_node_3, &relay_sim_node_4,
+};
+
+typedef struct __attribute__((packed)) {
+    uint8_t node;
+    int64_t sent_us;
+} sim_payload_t;
+
+typedef struct {
+    uint32_t sent;
+    uint32_t delivered;
+    int64_t latency_us;         // end to end, summed
+    int64_t relay_delay_ms;     // relay_hdr_t.delay_ms, summed
+    int64_t max_latency_us;
+} sim_origin_t;
+
+static int64_t sim_us;
+static uint32_t sim_rng = 0x2545F491;
+static bool sim_counting;
+static sim_origin_t origins[RELAY_SIM_NODES + 1];
+
+int64_t relay_sim_now_us(void) {
+    return sim_us;
+}
+
+esp_err_t relay_sim_read_mac(int node, uint8_t *mac) {
+    memcpy(mac, master_mac, 6);
+    mac[5] = (uint8_t)node;
+    return ESP_OK;
+}
+
+static bool sim_lost(void) {
+    sim_rng = sim_rng * 1664525u + 1013904223u;
+    return (sim_rng >> 8) % 100 < SIM_LOSS_PCT;
+}
+
+static int sim_node_of(const uint8_t *mac) {
+    if (memcmp(mac, master_mac, 5) != 0 || mac[5] > RELAY_SIM_NODES) return -1;
+    return mac[5];
+}
+
+// The master takes relayed frames apart as it does on target
+static void sim_master_receive(const uint8_t *data, size_t len) {
+    uint16_t relay_delay_ms = 0;
+    if (len > sizeof(relay_hdr_t) && data[0] == ESPNOW_CTRL_MAGIC && data[1] == CTRL_RELAY) {
+        relay_hdr_t hdr;
+        memcpy(&hdr, data, sizeof(hdr));
+        relay_delay_ms = hdr.delay_ms;
+        data += sizeof(hdr);
+        len -= sizeof(hdr);
+    }
+    if (len != sizeof(sim_payload_t)) return; // Route adverts
+    sim_payload_t payload;
+    memcpy(&payload, data, sizeof(payload));
+    if (!sim_counting || payload.sent_us < (int64_t)SIM_WARMUP * SIM_SUPERFRAME_MS * 1000) return;
+    sim_origin_t *o = &origins[payload.node];
+    int64_t latency_us = sim_us - payload.sent_us;
+    o->delivered++;
+    o->latency_us += latency_us;
+    o->relay_delay_ms += relay_delay_ms;
+    if (latency_us > o->max_latency_us) o->max_latency_us = latency_us;
+}
+
+static void sim_deliver(int from, int to, const uint8_t *data, size_t len) {
+    if (to == 0) {
+        sim_master_receive(data, len);
+        return;
+    }
+    uint8_t src[6];
+    relay_sim_read_mac(from, src);
+    wifi_pkt_rx_ctrl_t rx_ctrl = { .rssi = SIM_LINK_RSSI };
+    esp_now_recv_info_t info = { .src_addr = src, .rx_ctrl = &rx_ctrl };
+    nodes[to]->handle_frame(&info, data, (int)len, sim_us);
+}
+
+esp_err_t relay_sim_send(int node, const uint8_t *peer, const uint8_t *data, size_t len) {
+    static const uint8_t broadcast[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    if (memcmp(peer, broadcast, 6) == 0) {
+        for (int to = node - 1; to <= node + 1; to += 2) {
+            if (to >= 0 && to <= RELAY_SIM_NODES && !sim_lost()) sim_deliver(node, to, data, len);
+        }
+        return ESP_OK;
+    }
+    int to = sim_node_of(peer);
+    bool ok = to >= 0 && (to == node - 1 || to == node + 1) && !sim_lost();
+    if (ok) sim_deliver(node, to, data, len);
+    nodes[node]->report_send_result(peer, ok);
+    return ESP_OK;
+}
+
+static void test_delivery_and_latency_per_hop(void) {
+    esp_log_level_set(TAG, ESP_LOG_INFO);
+    for (int n = 1; n <= RELAY_SIM_NODES; n++) {
+        nodes[n]->use_radio(nodes[n]->radio);
+        TEST_ASSERT_EQUAL(ESP_OK, nodes[n]->init(true));
+    }
+
+    sim_counting = true;
+    for (int sf = 0; sf < SIM_SUPERFRAMES; sf++) {
+        int64_t start_us = (int64_t)sf * SIM_SUPERFRAME_MS * 1000;
+        sim_us = start_us;
+        if (!sim_lost()) nodes[1]->on_master_frame(SIM_LINK_RSSI, sim_us); // Slot beacon
+
+        for (int n = 1; n <= RELAY_SIM_NODES; n++) {
+            sim_us = start_us + (int64_t)n * SIM_SLOT_MS * 1000;
+            sim_payload_t payload = { .node = (uint8_t)n, .sent_us = sim_us };
+            nodes[n]->send((const uint8_t *)&payload, sizeof(payload));
+            if (sf >= SIM_WARMUP) origins[n].sent++;
+            nodes[n]->flush();
+        }
+    }
+    sim_counting = false;
+
+    ESP_LOGI(TAG, "%d superframes of %d ms, %d%% loss per transmission:", SIM_SUPERFRAMES - SIM_WARMUP,
+             SIM_SUPERFRAME_MS, SIM_LOSS_PCT);
+    ESP_LOGI(TAG, "%4s %9s %12s %12s %16s", "hops", "delivered", "latency ms", "max ms", "added/relay ms");
+    for (int n = 1; n <= RELAY_SIM_NODES; n++) {
+        sim_origin_t *o = &origins[n];
+        TEST_ASSERT_GREATER_THAN_UINT32(0, o->delivered);
+        double rate = (double)o->delivered / o->sent;
+        double added_ms = n > 1 ? (double)o->relay_delay_ms / o->delivered / (n - 1) : 0;
+        ESP_LOGI(TAG, "%4d %8.1f%% %12.0f %12.0f %16.0f", n, 100 * rate,
+                 (double)o->latency_us / o->delivered / 1000, (double)o->max_latency_us / 1000, added_ms);
+
+        // Each hop may lose a frame once (no retries above ESP-NOW's), with 1% slack for
+        // the seeded draws
+        double expected = 1;
+        for (int h = 0; h < n; h++) expected *= 1 - SIM_LOSS_PCT / 100.0;
+        TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE((int)(1000 * (expected - 0.01)), (int)(1000 * rate), "delivery rate");
+        // A relay forwards in its next slot: within one superframe
+        TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(SIM_SUPERFRAME_MS, (int)added_ms, "added latency per relay");
+        TEST_ASSERT_LESS_OR_EQUAL((int64_t)n * SIM_SUPERFRAME_MS * 1000, o->max_latency_us);
+    }
+}
+
+int main(int argc, char** argv) {
+    auth_use_ephemeral_key(); // Every node signs and checks adverts with the same group key
+    pairing_use_master(master_mac, NULL, 1);
+    UNITY_BEGIN();
+    RUN_TEST(test_adverts_are_authenticated);
+    RUN_TEST(test_delivery_and_latency_per_hop);
+    return UNITY_END();
+}
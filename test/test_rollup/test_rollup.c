@@ -0,0 +1,273 @@
+// Windowed rollups (lib/Rollup): exact count/min/max/mean, p95 within a fixed tolerance
+// of the sorted-sample quantile inside each metric's envelope (also in busy buckets whose
+// sketch is subsampled), values outside it, sliding and tumbling windows and zones
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unity.h>
+#include "host.h"
+#include "rollup.h"
+
+#define MAX_SAMPLES 20000
+
+static const uint8_t slave_macs[2][6] = {
+    { 0x02, 0x52, 0x4f, 0x00, 0x00, 0x01 },
+    { 0x02, 0x52, 0x4f, 0x00, 0x00, 0x02 },
+};
+
+static rollup_engine_t* engine;
+static uint32_t rng_state;
+static float samples[ROLLUP_METRIC_COUNT][MAX_SAMPLES];
+
+static uint32_t rng_next(void) {
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return rng_state = x;
+}
+
+static float rng_uniform(void) {
+    return (float)(rng_next() >> 8) / 16777216.0f;
+}
+
+static int cmp_float(const void* a, const void* b) {
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+// The sample at rank ROLLUP_QUANTILE * n, which the sketch approximates
+static float exact_quantile(float* v, int n) {
+    qsort(v, n, sizeof(float), cmp_float);
+    int k = (int)ceilf(ROLLUP_QUANTILE * (float)n) - 1;
+    return v[k < 0 ? 0 : k];
+}
+
+// How far p95 may be from the true quantile at v, inside each metric's envelope: a bin
+// of rollup.h's sketch is narrower (1.6 C, 2.2 %RH, 24% of the ppm reading)
+#define P95_TOLERANCE_C     2.0f
+#define P95_TOLERANCE_RH    3.0f
+#define P95_TOLERANCE_PPM   0.25f   // Of the reading
+#define P95_TOLERANCE_SHARE (1.0f / ROLLUP_SKETCH_BINS)
+
+static float p95_tolerance(rollup_metric_t m, float v) {
+    switch (m) {
+    case ROLLUP_TEMPERATURE:
+        return P95_TOLERANCE_C;
+    case ROLLUP_HUMIDITY:
+        return P95_TOLERANCE_RH;
+    case ROLLUP_LPG:
+    case ROLLUP_CO:
+    case ROLLUP_SMOKE:
+        return v * P95_TOLERANCE_PPM;
+    default:
+        return P95_TOLERANCE_SHARE;
+    }
+}
+
+// A reading in the metric's envelope: mostly a quiet baseline with a tail of events
+static float draw(rollup_metric_t m) {
+    bool tail = rng_next() % 100 < 10;
+    float u = rng_uniform();
+    switch (m) {
+    case ROLLUP_TEMPERATURE:
+        return tail ? 30.0f + 18.0f * u : 17.0f + 5.0f * u;
+    case ROLLUP_HUMIDITY:
+        return tail ? 25.0f + 20.0f * u : 55.0f + 15.0f * u;
+    case ROLLUP_CO:
+        return tail ? powf(10.0f, 3.0f + 1.8f * u) : powf(10.0f, 2.5f + 0.3f * u);
+    case ROLLUP_LPG:
+    case ROLLUP_SMOKE:
+        return tail ? powf(10.0f, 2.0f + 1.8f * u) : powf(10.0f, 1.2f + 0.5f * u);
+    default:
+        return tail ? 1.0f : 0.0f;
+    }
+}
+
+// Feeds n drawn samples spread evenly over [t0_ms, t0_ms + span_ms) and keeps them in samples[]
+static void feed(uint16_t slave, int64_t t0_ms, int64_t span_ms, int n) {
+    for (int i = 0; i < n; i++) {
+        float v[ROLLUP_METRIC_COUNT];
+        for (int m = 0; m < ROLLUP_METRIC_COUNT; m++) {
+            v[m] = samples[m][i] = draw((rollup_metric_t)m);
+        }
+        rollup_ingest(engine, slave, t0_ms + span_ms * i / n, v);
+    }
+}
+
+static void assert_p95_within_tolerance(int64_t now_ms, rollup_window_t window, int n) {
+    for (int m = 0; m < ROLLUP_METRIC_COUNT; m++) {
+        rollup_stats_t st;
+        TEST_ASSERT_TRUE(rollup_query(engine, ROLLUP_SCOPE_SLAVE, 0, window, (rollup_metric_t)m, now_ms, &st));
+        TEST_ASSERT_EQUAL_UINT32(n, st.count);
+        float exact = exact_quantile(samples[m], n);
+        TEST_ASSERT_FLOAT_WITHIN(p95_tolerance((rollup_metric_t)m, exact), exact, st.p95);
+    }
+}
+
+void setUp(void) {
+    rng_state = 0x5EED0031;
+    engine = rollup_create(4, 2);
+    TEST_ASSERT_NOT_NULL(engine);
+    TEST_ASSERT_EQUAL(0, rollup_slave_index(engine, slave_macs[0]));
+    TEST_ASSERT_EQUAL(1, rollup_slave_index(engine, slave_macs[1]));
+}
+
+void tearDown(void) {
+    rollup_destroy(engine);
+}
+
+static void test_count_min_max_mean_are_exact(void) {
+    float sum = 0.0f;
+    for (int i = 0; i < 12; i++) { // One minute of 5 s reports, the last humidity read failed
+        float temp = 20.0f + (float)((i * 7) % 12) * 0.5f;
+        float v[ROLLUP_METRIC_COUNT] = { temp, i == 11 ? NAN : 60.0f, 30.0f, 400.0f, 40.0f, (float)(i % 3 == 0) };
+        sum += temp;
+        rollup_ingest(engine, 0, 60000 + i * 5000, v);
+    }
+
+    rollup_stats_t st;
+    TEST_ASSERT_TRUE(rollup_query(engine, ROLLUP_SCOPE_SLAVE, 0, ROLLUP_WINDOW_1MIN, ROLLUP_TEMPERATURE, 119999, &st));
+    TEST_ASSERT_EQUAL_UINT32(12, st.count);
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, st.min);
+    TEST_ASSERT_EQUAL_FLOAT(25.5f, st.max);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, sum / 12, st.mean);
+    TEST_ASSERT_TRUE(rollup_query(engine, ROLLUP_SCOPE_SLAVE, 0, ROLLUP_WINDOW_1MIN, ROLLUP_HUMIDITY, 119999, &st));
+    TEST_ASSERT_EQUAL_UINT32(11, st.count);
+    TEST_ASSERT_TRUE(rollup_query(engine, ROLLUP_SCOPE_SLAVE, 0, ROLLUP_WINDOW_1MIN, ROLLUP_MOTION, 119999, &st));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 4.0f / 12, st.mean); // Share of frames with motion
+
+    // A slave with no samples, and indexes out of range
+    TEST_ASSERT_TRUE(rollup_query(engine, ROLLUP_SCOPE_SLAVE, 1, ROLLUP_WINDOW_1MIN, ROLLUP_TEMPERATURE, 119999, &st));
+    TEST_ASSERT_EQUAL_UINT32(0, st.count);
+    TEST_ASSERT_TRUE(isnan(st.p95));
+    TEST_ASSERT_FALSE(rollup_query(engine, ROLLUP_SCOPE_SLAVE, 2, ROLLUP_WINDOW_1MIN, ROLLUP_TEMPERATURE, 119999, &st));
+    TEST_ASSERT_FALSE(rollup_query(engine, ROLLUP_SCOPE_ZONE, 2, ROLLUP_WINDOW_1MIN, ROLLUP_TEMPERATURE, 119999, &st));
+}
+
+static void test_p95_within_tolerance_across_buckets(void) {
+    for (int run = 0; run < 20; run++) {
+        int64_t t0_ms = (int64_t)(run + 1) * 2 * 3600 * 1000; // An aligned hour, clear of the last run's
+        feed(0, t0_ms, 3600 * 1000, 720); // 5 s reports merged over the six 10-minute buckets
+        assert_p95_within_tolerance(t0_ms + 3600 * 1000 - 1, ROLLUP_WINDOW_1H, 720);
+    }
+}
+
+static void test_p95_within_tolerance_in_busy_bucket(void) {
+    // Enough samples in one 10 s bucket for the sketch to halve its bins several times
+    feed(0, 60000, 10000, MAX_SAMPLES);
+    assert_p95_within_tolerance(69999, ROLLUP_WINDOW_1MIN, MAX_SAMPLES);
+
+    rollup_stats_t st;
+    TEST_ASSERT_TRUE(rollup_query(engine, ROLLUP_SCOPE_SLAVE, 0, ROLLUP_WINDOW_1MIN, ROLLUP_TEMPERATURE, 69999, &st));
+    TEST_ASSERT_EQUAL_UINT32(MAX_SAMPLES, st.count);
+}
+
+static void test_values_outside_envelope(void) {
+    // A fire past the DHT11's range and gas below the MQ2 curve: the edge bins hold them
+    float temps[] = { -5.0f, 20.0f, 21.0f, 55.0f, 62.0f, 70.0f };
+    for (int i = 0; i < 6; i++) {
+        float v[ROLLUP_METRIC_COUNT] = { temps[i], 50.0f, 1.0f, 50.0f, 2.0f, 0.0f };
+        rollup_ingest(engine, 0, 60000 + i * 1000, v);
+    }
+
+    rollup_stats_t st;
+    TEST_ASSERT_TRUE(rollup_query(engine, ROLLUP_SCOPE_SLAVE, 0, ROLLUP_WINDOW_1MIN, ROLLUP_TEMPERATURE, 69999, &st));
+    TEST_ASSERT_EQUAL_FLOAT(-5.0f, st.min);
+    TEST_ASSERT_EQUAL_FLOAT(70.0f, st.max);
+    TEST_ASSERT_TRUE(st.p95 >= ROLLUP_TEMPERATURE_HI - P95_TOLERANCE_C && st.p95 <= st.max);
+    TEST_ASSERT_TRUE(rollup_query(engine, ROLLUP_SCOPE_SLAVE, 0, ROLLUP_WINDOW_1MIN, ROLLUP_LPG, 69999, &st));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, st.p95); // Clamped to the exact min and max
+    TEST_ASSERT_TRUE(rollup_query(engine, ROLLUP_SCOPE_SLAVE, 0, ROLLUP_WINDOW_1MIN, ROLLUP_CO, 69999, &st));
+    TEST_ASSERT_EQUAL_FLOAT(50.0f, st.p95);
+}
+
+static void test_sliding_window_drops_old_buckets(void) {
+    for (int s = 0; s < 120; s++) { // A ramp, one sample a second for two minutes
+        float v[ROLLUP_METRIC_COUNT] = { (float)s / 10.0f, 50.0f, 30.0f, 400.0f, 40.0f, 0.0f };
+        rollup_ingest(engine, 0, s * 1000, v);
+    }
+
+    rollup_stats_t st;
+    TEST_ASSERT_TRUE(rollup_query(engine, ROLLUP_SCOPE_SLAVE, 0, ROLLUP_WINDOW_1MIN, ROLLUP_TEMPERATURE, 119999, &st));
+    TEST_ASSERT_EQUAL_UINT32(60, st.count);
+    TEST_ASSERT_EQUAL_FLOAT(6.0f, st.min);
+    TEST_ASSERT_EQUAL_FLOAT(11.9f, st.max);
+    // Twenty seconds later two buckets have slid out, though no sample arrived
+    TEST_ASSERT_TRUE(rollup_query(engine, ROLLUP_SCOPE_SLAVE, 0, ROLLUP_WINDOW_1MIN, ROLLUP_TEMPERATURE, 139999, &st));
+    TEST_ASSERT_EQUAL_UINT32(40, st.count);
+    TEST_ASSERT_EQUAL_FLOAT(8.0f, st.min);
+    // The 15-minute window still holds both minutes
+    TEST_ASSERT_TRUE(rollup_query(engine, ROLLUP_SCOPE_SLAVE, 0, ROLLUP_WINDOW_15MIN, ROLLUP_TEMPERATURE, 139999, &st));
+    TEST_ASSERT_EQUAL_UINT32(120, st.count);
+}
+
+typedef struct {
+    rollup_scope_t scope;
+    uint16_t index;
+    int64_t end_ms;
+    rollup_stats_t temp;
+} emitted_t;
+
+static emitted_t emitted[16];
+static int emitted_count;
+
+static void record_emit(void* ctx, rollup_scope_t scope, uint16_t index, rollup_window_t window, int64_t end_ms,
+                        const rollup_stats_t stats[ROLLUP_METRIC_COUNT]) {
+    if (window != ROLLUP_WINDOW_1MIN || emitted_count >= 16) return;
+    emitted[emitted_count++] = (emitted_t){ scope, index, end_ms, stats[ROLLUP_TEMPERATURE] };
+}
+
+static void test_tumbling_windows_and_zones(void) {
+    emitted_count = 0;
+    rollup_set_emit_cb(engine, record_emit, NULL);
+    TEST_ASSERT_EQUAL(ESP_OK, rollup_set_zone(engine, 0, 1));
+    TEST_ASSERT_EQUAL(ESP_OK, rollup_set_zone(engine, 1, 1));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rollup_set_zone(engine, 0, 2));
+
+    // Minute 1: slave 0 reads 20 C, slave 1 reads 30 C, six reports each
+    for (int i = 0; i < 6; i++) {
+        for (uint16_t s = 0; s < 2; s++) {
+            float v[ROLLUP_METRIC_COUNT] = { s ? 30.0f : 20.0f, 50.0f, 30.0f, 400.0f, 40.0f, 0.0f };
+            rollup_ingest(engine, s, 60000 + i * 10000, v);
+        }
+    }
+    TEST_ASSERT_EQUAL(0, emitted_count); // Nothing completes until a later sample arrives
+
+    float v[ROLLUP_METRIC_COUNT] = { 25.0f, 50.0f, 30.0f, 400.0f, 40.0f, 0.0f };
+    rollup_ingest(engine, 0, 121000, v); // Minute 2 was idle: minute 1 is emitted once
+    TEST_ASSERT_EQUAL(2, emitted_count);
+    TEST_ASSERT_EQUAL(ROLLUP_SCOPE_SLAVE, emitted[0].scope);
+    TEST_ASSERT_EQUAL_INT64(120000, emitted[0].end_ms);
+    TEST_ASSERT_EQUAL_UINT32(6, emitted[0].temp.count);
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, emitted[0].temp.mean);
+    TEST_ASSERT_EQUAL(ROLLUP_SCOPE_ZONE, emitted[1].scope);
+    TEST_ASSERT_EQUAL(1, emitted[1].index);
+    TEST_ASSERT_EQUAL_UINT32(12, emitted[1].temp.count);
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, emitted[1].temp.mean);
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, emitted[1].temp.min);
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, emitted[1].temp.max);
+
+    // Slave 1 catches up: its minute 1, then the zone's minute 2 holding slave 0's sample
+    rollup_ingest(engine, 1, 185000, v);
+    TEST_ASSERT_EQUAL(4, emitted_count);
+    TEST_ASSERT_EQUAL(ROLLUP_SCOPE_SLAVE, emitted[2].scope);
+    TEST_ASSERT_EQUAL(1, emitted[2].index);
+    TEST_ASSERT_EQUAL_INT64(120000, emitted[2].end_ms);
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, emitted[2].temp.mean);
+    TEST_ASSERT_EQUAL(ROLLUP_SCOPE_ZONE, emitted[3].scope);
+    TEST_ASSERT_EQUAL_INT64(180000, emitted[3].end_ms);
+    TEST_ASSERT_EQUAL_UINT32(1, emitted[3].temp.count);
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, emitted[3].temp.mean);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_count_min_max_mean_are_exact);
+    RUN_TEST(test_p95_within_tolerance_across_buckets);
+    RUN_TEST(test_p95_within_tolerance_in_busy_bucket);
+    RUN_TEST(test_values_outside_envelope);
+    RUN_TEST(test_sliding_window_drops_old_buckets);
+    RUN_TEST(test_tumbling_windows_and_zones);
+    return UNITY_END();
+}
@@ -0,0 +1,339 @@
+// Compiled alarm rules (lib/Rules): thresholds at and either side of their value,
+// overlapping rules on one field, and random rule sets (with rules added and removed
+// and the set recompiled) checked frame by frame against plain per-rule evaluation;
+// then hold times, cross-slave counts and malformed rules
+#include <string.h>
+#include <math.h>
+#include <unity.h>
+#include "host.h"
+#include "rules.h"
+
+#define SLAVES      3
+#define MAX_RULES   32
+#define FRAMES      300
+
+static rules_engine_t* engine;
+static uint32_t rng_state;
+
+typedef struct {
+    uint16_t rule_id;
+    uint16_t slave;
+    bool active;
+} alarm_t;
+
+static alarm_t alarms[64];
+static int alarm_count;
+
+static uint32_t rng_next(void) {
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return rng_state = x;
+}
+
+static void record_alarm(void* ctx, uint16_t rule_id, uint16_t slave_index, bool active) {
+    if (alarm_count < 64) alarms[alarm_count++] = (alarm_t){ rule_id, slave_index, active };
+}
+
+static void compile(const rule_def_t* defs, uint16_t n) {
+    rules_destroy(engine);
+    engine = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, rules_compile(defs, n, SLAVES, &engine));
+    rules_set_alarm_cb(engine, record_alarm, NULL);
+    alarm_count = 0;
+}
+
+static void frame_of(float out[RULE_FIELD_COUNT], float temp, float smoke, float motion) {
+    for (int f = 0; f < RULE_FIELD_COUNT; f++) out[f] = NAN;
+    out[RULE_FIELD_TEMPERATURE] = temp;
+    out[RULE_FIELD_SMOKE] = smoke;
+    out[RULE_FIELD_MOTION] = motion;
+}
+
+// --- Reference: every condition of every rule tested on its own ---
+
+typedef struct {
+    float prev[SLAVES][RULE_FIELD_COUNT];
+    int64_t prev_t_ms[SLAVES];
+} naive_t;
+
+static void naive_reset(naive_t* n) {
+    for (int s = 0; s < SLAVES; s++) {
+        n->prev_t_ms[s] = -1;
+        for (int f = 0; f < RULE_FIELD_COUNT; f++) n->prev[s][f] = NAN;
+    }
+}
+
+static bool naive_cond(const rule_cond_t* c, float v) {
+    switch (c->op) {
+    case RULE_GT: return v > c->threshold;
+    case RULE_GE: return v >= c->threshold;
+    case RULE_LT: return v < c->threshold;
+    default:      return v <= c->threshold;
+    }
+}
+
+// Which rules the frame meets, as rules_eval() with no hold and a single slave should find
+static void naive_eval(naive_t* n, const rule_def_t* defs, uint16_t n_rules, uint16_t slave, int64_t t_ms,
+                       const float values[RULE_FIELD_COUNT], bool met[MAX_RULES]) {
+    int64_t dt_ms = n->prev_t_ms[slave] >= 0 ? t_ms - n->prev_t_ms[slave] : 0;
+    for (uint16_t r = 0; r < n_rules; r++) {
+        met[r] = true;
+        for (int c = 0; c < defs[r].n_conds; c++) {
+            const rule_cond_t* cond = &defs[r].conds[c];
+            float prev = n->prev[slave][cond->field];
+            float v = values[cond->field];
+            if (cond->kind == RULE_RATE) {
+                v = (dt_ms > 0 && !isnan(prev)) ? (v - prev) * 60000.0f / (float)dt_ms : NAN;
+            }
+            if (isnan(v) || !naive_cond(cond, v)) met[r] = false;
+        }
+    }
+    memcpy(n->prev[slave], values, sizeof(n->prev[slave]));
+    n->prev_t_ms[slave] = t_ms;
+}
+
+// Thresholds are drawn from a short list, so rules share and straddle each other's
+static const float threshold_pool[] = { -5.0f, 0.0f, 10.0f, 20.0f, 20.5f, 30.0f, 60.0f };
+#define POOL_SIZE (sizeof(threshold_pool) / sizeof(threshold_pool[0]))
+
+static rule_def_t random_rule(uint16_t id) {
+    rule_def_t d = { .id = id, .n_conds = (uint8_t)(1 + rng_next() % RULES_MAX_CONDS) };
+    for (int c = 0; c < d.n_conds; c++) {
+        d.conds[c] = (rule_cond_t){
+            .field = (uint8_t)(rng_next() % RULE_FIELD_COUNT),
+            .kind = (uint8_t)(rng_next() % 4 == 0 ? RULE_RATE : RULE_VALUE),
+            .op = (uint8_t)(rng_next() % 4),
+            .threshold = threshold_pool[rng_next() % POOL_SIZE],
+        };
+    }
+    return d;
+}
+
+// A value on, just above or just below a pooled threshold, or missing
+static float random_value(void) {
+    uint32_t pick = rng_next() % 16;
+    if (pick == 0) return NAN;
+    float t = threshold_pool[rng_next() % POOL_SIZE];
+    if (pick < 6) return nextafterf(t, INFINITY);
+    if (pick < 11) return nextafterf(t, -INFINITY);
+    return t;
+}
+
+// Drives the engine and the reference with the same frames; every rule must agree on every frame
+static void assert_matches_naive(const rule_def_t* defs, uint16_t n_rules, int64_t* t_ms) {
+    naive_t naive;
+    naive_reset(&naive);
+    for (int i = 0; i < FRAMES; i++) {
+        uint16_t slave = (uint16_t)(rng_next() % SLAVES);
+        // Steps of 6 s or exactly a minute, so rates land on thresholds too
+        *t_ms += rng_next() % 2 ? 6000 : 60000;
+        float values[RULE_FIELD_COUNT];
+        for (int f = 0; f < RULE_FIELD_COUNT; f++) values[f] = random_value();
+
+        bool met[MAX_RULES];
+        naive_eval(&naive, defs, n_rules, slave, *t_ms, values, met);
+        rules_eval(engine, slave, *t_ms, values);
+        for (uint16_t r = 0; r < n_rules; r++) {
+            TEST_ASSERT_EQUAL_MESSAGE(met[r], rules_is_active(engine, r, slave), "compiled and per-rule evaluation differ");
+        }
+    }
+}
+
+void setUp(void) {
+    rng_state = 0x5EED0032;
+    engine = NULL;
+    alarm_count = 0;
+}
+
+void tearDown(void) {
+    rules_destroy(engine);
+    engine = NULL;
+}
+
+static void test_thresholds_at_and_either_side(void) {
+    static const rule_op_t ops[] = { RULE_GT, RULE_GE, RULE_LT, RULE_LE };
+    rule_def_t defs[4];
+    for (int r = 0; r < 4; r++) {
+        defs[r] = (rule_def_t){ .id = (uint16_t)(100 + r), .n_conds = 1,
+                                .conds = { { RULE_FIELD_TEMPERATURE, RULE_VALUE, ops[r], 30.0f } } };
+    }
+    compile(defs, 4);
+
+    // GT, GE, LT, LE at 30 - ulp, 30 and 30 + ulp
+    static const bool expect[3][4] = {
+        { false, false, true,  true  },
+        { false, true,  false, true  },
+        { true,  true,  false, false },
+    };
+    const float temps[3] = { nextafterf(30.0f, -INFINITY), 30.0f, nextafterf(30.0f, INFINITY) };
+    for (int i = 0; i < 3; i++) {
+        float values[RULE_FIELD_COUNT];
+        frame_of(values, temps[i], 0.0f, 0.0f);
+        rules_eval(engine, 0, 1000 * (i + 1), values);
+        for (int r = 0; r < 4; r++) TEST_ASSERT_EQUAL(expect[i][r], rules_is_active(engine, r, 0));
+    }
+
+    // NAN meets no condition, not even the complementary ones
+    float values[RULE_FIELD_COUNT];
+    frame_of(values, NAN, 0.0f, 0.0f);
+    rules_eval(engine, 0, 4000, values);
+    for (int r = 0; r < 4; r++) TEST_ASSERT_FALSE(rules_is_active(engine, r, 0));
+}
+
+static void test_overlapping_rules_on_one_field(void) {
+    // Nested bands, a shared threshold and a rate rule on the same field
+    const rule_def_t defs[] = {
+        { .id = 1, .n_conds = 1, .conds = { { RULE_FIELD_TEMPERATURE, RULE_VALUE, RULE_GE, 40.0f } } },
+        { .id = 2, .n_conds = 1, .conds = { { RULE_FIELD_TEMPERATURE, RULE_VALUE, RULE_GT, 40.0f } } },
+        { .id = 3, .n_conds = 2, .conds = { { RULE_FIELD_TEMPERATURE, RULE_VALUE, RULE_GT, 25.0f },
+                                            { RULE_FIELD_TEMPERATURE, RULE_VALUE, RULE_LE, 40.0f } } },
+        { .id = 4, .n_conds = 2, .conds = { { RULE_FIELD_TEMPERATURE, RULE_VALUE, RULE_GT, 30.0f },
+                                            { RULE_FIELD_TEMPERATURE, RULE_VALUE, RULE_LT, 35.0f } } },
+        { .id = 5, .n_conds = 2, .conds = { { RULE_FIELD_TEMPERATURE, RULE_RATE, RULE_GE, 5.0f },
+                                            { RULE_FIELD_SMOKE, RULE_VALUE, RULE_GT, 100.0f } } },
+    };
+    compile(defs, 5);
+
+    static const struct { float temp; float smoke; bool active[5]; } steps[] = {
+        { 20.0f, 0.0f,   { false, false, false, false, false } },
+        { 32.0f, 200.0f, { false, false, true,  true,  true  } }, // +12 C in a minute, with smoke
+        { 40.0f, 200.0f, { true,  false, true,  false, true  } },
+        { 41.0f, 50.0f,  { true,  true,  false, false, false } },
+        { 35.0f, 200.0f, { false, false, true,  false, false } }, // Falling: no rate alarm
+    };
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        float values[RULE_FIELD_COUNT];
+        frame_of(values, steps[i].temp, steps[i].smoke, 0.0f);
+        rules_eval(engine, 0, 60000 * (int64_t)(i + 1), values);
+        for (int r = 0; r < 5; r++) {
+            TEST_ASSERT_EQUAL_MESSAGE(steps[i].active[r], rules_is_active(engine, r, 0), "overlapping rule");
+        }
+    }
+}
+
+static void test_random_rule_sets_match_naive(void) {
+    int64_t t_ms = 0;
+    for (int set = 0; set < 50; set++) {
+        rule_def_t defs[MAX_RULES];
+        uint16_t n = (uint16_t)(1 + rng_next() % MAX_RULES);
+        for (uint16_t r = 0; r < n; r++) defs[r] = random_rule(r);
+        compile(defs, n);
+        assert_matches_naive(defs, n, &t_ms);
+    }
+}
+
+static void test_recompiles_after_add_and_remove(void) {
+    rule_def_t defs[MAX_RULES];
+    uint16_t n = 12;
+    int64_t t_ms = 0;
+    for (uint16_t r = 0; r < n; r++) defs[r] = random_rule(r);
+    compile(defs, n);
+    assert_matches_naive(defs, n, &t_ms);
+
+    for (int change = 0; change < 40; change++) {
+        if (n < MAX_RULES && (n <= 1 || rng_next() % 2)) {
+            defs[n] = random_rule((uint16_t)(1000 + change)); // Add one
+            n++;
+        } else {
+            uint16_t drop = (uint16_t)(rng_next() % n); // Remove one; the rest move down
+            memmove(&defs[drop], &defs[drop + 1], (size_t)(n - drop - 1) * sizeof(rule_def_t));
+            n--;
+        }
+        compile(defs, n);
+        assert_matches_naive(defs, n, &t_ms);
+    }
+
+    // Alarms carry the rule's id, not its position in the recompiled set
+    const rule_def_t hot = { .id = 77, .n_conds = 1, .conds = { { RULE_FIELD_TEMPERATURE, RULE_VALUE, RULE_GT, 45.0f } } };
+    defs[0] = hot;
+    compile(defs, 1);
+    float values[RULE_FIELD_COUNT];
+    frame_of(values, 50.0f, 0.0f, 0.0f);
+    rules_eval(engine, 2, t_ms + 1000, values);
+    TEST_ASSERT_EQUAL(1, alarm_count);
+    TEST_ASSERT_EQUAL(77, alarms[0].rule_id);
+    TEST_ASSERT_EQUAL(2, alarms[0].slave);
+    TEST_ASSERT_TRUE(alarms[0].active);
+}
+
+static void test_hold_and_cross_slave(void) {
+    const rule_def_t defs[] = {
+        { .id = 10, .n_conds = 1, .conds = { { RULE_FIELD_SMOKE, RULE_VALUE, RULE_GT, 100.0f } }, .hold_ms = 10000 },
+        { .id = 11, .n_conds = 1, .conds = { { RULE_FIELD_MOTION, RULE_VALUE, RULE_GE, 1.0f } }, .min_slaves = 2 },
+    };
+    compile(defs, 2);
+    float values[RULE_FIELD_COUNT];
+
+    // Smoke must hold for 10 s; a clean frame in between restarts the hold
+    frame_of(values, 20.0f, 200.0f, 0.0f);
+    rules_eval(engine, 0, 0, values);
+    rules_eval(engine, 0, 5000, values);
+    TEST_ASSERT_FALSE(rules_is_active(engine, 0, 0));
+    frame_of(values, 20.0f, 50.0f, 0.0f);
+    rules_eval(engine, 0, 8000, values);
+    frame_of(values, 20.0f, 200.0f, 0.0f);
+    rules_eval(engine, 0, 12000, values);
+    rules_eval(engine, 0, 21000, values);
+    TEST_ASSERT_FALSE(rules_is_active(engine, 0, 0));
+    rules_eval(engine, 0, 22000, values);
+    TEST_ASSERT_TRUE(rules_is_active(engine, 0, 0));
+    TEST_ASSERT_EQUAL(1, alarm_count);
+
+    // Motion at two slaves at once; the fleet alarm clears when one goes quiet for good
+    alarm_count = 0;
+    frame_of(values, 20.0f, 0.0f, 1.0f);
+    rules_eval(engine, 1, 30000, values);
+    TEST_ASSERT_FALSE(rules_is_active(engine, 1, 1));
+    rules_eval(engine, 2, 31000, values);
+    TEST_ASSERT_TRUE(rules_is_active(engine, 1, 0)); // Fleet-wide: any slave index reads it
+    TEST_ASSERT_EQUAL(1, alarm_count);
+    TEST_ASSERT_EQUAL(11, alarms[0].rule_id);
+    TEST_ASSERT_EQUAL(2, alarms[0].slave);
+    rules_expire(engine, 30000 + RULES_SLAVE_TIMEOUT_MS); // Slave 1 is a full timeout old, no more
+    TEST_ASSERT_TRUE(rules_is_active(engine, 1, 0));
+    rules_expire(engine, 30000 + RULES_SLAVE_TIMEOUT_MS + 1); // Slave 1 is now silent too long
+    TEST_ASSERT_FALSE(rules_is_active(engine, 1, 0));
+    TEST_ASSERT_EQUAL(2, alarm_count);
+    TEST_ASSERT_EQUAL(1, alarms[1].slave);
+    TEST_ASSERT_FALSE(alarms[1].active);
+}
+
+static void test_rejects_malformed_rules(void) {
+    rule_def_t bad = { .id = 1, .n_conds = 1, .conds = { { RULE_FIELD_TEMPERATURE, RULE_VALUE, RULE_GT, 30.0f } } };
+    rules_engine_t* e = NULL;
+
+    bad.n_conds = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rules_compile(&bad, 1, SLAVES, &e));
+    bad.n_conds = RULES_MAX_CONDS + 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rules_compile(&bad, 1, SLAVES, &e));
+    bad.n_conds = 1;
+    bad.conds[0].op = RULE_LE + 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rules_compile(&bad, 1, SLAVES, &e));
+    bad.conds[0].op = RULE_GT;
+    bad.conds[0].field = RULE_FIELD_COUNT;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rules_compile(&bad, 1, SLAVES, &e));
+    bad.conds[0].field = RULE_FIELD_TEMPERATURE;
+    bad.conds[0].threshold = NAN;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rules_compile(&bad, 1, SLAVES, &e));
+    TEST_ASSERT_NULL(e);
+
+    // An empty set compiles and never fires
+    TEST_ASSERT_EQUAL(ESP_OK, rules_compile(NULL, 0, SLAVES, &e));
+    float values[RULE_FIELD_COUNT];
+    frame_of(values, 90.0f, 9000.0f, 1.0f);
+    rules_eval(e, 0, 1000, values);
+    rules_destroy(e);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_thresholds_at_and_either_side);
+    RUN_TEST(test_overlapping_rules_on_one_field);
+    RUN_TEST(test_random_rule_sets_match_naive);
+    RUN_TEST(test_recompiles_after_add_and_remove);
+    RUN_TEST(test_hold_and_cross_slave);
+    RUN_TEST(test_rejects_malformed_rules);
+    return UNITY_END();
+}
@@ -0,0 +1,65 @@
+// The slave's sampling loop for a simulated day against the soak's sensor and radio models
+#include <unity.h>
+#include "host.h"
+#include "pairing.h"
+#include "soak.h"
+
+void app_main(void);
+
+static soak_stats_t st;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// The day runs once; each test checks its part of the result
+static void soak_run(void) {
+    static bool done;
+    if (done) return;
+    done = true;
+    app_main();
+    TEST_ASSERT_TRUE_MESSAGE(host_task_wait("sensor_task", 10 * 60 * 1000), "soak did not finish within 10 min");
+    soak_get_stats(&st);
+}
+
+static void test_day_of_sampling(void) {
+    soak_run();
+    TEST_ASSERT_TRUE(soak_finished());
+    TEST_ASSERT_GREATER_THAN_UINT32(SOAK_DURATION_S / 300, st.cycles); // At least one cycle per 5 min
+    // Real time on a shared build machine can stall a thread for a few ms; the firmware cannot
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(st.cycles / 1000, st.missed_deadlines);
+
+    // Radio failures and outages were exercised
+    TEST_ASSERT_GREATER_THAN_UINT32(0, st.frames_failed);
+    TEST_ASSERT_GREATER_THAN_UINT32(st.frames_failed, st.frames_sent);
+
+    // Every burst reached the master, but one in the last SOAK_EVENT_DEADLINE_S may still
+    // be on its way when the day ends
+    TEST_ASSERT_GREATER_THAN_UINT32(0, st.motion_events);
+    TEST_ASSERT_EQUAL_UINT32(0, st.motion_lost);
+    TEST_ASSERT_EQUAL_UINT32(st.motion_events, st.motion_delivered + st.motion_pending);
+
+    TEST_ASSERT_GREATER_THAN_UINT32(0, st.events);
+    TEST_ASSERT_EQUAL_UINT32(st.events, st.events_detected);
+    TEST_ASSERT_EQUAL_UINT32(0, st.events_missed);
+    TEST_ASSERT_EQUAL_UINT32(0, st.false_alarms);
+    TEST_ASSERT_EQUAL_UINT32(0, st.misclassified);
+}
+
+// The primary master dies at SOAK_PRIMARY_DOWN_S; frames must reach the standby within
+// the deadline and the slave must stay with it
+static void test_failover_to_standby(void) {
+    soak_run();
+    TEST_ASSERT_GREATER_OR_EQUAL(0, st.failover_us);
+    TEST_ASSERT_LESS_OR_EQUAL((int64_t)SOAK_FAILOVER_DEADLINE_S * 1000000, st.failover_us);
+    TEST_ASSERT_TRUE(pairing_ready());
+    TEST_ASSERT_EQUAL_MEMORY(soak_standby_mac, pairing_master_mac(), 6);
+    TEST_ASSERT_EQUAL_MEMORY(soak_master_mac, pairing_primary_mac(), 6);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_day_of_sampling);
+    RUN_TEST(test_failover_to_standby);
+    return UNITY_END();
+}
@@ -0,0 +1,327 @@
+// Spool outages, remounts and overflow on a RAM backend with NOR flash rules
+#include <string.h>
+#include <unity.h>
+#include "spool.h"
+
+// --- RAM Backend ---
+// Writes may only clear bits, as on NOR flash; fail_writes_after injects a backend
+// failure (a write that stops half way, like a reset mid-record).
+
+#define RAM_SECTORS 8
+
+typedef struct {
+    uint8_t mem[RAM_SECTORS * SPOOL_SECTOR_SIZE];
+    size_t size;
+    int fail_writes_after;     // Writes left before one fails half written; -1 = never
+    bool fail_ack_writes;      // Fail the 4-byte ack writes only
+    uint32_t nor_violations;   // Writes that tried to set a cleared bit
+} ram_flash_t;
+
+static ram_flash_t flash;
+
+static esp_err_t ram_read(void* ctx, size_t offset, void* dst, size_t len) {
+    ram_flash_t* f = ctx;
+    if (offset + len > f->size) return ESP_ERR_INVALID_ARG;
+    memcpy(dst, f->mem + offset, len);
+    return ESP_OK;
+}
+
+static esp_err_t ram_write(void* ctx, size_t offset, const void* src, size_t len) {
+    ram_flash_t* f = ctx;
+    if (offset + len > f->size) return ESP_ERR_INVALID_ARG;
+    if (f->fail_ack_writes && len == 4 && memcmp(src, "\0\0\0\0", 4) == 0) return ESP_FAIL;
+    size_t n = len;
+    esp_err_t ret = ESP_OK;
+    if (f->fail_writes_after == 0) {
+        n = len / 2;
+        ret = ESP_FAIL;
+    } else if (f->fail_writes_after > 0) {
+        f->fail_writes_after--;
+    }
+    const uint8_t* s = src;
+    for (size_t i = 0; i < n; i++) {
+        if ((f->mem[offset + i] & s[i]) != s[i]) f->nor_violations++;
+        f->mem[offset + i] &= s[i];
+    }
+    return ret;
+}
+
+static esp_err_t ram_erase(void* ctx, size_t offset, size_t len) {
+    ram_flash_t* f = ctx;
+    if (offset % SPOOL_SECTOR_SIZE != 0 || len % SPOOL_SECTOR_SIZE != 0 || offset + len > f->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(f->mem + offset, 0xFF, len);
+    return ESP_OK;
+}
+
+static spool_backend_t ram_backend(size_t sectors) {
+    flash.size = sectors * SPOOL_SECTOR_SIZE;
+    return (spool_backend_t){ .size = flash.size, .read = ram_read, .write = ram_write, .erase = ram_erase, .ctx = &flash };
+}
+
+// --- Fake Broker ---
+// Messages are [uint32_t seq][filler]; the broker checks they arrive in order.
+
+typedef struct {
+    bool up;
+    uint32_t next;             // Next seq expected
+    uint32_t first;            // First seq received (after drops)
+    uint32_t received;
+    uint32_t batches;
+    bool out_of_order;
+} broker_t;
+
+static broker_t broker;
+
+static esp_err_t broker_sink(const uint8_t* batch, size_t len, uint32_t n, void* ctx) {
+    broker_t* b = ctx;
+    if (!b->up) return ESP_ERR_TIMEOUT;
+    size_t off = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        TEST_ASSERT_LESS_OR_EQUAL(len, off + 2);
+        uint16_t msg_len = (uint16_t)(batch[off] | (batch[off + 1] << 8));
+        uint32_t seq;
+        memcpy(&seq, batch + off + 2, sizeof(seq));
+        if (b->received == 0) {
+            b->first = seq;
+        } else if (seq != b->next) {
+            b->out_of_order = true;
+        }
+        b->next = seq + 1;
+        b->received++;
+        off += 2 + msg_len;
+    }
+    TEST_ASSERT_EQUAL(len, off);
+    b->batches++;
+    return ESP_OK;
+}
+
+static const spool_config_t config = {
+    .drain_rate_bps = 8192,
+    .burst_bytes = 8192,
+    .batch_max_bytes = 2 + SPOOL_MAX_MESSAGE,
+    .drop_oldest = true,
+};
+
+static int64_t now_ms;
+
+static esp_err_t append_seq(spool_t* spool, uint32_t seq, size_t len) {
+    uint8_t msg[256];
+    memset(msg, (int)seq, sizeof(msg));
+    memcpy(msg, &seq, sizeof(seq));
+    return spool_append(spool, msg, len);
+}
+
+// Drains until the spool is empty or the sink fails; returns the last drain result
+static esp_err_t drain_all(spool_t* spool) {
+    for (int i = 0; i < 10000; i++) {
+        spool_stats_t st;
+        spool_get_stats(spool, &st);
+        if (st.records == 0) return ESP_OK;
+        now_ms += 100;
+        esp_err_t ret = spool_drain(spool, now_ms, broker_sink, &broker);
+        if (ret != ESP_OK && ret != ESP_ERR_NOT_FINISHED) return ret;
+    }
+    return ESP_ERR_TIMEOUT;
+}
+
+void setUp(void) {
+    memset(&flash, 0xFF, sizeof(flash.mem));
+    flash.fail_writes_after = -1;
+    flash.fail_ack_writes = false;
+    flash.nor_violations = 0;
+    memset(&broker, 0, sizeof(broker));
+    broker.up = true;
+    now_ms = 0;
+}
+
+void tearDown(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, flash.nor_violations);
+}
+
+static void test_outage_costs_latency_not_data(void) {
+    spool_backend_t be = ram_backend(RAM_SECTORS);
+    spool_t* spool;
+    TEST_ASSERT_EQUAL(ESP_OK, spool_open(&be, &config, &spool));
+
+    broker.up = false;
+    for (uint32_t seq = 0; seq < 200; seq++) TEST_ASSERT_EQUAL(ESP_OK, append_seq(spool, seq, 64));
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, drain_all(spool));
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, drain_all(spool));
+
+    spool_stats_t st;
+    spool_get_stats(spool, &st);
+    TEST_ASSERT_EQUAL_UINT32(200, st.records);
+    TEST_ASSERT_EQUAL_UINT32(2, st.sink_failures);
+    TEST_ASSERT_EQUAL_UINT32(0, broker.received);
+
+    broker.up = true;
+    TEST_ASSERT_EQUAL(ESP_OK, drain_all(spool));
+    spool_get_stats(spool, &st);
+    TEST_ASSERT_EQUAL_UINT32(0, st.records);
+    TEST_ASSERT_EQUAL_UINT32(200, st.drained_records);
+    TEST_ASSERT_EQUAL_UINT32(200, broker.received);
+    TEST_ASSERT_EQUAL_UINT32(0, broker.first);
+    TEST_ASSERT_FALSE(broker.out_of_order);
+    spool_close(spool);
+}
+
+static void test_drain_is_paced_by_the_token_bucket(void) {
+    spool_backend_t be = ram_backend(RAM_SECTORS);
+    spool_t* spool;
+    TEST_ASSERT_EQUAL(ESP_OK, spool_open(&be, &config, &spool));
+    for (uint32_t seq = 0; seq < 300; seq++) TEST_ASSERT_EQUAL(ESP_OK, append_seq(spool, seq, 100));
+
+    // Polled every 10 ms for 2 s: one burst plus 2 s at drain_rate_bps of batch bytes (payload plus
+    // 2 per message), less at most the batch still waiting
+    for (now_ms = 0; now_ms <= 2000; now_ms += 10) spool_drain(spool, now_ms, broker_sink, &broker);
+    spool_stats_t st;
+    spool_get_stats(spool, &st);
+    uint64_t wire = st.drained_bytes + 2ULL * st.drained_records;
+    TEST_ASSERT_LESS_OR_EQUAL_UINT64(config.burst_bytes + 2 * config.drain_rate_bps, wire);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT64(config.burst_bytes + 2 * config.drain_rate_bps - config.batch_max_bytes, wire);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, st.records);
+    TEST_ASSERT_FALSE(broker.out_of_order);
+    spool_close(spool);
+}
+
+static void test_remount_resumes_after_the_last_ack(void) {
+    spool_backend_t be = ram_backend(RAM_SECTORS);
+    spool_t* spool;
+    TEST_ASSERT_EQUAL(ESP_OK, spool_open(&be, &config, &spool));
+    for (uint32_t seq = 0; seq < 100; seq++) TEST_ASSERT_EQUAL(ESP_OK, append_seq(spool, seq, 120));
+    TEST_ASSERT_EQUAL(ESP_OK, spool_drain(spool, 0, broker_sink, &broker)); // One batch
+    uint32_t delivered = broker.received;
+    TEST_ASSERT_GREATER_THAN_UINT32(0, delivered);
+    TEST_ASSERT_LESS_THAN_UINT32(100, delivered);
+    spool_close(spool);
+
+    TEST_ASSERT_EQUAL(ESP_OK, spool_open(&be, &config, &spool));
+    spool_stats_t st;
+    spool_get_stats(spool, &st);
+    TEST_ASSERT_EQUAL_UINT32(100 - delivered, st.records);
+
+    // Appends after the remount follow the old ones
+    for (uint32_t seq = 100; seq < 150; seq++) TEST_ASSERT_EQUAL(ESP_OK, append_seq(spool, seq, 120));
+    TEST_ASSERT_EQUAL(ESP_OK, drain_all(spool));
+    TEST_ASSERT_EQUAL_UINT32(150, broker.received);
+    TEST_ASSERT_FALSE(broker.out_of_order);
+    spool_close(spool);
+
+    TEST_ASSERT_EQUAL(ESP_OK, spool_open(&be, &config, &spool));
+    spool_get_stats(spool, &st);
+    TEST_ASSERT_EQUAL_UINT32(0, st.records);
+    spool_close(spool);
+}
+
+static void test_torn_append_is_skipped_at_remount(void) {
+    spool_backend_t be = ram_backend(RAM_SECTORS);
+    spool_t* spool;
+    TEST_ASSERT_EQUAL(ESP_OK, spool_open(&be, &config, &spool));
+    broker.up = false;
+    for (uint32_t seq = 0; seq < 10; seq++) TEST_ASSERT_EQUAL(ESP_OK, append_seq(spool, seq, 64));
+    flash.fail_writes_after = 1; // Header written, payload torn
+    TEST_ASSERT_EQUAL(ESP_FAIL, append_seq(spool, 10, 64));
+    flash.fail_writes_after = -1;
+    TEST_ASSERT_EQUAL(ESP_OK, append_seq(spool, 11, 64)); // Goes to a fresh sector
+    spool_close(spool);
+
+    TEST_ASSERT_EQUAL(ESP_OK, spool_open(&be, &config, &spool));
+    spool_stats_t st;
+    spool_get_stats(spool, &st);
+    TEST_ASSERT_EQUAL_UINT32(11, st.records);
+    broker.up = true;
+    TEST_ASSERT_EQUAL(ESP_OK, drain_all(spool));
+    TEST_ASSERT_EQUAL_UINT32(11, broker.received);
+    TEST_ASSERT_TRUE(broker.out_of_order); // 10 is lost: it never finished writing
+    TEST_ASSERT_EQUAL_UINT32(12, broker.next);
+    spool_close(spool);
+}
+
+static void test_failed_ack_still_counts_the_delivery(void) {
+    spool_backend_t be = ram_backend(RAM_SECTORS);
+    spool_t* spool;
+    TEST_ASSERT_EQUAL(ESP_OK, spool_open(&be, &config, &spool));
+    for (uint32_t seq = 0; seq < 10; seq++) TEST_ASSERT_EQUAL(ESP_OK, append_seq(spool, seq, 64));
+    flash.fail_ack_writes = true;
+    TEST_ASSERT_EQUAL(ESP_OK, spool_drain(spool, 0, broker_sink, &broker));
+
+    spool_stats_t st;
+    spool_get_stats(spool, &st);
+    TEST_ASSERT_EQUAL_UINT32(10, broker.received);
+    TEST_ASSERT_EQUAL_UINT32(0, st.records);
+    TEST_ASSERT_EQUAL_UINT32(10, st.drained_records);
+    TEST_ASSERT_EQUAL_UINT32(1, st.ack_failures);
+    TEST_ASSERT_EQUAL(ESP_OK, spool_drain(spool, 100, broker_sink, &broker)); // Nothing left
+    TEST_ASSERT_EQUAL_UINT32(1, broker.batches);
+    spool_close(spool);
+
+    // Without the ack, a reset resends the batch
+    flash.fail_ack_writes = false;
+    TEST_ASSERT_EQUAL(ESP_OK, spool_open(&be, &config, &spool));
+    spool_get_stats(spool, &st);
+    TEST_ASSERT_EQUAL_UINT32(10, st.records);
+    spool_close(spool);
+}
+
+static void test_overflow_drops_the_oldest_sector(void) {
+    spool_backend_t be = ram_backend(4);
+    spool_t* spool;
+    TEST_ASSERT_EQUAL(ESP_OK, spool_open(&be, &config, &spool));
+    broker.up = false;
+    const uint32_t total = 4 * SPOOL_SECTOR_SIZE / 136 + 60; // More than the region holds
+    for (uint32_t seq = 0; seq < total; seq++) TEST_ASSERT_EQUAL(ESP_OK, append_seq(spool, seq, 128));
+
+    spool_stats_t st;
+    spool_get_stats(spool, &st);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, st.dropped);
+    TEST_ASSERT_EQUAL_UINT32(total, st.records + st.dropped);
+
+    broker.up = true;
+    TEST_ASSERT_EQUAL(ESP_OK, drain_all(spool));
+    TEST_ASSERT_EQUAL_UINT32(st.dropped, broker.first); // Exactly the oldest went
+    TEST_ASSERT_EQUAL_UINT32(total, broker.next);
+    TEST_ASSERT_FALSE(broker.out_of_order);
+    spool_close(spool);
+}
+
+static void test_overflow_rejects_without_drop_oldest(void) {
+    spool_backend_t be = ram_backend(4);
+    spool_config_t cfg = config;
+    cfg.drop_oldest = false;
+    spool_t* spool;
+    TEST_ASSERT_EQUAL(ESP_OK, spool_open(&be, &cfg, &spool));
+    uint32_t accepted = 0;
+    esp_err_t ret = ESP_OK;
+    while (ret == ESP_OK && accepted < 1000) {
+        ret = append_seq(spool, accepted, 128);
+        if (ret == ESP_OK) accepted++;
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, ret);
+
+    spool_stats_t st;
+    spool_get_stats(spool, &st);
+    TEST_ASSERT_EQUAL_UINT32(1, st.rejected);
+    TEST_ASSERT_EQUAL_UINT32(0, st.dropped);
+    TEST_ASSERT_EQUAL_UINT32(accepted, st.records);
+
+    // Draining makes room again
+    TEST_ASSERT_EQUAL(ESP_OK, drain_all(spool));
+    TEST_ASSERT_EQUAL(ESP_OK, append_seq(spool, accepted, 128));
+    TEST_ASSERT_EQUAL_UINT32(accepted, broker.received);
+    TEST_ASSERT_FALSE(broker.out_of_order);
+    spool_close(spool);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_outage_costs_latency_not_data);
+    RUN_TEST(test_drain_is_paced_by_the_token_bucket);
+    RUN_TEST(test_remount_resumes_after_the_last_ack);
+    RUN_TEST(test_torn_append_is_skipped_at_remount);
+    RUN_TEST(test_failed_ack_still_counts_the_delivery);
+    RUN_TEST(test_overflow_drops_the_oldest_sector);
+    RUN_TEST(test_overflow_rejects_without_drop_oldest);
+    return UNITY_END();
+}
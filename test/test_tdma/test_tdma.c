@@ -0,0 +1,238 @@
+// A fleet of slaves sharing the master's channel (lib/TDMA): delivered frames/s against
+// slave count with a fixed report period from boot, with jitter only, and with the
+// master's slot assignments
+#include <string.h>
+#include <unity.h>
+#include "host.h"
+#include "tdma.h"
+
+static const char *TAG = "TDMA_SIM";
+
+// Slaves stand evenly along an aisle with the master at one end; the master hears them
+// all, but a slave only senses the carrier of those within SIM_SENSE_M, so the far ends
+// of the aisle are hidden from each other. A frame reaches the master unless another
+// transmission overlaps it. Slaves sense the channel before sending (CSMA, defer plus
+// random backoff), but two that start within SIM_CCA_US of each other cannot tell. Lost
+// frames are retried by the MAC up to SIM_MAC_RETRIES times with binary exponential
+// backoff, as ESP-NOW unicasts are. Every slave was powered on with the others.
+#define SIM_PERIOD_MS        5000    // Report period
+#define SIM_SLOT_MS          20      // One frame with its retries plus TDMA_GUARD_MS
+#define SIM_DURATION_S       3600
+#define SIM_WARMUP_S         60      // Assignments settle; not counted
+#define SIM_AIRTIME_US       2200    // A full batch frame at 1 Mbps with its MAC ack
+#define SIM_AISLE_M          120
+#define SIM_SENSE_M          40
+#define SIM_CCA_US           20
+#define SIM_BACKOFF_SLOT_US  9
+#define SIM_CW_MIN           15
+#define SIM_MAC_RETRIES      7
+#define SIM_BOOT_SPREAD_MS   300     // Power-on to first report, across the fleet
+#define SIM_DRIFT_PPM        20      // Crystal tolerance, each way
+#define SIM_BEACON_LOSS_PCT  2       // Per slave, per beacon (and per assignment)
+
+typedef enum {
+    MODE_FIXED = 0,     // SIM_PERIOD_MS from boot, as before slotting
+    MODE_JITTER,        // tdma.h's fallback only: never assigned a slot
+    MODE_SLOTTED,       // Beacons and slot assignments from the master
+    MODE_COUNT,
+} sim_mode_t;
+
+static const char *const mode_names[MODE_COUNT] = { "fixed", "jitter", "slotted" };
+
+typedef struct {
+    tdma_slave_t tdma;
+    uint8_t mac[6];
+    float pos_m;
+    int64_t boot_us;        // Global time of power-on
+    double rate;            // Local clock rate (1 + drift)
+    int64_t next_us;        // Global time of this slave's next event
+    int64_t report_us;      // Global time the current frame was first tried
+    bool sending;           // next_us is the end of a transmission, not a start
+    bool collided;
+    uint8_t attempt;
+} sim_slave_t;
+
+typedef struct {
+    uint32_t offered;       // Frames the slaves wanted to send (after the warm-up)
+    uint32_t delivered;
+    uint32_t attempts;
+} sim_result_t;
+
+static sim_slave_t slaves[TDMA_MAX_SLAVES];
+static tdma_master_t master;
+static uint32_t rng_state;
+
+static uint32_t rng_next(void) {
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return rng_state = x;
+}
+
+static int64_t local_us(const sim_slave_t *s, int64_t global_us) {
+    return (int64_t)((double)(global_us - s->boot_us) * s->rate);
+}
+
+static int64_t global_us(const sim_slave_t *s, int64_t local) {
+    return s->boot_us + (int64_t)((double)local / s->rate);
+}
+
+static int64_t backoff_us(uint8_t attempt) {
+    uint32_t cw = ((SIM_CW_MIN + 1) << (attempt < 6 ? attempt : 6)) - 1;
+    return (int64_t)(rng_next() % (cw + 1)) * SIM_BACKOFF_SLOT_US;
+}
+
+// Schedules the slave's next report after now
+static void sim_next_report(sim_slave_t *s, sim_mode_t mode, int64_t now_us) {
+    if (mode == MODE_FIXED) {
+        int64_t period_us = (int64_t)SIM_PERIOD_MS * 1000;
+        int64_t local = local_us(s, now_us);
+        s->next_us = global_us(s, (local / period_us + 1) * period_us);
+    } else {
+        s->next_us = global_us(s, tdma_slave_next_tx_us(&s->tdma, local_us(s, now_us)));
+    }
+    s->attempt = 0;
+    s->report_us = s->next_us;
+}
+
+static void sim_run(int count, sim_mode_t mode, sim_result_t *r) {
+    memset(r, 0, sizeof(*r));
+    rng_state = 0x7D3A + count;
+    tdma_master_init(&master, SIM_SLOT_MS, SIM_PERIOD_MS);
+    for (int i = 0; i < count; i++) {
+        sim_slave_t *s = &slaves[i];
+        memset(s, 0, sizeof(*s));
+        s->mac[0] = 0x02;
+        s->mac[5] = (uint8_t)i;
+        s->pos_m = count > 1 ? (float)SIM_AISLE_M * i / (count - 1) : 0;
+        s->boot_us = (int64_t)(rng_next() % (SIM_BOOT_SPREAD_MS * 1000));
+        s->rate = 1.0 + (double)((int32_t)(rng_next() % (2 * SIM_DRIFT_PPM + 1)) - SIM_DRIFT_PPM) / 1e6;
+        tdma_slave_init(&s->tdma, SIM_PERIOD_MS);
+        s->next_us = s->boot_us; // First report right after boot
+        s->report_us = s->next_us;
+    }
+
+    int64_t end_us = (int64_t)SIM_DURATION_S * 1000000;
+    int64_t warmup_us = (int64_t)SIM_WARMUP_S * 1000000;
+    int64_t beacon_us = 0;
+    for (;;) {
+        int next = -1;
+        for (int i = 0; i < count; i++) {
+            if (next < 0 || slaves[i].next_us < slaves[next].next_us) next = i;
+        }
+        int64_t now_us = slaves[next].next_us;
+        if (mode == MODE_SLOTTED && beacon_us <= now_us) {
+            // The master's beacon opens each superframe
+            uint16_t slot_count = tdma_master_slot_count(&master);
+            uint16_t superframe_ms = tdma_master_superframe_ms(&master);
+            for (int i = 0; i < count && slot_count > 0; i++) {
+                if (rng_next() % 100 >= SIM_BEACON_LOSS_PCT) {
+                    tdma_slave_on_beacon(&slaves[i].tdma, superframe_ms, SIM_SLOT_MS, slot_count,
+                                         local_us(&slaves[i], beacon_us));
+                }
+            }
+            tdma_master_tick(&master);
+            beacon_us += (int64_t)superframe_ms * 1000;
+            continue;
+        }
+        if (now_us >= end_us) break;
+
+        sim_slave_t *s = &slaves[next];
+        if (!s->sending) {
+            // Carrier sense: defer behind a transmission we can hear (unless it only just began)
+            int64_t busy_until = 0;
+            for (int i = 0; i < count; i++) {
+                sim_slave_t *o = &slaves[i];
+                float d = o->pos_m - s->pos_m;
+                if (i != next && o->sending && (d < 0 ? -d : d) <= SIM_SENSE_M &&
+                    now_us - (o->next_us - SIM_AIRTIME_US) >= SIM_CCA_US && o->next_us > busy_until) {
+                    busy_until = o->next_us;
+                }
+            }
+            if (busy_until > 0) {
+                s->next_us = busy_until + backoff_us(s->attempt);
+                continue;
+            }
+            s->sending = true;
+            s->collided = false;
+            for (int i = 0; i < count; i++) { // Overlaps garble both frames at the master
+                if (i != next && slaves[i].sending) {
+                    slaves[i].collided = true;
+                    s->collided = true;
+                }
+            }
+            s->next_us = now_us + SIM_AIRTIME_US;
+            if (s->report_us >= warmup_us) r->attempts++;
+            continue;
+        }
+
+        s->sending = false;
+        if (!s->collided) {
+            if (s->report_us >= warmup_us) {
+                r->offered++;
+                r->delivered++;
+            }
+            if (mode == MODE_SLOTTED) {
+                // The master (re)assigns a slot to a slave heard without a usable one
+                int slot = tdma_master_assign(&master, s->mac);
+                if (slot >= 0 && !tdma_slave_is_synced(&s->tdma, local_us(s, now_us)) &&
+                    rng_next() % 100 >= SIM_BEACON_LOSS_PCT) {
+                    tdma_slave_on_assign(&s->tdma, (uint16_t)slot, tdma_master_slot_count(&master), SIM_SLOT_MS,
+                                         tdma_master_superframe_ms(&master));
+                }
+            }
+            sim_next_report(s, mode, now_us);
+        } else if (s->attempt < SIM_MAC_RETRIES) {
+            s->attempt++;
+            s->next_us = now_us + backoff_us(s->attempt);
+        } else {
+            if (s->report_us >= warmup_us) r->offered++; // Lost
+            sim_next_report(s, mode, now_us);
+        }
+    }
+}
+
+void setUp(void) {
+    esp_log_level_set(TAG, ESP_LOG_INFO);
+}
+
+void tearDown(void) {}
+
+static void test_slotted_delivery_beats_unslotted(void) {
+    static const int counts[] = { 8, 16, 32, 48, 64 };
+    const double measured_s = SIM_DURATION_S - SIM_WARMUP_S;
+    sim_result_t results[MODE_COUNT];
+
+    ESP_LOGI(TAG, "%d s, %d ms period, %d ms slots; delivered frames/s (delivery %%, attempts per frame):",
+             SIM_DURATION_S - SIM_WARMUP_S, SIM_PERIOD_MS, SIM_SLOT_MS);
+    ESP_LOGI(TAG, "%6s %22s %22s %22s", "slaves", mode_names[MODE_FIXED], mode_names[MODE_JITTER],
+             mode_names[MODE_SLOTTED]);
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        char cells[MODE_COUNT][32];
+        for (int mode = 0; mode < MODE_COUNT; mode++) {
+            sim_result_t *r = &results[mode];
+            sim_run(counts[c], (sim_mode_t)mode, r);
+            TEST_ASSERT_GREATER_THAN_UINT32(0, r->offered);
+            snprintf(cells[mode], sizeof(cells[mode]), "%6.2f (%5.1f%%, %4.2f)", r->delivered / measured_s,
+                     100.0 * r->delivered / r->offered, (double)r->attempts / r->offered);
+        }
+        ESP_LOGI(TAG, "%6d %22s %22s %22s", counts[c], cells[MODE_FIXED], cells[MODE_JITTER], cells[MODE_SLOTTED]);
+
+        const sim_result_t *slotted = &results[MODE_SLOTTED];
+        // Slots are collision-free: only beacon losses (unsynchronised stretches) cost anything
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT32(slotted->offered * 995 / 1000, slotted->delivered);
+        if (counts[c] >= 32) {
+            for (int mode = MODE_FIXED; mode < MODE_SLOTTED; mode++) {
+                TEST_ASSERT_GREATER_THAN_UINT32(results[mode].delivered, slotted->delivered);
+                TEST_ASSERT_GREATER_THAN_UINT32(slotted->attempts, results[mode].attempts);
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_slotted_delivery_beats_unslotted);
+    return UNITY_END();
+}
@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""Turns the "PROF ..." dumps of a profiling build (CONFIG_SLAVE_PROFILE, src/profile.h)
+into a per-task, per-function and per-zone CPU breakdown.
+
+Capture the console of a profiling build, e.g. `pio device monitor > slave.log`, then:
+
+    tools/profile_report.py slave.log --elf .pio/build/esp32dev/firmware.elf
+
+Every complete dump in the log is summed unless --last is given. Without --elf the
+sampled PCs are listed as raw addresses.
+"""
+
+import argparse
+import collections
+import shutil
+import subprocess
+import sys
+
+
+class Profile:
+    def __init__(self):
+        self.dumps = 0
+        self.window_us = 0
+        self.samples = 0
+        self.core = None
+        self.cores = 1
+        self.hz = 0
+        self.mhz = 0
+        self.tasks = collections.Counter()    # name -> samples on the sampled core
+        self.runtime = collections.Counter()  # name -> run time (us) on any core
+        self.pcs = collections.Counter()      # pc -> samples
+        self.pc_other = 0
+        self.zones = {}                       # name -> [calls, cycles, max_cycles, migrated]
+
+    def add(self, other):
+        self.dumps += other.dumps
+        self.window_us += other.window_us
+        self.samples += other.samples
+        self.core, self.cores, self.hz, self.mhz = other.core, other.cores, other.hz, other.mhz
+        self.tasks.update(other.tasks)
+        self.runtime.update(other.runtime)
+        self.pcs.update(other.pcs)
+        self.pc_other += other.pc_other
+        for name, (calls, cycles, max_cycles, migrated) in other.zones.items():
+            z = self.zones.setdefault(name, [0, 0, 0, 0])
+            z[0] += calls
+            z[1] += cycles
+            z[2] = max(z[2], max_cycles)
+            z[3] += migrated
+
+
+def parse(lines):
+    """Yields one Profile per complete begin..end dump."""
+    cur = None
+    for line in lines:
+        pos = line.find("PROF ")
+        if pos < 0:
+            continue
+        kind, _, rest = line[pos + 5:].strip().partition(" ")
+        try:
+            if kind == "begin":
+                cur = Profile()
+                cur.dumps = 1
+                fields = dict(f.split("=", 1) for f in rest.split())
+                cur.core = int(fields["core"])
+                cur.cores = int(fields["cores"])
+                cur.hz = int(fields["hz"])
+                cur.mhz = int(fields["mhz"])
+                cur.window_us = int(fields["window_us"])
+                cur.samples = int(fields["samples"])
+            elif cur is None:
+                continue
+            elif kind == "task":
+                count, _, name = rest.partition(" ")
+                cur.tasks[name] += int(count)
+            elif kind == "rt":
+                run_us, _, name = rest.partition(" ")
+                cur.runtime[name] += int(run_us)
+            elif kind == "pc":
+                for entry in rest.split():
+                    pc, _, count = entry.partition(":")
+                    cur.pcs[int(pc, 16)] += int(count)
+            elif kind == "pc_other":
+                cur.pc_other += int(rest)
+            elif kind == "zone":
+                calls, cycles, max_cycles, migrated, name = rest.split(" ", 4)
+                cur.zones[name] = [int(calls), int(cycles), int(max_cycles), int(migrated)]
+            elif kind == "end":
+                yield cur
+                cur = None
+        except (ValueError, KeyError):
+            cur = None  # Line mangled on the console (interleaved output): drop the dump
+
+
+def resolve(pcs, elf, addr2line):
+    """Maps each PC to "function (file:line)" with one addr2line run."""
+    if not elf or not pcs:
+        return {pc: "0x%08x" % pc for pc in pcs}
+    tool = addr2line or next((t for t in ("xtensa-esp32-elf-addr2line", "riscv32-esp-elf-addr2line", "addr2line")
+                              if shutil.which(t)), None)
+    if tool is None:
+        sys.exit("No addr2line found; pass --addr2line")
+    ordered = sorted(pcs)
+    out = subprocess.run([tool, "-f", "-C", "-e", elf] + ["0x%x" % pc for pc in ordered],
+                         check=True, capture_output=True, text=True).stdout.splitlines()
+    names = {}
+    for i, pc in enumerate(ordered):
+        func = out[2 * i] if 2 * i < len(out) else "??"
+        where = out[2 * i + 1] if 2 * i + 1 < len(out) else "??:0"
+        names[pc] = "0x%08x" % pc if func == "??" else "%s (%s)" % (func, where.rsplit("/", 1)[-1])
+    return names
+
+
+def function_of(label):
+    return label.split(" (", 1)[0]
+
+
+def report(p, names, top):
+    window_s = p.window_us / 1e6
+    print("%d dump(s), %.1f s; core %s sampled at %d Hz: %d samples, %d cores, %d MHz"
+          % (p.dumps, window_s, p.core, p.hz, p.samples, p.cores, p.mhz))
+
+    print("\nCPU by task, sampled core %s:" % p.core)
+    for name, n in p.tasks.most_common():
+        print("  %6.2f%%  %s" % (100.0 * n / max(p.samples, 1), name))
+
+    if p.runtime:
+        capacity = max(p.window_us * p.cores, 1)
+        print("\nCPU by task, FreeRTOS run time on all %d cores:" % p.cores)
+        for name, us in p.runtime.most_common():
+            print("  %6.2f%%  %s" % (100.0 * us / capacity, name))
+
+    by_func = collections.Counter()
+    for pc, n in p.pcs.items():
+        by_func[function_of(names[pc])] += n
+    print("\nCPU by function, sampled core %s (top %d):" % (p.core, top))
+    for func, n in by_func.most_common(top):
+        print("  %6.2f%%  %s" % (100.0 * n / max(p.samples, 1), func))
+    if p.pc_other:
+        print("  %6.2f%%  (PCs beyond the per-dump list)" % (100.0 * p.pc_other / max(p.samples, 1)))
+
+    print("\nHottest PCs:")
+    for pc, n in p.pcs.most_common(min(top, 10)):
+        print("  %6.2f%%  %s" % (100.0 * n / max(p.samples, 1), names[pc]))
+
+    if p.zones:
+        print("\nZones (elapsed per call, blocking included):")
+        print("  %-16s %8s %10s %10s %9s %9s" % ("zone", "calls", "mean us", "max us", "total ms", "% wall"))
+        for name, (calls, cycles, max_cycles, migrated) in sorted(p.zones.items(), key=lambda z: -z[1][1]):
+            mhz = max(p.mhz, 1)
+            note = "  (%d switched core)" % migrated if migrated else ""
+            print("  %-16s %8d %10.1f %10.1f %9.1f %8.2f%%%s"
+                  % (name, calls, cycles / mhz / max(calls, 1), max_cycles / mhz, cycles / mhz / 1000,
+                     100.0 * cycles / mhz / max(p.window_us, 1), note))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("log", nargs="?", help="Captured console output (default: stdin)")
+    ap.add_argument("--elf", help="Firmware ELF of the build that produced the log")
+    ap.add_argument("--addr2line", help="addr2line of the target toolchain (default: searched on PATH)")
+    ap.add_argument("--last", action="store_true", help="Only the last complete dump")
+    ap.add_argument("--top", type=int, default=25, help="Functions listed (default 25)")
+    args = ap.parse_args()
+
+    with (open(args.log, errors="replace") if args.log else sys.stdin) as f:
+        dumps = list(parse(f))
+    if not dumps:
+        sys.exit("No complete PROF dump found")
+    total = Profile()
+    for d in dumps[-1:] if args.last else dumps:
+        total.add(d)
+    report(total, resolve(list(total.pcs), args.elf, args.addr2line), args.top)
+
+
+if __name__ == "__main__":
+    main()
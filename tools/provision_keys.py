@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Derives a slave's frame keys from the site key and writes them as an NVS image CSV,
+to be flashed before the slave's first boot (src/auth.h, lib/FrameAuth/frame_auth.h).
+
+The slave reads two 16-byte blobs from NVS namespace "auth": "key", its own key
+(fa_derive_key() of the site key and its station MAC), and "gkey", the site's group key
+that checks broadcast frames from the master (fa_derive_group_key()). The site key
+itself never leaves the provisioning machine.
+
+    tools/provision_keys.py --site-key 00112233445566778899aabbccddeeff \\
+        --mac 24:6f:28:aa:bb:cc -o keys.csv
+    python $IDF_PATH/components/nvs_flash/nvs_partition_generator/nvs_partition_gen.py \\
+        generate keys.csv keys.bin 0x6000
+    esptool.py --port /dev/ttyUSB0 write_flash 0x9000 keys.bin
+
+The NVS image replaces the whole partition, including the frame sequence counter, so
+flash it only together with a new site key or on a new slave: reusing a key with a
+reset counter makes the master drop the slave's frames as replays.
+"""
+
+import argparse
+import struct
+import sys
+
+MASK = (1 << 64) - 1
+BROADCAST_MAC = bytes([0xFF] * 6)
+
+
+def rotl(x, b):
+    return ((x << b) | (x >> (64 - b))) & MASK
+
+
+def siphash24(k0, k1, data):
+    v0 = 0x736F6D6570736575 ^ k0
+    v1 = 0x646F72616E646F6D ^ k1
+    v2 = 0x6C7967656E657261 ^ k0
+    v3 = 0x7465646279746573 ^ k1
+
+    def rounds(n):
+        nonlocal v0, v1, v2, v3
+        for _ in range(n):
+            v0 = (v0 + v1) & MASK; v1 = rotl(v1, 13) ^ v0; v0 = rotl(v0, 32)
+            v2 = (v2 + v3) & MASK; v3 = rotl(v3, 16) ^ v2
+            v0 = (v0 + v3) & MASK; v3 = rotl(v3, 21) ^ v0
+            v2 = (v2 + v1) & MASK; v1 = rotl(v1, 17) ^ v2; v2 = rotl(v2, 32)
+
+    whole = len(data) & ~7
+    for i in range(0, whole, 8):
+        m, = struct.unpack_from("<Q", data, i)
+        v3 ^= m
+        rounds(2)
+        v0 ^= m
+    b = (len(data) << 56) & MASK
+    for i, byte in enumerate(data[whole:]):
+        b |= byte << (8 * i)
+    v3 ^= b
+    rounds(2)
+    v0 ^= b
+    v2 ^= 0xFF
+    rounds(4)
+    return v0 ^ v1 ^ v2 ^ v3
+
+
+def derive_key(site_key, mac):
+    """fa_derive_key(): returns the 16 key bytes as fa_key_from_bytes() reads them."""
+    k0, k1 = struct.unpack("<QQ", site_key)
+    return struct.pack("<QQ", siphash24(k0, k1, mac + b"K\x00"), siphash24(k0, k1, mac + b"K\x01"))
+
+
+def parse_mac(text):
+    parts = text.replace("-", ":").split(":")
+    if len(parts) != 6:
+        raise argparse.ArgumentTypeError("MAC must be six hex bytes, e.g. 24:6f:28:aa:bb:cc")
+    return bytes(int(p, 16) for p in parts)
+
+
+def parse_site_key(text):
+    try:
+        key = bytes.fromhex(text)
+    except ValueError:
+        key = b""
+    if len(key) != 16:
+        raise argparse.ArgumentTypeError("site key must be 32 hex digits")
+    return key
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--site-key", type=parse_site_key, required=True, help="32 hex digits, shared with the master")
+    parser.add_argument("--mac", type=parse_mac, required=True, help="the slave's station MAC (esptool.py read_mac)")
+    parser.add_argument("-o", "--output", help="CSV for nvs_partition_gen.py (default: stdout)")
+    args = parser.parse_args()
+
+    rows = [
+        "key,type,encoding,value",
+        "auth,namespace,,",
+        "key,data,hex2bin," + derive_key(args.site_key, args.mac).hex(),
+        "gkey,data,hex2bin," + derive_key(args.site_key, BROADCAST_MAC).hex(),
+    ]
+    out = open(args.output, "w") if args.output else sys.stdout
+    out.write("\n".join(rows) + "\n")
+    if args.output:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()